@@ -0,0 +1,118 @@
+/**
+ * @brief Compare cv::imdecode with the extractor's grayscale decode path
+ *
+ * Encodes synthetic frames of several sizes as JPEG and PNG, then times a
+ * plain cv::imdecode against decodeGrayscale (TurboJPEG / libspng into
+ * pooled buffers when built with them) at full and 1/4 resolution.
+ *
+ * Usage: decode_benchmark [--iterations=N]
+ */
+
+#include "feature_extractor/image_decoder.h"
+#include "options.h"
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace voyis;
+
+namespace {
+
+// Textured test image: smooth gradients plus noise, so codecs do real work
+cv::Mat makeTestImage(int width, int height) {
+    cv::Mat image(height, width, CV_8UC3);
+    for (int y = 0; y < height; ++y) {
+        cv::Vec3b* row = image.ptr<cv::Vec3b>(y);
+        for (int x = 0; x < width; ++x) {
+            row[x] = cv::Vec3b(static_cast<uint8_t>(x * 255 / width),
+                               static_cast<uint8_t>(y * 255 / height),
+                               static_cast<uint8_t>((x + y) % 256));
+        }
+    }
+    cv::Mat noise(height, width, CV_8UC3);
+    cv::randu(noise, 0, 32);
+    image += noise;
+    return image;
+}
+
+// Mean milliseconds per call
+double timeMs(int iterations, const std::function<void()>& fn) {
+    fn(); // Warm up caches and the buffer pool
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        fn();
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+void runCase(const std::string& label, const std::vector<uint8_t>& encoded, int iterations) {
+    DecodeBackend backend = DecodeBackend::OpenCV;
+    decodeGrayscale(encoded.data(), encoded.size(), 1, &backend);
+
+    double opencv_full = timeMs(iterations, [&]() {
+        cv::Mat image = cv::imdecode(encoded, cv::IMREAD_GRAYSCALE);
+    });
+    double fast_full = timeMs(iterations, [&]() {
+        cv::Mat image = decodeGrayscale(encoded.data(), encoded.size(), 1);
+    });
+    double opencv_quarter = timeMs(iterations, [&]() {
+        cv::Mat image = cv::imdecode(encoded, cv::IMREAD_REDUCED_GRAYSCALE_4);
+    });
+    double fast_quarter = timeMs(iterations, [&]() {
+        cv::Mat image = decodeGrayscale(encoded.data(), encoded.size(), 4);
+    });
+
+    std::cout << std::left << std::setw(16) << label
+              << std::setw(11) << decodeBackendName(backend)
+              << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << opencv_full
+              << std::setw(10) << fast_full
+              << std::setw(10) << opencv_quarter
+              << std::setw(10) << fast_quarter
+              << std::setw(9) << opencv_full / fast_full << "x" << std::endl;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    Options options(argc, argv);
+    int iterations = options.getInt("iterations", 20);
+
+    struct Size {
+        const char* name;
+        int width;
+        int height;
+    };
+    const std::vector<Size> sizes = {
+        {"VGA", 640, 480},
+        {"12MP", 4000, 3000},
+        {"30MP", 6480, 4860},
+    };
+
+    std::cout << "Decode benchmark, " << iterations << " iterations per case (ms per frame)"
+              << std::endl;
+    std::cout << std::left << std::setw(16) << "image" << std::setw(11) << "backend"
+              << std::right << std::setw(10) << "cv full" << std::setw(10) << "full"
+              << std::setw(10) << "cv 1/4" << std::setw(10) << "1/4"
+              << std::setw(10) << "speedup" << std::endl;
+
+    for (const auto& size : sizes) {
+        cv::Mat image = makeTestImage(size.width, size.height);
+
+        std::vector<uint8_t> jpeg;
+        cv::imencode(".jpg", image, jpeg, {cv::IMWRITE_JPEG_QUALITY, 90});
+        runCase(std::string(size.name) + " jpeg", jpeg, iterations);
+
+        std::vector<uint8_t> png;
+        cv::imencode(".png", image, png);
+        runCase(std::string(size.name) + " png", png, iterations);
+    }
+
+    return 0;
+}
@@ -0,0 +1,56 @@
+/**
+ * @brief Per-frame cost of the always-on flight recorder
+ *
+ * Times frames made of six empty stages, as the feature extractor records
+ * them, with and without a recorder, and reports the difference as a share
+ * of a typical frame's processing time.
+ *
+ * Usage: flight_recorder_benchmark [--frames=N] [--frame-ms=<typical frame time>]
+ */
+
+#include "flight_recorder.h"
+#include "options.h"
+#include "trace_writer.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+
+using namespace voyis;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double nsPerFrame(FlightRecorder* recorder, int frames) {
+    const std::string frame_id = "frame_000000.jpg_12345";
+    auto start = Clock::now();
+    for (int i = 0; i < frames; ++i) {
+        FlightTimer timer(recorder, frame_id, 1);
+        for (const char* stage : {"process", "preview", "decode", "detect", "serialize", "publish"}) {
+            TraceSpan span(stage, frame_id);
+        }
+        timer.finish(static_cast<size_t>(i & 7));
+    }
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / frames;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    Options options(argc, argv);
+    const int frames = static_cast<int>(options.getInt("frames", 200000));
+    const double frame_ms = options.getDouble("frame-ms", 10.0);
+
+    FlightRecorder recorder("benchmark", 256, ".");
+    double baseline = nsPerFrame(nullptr, frames);
+    double recorded = nsPerFrame(&recorder, frames);
+    double overhead_ns = recorded - baseline;
+
+    std::cout << frames << " frames of 6 stages" << std::endl;
+    std::cout << "Without recorder: " << baseline << " ns/frame" << std::endl;
+    std::cout << "With recorder:    " << recorded << " ns/frame" << std::endl;
+    std::cout << "Overhead: " << overhead_ns / 1000.0 << " us/frame, "
+              << overhead_ns / (frame_ms * 1e4) << "% of a " << frame_ms << " ms frame"
+              << std::endl;
+    return 0;
+}
@@ -0,0 +1,86 @@
+/**
+ * @brief Page faults and time per frame: std::vector against pooled FrameBuffers
+ *
+ * Simulates the per-frame buffer churn of the pipeline: read a frame into a
+ * fresh buffer, serialize it into a second buffer, then free both. With
+ * std::vector every frame maps and faults in new memory; with FrameBuffer
+ * the pool hands back buffers that are already faulted in (and backed by
+ * huge pages where available).
+ *
+ * Usage: frame_buffer_benchmark [--frame-mb=N] [--frames=N]
+ *                               [--huge-pages=off|transparent|explicit]
+ */
+
+#include "frame_allocator.h"
+#include "options.h"
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace voyis;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Result {
+    double faults_per_frame;
+    double ms_per_frame;
+};
+
+template <typename Buffer>
+Result run(size_t frame_bytes, int frames) {
+    PageFaults before = PageFaults::now();
+    auto start = Clock::now();
+    for (int i = 0; i < frames; ++i) {
+        Buffer frame(frame_bytes);
+        std::memset(frame.data(), i & 0xFF, frame.size()); // "Read" the file
+        Buffer serialized(frame_bytes + 64);
+        std::memcpy(serialized.data() + 64, frame.data(), frame.size());
+    }
+    double elapsed_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    PageFaults faults = PageFaults::now() - before;
+
+    Result result;
+    result.faults_per_frame = static_cast<double>(faults.minor + faults.major) / frames;
+    result.ms_per_frame = elapsed_ms / frames;
+    return result;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    Options options(argc, argv);
+    const size_t frame_bytes = static_cast<size_t>(options.getDouble("frame-mb", 24.0) * 1024 * 1024);
+    const int frames = static_cast<int>(options.getInt("frames", 50));
+
+    // Prefault the two buffers a frame needs, as the applications do at startup
+    PageFaults startup = PageFaults::now();
+    FramePool::shared().setMode(parseHugePageMode(options.getString("huge-pages", "transparent")));
+    FramePool::shared().prefault(frame_bytes, 1);
+    FramePool::shared().prefault(frame_bytes + 64, 1);
+    PageFaults prefault = PageFaults::now() - startup;
+
+    std::cout << frames << " frames of " << frame_bytes / (1024.0 * 1024.0) << " MB, huge pages "
+              << hugePageModeName(FramePool::shared().mode()) << " (prefault: " << prefault.minor
+              << " page faults)" << std::endl;
+
+    Result baseline = run<std::vector<uint8_t>>(frame_bytes, frames);
+    Result pooled = run<FrameBuffer>(frame_bytes, frames);
+
+    std::cout << std::left << std::setw(20) << "" << std::right << std::setw(14) << "std::vector"
+              << std::setw(14) << "FrameBuffer" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << std::left << std::setw(20) << "Page faults/frame" << std::right << std::setw(14)
+              << baseline.faults_per_frame << std::setw(14) << pooled.faults_per_frame << std::endl;
+    std::cout << std::setprecision(2);
+    std::cout << std::left << std::setw(20) << "Time/frame (ms)" << std::right << std::setw(14)
+              << baseline.ms_per_frame << std::setw(14) << pooled.ms_per_frame << std::endl;
+
+    FramePool::Stats stats = FramePool::shared().stats();
+    std::cout << "Frame pool: " << stats.mapped << " mapped, " << stats.reused << " reused, "
+              << stats.explicit_huge << " on reserved huge pages" << std::endl;
+    return 0;
+}
@@ -0,0 +1,273 @@
+/**
+ * @brief Compare the lock-free queues and work-stealing pool with mutex baselines
+ *
+ * Throughput: items per second through SpscRing (1 producer, 1 consumer)
+ * and MpmcQueue (N producers, N consumers) against a std::mutex +
+ * std::condition_variable deque. Latency: ping-pong round trips between two
+ * threads over a pair of queues. Executor: many tiny tasks through
+ * WorkStealingPool against a single shared mutex-protected task queue.
+ *
+ * Usage: queue_benchmark [--items=N] [--threads=N]
+ */
+
+#include "lockfree_queue.h"
+#include "options.h"
+#include "work_stealing_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace voyis;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Baseline: deque guarded by a mutex, consumers wait on a condvar
+ */
+template <typename T>
+class MutexQueue {
+public:
+    explicit MutexQueue(size_t capacity) : capacity_(capacity) {}
+
+    bool tryPush(T value) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (items_.size() >= capacity_) {
+                return false;
+            }
+            items_.push_back(std::move(value));
+        }
+        not_empty_.notify_one();
+        return true;
+    }
+
+    bool tryPop(T& value) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!not_empty_.wait_for(lock, std::chrono::milliseconds(1),
+                                 [this]() { return !items_.empty(); })) {
+            return false;
+        }
+        value = std::move(items_.front());
+        items_.pop_front();
+        return true;
+    }
+
+private:
+    size_t capacity_;
+    std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::deque<T> items_;
+};
+
+/**
+ * @brief Baseline executor: one shared task queue, workers wait on a condvar
+ */
+class MutexPool {
+public:
+    explicit MutexPool(size_t threads) {
+        for (size_t i = 0; i < threads; ++i) {
+            threads_.emplace_back([this]() { run(); });
+        }
+    }
+
+    ~MutexPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    void submit(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.push_back(std::move(task));
+            ++active_;
+        }
+        wake_.notify_one();
+    }
+
+    void waitIdle() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_.wait(lock, [this]() { return active_ == 0; });
+    }
+
+private:
+    void run() {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+                if (tasks_.empty()) {
+                    return;
+                }
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+            task();
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--active_ == 0) {
+                idle_.notify_all();
+            }
+        }
+    }
+
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable idle_;
+    std::deque<std::function<void()>> tasks_;
+    size_t active_ = 0;
+    bool stopping_ = false;
+};
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Items per second moved through a queue by the given numbers of threads
+template <typename Queue>
+double throughput(Queue& queue, int producers, int consumers, int64_t items) {
+    const int64_t per_producer = items / producers;
+    const int64_t total = per_producer * producers;
+    std::atomic<int64_t> consumed(0);
+    std::vector<std::thread> threads;
+
+    auto start = Clock::now();
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&]() {
+            for (int64_t i = 0; i < per_producer; ++i) {
+                while (!queue.tryPush(i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&]() {
+            int64_t value = 0;
+            while (consumed.load(std::memory_order_relaxed) < total) {
+                if (queue.tryPop(value)) {
+                    consumed.fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return total / secondsSince(start);
+}
+
+// Mean round trip in microseconds: ping on one queue, pong back on the other
+template <typename Queue>
+double roundTripUs(Queue& ping, Queue& pong, int64_t trips) {
+    std::thread echo([&]() {
+        int64_t value = 0;
+        for (int64_t i = 0; i < trips; ++i) {
+            while (!ping.tryPop(value)) {
+                std::this_thread::yield();
+            }
+            while (!pong.tryPush(value)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    auto start = Clock::now();
+    int64_t value = 0;
+    for (int64_t i = 0; i < trips; ++i) {
+        while (!ping.tryPush(i)) {
+            std::this_thread::yield();
+        }
+        while (!pong.tryPop(value)) {
+            std::this_thread::yield();
+        }
+    }
+    double elapsed = secondsSince(start);
+    echo.join();
+    return elapsed * 1e6 / trips;
+}
+
+// Tasks per second for tiny tasks
+template <typename Pool>
+double taskRate(Pool& pool, int64_t tasks) {
+    std::atomic<int64_t> sum(0);
+    auto start = Clock::now();
+    for (int64_t i = 0; i < tasks; ++i) {
+        pool.submit([&sum, i]() { sum.fetch_add(i, std::memory_order_relaxed); });
+    }
+    pool.waitIdle();
+    return tasks / secondsSince(start);
+}
+
+void printRow(const std::string& label, double baseline, double candidate, const char* unit,
+              bool higher_is_better) {
+    double speedup = higher_is_better ? candidate / baseline : baseline / candidate;
+    std::cout << std::left << std::setw(28) << label << std::right << std::fixed
+              << std::setprecision(2) << std::setw(14) << baseline << std::setw(14) << candidate
+              << "  " << unit << "  (" << speedup << "x)" << std::endl;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    Options options(argc, argv);
+    const int64_t items = options.getInt("items", 2000000);
+    const int threads = static_cast<int>(options.getInt(
+        "threads", std::max(2u, std::thread::hardware_concurrency() / 2)));
+    const size_t capacity = 1024;
+
+    std::cout << items << " items, " << threads << " producer/consumer threads, capacity "
+              << capacity << std::endl;
+    std::cout << std::left << std::setw(28) << "" << std::right << std::setw(14) << "mutex"
+              << std::setw(14) << "lock-free" << std::endl;
+
+    {
+        MutexQueue<int64_t> baseline(capacity);
+        SpscRing<int64_t> ring(capacity);
+        printRow("SPSC throughput", throughput(baseline, 1, 1, items) / 1e6,
+                 throughput(ring, 1, 1, items) / 1e6, "M items/s", true);
+    }
+    {
+        MutexQueue<int64_t> baseline(capacity);
+        MpmcQueue<int64_t> queue(capacity);
+        printRow("MPMC throughput (" + std::to_string(threads) + "x" + std::to_string(threads) + ")",
+                 throughput(baseline, threads, threads, items) / 1e6,
+                 throughput(queue, threads, threads, items) / 1e6, "M items/s", true);
+    }
+    {
+        const int64_t trips = std::max<int64_t>(1, items / 20);
+        MutexQueue<int64_t> ping(capacity);
+        MutexQueue<int64_t> pong(capacity);
+        SpscRing<int64_t> ring_ping(capacity);
+        SpscRing<int64_t> ring_pong(capacity);
+        printRow("SPSC round trip", roundTripUs(ping, pong, trips),
+                 roundTripUs(ring_ping, ring_pong, trips), "us", false);
+    }
+    {
+        const int64_t tasks = std::max<int64_t>(1, items / 4);
+        MutexPool baseline(static_cast<size_t>(threads));
+        WorkStealingPool pool(static_cast<size_t>(threads));
+        printRow("Executor (tiny tasks)", taskRate(baseline, tasks) / 1e6,
+                 taskRate(pool, tasks) / 1e6, "M tasks/s", true);
+    }
+
+    return 0;
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace voyis {
+
+/**
+ * @brief Thread-safe cache of the most recent entries, bounded by count and bytes
+ *
+ * Holds up to max_entries values and max_bytes of their accounted size; the
+ * oldest entries are evicted first. Inserting an existing key replaces it
+ * and makes it the newest. Values are shared, so a reader keeps a value
+ * alive after it is evicted.
+ */
+template <typename Key, typename Value>
+class BoundedCache {
+public:
+    using Entry = std::pair<Key, std::shared_ptr<const Value>>;
+
+    /**
+     * @throws std::invalid_argument if max_entries is 0
+     */
+    BoundedCache(size_t max_entries, size_t max_bytes)
+        : max_entries_(max_entries), max_bytes_(max_bytes) {
+        if (max_entries == 0) {
+            throw std::invalid_argument("Cache needs room for at least one entry");
+        }
+    }
+
+    /**
+     * @brief Add a value accounted as bytes, evicting old entries to stay within the limits
+     * @return false if the value is larger than max_bytes on its own (it is not cached)
+     */
+    bool insert(const Key& key, std::shared_ptr<const Value> value, size_t bytes) {
+        if (bytes > max_bytes_) {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto existing = index_.find(key);
+        if (existing != index_.end()) {
+            bytes_ -= existing->second.second;
+            index_.erase(existing);
+            for (auto it = order_.begin(); it != order_.end(); ++it) {
+                if (*it == key) {
+                    order_.erase(it);
+                    break;
+                }
+            }
+        }
+
+        while (!order_.empty() &&
+               (order_.size() >= max_entries_ || bytes_ + bytes > max_bytes_)) {
+            auto oldest = index_.find(order_.front());
+            bytes_ -= oldest->second.second;
+            index_.erase(oldest);
+            order_.pop_front();
+        }
+
+        order_.push_back(key);
+        index_.emplace(key, std::make_pair(std::move(value), bytes));
+        bytes_ += bytes;
+        return true;
+    }
+
+    /**
+     * @brief Cached value, or nullptr
+     */
+    std::shared_ptr<const Value> find(const Key& key) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        return it == index_.end() ? nullptr : it->second.first;
+    }
+
+    /**
+     * @brief Newest entry whose value satisfies match, or an entry with a null value
+     */
+    template <typename Predicate>
+    Entry findNewest(Predicate match) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = order_.rbegin(); it != order_.rend(); ++it) {
+            const std::shared_ptr<const Value>& value = index_.at(*it).first;
+            if (match(*value)) {
+                return {*it, value};
+            }
+        }
+        return {};
+    }
+
+    /**
+     * @brief Up to count newest entries, newest first
+     */
+    std::vector<Entry> newest(size_t count) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<Entry> entries;
+        entries.reserve(std::min(count, order_.size()));
+        for (auto it = order_.rbegin(); it != order_.rend() && entries.size() < count; ++it) {
+            entries.emplace_back(*it, index_.at(*it).first);
+        }
+        return entries;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return order_.size();
+    }
+
+    size_t bytes() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return bytes_;
+    }
+
+    size_t maxEntries() const { return max_entries_; }
+    size_t maxBytes() const { return max_bytes_; }
+
+private:
+    const size_t max_entries_;
+    const size_t max_bytes_;
+
+    mutable std::mutex mutex_;
+    std::deque<Key> order_; // Oldest first
+    std::unordered_map<Key, std::pair<std::shared_ptr<const Value>, size_t>> index_;
+    size_t bytes_ = 0;
+};
+
+} // namespace voyis
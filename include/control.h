@@ -0,0 +1,172 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace voyis {
+
+class ReplyServer;
+
+/**
+ * @brief Named performance settings that can be changed while running
+ *
+ * The processing loop owns the settings: a control request only queues a
+ * validated batch of changes, and the loop applies the whole batch at the
+ * next frame boundary by calling applyPending(). A frame therefore never
+ * sees half of a batch, and the check costs one atomic load per frame when
+ * nothing is queued.
+ */
+class Tunables {
+public:
+    struct Info {
+        std::string name;
+        double value = 0.0;
+        double min = 0.0;
+        double max = 0.0;
+        bool integer = false;
+        std::string description;
+    };
+
+    /**
+     * @brief Register a setting (before the control server starts)
+     * @throws std::invalid_argument for a duplicate name or a value outside [min, max]
+     */
+    void add(const std::string& name, double value, double min, double max,
+             const std::string& description, bool integer = false);
+
+    /**
+     * @brief Current (applied) value
+     * @throws std::invalid_argument for an unknown name
+     */
+    double get(const std::string& name) const;
+    int64_t getInt(const std::string& name) const;
+
+    /**
+     * @brief Validate and queue a batch of "name" -> "value" changes
+     *
+     * Either every change is queued or none is.
+     * @return Generation to pass to waitApplied()
+     * @throws std::invalid_argument for an unknown name, a malformed or
+     *         out-of-range value, or a fraction for an integer setting
+     */
+    uint64_t request(const std::vector<std::pair<std::string, std::string>>& changes);
+
+    /**
+     * @brief Wait until the processing loop applied a requested batch
+     * @return false if it was not applied within the timeout (it stays queued)
+     */
+    bool waitApplied(uint64_t generation, std::chrono::milliseconds timeout) const;
+
+    /**
+     * @brief Apply all queued changes; call at frame boundaries
+     * @return true if anything changed (the caller re-reads its settings)
+     */
+    bool applyPending();
+
+    /**
+     * @brief All settings in name order
+     */
+    std::vector<Info> list() const;
+
+private:
+    mutable std::mutex mutex_;
+    mutable std::condition_variable applied_cv_;
+    std::map<std::string, Info> entries_;
+    std::vector<std::pair<std::string, double>> pending_;
+    std::atomic<bool> has_pending_{false};
+    uint64_t requested_generation_ = 0;
+    uint64_t applied_generation_ = 0;
+};
+
+/**
+ * @brief Local REQ/REP control socket of a running process
+ *
+ * A background thread answers one-line text requests with JSON:
+ *   get [name...]           current settings
+ *   set name=value [...]    change settings atomically; replies once the
+ *                           processing loop applied them (or reports
+ *                           "applied":false if it did not within 2 s)
+ *   list                    settings with their ranges and descriptions
+ *   stats                   counters published by the process plus uptime,
+ *                           page faults and frame pool state
+ * Use the voyisctl tool to send requests from a shell.
+ */
+class ControlServer {
+public:
+    /**
+     * @throws std::runtime_error if the endpoint cannot be bound, or is an
+     *         ipc:// socket another running process answers on
+     */
+    ControlServer(const std::string& endpoint, const std::string& process_name,
+                  Tunables& tunables);
+
+    /**
+     * @brief Stops the server thread
+     */
+    ~ControlServer();
+
+    ControlServer(const ControlServer&) = delete;
+    ControlServer& operator=(const ControlServer&) = delete;
+
+    /**
+     * @brief Counter reported by "stats", updated lock-free by the hot path
+     *
+     * Register every counter before the first frame; the reference stays valid
+     * for the lifetime of the server.
+     */
+    std::atomic<double>& stat(const std::string& name);
+
+    /**
+     * @brief Answer one request (what the server thread does per message)
+     */
+    std::string handle(const std::string& request);
+
+    const std::string& endpoint() const { return endpoint_; }
+
+private:
+    std::string handleSet(const std::vector<std::string>& args);
+    std::string statsJson();
+
+    const std::string endpoint_;
+    const std::string process_name_;
+    Tunables& tunables_;
+    const std::chrono::steady_clock::time_point started_;
+
+    std::mutex stats_mutex_;
+    std::map<std::string, std::unique_ptr<std::atomic<double>>> stats_;
+
+    std::unique_ptr<ReplyServer> server_; // Last, so it stops before the state it reads
+};
+
+/**
+ * @brief Default control endpoint of a process: ipc:///tmp/voyis-<process>.sock
+ */
+std::string defaultControlEndpoint(const std::string& process_name);
+
+/**
+ * @brief server->stat(name), or a counter nobody reads when control is off
+ */
+std::atomic<double>& controlStat(ControlServer* server, const std::string& name);
+
+class Options;
+
+/**
+ * @brief Start the control socket from the command line
+ *
+ * Binds --control (default defaultControlEndpoint()); --control=off disables
+ * it and returns nullptr.
+ * @throws std::runtime_error if the endpoint cannot be bound or is in use
+ */
+std::unique_ptr<ControlServer> configureControl(const Options& options,
+                                                const std::string& process_name,
+                                                Tunables& tunables);
+
+} // namespace voyis
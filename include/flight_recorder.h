@@ -0,0 +1,206 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace voyis {
+
+/**
+ * @brief Timings and process state of one frame, kept by the flight recorder
+ */
+struct FlightFrame {
+    static constexpr size_t kMaxStages = 8;
+
+    struct Stage {
+        const char* name = nullptr; // String literal
+        float ms = 0.0f;
+    };
+
+    char frame_id[64] = {};
+    int64_t end_unix_ms = 0;
+    float total_ms = 0.0f;      // From FlightTimer start to finish
+    float age_ms = -1.0f;       // Since the frame's capture timestamp, -1 if unknown
+    uint32_t queue_depth = 0;
+    uint32_t stage_count = 0;
+    Stage stages[kMaxStages];   // In the order they ended; extra stages are dropped
+    int64_t minor_faults = 0;   // Page faults of the process during the frame
+    uint64_t pool_mapped = 0;   // FramePool::shared() counters after the frame
+    uint64_t pool_reused = 0;
+    uint64_t pool_cached_bytes = 0;
+
+    /**
+     * @brief Append a stage timing (used by TraceSpan)
+     */
+    void addStage(const char* name, uint64_t duration_ns) {
+        if (stage_count < kMaxStages) {
+            stages[stage_count].name = name;
+            stages[stage_count].ms = static_cast<float>(duration_ns / 1e6);
+            ++stage_count;
+        }
+    }
+};
+
+/**
+ * @brief Always-on ring of the last frames, dumped to disk after a spike
+ *
+ * Recording a frame copies one fixed-size record into a ring under an
+ * uncontended mutex; with the page fault and pool counters that is about
+ * 2 us per frame (benchmarks/flight_recorder_benchmark). Dumps never run
+ * on the recording thread: a background thread writes the snapshot when a
+ * frame exceeds the latency threshold (at most once per cooldown period)
+ * or when the process gets SIGUSR1.
+ *
+ * Dumps are JSON files named flight_<process>_<pid>_<unix ms>_<reason>.json,
+ * oldest frame first.
+ */
+class FlightRecorder {
+public:
+    /**
+     * @param capacity Frames kept
+     * @param dump_dir Directory the snapshots are written to
+     * @param threshold_ms Dump when a frame takes longer; 0 disables
+     * @param cooldown Minimum time between two latency-triggered dumps
+     * @throws std::invalid_argument for a zero capacity
+     */
+    FlightRecorder(const std::string& process_name, size_t capacity, const std::string& dump_dir,
+                   double threshold_ms = 0.0,
+                   std::chrono::milliseconds cooldown = std::chrono::milliseconds(10000));
+
+    /**
+     * @brief Stops the dump thread; pending dump requests are written first
+     */
+    ~FlightRecorder();
+
+    FlightRecorder(const FlightRecorder&) = delete;
+    FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+    /**
+     * @brief Add a finished frame, requesting a dump if it was too slow
+     */
+    void record(const FlightFrame& frame);
+
+    /**
+     * @brief Ask the dump thread to write a snapshot
+     */
+    void requestDump(const std::string& reason);
+
+    /**
+     * @brief Write a snapshot from the calling thread
+     * @return Path of the dump file
+     * @throws std::runtime_error if the file cannot be written
+     */
+    std::string dumpNow(const std::string& reason);
+
+    /**
+     * @brief Recorded frames, oldest first
+     */
+    std::vector<FlightFrame> snapshot() const;
+
+    size_t capacity() const { return ring_.size(); }
+    double thresholdMs() const { return threshold_ms_; }
+    uint64_t dumps() const { return dumps_.load(std::memory_order_relaxed); }
+    std::string lastDumpPath() const;
+
+    /**
+     * @brief One-line description of the settings for startup logs
+     */
+    std::string describe() const;
+
+    /**
+     * @brief Make SIGUSR1 request a dump from every live recorder
+     */
+    static void installSignalHandler();
+
+private:
+    void dumpLoop();
+
+    const std::string process_name_;
+    const std::string dump_dir_;
+    const double threshold_ms_;
+    const std::chrono::milliseconds cooldown_;
+
+    mutable std::mutex ring_mutex_;
+    std::vector<FlightFrame> ring_;
+    uint64_t recorded_ = 0;
+    std::chrono::steady_clock::time_point last_latency_dump_;
+    bool latency_dumped_ = false;
+
+    mutable std::mutex dump_mutex_;
+    std::condition_variable dump_cv_;
+    std::vector<std::string> pending_reasons_;
+    bool stopping_ = false;
+    std::string last_dump_path_;
+    std::atomic<uint64_t> dumps_{0};
+    uint64_t signals_seen_ = 0;
+    std::thread dumper_;
+};
+
+/**
+ * @brief Times one frame and hands it to a recorder when finished
+ *
+ * While a timer is running on a thread, every TraceSpan ending on that thread
+ * adds its duration as a stage of the frame. With a null recorder the timer
+ * does nothing.
+ */
+class FlightTimer {
+public:
+    /**
+     * @param capture_unix_ms Capture timestamp of the frame, 0 if unknown
+     */
+    FlightTimer(FlightRecorder* recorder, const std::string& frame_id, int64_t capture_unix_ms = 0);
+
+    /**
+     * @brief Finishes the frame if finish() was not called
+     */
+    ~FlightTimer();
+
+    FlightTimer(const FlightTimer&) = delete;
+    FlightTimer& operator=(const FlightTimer&) = delete;
+
+    /**
+     * @brief Set the frame once it is known, e.g. after deserializing
+     */
+    void setFrameId(const std::string& frame_id, int64_t capture_unix_ms = 0);
+
+    /**
+     * @brief Record the frame (once)
+     */
+    void finish(size_t queue_depth = 0);
+
+    /**
+     * @brief Frame being timed on the calling thread, or nullptr
+     */
+    static FlightFrame* current() { return current_; }
+
+private:
+    FlightRecorder* recorder_;
+    FlightFrame frame_;
+    int64_t capture_unix_ms_;
+    std::chrono::steady_clock::time_point start_;
+    int64_t start_faults_ = 0;
+
+    static thread_local FlightFrame* current_;
+};
+
+class Options;
+
+/**
+ * @brief Create the flight recorder from the command line
+ *
+ * Keeps --flight-frames frames (default 256; 0 disables the recorder and
+ * returns nullptr) and dumps them to --flight-dir (default ".") on SIGUSR1
+ * and, with --flight-threshold-ms, after a slower frame, at most once per
+ * --flight-cooldown-ms (default 10000).
+ * @throws std::invalid_argument for a negative cooldown
+ */
+std::unique_ptr<FlightRecorder> configureFlightRecorder(const Options& options,
+                                                        const std::string& process_name);
+
+} // namespace voyis
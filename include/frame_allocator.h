@@ -0,0 +1,241 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace voyis {
+
+/**
+ * @brief How frame buffers are backed by huge pages
+ */
+enum class HugePageMode {
+    Off,         // Regular 4 KB pages
+    Transparent, // madvise(MADV_HUGEPAGE) on 2 MB aligned mappings
+    Explicit     // MAP_HUGETLB from the reserved pool, transparent when none are free
+};
+
+/**
+ * @brief Parse a huge page mode name ("off", "transparent" or "explicit")
+ * @throws std::invalid_argument for an unknown name
+ */
+HugePageMode parseHugePageMode(const std::string& name);
+
+/**
+ * @brief Name of a huge page mode for logs
+ */
+const char* hugePageModeName(HugePageMode mode);
+
+/**
+ * @brief Recycling allocator for large (10-30 MB) frame buffers
+ *
+ * Freshly allocated frame-sized buffers cost thousands of page faults and
+ * TLB misses per frame. The pool maps buffers in 2 MB aligned size classes
+ * backed by huge pages and keeps freed buffers on per-class free lists, so
+ * steady-state frames reuse memory that is already faulted in.
+ *
+ * Thread-safe: buffers may be freed on another thread (e.g. ZeroMQ's I/O
+ * thread after a zero-copy send).
+ */
+class FramePool {
+public:
+    static constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+    // Smaller allocations are not worth a mapping and use operator new
+    static constexpr size_t kMinPooledBytes = 1024 * 1024;
+
+    struct Stats {
+        size_t mapped = 0;        // Buffers mapped from the kernel
+        size_t reused = 0;        // Allocations served from a free list
+        size_t explicit_huge = 0; // Mappings backed by MAP_HUGETLB
+        size_t cached_bytes = 0;  // Bytes held on free lists
+    };
+
+    explicit FramePool(HugePageMode mode = HugePageMode::Transparent,
+                       size_t max_cached_bytes = 512 * 1024 * 1024);
+    ~FramePool();
+
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    /**
+     * @brief Process-wide pool used by FrameAllocator (never destroyed)
+     */
+    static FramePool& shared();
+
+    /**
+     * @brief Mapping size used for a request: a multiple of 2 MB, with four
+     *        classes per doubling so at most a quarter is wasted
+     */
+    static size_t sizeClass(size_t bytes);
+
+    /**
+     * @brief Change the huge page mode of future mappings
+     */
+    void setMode(HugePageMode mode);
+    HugePageMode mode() const;
+
+    /**
+     * @brief Limit the bytes kept on free lists; extra buffers are unmapped
+     */
+    void setMaxCachedBytes(size_t bytes);
+
+    /**
+     * @brief Get a buffer of at least the given size, aligned to 2 MB
+     * @throws std::bad_alloc if the mapping fails
+     */
+    void* allocate(size_t bytes);
+
+    /**
+     * @brief Return a buffer; bytes must be the size it was allocated with
+     */
+    void deallocate(void* ptr, size_t bytes) noexcept;
+
+    /**
+     * @brief Map and touch count buffers for the given size, then cache them
+     *
+     * Run at startup so the first frames do not pay for the page faults.
+     */
+    void prefault(size_t bytes, size_t count);
+
+    /**
+     * @brief Unmap every cached buffer
+     */
+    void trim();
+
+    Stats stats() const;
+
+private:
+    void* map(size_t size);
+    void unmap(void* ptr, size_t size) noexcept;
+
+    mutable std::mutex mutex_;
+    HugePageMode mode_;
+    size_t max_cached_bytes_;
+    std::map<size_t, std::vector<void*>> free_lists_; // Size class -> free buffers
+    Stats stats_;
+};
+
+/**
+ * @brief Standard allocator drawing large allocations from FramePool::shared()
+ *
+ * Elements are default-initialized, so resize() leaves new bytes
+ * uninitialized like a malloc'd buffer instead of zeroing 30 MB that is about
+ * to be overwritten by a read, memcpy or decode.
+ */
+template <typename T>
+class FrameAllocator {
+public:
+    using value_type = T;
+
+    FrameAllocator() noexcept = default;
+    template <typename U>
+    FrameAllocator(const FrameAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        size_t bytes = n * sizeof(T);
+        if (bytes < FramePool::kMinPooledBytes) {
+            return static_cast<T*>(::operator new(bytes));
+        }
+        return static_cast<T*>(FramePool::shared().allocate(bytes));
+    }
+
+    void deallocate(T* ptr, size_t n) noexcept {
+        size_t bytes = n * sizeof(T);
+        if (bytes < FramePool::kMinPooledBytes) {
+            ::operator delete(ptr);
+        } else {
+            FramePool::shared().deallocate(ptr, bytes);
+        }
+    }
+
+    template <typename U>
+    void construct(U* ptr) {
+        ::new (static_cast<void*>(ptr)) U;
+    }
+
+    template <typename U, typename... Args>
+    void construct(U* ptr, Args&&... args) {
+        ::new (static_cast<void*>(ptr)) U(std::forward<Args>(args)...);
+    }
+
+    template <typename U>
+    bool operator==(const FrameAllocator<U>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const FrameAllocator<U>&) const noexcept { return false; }
+};
+
+/**
+ * @brief Byte buffer for image payloads and serialized frames
+ */
+using FrameBuffer = std::vector<uint8_t, FrameAllocator<uint8_t>>;
+
+/**
+ * @brief Page fault counters of this process (getrusage)
+ */
+struct PageFaults {
+    int64_t minor = 0; // Served without I/O (first touch of anonymous memory)
+    int64_t major = 0; // Needed I/O
+
+    static PageFaults now();
+
+    PageFaults operator-(const PageFaults& other) const {
+        PageFaults delta;
+        delta.minor = minor - other.minor;
+        delta.major = major - other.major;
+        return delta;
+    }
+};
+
+/**
+ * @brief Resident memory and malloc heap usage of this process
+ *
+ * Heap figures come from glibc's mallinfo2() (the totals malloc_info()
+ * reports, summed over all arenas) and are zero under another allocator,
+ * e.g. jemalloc or mimalloc preloaded with LD_PRELOAD. resident is always
+ * measured.
+ */
+struct HeapStats {
+    int64_t resident = 0;    // RSS in bytes (/proc/self/statm)
+    int64_t heap = 0;        // Bytes malloc got from the system, arenas and mmapped chunks
+    int64_t heap_in_use = 0; // Bytes in allocated chunks
+    int64_t heap_free = 0;   // Bytes held by malloc in free chunks
+
+    static HeapStats now();
+
+    /**
+     * @brief Share of the heap held in free chunks (0 when nothing is mapped)
+     */
+    double fragmentation() const {
+        return heap > 0 ? static_cast<double>(heap_free) / static_cast<double>(heap) : 0.0;
+    }
+};
+
+class Options;
+
+/**
+ * @brief Configure FramePool::shared() from the command line
+ *
+ * Reads --huge-pages=<off|transparent|explicit> (default transparent) and
+ * prefaults --prefault-frames buffers (default 2) for images of --prefault-mb
+ * megabytes, or of default_prefault_bytes when that option is not given, and
+ * as many for serialized messages carrying such an image.
+ * @throws std::invalid_argument for an unknown huge page mode
+ */
+void configureFramePool(const Options& options, size_t default_prefault_bytes = 0);
+
+/**
+ * @brief One-line summary of page faults per frame and frame pool reuse
+ */
+std::string frameMemoryReport(const PageFaults& faults, size_t frames);
+
+} // namespace voyis
@@ -5,6 +5,12 @@
 #include <memory>
 #include <functional>
 #include <atomic>
+#include <thread>
+#include "frame_allocator.h"
+
+#ifdef VOYIS_HAVE_COROUTINES
+#include "reactor.h"
+#endif
 
 // Forward declare ZeroMQ context and socket to avoid exposing zmq.h
 typedef struct zmq_ctx_t zmq_ctx_t;
@@ -38,12 +44,51 @@ public:
      */
     bool publish(const std::vector<uint8_t>& data);
 
+    /**
+     * @brief Publish a pooled buffer without copying it
+     *
+     * ZeroMQ takes ownership and returns the buffer to the frame pool once it
+     * has been sent. The buffer is consumed even if publishing fails.
+     * @return true if successful, false otherwise
+     */
+    bool publish(FrameBuffer&& data);
+
+    /**
+     * @brief Publish head + payload + tail as one message without copying payload
+     *
+     * The parts go out as one multipart ZeroMQ message, which is delivered
+     * whole or not at all and joined again by Subscriber::receive. owner keeps
+     * the payload's memory (e.g. a mapped archive) alive until ZeroMQ has sent
+     * it. head and tail are consumed even if publishing fails.
+     * @return true if successful, false otherwise
+     */
+    bool publish(FrameBuffer&& head, const uint8_t* payload, size_t size,
+                 std::shared_ptr<const void> owner, FrameBuffer&& tail);
+
+#ifdef VOYIS_HAVE_COROUTINES
+    /**
+     * @brief Publish from a reactor coroutine, waiting while the send queue is full
+     * @param timeout_ms Give up after this long (-1 waits until the reactor stops)
+     * @return true if sent, false on timeout, cancellation or error
+     */
+    Task<bool> async_publish(Reactor& reactor, std::vector<uint8_t> data, int timeout_ms = -1);
+#endif
+
     /**
      * @brief Check if publisher is connected
      */
     bool isConnected() const { return connected_; }
 
 private:
+    // Send one message with the given zmq_send flags
+    bool send(const void* data, size_t size, int flags);
+
+    // Zero-copy send of a pooled buffer
+    bool publishOwned(FrameBuffer&& data);
+
+    // Report a failed send unless the queue was just full
+    static void reportSendError(int error);
+
     void* context_;
     void* socket_;
     std::string endpoint_;
@@ -72,23 +117,44 @@ public:
 
     /**
      * @brief Receive a message (blocking or with timeout)
+     *
+     * The parts of a multipart message are joined into one.
      * @param data Output parameter for received message data
      * @return true if message received, false on timeout or error
      */
     bool receive(std::vector<uint8_t>& data);
 
+    /**
+     * @brief Receive a message into a pooled buffer (for frame-sized messages)
+     * @return true if message received, false on timeout or error
+     */
+    bool receive(FrameBuffer& data);
+
     /**
      * @brief Set receive timeout
      * @param timeout_ms Timeout in milliseconds (-1 for blocking)
      */
     void setTimeout(int timeout_ms);
 
+#ifdef VOYIS_HAVE_COROUTINES
+    /**
+     * @brief Receive from a reactor coroutine without blocking the reactor thread
+     * @param timeout_ms Give up after this long (-1 waits until the reactor stops)
+     * @return The message, or nothing on timeout, cancellation or error
+     */
+    Task<std::optional<std::vector<uint8_t>>> async_receive(Reactor& reactor, int timeout_ms = -1);
+#endif
+
     /**
      * @brief Check if subscriber is connected
      */
     bool isConnected() const { return connected_; }
 
 private:
+    // Receive one message with the given zmq_msg_recv flags
+    template <typename Buffer>
+    bool receiveMessage(Buffer& data, int flags);
+
     void* context_;
     void* socket_;
     std::string endpoint_;
@@ -96,4 +162,109 @@ private:
     std::atomic<bool> connected_;
 };
 
+/**
+ * @brief Reply side of a request/reply channel (ZeroMQ REP)
+ *
+ * Binds to an endpoint and answers one request at a time: every receive()
+ * must be followed by a reply() before the next request is received.
+ */
+class Replier {
+public:
+    /**
+     * @param endpoint ZeroMQ endpoint to bind (e.g., "ipc:///tmp/voyis.sock")
+     * @param timeout_ms Receive timeout in milliseconds (-1 for blocking)
+     */
+    explicit Replier(const std::string& endpoint, int timeout_ms = 1000);
+    ~Replier();
+
+    // Disable copy
+    Replier(const Replier&) = delete;
+    Replier& operator=(const Replier&) = delete;
+
+    /**
+     * @brief Wait for the next request
+     * @return true if a request was received, false on timeout or error
+     */
+    bool receive(std::vector<uint8_t>& request);
+
+    /**
+     * @brief Answer the last received request
+     * @return true if successful, false otherwise
+     */
+    bool reply(const std::vector<uint8_t>& data);
+
+    const std::string& endpoint() const { return endpoint_; }
+
+private:
+    void* context_;
+    void* socket_;
+    std::string endpoint_;
+};
+
+/**
+ * @brief Answers requests on a ZeroMQ REP socket from its own thread
+ *
+ * Every request is passed to the handler and its result sent back. The
+ * handler runs on the server thread and must not throw. Declare the server
+ * after the state its handler uses, so it stops before that state is gone.
+ */
+class ReplyServer {
+public:
+    using Handler = std::function<std::vector<uint8_t>(const std::vector<uint8_t>&)>;
+
+    /**
+     * @throws std::runtime_error if the endpoint cannot be bound
+     */
+    ReplyServer(const std::string& endpoint, Handler handler);
+
+    /**
+     * @brief Stops the server thread (within the 200 ms receive timeout)
+     */
+    ~ReplyServer();
+
+    ReplyServer(const ReplyServer&) = delete;
+    ReplyServer& operator=(const ReplyServer&) = delete;
+
+    const std::string& endpoint() const { return replier_.endpoint(); }
+
+private:
+    void serve();
+
+    Replier replier_;
+    Handler handler_;
+    std::atomic<bool> stopping_{false};
+    std::thread server_;
+};
+
+/**
+ * @brief Request side of a request/reply channel (ZeroMQ REQ)
+ *
+ * A request that times out does not wedge the socket: the next request is
+ * sent right away and a late reply to the old one is discarded.
+ */
+class Requester {
+public:
+    /**
+     * @param endpoint ZeroMQ endpoint to connect to
+     * @param timeout_ms How long request() waits for the reply
+     */
+    explicit Requester(const std::string& endpoint, int timeout_ms = 2000);
+    ~Requester();
+
+    // Disable copy
+    Requester(const Requester&) = delete;
+    Requester& operator=(const Requester&) = delete;
+
+    /**
+     * @brief Send a request and wait for its reply
+     * @return true if the reply arrived in time, false otherwise
+     */
+    bool request(const std::vector<uint8_t>& data, std::vector<uint8_t>& reply);
+
+private:
+    void* context_;
+    void* socket_;
+    std::string endpoint_;
+};
+
 } // namespace voyis
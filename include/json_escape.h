@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+
+namespace voyis {
+
+/**
+ * @brief Append value to out as a quoted, escaped JSON string
+ *
+ * Shared by the trace, flight recorder and control socket writers, which
+ * build small JSON documents by hand.
+ */
+inline void appendJsonString(std::string& out, const std::string& value) {
+    out += '"';
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+            out += escaped;
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+}
+
+} // namespace voyis
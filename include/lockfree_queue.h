@@ -0,0 +1,209 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace voyis {
+
+/**
+ * @brief Assumed cache line size, used to keep hot atomics on separate lines
+ */
+constexpr size_t kCacheLineSize = 64;
+
+/**
+ * @brief Smallest power of two >= n (and >= 2)
+ */
+inline size_t roundUpToPowerOfTwo(size_t n) {
+    size_t size = 2;
+    while (size < n) {
+        size <<= 1;
+    }
+    return size;
+}
+
+/**
+ * @brief Bounded single-producer single-consumer ring buffer
+ *
+ * Wait-free: one thread may call tryPush() and one other thread tryPop().
+ * Each side caches the other side's index and only re-reads it (one cache
+ * miss) when the ring looks full or empty. T must be default-constructible
+ * and move-assignable; popped slots keep a moved-from value.
+ */
+template <typename T>
+class SpscRing {
+public:
+    /**
+     * @param capacity Minimum number of elements; rounded up to a power of two
+     */
+    explicit SpscRing(size_t capacity)
+        : capacity_(roundUpToPowerOfTwo(capacity)),
+          mask_(capacity_ - 1),
+          slots_(new T[capacity_]) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /**
+     * @brief Append an element (producer thread only)
+     * @return false if the ring is full
+     */
+    template <typename U>
+    bool tryPush(U&& value) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_cache_ == capacity_) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail - head_cache_ == capacity_) {
+                return false;
+            }
+        }
+        slots_[tail & mask_] = std::forward<U>(value);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Remove the oldest element (consumer thread only)
+     * @return false if the ring is empty
+     */
+    bool tryPop(T& value) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_cache_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head == tail_cache_) {
+                return false;
+            }
+        }
+        value = std::move(slots_[head & mask_]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t capacity() const { return capacity_; }
+
+    /**
+     * @brief Number of elements; exact only when neither side is active
+     */
+    size_t sizeApprox() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+
+private:
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<T[]> slots_;
+
+    // Producer side
+    alignas(kCacheLineSize) std::atomic<size_t> tail_{0};
+    size_t head_cache_ = 0;
+
+    // Consumer side
+    alignas(kCacheLineSize) std::atomic<size_t> head_{0};
+    size_t tail_cache_ = 0;
+};
+
+/**
+ * @brief Bounded multi-producer multi-consumer queue
+ *
+ * Lock-free array queue (Vyukov): every slot carries a sequence number that
+ * tells producers and consumers whose turn it is, so each operation is one
+ * compare-and-swap on the shared index plus uncontended slot accesses. Any
+ * number of threads may push and pop concurrently. T must be
+ * default-constructible and move-assignable.
+ */
+template <typename T>
+class MpmcQueue {
+public:
+    /**
+     * @param capacity Minimum number of elements; rounded up to a power of two
+     */
+    explicit MpmcQueue(size_t capacity)
+        : capacity_(roundUpToPowerOfTwo(capacity)),
+          mask_(capacity_ - 1),
+          slots_(new Slot[capacity_]) {
+        for (size_t i = 0; i < capacity_; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    /**
+     * @brief Append an element
+     * @return false if the queue is full
+     */
+    template <typename U>
+    bool tryPush(U&& value) {
+        size_t pos = enqueue_.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots_[pos & mask_];
+            const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.value = std::forward<U>(value);
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // Slot still holds an element from the previous lap
+            } else {
+                pos = enqueue_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Remove the oldest element
+     * @return false if the queue is empty
+     */
+    bool tryPop(T& value) {
+        size_t pos = dequeue_.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots_[pos & mask_];
+            const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    value = std::move(slot.value);
+                    slot.sequence.store(pos + capacity_, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // Slot not written yet
+            } else {
+                pos = dequeue_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    size_t capacity() const { return capacity_; }
+
+    /**
+     * @brief Number of elements; exact only when no thread is active
+     */
+    size_t sizeApprox() const {
+        const size_t enqueued = enqueue_.load(std::memory_order_acquire);
+        const size_t dequeued = dequeue_.load(std::memory_order_acquire);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+private:
+    struct alignas(kCacheLineSize) Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+
+    alignas(kCacheLineSize) std::atomic<size_t> enqueue_{0};
+    alignas(kCacheLineSize) std::atomic<size_t> dequeue_{0};
+};
+
+} // namespace voyis
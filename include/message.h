@@ -1,9 +1,12 @@
 #pragma once
 
+#include "frame_allocator.h"
+#include "message_schema.h"
 #include <string>
 #include <vector>
 #include <cstdint>
 #include <memory>
+#include <tuple>
 
 namespace voyis {
 
@@ -16,6 +19,10 @@ struct Point2f {
 
     Point2f() : x(0.0f), y(0.0f) {}
     Point2f(float x_, float y_) : x(x_), y(y_) {}
+
+    static constexpr auto fields() {
+        return std::make_tuple(schema::field("x", &Point2f::x), schema::field("y", &Point2f::y));
+    }
 };
 
 /**
@@ -29,6 +36,83 @@ struct KeyPoint {
     int octave;          // Octave (pyramid layer) from which the keypoint was extracted
 
     KeyPoint() : size(0), angle(-1), response(0), octave(0) {}
+
+    // Wire layout matches memory layout, so keypoint arrays are copied in bulk
+    static constexpr auto fields() {
+        return std::make_tuple(
+            schema::field("pt", &KeyPoint::pt),
+            schema::field("size", &KeyPoint::size),
+            schema::field("angle", &KeyPoint::angle),
+            schema::field("response", &KeyPoint::response),
+            schema::field("octave", &KeyPoint::octave));
+    }
+};
+
+/**
+ * @brief Reasons a frame failed the extractor's quality check (bit flags)
+ */
+enum QualityFlags : uint32_t {
+    kQualityOk = 0,
+    kQualityBlurry = 1u << 0,       // Laplacian variance below threshold
+    kQualityUnderexposed = 1u << 1, // Too dark (mean or fraction of dark pixels)
+    kQualityOverexposed = 1u << 2,  // Too bright (mean or fraction of saturated pixels)
+    kQualityLowContrast = 1u << 3   // Intensity standard deviation below threshold
+};
+
+/**
+ * @brief Image quality scores measured on a reduced-resolution decode
+ */
+struct QualityMetrics {
+    float sharpness;          // Variance of the Laplacian
+    float brightness;         // Mean intensity (0-255)
+    float contrast;           // Standard deviation of intensity
+    float dark_fraction;      // Fraction of pixels below 16
+    float saturated_fraction; // Fraction of pixels above 239
+    uint32_t flags;           // QualityFlags; non-zero frames were not processed
+
+    QualityMetrics()
+        : sharpness(0), brightness(0), contrast(0),
+          dark_fraction(0), saturated_fraction(0), flags(kQualityOk) {}
+
+    static constexpr auto fields() {
+        return std::make_tuple(
+            schema::field("sharpness", &QualityMetrics::sharpness),
+            schema::field("brightness", &QualityMetrics::brightness),
+            schema::field("contrast", &QualityMetrics::contrast),
+            schema::field("dark_fraction", &QualityMetrics::dark_fraction),
+            schema::field("saturated_fraction", &QualityMetrics::saturated_fraction),
+            schema::field("flags", &QualityMetrics::flags));
+    }
+};
+
+/**
+ * @brief Bytes per pixel of an uncompressed pixel format
+ *
+ * Raw formats are "mono8", "mono16" and the Bayer mosaics "bayer_rggb8",
+ * "bayer_bggr8", "bayer_gbrg8", "bayer_grbg8" (and their 16-bit variants).
+ * 16-bit samples are little-endian.
+ *
+ * @return 1 or 2 for raw pixel formats, 0 for encoded formats (png, jpg, ...)
+ */
+int rawBytesPerPixel(const std::string& format);
+
+/**
+ * @brief Whether a format carries uncompressed pixels rather than an encoded file
+ */
+inline bool isRawPixelFormat(const std::string& format) {
+    return rawBytesPerPixel(format) > 0;
+}
+
+/**
+ * @brief Encoding of a message around image bytes that are sent separately
+ *
+ * head + image bytes + tail is exactly what serialize() produces with those
+ * bytes in image_data, so a receiver that joins the parts cannot tell the
+ * difference.
+ */
+struct FrameParts {
+    FrameBuffer head; // Fields before the image bytes, ending with their length
+    FrameBuffer tail; // Fields after the image bytes
 };
 
 /**
@@ -37,19 +121,44 @@ struct KeyPoint {
  */
 struct ImageMessage {
     std::string image_id;           // Unique identifier for the image
-    std::vector<uint8_t> image_data; // Raw image bytes
-    std::string format;             // Image format (e.g., "png", "jpg")
-    int width;                      // Image width
-    int height;                     // Image height
+    std::string stream_id;          // Source stream (camera) the image belongs to
+    FrameBuffer image_data;         // Raw image bytes (pooled, huge-page backed when large)
+    std::string format;             // Image format (e.g., "png", "jpg", "mono8")
+    int width;                      // Image width (required for raw pixel formats)
+    int height;                     // Image height (required for raw pixel formats)
+    int stride;                     // Bytes per row for raw pixel formats (0 if encoded)
+    int bit_depth;                  // Significant bits per sample for raw formats (0 if encoded)
     int64_t timestamp;              // Timestamp when image was read
 
-    ImageMessage() : width(0), height(0), timestamp(0) {}
+    ImageMessage() : width(0), height(0), stride(0), bit_depth(0), timestamp(0) {}
+
+    // Wire layout, in order (serialization is generated from this list)
+    static constexpr auto fields() {
+        return std::make_tuple(
+            schema::field("image_id", &ImageMessage::image_id),
+            schema::field("stream_id", &ImageMessage::stream_id),
+            schema::field("image_data", &ImageMessage::image_data),
+            schema::field("format", &ImageMessage::format),
+            schema::field("width", &ImageMessage::width),
+            schema::field("height", &ImageMessage::height),
+            schema::field("stride", &ImageMessage::stride),
+            schema::field("bit_depth", &ImageMessage::bit_depth),
+            schema::field("timestamp", &ImageMessage::timestamp));
+    }
 
     // Serialize to bytes for IPC transmission
     std::vector<uint8_t> serialize() const;
 
+    // Serialize into a pooled buffer, for zero-copy Publisher::publish(FrameBuffer&&)
+    FrameBuffer serializeFrame() const;
+
+    // Serialize all but image_data (which must be empty) around image_size bytes sent
+    // separately, for Publisher::publish(FrameParts&&, ...); throws std::logic_error
+    FrameParts serializeParts(size_t image_size) const;
+
     // Deserialize from bytes received via IPC
     static ImageMessage deserialize(const std::vector<uint8_t>& data);
+    static ImageMessage deserialize(const FrameBuffer& data);
 };
 
 /**
@@ -58,22 +167,250 @@ struct ImageMessage {
  */
 struct ProcessedImageMessage {
     std::string image_id;           // Unique identifier for the image
-    std::vector<uint8_t> image_data; // Raw image bytes
+    std::string stream_id;          // Source stream (camera) the image belongs to
+    FrameBuffer image_data;         // Raw image bytes (pooled, huge-page backed when large)
     std::string format;             // Image format
     int width;                      // Image width
     int height;                     // Image height
+    int stride;                     // Bytes per row for raw pixel formats (0 if encoded)
+    int bit_depth;                  // Significant bits per sample for raw formats (0 if encoded)
     int64_t timestamp;              // Original timestamp
     int64_t processed_timestamp;    // When SIFT processing completed
+    QualityMetrics quality;         // Quality scores (features are empty if flags != 0)
+    uint32_t descriptor_dim;        // Length of each descriptor (128 for SIFT, less after PCA)
     std::vector<KeyPoint> keypoints; // Extracted SIFT keypoints
-    std::vector<std::vector<float>> descriptors; // SIFT descriptors (128-dim per keypoint)
+    std::vector<std::vector<float>> descriptors; // One descriptor_dim vector per keypoint
+
+    ProcessedImageMessage()
+        : width(0), height(0), stride(0), bit_depth(0), timestamp(0), processed_timestamp(0),
+          descriptor_dim(0) {}
 
-    ProcessedImageMessage() : width(0), height(0), timestamp(0), processed_timestamp(0) {}
+    // Wire layout, in order (serialization is generated from this list)
+    static constexpr auto fields() {
+        return std::make_tuple(
+            schema::field("image_id", &ProcessedImageMessage::image_id),
+            schema::field("stream_id", &ProcessedImageMessage::stream_id),
+            schema::field("image_data", &ProcessedImageMessage::image_data),
+            schema::field("format", &ProcessedImageMessage::format),
+            schema::field("width", &ProcessedImageMessage::width),
+            schema::field("height", &ProcessedImageMessage::height),
+            schema::field("stride", &ProcessedImageMessage::stride),
+            schema::field("bit_depth", &ProcessedImageMessage::bit_depth),
+            schema::field("timestamp", &ProcessedImageMessage::timestamp),
+            schema::field("processed_timestamp", &ProcessedImageMessage::processed_timestamp),
+            schema::field("quality", &ProcessedImageMessage::quality),
+            schema::field("descriptor_dim", &ProcessedImageMessage::descriptor_dim),
+            schema::field("keypoints", &ProcessedImageMessage::keypoints),
+            schema::field("descriptors", &ProcessedImageMessage::descriptors));
+    }
 
     // Serialize to bytes for IPC transmission
     std::vector<uint8_t> serialize() const;
 
+    // Serialize into a pooled buffer, for zero-copy Publisher::publish(FrameBuffer&&)
+    FrameBuffer serializeFrame() const;
+
     // Deserialize from bytes received via IPC
     static ProcessedImageMessage deserialize(const std::vector<uint8_t>& data);
+    static ProcessedImageMessage deserialize(const FrameBuffer& data);
+};
+
+/**
+ * @brief Request for descriptors of a frame that was published with keypoints only
+ * Sent to the Feature Extractor's descriptor service (REQ/REP)
+ */
+struct DescriptorRequest {
+    std::string image_id;                   // Frame to compute descriptors for
+    std::vector<uint32_t> keypoint_indices; // Indices into the published keypoints; empty means all
+
+    static constexpr auto fields() {
+        return std::make_tuple(
+            schema::field("image_id", &DescriptorRequest::image_id),
+            schema::field("keypoint_indices", &DescriptorRequest::keypoint_indices));
+    }
+
+    // Serialize to bytes for IPC transmission
+    std::vector<uint8_t> serialize() const;
+
+    // Deserialize from bytes received via IPC
+    static DescriptorRequest deserialize(const std::vector<uint8_t>& data);
+};
+
+/**
+ * @brief Descriptors computed by the descriptor service
+ */
+struct DescriptorReply {
+    std::string image_id;                   // Frame the descriptors belong to
+    bool found;                             // False if the frame is not (or no longer) cached
+    std::string error;                      // Why no descriptors were computed, empty on success
+    uint32_t descriptor_dim;                // Length of each descriptor (less than 128 after PCA)
+    std::vector<uint32_t> keypoint_indices; // Keypoint of each descriptor, in request order
+    std::vector<std::vector<float>> descriptors;
+
+    DescriptorReply() : found(false), descriptor_dim(0) {}
+
+    static constexpr auto fields() {
+        return std::make_tuple(
+            schema::field("image_id", &DescriptorReply::image_id),
+            schema::field("found", &DescriptorReply::found),
+            schema::field("error", &DescriptorReply::error),
+            schema::field("descriptor_dim", &DescriptorReply::descriptor_dim),
+            schema::field("keypoint_indices", &DescriptorReply::keypoint_indices),
+            schema::field("descriptors", &DescriptorReply::descriptors));
+    }
+
+    // Serialize to bytes for IPC transmission
+    std::vector<uint8_t> serialize() const;
+
+    // Deserialize from bytes received via IPC
+    static DescriptorReply deserialize(const std::vector<uint8_t>& data);
+};
+
+/**
+ * @brief Query for recently logged frames
+ * Sent to the Data Logger's query service (REQ/REP)
+ */
+struct FrameQuery {
+    std::string image_id;  // Frame to return; empty asks for the newest frames
+    uint32_t count;        // How many of the newest frames, when image_id is empty
+    bool include_image;    // Also return image_data (frames can be tens of MB)
+    bool include_features; // Also return keypoints and descriptors
+
+    FrameQuery() : count(1), include_image(false), include_features(true) {}
+
+    static constexpr auto fields() {
+        return std::make_tuple(
+            schema::field("image_id", &FrameQuery::image_id),
+            schema::field("count", &FrameQuery::count),
+            schema::field("include_image", &FrameQuery::include_image),
+            schema::field("include_features", &FrameQuery::include_features));
+    }
+
+    // Serialize to bytes for IPC transmission
+    std::vector<uint8_t> serialize() const;
+
+    // Deserialize from bytes received via IPC
+    static FrameQuery deserialize(const std::vector<uint8_t>& data);
+};
+
+/**
+ * @brief Frames found by a FrameQuery, newest first
+ */
+struct FrameQueryReply {
+    std::string error;                          // Why the query failed, empty on success
+    std::vector<ProcessedImageMessage> frames;  // Without the parts that were not asked for
+    uint32_t cache_hits;                        // Frames served from memory
+    uint32_t database_reads;                    // Frames read from the database
+
+    FrameQueryReply() : cache_hits(0), database_reads(0) {}
+
+    static constexpr auto fields() {
+        return std::make_tuple(
+            schema::field("error", &FrameQueryReply::error),
+            schema::field("frames", &FrameQueryReply::frames),
+            schema::field("cache_hits", &FrameQueryReply::cache_hits),
+            schema::field("database_reads", &FrameQueryReply::database_reads));
+    }
+
+    // Serialize to bytes for IPC transmission
+    std::vector<uint8_t> serialize() const;
+
+    // Deserialize from bytes received via IPC
+    static FrameQueryReply deserialize(const std::vector<uint8_t>& data);
+};
+
+/**
+ * @brief Descriptor correspondence between two frames
+ */
+struct FeatureMatch {
+    uint32_t query_idx;   // Keypoint index in the new frame
+    uint32_t train_idx;   // Keypoint index in the reference frame
+    float distance;       // Descriptor distance
+
+    FeatureMatch() : query_idx(0), train_idx(0), distance(0) {}
+    FeatureMatch(uint32_t query, uint32_t train, float dist)
+        : query_idx(query), train_idx(train), distance(dist) {}
+
+    static constexpr auto fields() {
+        return std::make_tuple(
+            schema::field("query_idx", &FeatureMatch::query_idx),
+            schema::field("train_idx", &FeatureMatch::train_idx),
+            schema::field("distance", &FeatureMatch::distance));
+    }
+};
+
+/**
+ * @brief Matches of a frame against one earlier frame of its stream
+ */
+struct FrameMatch {
+    std::string reference_id;           // Earlier frame the matches refer to
+    bool has_homography;                // Whether a homography could be estimated
+    double homography[9];               // Row-major 3x3, maps new-frame points to the reference
+    uint32_t num_inliers;               // RANSAC inliers (0 without a homography)
+    std::vector<FeatureMatch> matches;  // Inliers, or all ratio-test matches without a homography
+
+    FrameMatch() : has_homography(false), homography{}, num_inliers(0) {}
+
+    static constexpr auto fields() {
+        return std::make_tuple(
+            schema::field("reference_id", &FrameMatch::reference_id),
+            schema::field("has_homography", &FrameMatch::has_homography),
+            schema::field("homography", &FrameMatch::homography),
+            schema::field("num_inliers", &FrameMatch::num_inliers),
+            schema::field("matches", &FrameMatch::matches));
+    }
+};
+
+/**
+ * @brief Earlier frame that looks like the same place (loop-closure candidate)
+ */
+struct PlaceCandidate {
+    std::string image_id;  // Earlier frame
+    std::string stream_id; // Stream of the earlier frame
+    float score;           // TF-IDF cosine similarity (0-1)
+
+    PlaceCandidate() : score(0) {}
+    PlaceCandidate(const std::string& image, const std::string& stream, float s)
+        : image_id(image), stream_id(stream), score(s) {}
+
+    static constexpr auto fields() {
+        return std::make_tuple(
+            schema::field("image_id", &PlaceCandidate::image_id),
+            schema::field("stream_id", &PlaceCandidate::stream_id),
+            schema::field("score", &PlaceCandidate::score));
+    }
+};
+
+/**
+ * @brief Matches of a frame against the previous frames of its stream
+ * Used for communication between Feature Matcher and downstream consumers
+ */
+struct MatchSetMessage {
+    std::string image_id;           // Frame that was matched
+    std::string stream_id;          // Stream the frame belongs to
+    int64_t timestamp;              // Original timestamp of the frame
+    int64_t matched_timestamp;      // When matching completed
+    std::vector<FrameMatch> frames; // One entry per earlier frame, newest first
+    std::vector<PlaceCandidate> loop_candidates; // Similar older frames, best first
+
+    MatchSetMessage() : timestamp(0), matched_timestamp(0) {}
+
+    // Wire layout, in order (serialization is generated from this list)
+    static constexpr auto fields() {
+        return std::make_tuple(
+            schema::field("image_id", &MatchSetMessage::image_id),
+            schema::field("stream_id", &MatchSetMessage::stream_id),
+            schema::field("timestamp", &MatchSetMessage::timestamp),
+            schema::field("matched_timestamp", &MatchSetMessage::matched_timestamp),
+            schema::field("frames", &MatchSetMessage::frames),
+            schema::field("loop_candidates", &MatchSetMessage::loop_candidates));
+    }
+
+    // Serialize to bytes for IPC transmission
+    std::vector<uint8_t> serialize() const;
+
+    // Deserialize from bytes received via IPC
+    static MatchSetMessage deserialize(const std::vector<uint8_t>& data);
 };
 
 } // namespace voyis
@@ -0,0 +1,517 @@
+#pragma once
+
+// Compile-time field lists for the IPC message structs and the codecs generated from them.
+//
+// A struct opts in with a static constexpr fields() returning its fields in wire order:
+//
+//     static constexpr auto fields() {
+//         return std::make_tuple(schema::field("x", &Point2f::x), schema::field("y", &Point2f::y));
+//     }
+//
+// Wire encoding per field type (host byte order):
+//   arithmetic          raw bytes
+//   bool                one byte, 0 or 1
+//   T[N]                N elements back to back
+//   std::string         uint32 length + bytes
+//   std::vector<T>      uint32 count + elements
+//   struct with schema  its fields back to back, no prefix
+//
+// A struct whose fields are all fixed-size scalars, listed in declaration order with no padding
+// (sizeof equals the sum of the field sizes), is "bulk": it and arrays/vectors of it are copied
+// with a single memcpy instead of field by field. The wire format is the same either way.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace voyis {
+namespace schema {
+
+/**
+ * @brief One serialized member of a struct
+ */
+template <typename Class, typename T>
+struct Field {
+    const char* name;
+    T Class::*member;
+};
+
+template <typename Class, typename T>
+constexpr Field<Class, T> field(const char* name, T Class::*member) {
+    return Field<Class, T>{name, member};
+}
+
+// ---------------------------------------------------------------------------
+// Type traits
+
+template <typename T, typename = void>
+struct HasSchema : std::false_type {};
+
+template <typename T>
+struct HasSchema<T, std::void_t<decltype(T::fields())>> : std::true_type {};
+
+template <typename T>
+struct IsVector : std::false_type {};
+
+template <typename T, typename A>
+struct IsVector<std::vector<T, A>> : std::true_type {};
+
+template <typename T>
+constexpr bool isScalar = std::is_arithmetic_v<T> && !std::is_same_v<T, bool>;
+
+template <typename T>
+constexpr size_t fixedSize();
+
+template <typename T>
+constexpr size_t minSize();
+
+template <typename T>
+constexpr bool bulkSafe();
+
+template <typename Tuple>
+struct SchemaFields;
+
+template <typename... Classes, typename... Types>
+struct SchemaFields<std::tuple<Field<Classes, Types>...>> {
+    static constexpr size_t fixedSize() {
+        return ((schema::fixedSize<Types>() != 0) && ...) ? (schema::fixedSize<Types>() + ... + 0) : 0;
+    }
+    static constexpr size_t minSize() { return (schema::minSize<Types>() + ... + 0); }
+    static constexpr bool bulkSafe() { return (schema::bulkSafe<Types>() && ...); }
+};
+
+template <typename T>
+using FieldsOf = SchemaFields<std::decay_t<decltype(T::fields())>>;
+
+/**
+ * @brief Encoded size of every value of type T, or 0 if it varies
+ */
+template <typename T>
+constexpr size_t fixedSize() {
+    if constexpr (isScalar<T>) {
+        return sizeof(T);
+    } else if constexpr (std::is_same_v<T, bool>) {
+        return 1;
+    } else if constexpr (std::is_array_v<T>) {
+        return fixedSize<std::remove_extent_t<T>>() * std::extent_v<T>;
+    } else if constexpr (HasSchema<T>::value) {
+        return FieldsOf<T>::fixedSize();
+    } else {
+        return 0;
+    }
+}
+
+/**
+ * @brief Smallest possible encoding of a T (bounds element counts before allocating)
+ */
+template <typename T>
+constexpr size_t minSize() {
+    if constexpr (fixedSize<T>() != 0) {
+        return fixedSize<T>();
+    } else if constexpr (std::is_array_v<T>) {
+        return minSize<std::remove_extent_t<T>>() * std::extent_v<T>;
+    } else if constexpr (HasSchema<T>::value) {
+        return FieldsOf<T>::minSize();
+    } else {
+        return sizeof(uint32_t); // Length prefix of strings and vectors
+    }
+}
+
+// Whether every byte pattern of the in-memory representation is valid on the wire
+template <typename T>
+constexpr bool bulkSafe() {
+    if constexpr (isScalar<T>) {
+        return true;
+    } else if constexpr (std::is_array_v<T>) {
+        return bulkSafe<std::remove_extent_t<T>>();
+    } else if constexpr (HasSchema<T>::value) {
+        return FieldsOf<T>::bulkSafe();
+    } else {
+        return false;
+    }
+}
+
+/**
+ * @brief Whether T's memory layout is its wire layout, so it can be memcpy'd
+ */
+template <typename T>
+constexpr bool isBulk =
+    std::is_trivially_copyable_v<T> && bulkSafe<T>() && fixedSize<T>() == sizeof(T);
+
+// ---------------------------------------------------------------------------
+// Cursor types
+
+class Writer {
+public:
+    explicit Writer(uint8_t* out) : out_(out) {}
+
+    void bytes(const void* data, size_t size) {
+        if (size > 0) {
+            std::memcpy(out_, data, size);
+            out_ += size;
+        }
+    }
+
+    uint8_t* position() const { return out_; }
+
+private:
+    uint8_t* out_;
+};
+
+class Reader {
+public:
+    Reader(const uint8_t* data, size_t size) : data_(data), remaining_(size) {}
+
+    // Consume size bytes, returning where they start
+    const uint8_t* take(size_t size, const char* what) {
+        if (remaining_ < size) {
+            throw std::runtime_error(std::string("Insufficient data to read ") + what);
+        }
+        const uint8_t* start = data_;
+        data_ += size;
+        remaining_ -= size;
+        return start;
+    }
+
+    void bytes(void* out, size_t size, const char* what) {
+        if (size > 0) {
+            std::memcpy(out, take(size, what), size);
+        }
+    }
+
+    // Read an element count, rejecting counts the remaining data cannot hold
+    uint32_t count(size_t min_element_size, const char* what) {
+        uint32_t n;
+        bytes(&n, sizeof(n), "value");
+        if (min_element_size > 0 && remaining_ / min_element_size < n) {
+            throw std::runtime_error(std::string("Insufficient data to read ") + what);
+        }
+        return n;
+    }
+
+    size_t remaining() const { return remaining_; }
+
+private:
+    const uint8_t* data_;
+    size_t remaining_;
+};
+
+template <typename Tuple, typename F>
+constexpr void forEachField(const Tuple& fields, F&& visit) {
+    std::apply([&](const auto&... each) { (visit(each), ...); }, fields);
+}
+
+// ---------------------------------------------------------------------------
+// Generated codecs
+
+/**
+ * @brief Exact number of bytes serialize() produces for a value
+ */
+template <typename T>
+size_t encodedSize(const T& value) {
+    if constexpr (fixedSize<T>() != 0) {
+        return fixedSize<T>();
+    } else if constexpr (std::is_array_v<T>) {
+        size_t size = 0;
+        for (const auto& element : value) {
+            size += encodedSize(element);
+        }
+        return size;
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        return sizeof(uint32_t) + value.size();
+    } else if constexpr (IsVector<T>::value) {
+        using Element = typename T::value_type;
+        if constexpr (fixedSize<Element>() != 0) {
+            return sizeof(uint32_t) + value.size() * fixedSize<Element>();
+        } else {
+            size_t size = sizeof(uint32_t);
+            for (const auto& element : value) {
+                size += encodedSize(element);
+            }
+            return size;
+        }
+    } else {
+        static_assert(HasSchema<T>::value, "Type has no wire encoding");
+        size_t size = 0;
+        forEachField(T::fields(), [&](const auto& f) { size += encodedSize(value.*(f.member)); });
+        return size;
+    }
+}
+
+template <typename T>
+void write(Writer& writer, const T& value) {
+    if constexpr (isBulk<T>) {
+        writer.bytes(&value, sizeof(T));
+    } else if constexpr (std::is_same_v<T, bool>) {
+        uint8_t byte = value ? 1 : 0;
+        writer.bytes(&byte, 1);
+    } else if constexpr (std::is_array_v<T>) {
+        for (const auto& element : value) {
+            write(writer, element);
+        }
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        uint32_t length = static_cast<uint32_t>(value.size());
+        writer.bytes(&length, sizeof(length));
+        writer.bytes(value.data(), value.size());
+    } else if constexpr (IsVector<T>::value) {
+        using Element = typename T::value_type;
+        uint32_t count = static_cast<uint32_t>(value.size());
+        writer.bytes(&count, sizeof(count));
+        if constexpr (isBulk<Element>) {
+            writer.bytes(value.data(), value.size() * sizeof(Element));
+        } else {
+            for (const auto& element : value) {
+                write(writer, element);
+            }
+        }
+    } else {
+        static_assert(HasSchema<T>::value, "Type has no wire encoding");
+        forEachField(T::fields(), [&](const auto& f) { write(writer, value.*(f.member)); });
+    }
+}
+
+template <typename T>
+void read(Reader& reader, T& value) {
+    if constexpr (isBulk<T>) {
+        reader.bytes(&value, sizeof(T), "value");
+    } else if constexpr (std::is_same_v<T, bool>) {
+        uint8_t byte;
+        reader.bytes(&byte, 1, "value");
+        value = byte != 0;
+    } else if constexpr (std::is_array_v<T>) {
+        for (auto& element : value) {
+            read(reader, element);
+        }
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        uint32_t length = reader.count(1, "string");
+        value.assign(reinterpret_cast<const char*>(reader.take(length, "string")), length);
+    } else if constexpr (IsVector<T>::value) {
+        using Element = typename T::value_type;
+        uint32_t count = reader.count(minSize<Element>(), "array");
+        if constexpr (isBulk<Element>) {
+            value.resize(count);
+            reader.bytes(value.data(), static_cast<size_t>(count) * sizeof(Element), "array");
+        } else {
+            value.clear();
+            value.resize(count);
+            for (auto& element : value) {
+                read(reader, element);
+            }
+        }
+    } else {
+        static_assert(HasSchema<T>::value, "Type has no wire encoding");
+        forEachField(T::fields(), [&](const auto& f) { read(reader, value.*(f.member)); });
+    }
+}
+
+/**
+ * @brief Step over an encoded T without decoding it
+ */
+template <typename T>
+void skip(Reader& reader) {
+    if constexpr (fixedSize<T>() != 0) {
+        reader.take(fixedSize<T>(), "value");
+    } else if constexpr (std::is_array_v<T>) {
+        for (size_t i = 0; i < std::extent_v<T>; ++i) {
+            skip<std::remove_extent_t<T>>(reader);
+        }
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        reader.take(reader.count(1, "string"), "string");
+    } else if constexpr (IsVector<T>::value) {
+        using Element = typename T::value_type;
+        uint32_t count = reader.count(minSize<Element>(), "array");
+        if constexpr (fixedSize<Element>() != 0) {
+            reader.take(static_cast<size_t>(count) * fixedSize<Element>(), "array");
+        } else {
+            for (uint32_t i = 0; i < count; ++i) {
+                skip<Element>(reader);
+            }
+        }
+    } else {
+        static_assert(HasSchema<T>::value, "Type has no wire encoding");
+        forEachField(T::fields(), [&](const auto& f) {
+            // Not std::decay_t: arrays such as FrameMatch::homography must stay arrays
+            skip<std::remove_cv_t<std::remove_reference_t<decltype(std::declval<T&>().*(f.member))>>>(
+                reader);
+        });
+    }
+}
+
+/**
+ * @brief Serialize into a buffer allocated once at the exact size
+ * @tparam Buffer Byte vector type (std::vector<uint8_t> or a pooled FrameBuffer)
+ */
+template <typename Buffer = std::vector<uint8_t>, typename T>
+Buffer serialize(const T& value) {
+    Buffer buffer(encodedSize(value));
+    Writer writer(buffer.data());
+    write(writer, value);
+    return buffer;
+}
+
+/**
+ * @brief Decode a T
+ * @throws std::runtime_error if the data is truncated
+ */
+template <typename T>
+T deserialize(const uint8_t* data, size_t size) {
+    Reader reader(data, size);
+    T value;
+    read(reader, value);
+    return value;
+}
+
+/**
+ * @brief Whether data holds a complete T (no allocation or decoding)
+ */
+template <typename T>
+bool validate(const uint8_t* data, size_t size) {
+    try {
+        Reader reader(data, size);
+        skip<T>(reader);
+        return true;
+    } catch (const std::runtime_error&) {
+        return false;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Zero-copy field views
+
+/**
+ * @brief Array of bulk elements inside a serialized buffer (possibly unaligned)
+ */
+template <typename T>
+class ArrayView {
+public:
+    ArrayView() : data_(nullptr), count_(0) {}
+    ArrayView(const uint8_t* data, size_t count) : data_(data), count_(count) {}
+
+    size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+    const uint8_t* bytes() const { return data_; }
+    size_t byteSize() const { return count_ * sizeof(T); }
+
+    T operator[](size_t index) const {
+        T value;
+        std::memcpy(&value, data_ + index * sizeof(T), sizeof(T));
+        return value;
+    }
+
+    std::vector<T> toVector() const {
+        std::vector<T> values(count_);
+        if (count_ > 0) {
+            std::memcpy(values.data(), data_, byteSize());
+        }
+        return values;
+    }
+
+private:
+    const uint8_t* data_;
+    size_t count_;
+};
+
+template <typename T>
+struct ViewType {
+    using type = T; // Fixed-size values are decoded
+};
+
+template <>
+struct ViewType<std::string> {
+    using type = std::string_view;
+};
+
+template <typename T, typename A>
+struct ViewType<std::vector<T, A>> {
+    static_assert(isBulk<T>, "Only vectors of bulk elements can be viewed in place");
+    using type = ArrayView<T>;
+};
+
+template <typename T>
+struct MemberPointer;
+
+template <typename Class, typename T>
+struct MemberPointer<T Class::*> {
+    using ClassType = Class;
+    using FieldType = T;
+};
+
+/**
+ * @brief Read one top-level field straight out of a serialized message
+ *
+ * Earlier fields are skipped without decoding. Strings come back as a
+ * std::string_view and vectors of bulk elements (bytes, floats, keypoints)
+ * as an ArrayView, both pointing into data, which must outlive the view.
+ *
+ * @throws std::runtime_error if the data is truncated
+ */
+template <auto Member>
+typename ViewType<typename MemberPointer<decltype(Member)>::FieldType>::type view(const uint8_t* data,
+                                                                                  size_t size) {
+    using Class = typename MemberPointer<decltype(Member)>::ClassType;
+    using Type = typename MemberPointer<decltype(Member)>::FieldType;
+
+    Reader reader(data, size);
+    typename ViewType<Type>::type result{};
+    bool found = false;
+
+    forEachField(Class::fields(), [&](const auto& f) {
+        using FieldType =
+            std::remove_cv_t<std::remove_reference_t<decltype(std::declval<Class&>().*(f.member))>>;
+        if (found) {
+            return;
+        }
+        if constexpr (std::is_same_v<decltype(f.member), decltype(Member)>) {
+            if (f.member == Member) {
+                found = true;
+                if constexpr (std::is_same_v<Type, std::string>) {
+                    uint32_t length = reader.count(1, "string");
+                    result = std::string_view(
+                        reinterpret_cast<const char*>(reader.take(length, "string")), length);
+                } else if constexpr (IsVector<Type>::value) {
+                    using Element = typename Type::value_type;
+                    uint32_t count = reader.count(sizeof(Element), "array");
+                    result = ArrayView<Element>(
+                        reader.take(static_cast<size_t>(count) * sizeof(Element), "array"), count);
+                } else {
+                    read(reader, result);
+                }
+                return;
+            }
+        }
+        skip<FieldType>(reader);
+    });
+
+    return result;
+}
+
+/**
+ * @brief Whether a bulk struct's schema lists every field at its in-memory offset
+ *
+ * Bulk copies assume this; it cannot be checked at compile time without the
+ * field names, so the unit tests check it for every bulk message type.
+ */
+template <typename T>
+bool layoutMatchesSchema() {
+    static_assert(HasSchema<T>::value, "Type has no schema");
+    T value{};
+    const uint8_t* base = reinterpret_cast<const uint8_t*>(&value);
+    size_t offset = 0;
+    bool matches = true;
+    forEachField(T::fields(), [&](const auto& f) {
+        const uint8_t* member = reinterpret_cast<const uint8_t*>(&(value.*(f.member)));
+        matches = matches && static_cast<size_t>(member - base) == offset;
+        offset += fixedSize<std::remove_cv_t<std::remove_reference_t<decltype(value.*(f.member))>>>();
+    });
+    return matches && offset == sizeof(T);
+}
+
+} // namespace schema
+} // namespace voyis
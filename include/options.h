@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace voyis {
+
+/**
+ * @brief Minimal command line parser shared by all applications
+ *
+ * Options are written as "--name=value" or as a bare "--name" flag (which
+ * reads as "true"). Every other argument is kept as a positional argument.
+ * Values are never taken from the following argument, so positional
+ * arguments and flags can be mixed in any order.
+ */
+class Options {
+public:
+    Options() = default;
+    Options(int argc, char* argv[]);
+
+    /**
+     * @brief Check whether an option was given on the command line
+     */
+    bool has(const std::string& name) const;
+
+    /**
+     * @brief Get an option value as a string
+     */
+    std::string getString(const std::string& name, const std::string& def = "") const;
+
+    /**
+     * @brief Get an option value as an integer
+     * @throws std::invalid_argument if the value is not a valid integer
+     */
+    int64_t getInt(const std::string& name, int64_t def = 0) const;
+
+    /**
+     * @brief Get an option value as a floating point number
+     * @throws std::invalid_argument if the value is not a valid number
+     */
+    double getDouble(const std::string& name, double def = 0.0) const;
+
+    /**
+     * @brief Get a boolean option ("true"/"1"/"yes"/"on" or a bare flag)
+     */
+    bool getBool(const std::string& name, bool def = false) const;
+
+    /**
+     * @brief Get a comma separated option value as a list
+     */
+    std::vector<std::string> getList(const std::string& name) const;
+
+    /**
+     * @brief Get a list of "key:value" pairs (e.g. "--stream-slo=cam0:200,cam1:500")
+     * @throws std::invalid_argument if an entry has no ':' separator
+     */
+    std::map<std::string, std::string> getMap(const std::string& name) const;
+
+    /**
+     * @brief Get a list of "key:value" pairs with integer values
+     * @throws std::invalid_argument if an entry has no ':' or its value is not a valid integer
+     */
+    std::map<std::string, int64_t> getIntMap(const std::string& name) const;
+
+    /**
+     * @brief Get a list of "key:value" pairs with floating point values
+     * @throws std::invalid_argument if an entry has no ':' or its value is not a valid number
+     */
+    std::map<std::string, double> getDoubleMap(const std::string& name) const;
+
+    /**
+     * @brief Positional (non "--") arguments in command line order
+     */
+    const std::vector<std::string>& positional() const { return positional_; }
+
+private:
+    std::map<std::string, std::string> values_;
+    std::vector<std::string> positional_;
+};
+
+} // namespace voyis
@@ -0,0 +1,239 @@
+#pragma once
+
+// C++20 coroutine support for the IPC layer (built with -DVOYIS_ENABLE_COROUTINES=ON)
+
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace voyis {
+
+template <typename T>
+class Task;
+
+namespace detail {
+
+struct TaskPromiseBase {
+    std::coroutine_handle<> continuation;
+    std::exception_ptr error;
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    // Resume whoever awaited the task (symmetric transfer, no stack growth)
+    struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            std::coroutine_handle<> next = handle.promise().continuation;
+            return next ? next : std::noop_coroutine();
+        }
+        void await_resume() noexcept {}
+    };
+    FinalAwaiter final_suspend() noexcept { return {}; }
+
+    void unhandled_exception() { error = std::current_exception(); }
+};
+
+template <typename T>
+struct TaskPromise : TaskPromiseBase {
+    std::optional<T> value;
+
+    Task<T> get_return_object();
+    void return_value(T result) { value = std::move(result); }
+    T take() {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return std::move(*value);
+    }
+};
+
+template <>
+struct TaskPromise<void> : TaskPromiseBase {
+    Task<void> get_return_object();
+    void return_void() {}
+    void take() {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+} // namespace detail
+
+/**
+ * @brief Lazily started coroutine producing a T
+ *
+ * Starts when awaited (or when handed to Reactor::spawn) and resumes its
+ * awaiter when it finishes. Exceptions propagate to the awaiter.
+ */
+template <typename T = void>
+class [[nodiscard]] Task {
+public:
+    using promise_type = detail::TaskPromise<T>;
+    using Handle = std::coroutine_handle<promise_type>;
+
+    explicit Task(Handle handle) : handle_(handle) {}
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle_) {
+                handle_.destroy();
+            }
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept {
+        handle_.promise().continuation = awaiter;
+        return handle_;
+    }
+    T await_resume() { return handle_.promise().take(); }
+
+private:
+    Handle handle_;
+};
+
+namespace detail {
+
+template <typename T>
+Task<T> TaskPromise<T>::get_return_object() {
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() {
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+} // namespace detail
+
+/**
+ * @brief Outcome of waiting on a socket or timer
+ */
+enum class IoStatus {
+    Ready,    // Socket can be read/written
+    Timeout,  // Deadline passed first
+    Cancelled // Reactor is shutting down
+};
+
+class Reactor;
+
+/**
+ * @brief Awaitable that suspends until a ZeroMQ socket is ready, a deadline passes or the reactor stops
+ */
+class IoWait {
+public:
+    /**
+     * @param socket ZeroMQ socket, or nullptr for a plain timer
+     * @param events ZMQ_POLLIN and/or ZMQ_POLLOUT
+     * @param deadline_ms Steady-clock deadline in ms, or -1 for none
+     */
+    IoWait(Reactor& reactor, void* socket, short events, int64_t deadline_ms)
+        : reactor_(reactor), socket_(socket), events_(events), deadline_ms_(deadline_ms) {}
+
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(std::coroutine_handle<> handle);
+    IoStatus await_resume() const noexcept { return status_; }
+
+private:
+    friend class Reactor;
+
+    Reactor& reactor_;
+    void* socket_;
+    short events_;
+    int64_t deadline_ms_;
+    std::coroutine_handle<> handle_;
+    IoStatus status_ = IoStatus::Cancelled;
+};
+
+/**
+ * @brief Single-threaded epoll event loop that drives IPC coroutines
+ *
+ * Every coroutine spawned on the reactor runs on the thread that calls
+ * run(), so the ZeroMQ sockets they use (which are not thread-safe) need no
+ * locking; many streams are served by cheap coroutine frames instead of one
+ * OS thread each. ZeroMQ exposes readiness through an edge-triggered file
+ * descriptor per socket, so after every wake-up the reactor re-checks
+ * ZMQ_EVENTS of each waiting socket. stop() may be called from any thread
+ * or a signal handler: pending waits complete with IoStatus::Cancelled and
+ * run() returns once every spawned task has finished.
+ */
+class Reactor {
+public:
+    Reactor();
+    ~Reactor();
+
+    Reactor(const Reactor&) = delete;
+    Reactor& operator=(const Reactor&) = delete;
+
+    /**
+     * @brief Start a task on the reactor (before run() or from a reactor coroutine)
+     *
+     * Exceptions escaping the task are reported on stderr.
+     */
+    void spawn(Task<void> task);
+
+    /**
+     * @brief Run the event loop until every spawned task has finished
+     */
+    void run();
+
+    /**
+     * @brief Cancel pending waits and let tasks wind down (thread- and signal-safe)
+     */
+    void stop();
+
+    bool stopping() const { return stop_requested_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Wait until a socket has the given events (see IoWait)
+     */
+    IoWait wait(void* socket, short events, int64_t deadline_ms) {
+        return IoWait(*this, socket, events, deadline_ms);
+    }
+
+    /**
+     * @brief Suspend for a while
+     * @return IoStatus::Timeout after the full delay, IoStatus::Cancelled on shutdown
+     */
+    IoWait sleep(int64_t delay_ms) { return IoWait(*this, nullptr, 0, now() + delay_ms); }
+
+    /**
+     * @brief Steady-clock time in milliseconds, the clock used for deadlines
+     */
+    static int64_t now();
+
+    /**
+     * @brief Deadline timeout_ms from now, or -1 for a negative timeout
+     */
+    static int64_t deadline(int timeout_ms) { return timeout_ms < 0 ? -1 : now() + timeout_ms; }
+
+private:
+    friend class IoWait;
+
+    // Whether a socket currently has any of the events
+    static bool socketReady(void* socket, short events);
+
+    void add(IoWait* waiter);
+
+    int epoll_fd_;
+    int wake_fd_; // eventfd written by stop()
+    std::atomic<bool> stop_requested_{false};
+    std::vector<IoWait*> waiters_;
+    size_t active_tasks_ = 0;
+};
+
+} // namespace voyis
@@ -0,0 +1,217 @@
+#pragma once
+
+#include "flight_recorder.h"
+#include "lockfree_queue.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace voyis {
+
+/**
+ * @brief One completed span, as recorded by the thread that ran it
+ */
+struct TraceEvent {
+    const char* name = nullptr; // String literal
+    uint64_t start_ns = 0;      // CLOCK_MONOTONIC, shared by all processes on a host
+    uint64_t duration_ns = 0;
+    uint32_t tid = 0;
+    int port = 0;               // IPC port of publish/receive spans, 0 otherwise
+    char frame_id[64] = {};     // Truncated image_id
+};
+
+/**
+ * @brief Writes per-frame spans as a Chrome JSON trace (loads in Perfetto UI)
+ *
+ * Each recording thread gets its own single-producer ring, so recording a
+ * span never takes a lock or a system call. A flusher thread drains the
+ * rings every flush interval and appends the spans to the trace file; spans
+ * that find their thread's ring full are counted as dropped.
+ *
+ * The file is a JSON array written incrementally. A clean shutdown closes
+ * it; the trace of a crashed process only lacks the closing bracket, which
+ * both chrome://tracing and scripts/merge_traces.py accept. The first
+ * events carry the process name and the host's boot id and clock offsets,
+ * which the merge script uses to put several processes on one timeline.
+ */
+class TraceWriter {
+public:
+    /**
+     * @param path Trace file, truncated
+     * @param process_name Shown as the process track name
+     * @param flush_interval How often the flusher drains the rings
+     * @param events_per_thread Ring capacity of each recording thread
+     * @throws std::runtime_error if the file cannot be opened
+     */
+    TraceWriter(const std::string& path, const std::string& process_name,
+                std::chrono::milliseconds flush_interval = std::chrono::milliseconds(1000),
+                size_t events_per_thread = 16384);
+
+    /**
+     * @brief Stops the flusher, writes the remaining spans and closes the file
+     */
+    ~TraceWriter();
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    /**
+     * @brief Record a finished span from the calling thread (lock-free)
+     * @param name String literal naming the stage
+     * @param port IPC port for publish/receive spans, 0 otherwise
+     */
+    void record(const char* name, uint64_t start_ns, uint64_t end_ns,
+                const std::string& frame_id, int port = 0);
+
+    /**
+     * @brief Name the calling thread's track in the trace
+     */
+    void nameThread(const std::string& name);
+
+    /**
+     * @brief Write all spans recorded so far to the file
+     */
+    void flush();
+
+    uint64_t written() const { return written_.load(std::memory_order_relaxed); }
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Writer that TraceSpan records into, or nullptr when tracing is off
+     */
+    static TraceWriter* active() { return active_.load(std::memory_order_acquire); }
+    static void setActive(TraceWriter* writer) { active_.store(writer, std::memory_order_release); }
+
+    /**
+     * @brief CLOCK_MONOTONIC in nanoseconds
+     */
+    static uint64_t nowNs();
+
+private:
+    struct ThreadBuffer {
+        explicit ThreadBuffer(size_t capacity) : ring(capacity) {}
+
+        uint32_t tid = 0;
+        std::string name;     // Guarded by buffers_mutex_
+        bool name_written = false;
+        SpscRing<TraceEvent> ring;
+    };
+
+    ThreadBuffer& threadBuffer();
+    void flushLoop();
+    void writeEvent(const TraceEvent& event);
+    void writeRaw(const std::string& json);
+
+    const uint64_t id_; // Distinguishes writers in the per-thread buffer cache
+    const uint32_t pid_;
+    const std::chrono::milliseconds flush_interval_;
+    const size_t events_per_thread_;
+
+    std::mutex buffers_mutex_;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+
+    std::mutex file_mutex_; // Single consumer of the rings
+    std::ofstream file_;
+    bool first_event_ = true;
+    std::string pending_;
+
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> dropped_{0};
+
+    std::mutex stop_mutex_;
+    std::condition_variable stop_cv_;
+    bool stopping_ = false;
+    std::thread flusher_;
+
+    static std::atomic<TraceWriter*> active_;
+};
+
+/**
+ * @brief RAII span around one pipeline stage of one frame
+ *
+ * Goes to the active trace writer and, as a stage timing, to the frame of a
+ * FlightTimer running on the same thread. With neither, it costs one atomic
+ * and one thread-local load. The frame id is copied, so the message it came
+ * from may be moved while the span is open.
+ */
+class TraceSpan {
+public:
+    TraceSpan(const char* name, const std::string& frame_id, int port = 0)
+        : writer_(TraceWriter::active()), flight_frame_(FlightTimer::current()), name_(name),
+          port_(port) {
+        if (writer_) {
+            frame_id_ = frame_id;
+        }
+        if (writer_ || flight_frame_) {
+            start_ns_ = TraceWriter::nowNs();
+        }
+    }
+
+    ~TraceSpan() { end(); }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    /**
+     * @brief Set the frame id once it is known, e.g. after deserializing
+     */
+    void setFrameId(const std::string& frame_id) {
+        if (writer_) {
+            frame_id_ = frame_id;
+        }
+    }
+
+    /**
+     * @brief Close the span before the end of the scope
+     */
+    void end() {
+        if (!writer_ && !flight_frame_) {
+            return;
+        }
+        uint64_t end_ns = TraceWriter::nowNs();
+        if (writer_) {
+            writer_->record(name_, start_ns_, end_ns, frame_id_, port_);
+            writer_ = nullptr;
+        }
+        if (flight_frame_) {
+            flight_frame_->addStage(name_, end_ns - start_ns_);
+            flight_frame_ = nullptr;
+        }
+    }
+
+private:
+    TraceWriter* writer_;
+    FlightFrame* flight_frame_;
+    const char* name_;
+    int port_;
+    std::string frame_id_;
+    uint64_t start_ns_ = 0;
+};
+
+/**
+ * @brief Port number at the end of a ZeroMQ endpoint, 0 if it has none
+ */
+int endpointPort(const std::string& endpoint);
+
+class Options;
+
+/**
+ * @brief Start tracing from the command line
+ *
+ * With --trace=<file>, creates a writer flushing every --trace-flush-ms
+ * milliseconds (default 1000) and makes it the active writer until it is
+ * destroyed. Returns nullptr when --trace is not given.
+ * @throws std::runtime_error if the trace file cannot be opened
+ * @throws std::invalid_argument for a non-positive flush interval
+ */
+std::unique_ptr<TraceWriter> configureTracing(const Options& options,
+                                              const std::string& process_name);
+
+} // namespace voyis
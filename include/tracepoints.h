@@ -0,0 +1,48 @@
+#pragma once
+
+/**
+ * @brief USDT (user-level statically defined tracing) probes, provider "voyis"
+ *
+ * Each probe compiles to a single nop plus an ELF note, so it costs nothing
+ * until a tracer (bpftrace, perf, SystemTap) attaches to it on a live
+ * process. Builds without <sys/sdt.h> (or with -DVOYIS_ENABLE_USDT=OFF)
+ * compile the probes away entirely.
+ *
+ * Probes and arguments (strings are char*, sizes are bytes):
+ *
+ *   every executable  publish_start(bytes)
+ *                     publish_done(bytes, ok)
+ *                     receive(bytes)
+ *   image_generator   read_start(path)
+ *                     read_done(path, bytes)
+ *                     frame_published(image_id, bytes)
+ *   feature_extractor frame_received(image_id, bytes)
+ *                     process_start(image_id, bytes)
+ *                     process_done(image_id, keypoints, quality_flags)
+ *                     frame_published(image_id, bytes)
+ *   data_logger       store_start(image_id, keypoints)
+ *                     store_done(image_id, keypoints, ok)
+ *   feature_matcher   match_start(image_id, keypoints)
+ *                     match_done(image_id, reference_frames, loop_candidates)
+ *
+ * List them with: readelf -n bin/feature_extractor | grep -A2 stapsdt
+ * scripts/bpftrace/ turns them into per-stage latency distributions.
+ */
+
+#ifdef VOYIS_HAVE_USDT
+
+#include <sys/sdt.h>
+
+#define VOYIS_TRACE1(name, a1) DTRACE_PROBE1(voyis, name, a1)
+#define VOYIS_TRACE2(name, a1, a2) DTRACE_PROBE2(voyis, name, a1, a2)
+#define VOYIS_TRACE3(name, a1, a2, a3) DTRACE_PROBE3(voyis, name, a1, a2, a3)
+
+#else
+
+// Arguments stay unevaluated but count as used, so no unused-variable warnings
+#define VOYIS_TRACE1(name, a1) do { (void)sizeof(a1); } while (0)
+#define VOYIS_TRACE2(name, a1, a2) do { (void)sizeof(a1); (void)sizeof(a2); } while (0)
+#define VOYIS_TRACE3(name, a1, a2, a3) \
+    do { (void)sizeof(a1); (void)sizeof(a2); (void)sizeof(a3); } while (0)
+
+#endif
@@ -0,0 +1,199 @@
+#pragma once
+
+#include "lockfree_queue.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace voyis {
+
+/**
+ * @brief Thread pool where each worker owns a task deque and idle workers steal
+ *
+ * Tasks submitted from a worker go to the back of that worker's own deque
+ * and are popped LIFO, so recursive splits stay cache-hot on one core;
+ * tasks submitted from other threads are spread round-robin. A worker whose
+ * deque is empty steals the oldest task from the front of another worker's
+ * deque. Each deque has its own lock, so workers only contend when stealing.
+ * Workers with nothing to do sleep until a task is submitted.
+ */
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    /**
+     * @param threads Number of workers (0 uses one per hardware thread)
+     */
+    explicit WorkStealingPool(size_t threads = 0) {
+        if (threads == 0) {
+            threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+        }
+        for (size_t i = 0; i < threads; ++i) {
+            workers_.push_back(std::make_unique<Worker>());
+        }
+        for (size_t i = 0; i < threads; ++i) {
+            threads_.emplace_back([this, i]() { run(i); });
+        }
+    }
+
+    /**
+     * @brief Run all queued tasks, then join the workers
+     */
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (auto& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /**
+     * @brief Queue a task; exceptions it throws are discarded
+     */
+    void submit(Task task) {
+        const size_t index = current_pool_ == this
+                                 ? current_index_
+                                 : next_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+
+        // Count before publishing so a worker never sees the task uncounted
+        active_.fetch_add(1, std::memory_order_relaxed);
+        queued_.fetch_add(1, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(workers_[index]->mutex);
+            workers_[index]->tasks.push_back(std::move(task));
+        }
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+        }
+        wake_.notify_one();
+    }
+
+    /**
+     * @brief Queue a callable and get a future for its result
+     */
+    template <typename F>
+    auto async(F&& fn) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+        using Result = std::invoke_result_t<std::decay_t<F>>;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(fn));
+        std::future<Result> result = task->get_future();
+        submit([task]() { (*task)(); });
+        return result;
+    }
+
+    /**
+     * @brief Block until every submitted task has finished (not from a worker)
+     */
+    void waitIdle() {
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        idle_.wait(lock, [this]() { return active_.load(std::memory_order_acquire) == 0; });
+    }
+
+    size_t size() const { return workers_.size(); }
+
+    /**
+     * @brief Tasks run by a worker other than the one they were queued on
+     */
+    uint64_t steals() const { return steals_.load(std::memory_order_relaxed); }
+
+private:
+    struct alignas(kCacheLineSize) Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    bool popLocal(size_t index, Task& task) {
+        Worker& worker = *workers_[index];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (worker.tasks.empty()) {
+            return false;
+        }
+        task = std::move(worker.tasks.back());
+        worker.tasks.pop_back();
+        return true;
+    }
+
+    bool steal(size_t thief, Task& task) {
+        for (size_t i = 1; i < workers_.size(); ++i) {
+            Worker& victim = *workers_[(thief + i) % workers_.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                steals_.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void run(size_t index) {
+        current_pool_ = this;
+        current_index_ = index;
+
+        for (;;) {
+            Task task;
+            if (popLocal(index, task) || steal(index, task)) {
+                queued_.fetch_sub(1, std::memory_order_relaxed);
+                try {
+                    task();
+                } catch (...) {
+                    // A failing task must not take the worker down
+                }
+                if (active_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    std::lock_guard<std::mutex> lock(sleep_mutex_);
+                    idle_.notify_all();
+                }
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleep_mutex_);
+            if (queued_.load(std::memory_order_acquire) > 0) {
+                // Counted but not yet pushed; it will appear shortly
+                lock.unlock();
+                std::this_thread::yield();
+                continue;
+            }
+            if (stopping_) {
+                return;
+            }
+            wake_.wait(lock, [this]() {
+                return stopping_ || queued_.load(std::memory_order_acquire) > 0;
+            });
+        }
+    }
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+    std::atomic<size_t> next_{0};     // Round-robin target for external submits
+    std::atomic<size_t> queued_{0};   // Submitted, not yet started
+    std::atomic<size_t> active_{0};   // Submitted, not yet finished
+    std::atomic<uint64_t> steals_{0};
+
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    std::condition_variable idle_;
+    bool stopping_ = false;
+
+    // Pool and worker index of the calling thread, if it is a worker
+    static inline thread_local const WorkStealingPool* current_pool_ = nullptr;
+    static inline thread_local size_t current_index_ = 0;
+};
+
+} // namespace voyis
@@ -0,0 +1,206 @@
+#!/usr/bin/env python3
+"""Merge the --trace files of several pipeline processes into one timeline.
+
+Each process writes its spans with CLOCK_MONOTONIC timestamps, which all
+processes of one boot share, so traces from one host line up as they are.
+Traces from other hosts (a different boot id) are first moved to wall-clock
+time using the clock offsets recorded at startup, then shifted by frame id:
+every "publish" span is paired with the "receive" spans of the same frame on
+the same port, and each clock domain is shifted so that its fastest frame
+is received as it is published (one-way latency between hosts cannot be
+measured without a shared clock).
+
+The output is a Chrome JSON trace with a flow arrow from each publish to
+its receives; open it in https://ui.perfetto.dev or chrome://tracing. A
+summary of the publish -> receive latency of every hop goes to stderr.
+
+Usage:
+  scripts/merge_traces.py generator.json extractor.json logger.json -o pipeline.json
+  scripts/merge_traces.py --align=frames ...   # shift every trace by frame id
+  scripts/merge_traces.py --align=none ...     # keep the recorded timestamps
+"""
+
+import argparse
+import json
+import statistics
+import sys
+from collections import defaultdict
+
+
+def load_events(path):
+    """Read a trace, tolerating the missing tail of a process that crashed."""
+    with open(path) as f:
+        text = f.read().strip()
+    if text.startswith("{"):
+        return json.loads(text)["traceEvents"]
+
+    # Incrementally written array: one event per line, maybe cut short
+    lines = text.split("\n")
+    if lines[-1].strip() == "]":
+        lines.pop()
+    while True:
+        body = "\n".join(lines).rstrip().rstrip(",")
+        try:
+            return json.loads(body + "\n]")
+        except ValueError:
+            if len(lines) <= 1:
+                raise
+            lines.pop()  # Event only partly written
+
+
+class Trace:
+    def __init__(self, path):
+        self.path = path
+        self.events = load_events(path)
+        self.name = path
+        self.boot_id = None
+        self.unix_offset_us = 0.0
+        self.pid = None
+        for event in self.events:
+            if event.get("ph") != "M":
+                continue
+            self.pid = event.get("pid", self.pid)
+            if event["name"] == "process_name":
+                self.name = event["args"]["name"]
+            elif event["name"] == "clock_sync":
+                args = event["args"]
+                self.boot_id = args.get("boot_id") or None
+                self.unix_offset_us = (args["unix_ns"] - args["monotonic_ns"]) / 1000.0
+        self.offset_us = 0.0
+
+    def spans(self, name):
+        for event in self.events:
+            if event.get("ph") == "X" and event["name"] == name and event["args"].get("frame"):
+                yield event
+
+
+def make_pids_unique(traces):
+    """Processes on different hosts can share a pid."""
+    used = set()
+    for trace in traces:
+        pid = trace.pid
+        if pid is None or pid in used:
+            pid = max(used | {0}) + 1
+            for event in trace.events:
+                event["pid"] = pid
+            trace.pid = pid
+        used.add(pid)
+
+
+def pair_frames(traces):
+    """(upstream index, downstream index) -> [(publish event, receive event)]"""
+    published = {}
+    for index, trace in enumerate(traces):
+        for event in trace.spans("publish"):
+            port = event["args"].get("port")
+            if port:
+                published[(port, event["args"]["frame"])] = (index, event)
+
+    pairs = defaultdict(list)
+    for index, trace in enumerate(traces):
+        for event in trace.spans("receive"):
+            key = (event["args"].get("port"), event["args"]["frame"])
+            if key in published and published[key][0] != index:
+                upstream, publish = published[key]
+                pairs[(upstream, index)].append((publish, event))
+    return pairs
+
+
+def align(traces, pairs, mode):
+    """Set each trace's offset_us so that all traces share one timeline."""
+    boot_ids = [trace.boot_id or trace.path for trace in traces]
+    if len(set(boot_ids)) == 1 and mode != "frames":
+        return  # One host: the monotonic clocks already agree
+    for trace in traces:
+        trace.offset_us = trace.unix_offset_us
+    if mode == "none":
+        return
+    domains = list(range(len(traces))) if mode == "frames" else boot_ids
+
+    # Place the domain of the first trace, then any domain fed by a placed one
+    placed = {domains[0]}
+    while True:
+        best = None
+        for (upstream, downstream), frames in pairs.items():
+            if domains[upstream] in placed and domains[downstream] not in placed:
+                delta = min(
+                    (receive["ts"] + traces[downstream].offset_us)
+                    - (publish["ts"] + traces[upstream].offset_us)
+                    for publish, receive in frames
+                )
+                best = (domains[downstream], delta)
+                break
+        if best is None:
+            break
+        domain, delta = best
+        for index, trace in enumerate(traces):
+            if domains[index] == domain:
+                trace.offset_us -= delta
+        placed.add(domain)
+
+    unplaced = sorted({traces[i].name for i in range(len(traces)) if domains[i] not in placed})
+    if unplaced:
+        print("No frames shared with the other traces, kept clock offsets: " +
+              ", ".join(unplaced), file=sys.stderr)
+
+
+def merge(traces, pairs):
+    events = []
+    for trace in traces:
+        for event in trace.events:
+            if "ts" in event:
+                event["ts"] = round(event["ts"] + trace.offset_us, 3)
+            events.append(event)
+
+    # Flow arrows from each publish to the receives of the same frame
+    flow_id = 0
+    for (upstream, downstream), frames in sorted(pairs.items()):
+        for publish, receive in frames:
+            flow_id += 1
+            events.append({"name": "frame", "cat": "flow", "ph": "s", "id": flow_id,
+                           "pid": publish["pid"], "tid": publish["tid"], "ts": publish["ts"],
+                           "args": {"frame": publish["args"]["frame"]}})
+            events.append({"name": "frame", "cat": "flow", "ph": "f", "bp": "e", "id": flow_id,
+                           "pid": receive["pid"], "tid": receive["tid"], "ts": receive["ts"],
+                           "args": {"frame": receive["args"]["frame"]}})
+
+    events.sort(key=lambda event: (event.get("ph") != "M", event.get("ts", 0)))
+    return {"traceEvents": events, "displayTimeUnit": "ms"}
+
+
+def print_hops(traces, pairs):
+    for (upstream, downstream), frames in sorted(pairs.items()):
+        latencies = sorted((receive["ts"] + receive["dur"] - publish["ts"]) / 1000.0
+                           for publish, receive in frames)
+        port = frames[0][0]["args"]["port"]
+        print("%s -> %s (port %d): %d frames, publish to received median %.3f ms, max %.3f ms"
+              % (traces[upstream].name, traces[downstream].name, port, len(frames),
+                 statistics.median(latencies), latencies[-1]), file=sys.stderr)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("traces", nargs="+", help="trace files written with --trace")
+    parser.add_argument("-o", "--output", default="pipeline_trace.json",
+                        help="merged trace (default: pipeline_trace.json)")
+    parser.add_argument("--align", choices=["auto", "frames", "none"], default="auto",
+                        help="auto: shift only traces from other hosts (default); "
+                             "frames: shift every trace by frame id; "
+                             "none: keep the recorded clocks")
+    args = parser.parse_args()
+
+    traces = [Trace(path) for path in args.traces]
+    make_pids_unique(traces)
+    pairs = pair_frames(traces)
+    align(traces, pairs, args.align)
+    merged = merge(traces, pairs)
+    print_hops(traces, pairs)
+    with open(args.output, "w") as f:
+        json.dump(merged, f)
+    spans = sum(1 for event in merged["traceEvents"] if event.get("ph") == "X")
+    print("Wrote %d spans from %d trace(s) to %s" % (spans, len(traces), args.output),
+          file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,294 @@
+#!/usr/bin/env python3
+"""Run the pipeline for a long time on a synthetic workload and watch its memory.
+
+The generator publishes frames alternating between small (1 KB) and large
+(30 MB) sizes, the mix that fragments malloc heaps the most. Large frames
+are flat by default, so they fail the extractor's contrast check and are
+passed on without running SIFT: the workload stays fast while every stage
+still receives, copies and frees 30 MB messages. The logger keeps only the
+newest images so the database does not fill the disk.
+
+Every --sample-interval the resident memory (RSS), page faults and malloc
+heap statistics of each process are recorded to a CSV file. RSS comes from
+/proc; heap figures come from each process's control socket (glibc malloc
+only, zero under another allocator). After the run, the RSS growth of each
+process since the end of the warm-up is compared with --max-growth-mb, and
+the harness exits with 1 if any process grew more, stopped making progress
+or died.
+
+Usage:
+  scripts/soak_test.py --bin-dir=build/bin --duration=24h
+  scripts/soak_test.py --duration=2h --preload=/usr/lib/x86_64-linux-gnu/libjemalloc.so.2
+  scripts/soak_test.py --duration=2h --preload=/usr/lib/x86_64-linux-gnu/libmimalloc.so
+  scripts/soak_test.py --logger-args="--batch-size=50" --large-every=4
+
+The pipeline uses the fixed ports 5555 and 5556, so nothing else may run
+the pipeline on this host during a soak test.
+"""
+
+import argparse
+import csv
+import json
+import math
+import os
+import shlex
+import signal
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+MB = 1024 * 1024
+
+# Counter of frames handled, per process
+FRAME_STATS = {
+    "image_generator": "frames_published",
+    "feature_extractor": "frames_processed",
+    "data_logger": "frames_stored",
+}
+
+
+def parse_duration(text):
+    """Seconds from "90", "30s", "10m", "24h" or "7d"."""
+    units = {"s": 1, "m": 60, "h": 3600, "d": 86400}
+    if text and text[-1] in units:
+        return float(text[:-1]) * units[text[-1]]
+    return float(text)
+
+
+def write_pgm(path, side, pixels):
+    with open(path, "wb") as f:
+        f.write(b"P5\n%d %d\n255\n" % (side, side))
+        f.write(pixels)
+
+
+def make_workload(directory, args):
+    """Frames named so that the generator's sorted order alternates sizes."""
+    os.makedirs(directory, exist_ok=True)
+    small_side = max(16, int(math.sqrt(args.small_kb * 1024)))
+    large_side = int(math.sqrt(args.large_mb * MB))
+    for i in range(args.frames):
+        path = os.path.join(directory, "frame_%04d.pgm" % i)
+        if i % args.large_every == args.large_every - 1:
+            pixels = os.urandom(large_side * large_side) if args.large_sift \
+                else bytes([128]) * (large_side * large_side)
+            write_pgm(path, large_side, pixels)
+        else:
+            write_pgm(path, small_side, os.urandom(small_side * small_side))
+    return small_side, large_side
+
+
+def read_proc(pid):
+    """RSS in bytes and minor/major page faults from /proc."""
+    rss = 0
+    with open("/proc/%d/status" % pid) as f:
+        for line in f:
+            if line.startswith("VmRSS:"):
+                rss = int(line.split()[1]) * 1024
+    with open("/proc/%d/stat" % pid) as f:
+        # Fields after the command name, which may contain spaces
+        fields = f.read().rsplit(")", 1)[1].split()
+    return rss, int(fields[7]), int(fields[9])
+
+
+def query_stats(voyisctl, endpoint):
+    try:
+        result = subprocess.run([voyisctl, endpoint, "stats", "--timeout-ms=2000"],
+                                capture_output=True, text=True, timeout=10)
+        reply = json.loads(result.stdout)
+        return reply.get("stats", {}) if reply.get("ok") else {}
+    except (subprocess.SubprocessError, ValueError):
+        return {}
+
+
+def slope_mb_per_hour(points):
+    """Least-squares slope of (seconds, bytes) points."""
+    if len(points) < 2:
+        return 0.0
+    mean_t = statistics.fmean(t for t, _ in points)
+    mean_v = statistics.fmean(v for _, v in points)
+    var_t = sum((t - mean_t) ** 2 for t, _ in points)
+    if var_t == 0:
+        return 0.0
+    cov = sum((t - mean_t) * (v - mean_v) for t, v in points)
+    return cov / var_t * 3600 / MB
+
+
+class Stage:
+    def __init__(self, name, command, workdir, env, keep_logs):
+        self.name = name
+        self.endpoint = "ipc://%s/%s.sock" % (workdir, name)
+        stdout = open(os.path.join(workdir, name + ".log"), "w") if keep_logs \
+            else subprocess.DEVNULL
+        self.stderr = open(os.path.join(workdir, name + ".err"), "w")
+        self.process = subprocess.Popen(command + ["--control=" + self.endpoint],
+                                        stdout=stdout, stderr=self.stderr, env=env,
+                                        cwd=workdir)
+        self.samples = []  # (elapsed seconds, rss bytes)
+        self.frames = 0
+        self.max_fragmentation = 0.0
+
+    def stop(self):
+        if self.process.poll() is None:
+            self.process.send_signal(signal.SIGINT)
+            try:
+                self.process.wait(timeout=15)
+            except subprocess.TimeoutExpired:
+                self.process.kill()
+                self.process.wait()
+        self.stderr.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Pipeline memory soak test")
+    parser.add_argument("--bin-dir", default="build/bin", help="Directory of the built binaries")
+    parser.add_argument("--workdir", help="Images, database, logs and CSV (default: a temp dir)")
+    parser.add_argument("--duration", default="10m", help="Run time, e.g. 30m, 24h, 7d")
+    parser.add_argument("--warmup", default="2m", help="Growth is measured from the end of this")
+    parser.add_argument("--sample-interval", default="10s")
+    parser.add_argument("--max-growth-mb", type=float, default=64.0,
+                        help="Allowed RSS growth per process after the warm-up")
+    parser.add_argument("--small-kb", type=float, default=1.0)
+    parser.add_argument("--large-mb", type=float, default=30.0)
+    parser.add_argument("--large-every", type=int, default=2,
+                        help="Every Nth frame is large (2 alternates)")
+    parser.add_argument("--large-sift", action="store_true",
+                        help="Give large frames texture so SIFT runs on them (slow)")
+    parser.add_argument("--frames", type=int, default=10, help="Distinct frame files")
+    parser.add_argument("--interval-ms", type=int, default=10, help="Generator frame interval")
+    parser.add_argument("--keep-images", type=int, default=100,
+                        help="Images the logger keeps in its database")
+    parser.add_argument("--preload", help="Allocator library for LD_PRELOAD, e.g. libjemalloc.so.2")
+    parser.add_argument("--generator-args", default="", help="Extra image_generator options")
+    parser.add_argument("--extractor-args", default="", help="Extra feature_extractor options")
+    parser.add_argument("--logger-args", default="", help="Extra data_logger options")
+    parser.add_argument("--keep-logs", action="store_true",
+                        help="Keep stdout of each stage (grows with every frame)")
+    parser.add_argument("--csv", help="Samples output (default: <workdir>/soak.csv)")
+    args = parser.parse_args()
+
+    if args.large_every < 1 or args.frames < args.large_every:
+        parser.error("--frames must be at least --large-every, which must be positive")
+    duration = parse_duration(args.duration)
+    warmup = parse_duration(args.warmup)
+    sample_interval = parse_duration(args.sample_interval)
+    if warmup >= duration:
+        parser.error("--warmup must be shorter than --duration")
+
+    bin_dir = os.path.abspath(args.bin_dir)
+    workdir = os.path.abspath(args.workdir or tempfile.mkdtemp(prefix="voyis-soak-"))
+    os.makedirs(workdir, exist_ok=True)
+    csv_path = args.csv or os.path.join(workdir, "soak.csv")
+    voyisctl = os.path.join(bin_dir, "voyisctl")
+
+    image_dir = os.path.join(workdir, "images")
+    small_side, large_side = make_workload(image_dir, args)
+    print("Workload: %d frames in %s, %dx%d and every %d. %dx%d (%.1f MB)%s" % (
+        args.frames, image_dir, small_side, small_side, args.large_every, large_side,
+        large_side, large_side * large_side / MB, ", textured" if args.large_sift else ""))
+
+    env = dict(os.environ)
+    if args.preload:
+        env["LD_PRELOAD"] = os.path.abspath(args.preload)
+        print("Allocator: LD_PRELOAD=" + env["LD_PRELOAD"])
+
+    # Downstream stages first so no frame is published into the void
+    stages = []
+    try:
+        stages.append(Stage("data_logger", [
+            os.path.join(bin_dir, "data_logger"), os.path.join(workdir, "soak.db"),
+            "--keep-images=%d" % args.keep_images] + shlex.split(args.logger_args),
+            workdir, env, args.keep_logs))
+        stages.append(Stage("feature_extractor", [
+            os.path.join(bin_dir, "feature_extractor"),
+            "--min-contrast=1"] + shlex.split(args.extractor_args),
+            workdir, env, args.keep_logs))
+        time.sleep(1.0)
+        stages.append(Stage("image_generator", [
+            os.path.join(bin_dir, "image_generator"), image_dir,
+            "--interval-ms=%d" % args.interval_ms] + shlex.split(args.generator_args),
+            workdir, env, args.keep_logs))
+
+        failures = run(stages, voyisctl, csv_path, duration, warmup, sample_interval)
+    finally:
+        for stage in reversed(stages):
+            stage.stop()
+
+    failures += summarize(stages, warmup, args.max_growth_mb)
+    print("\nSamples: " + csv_path)
+    for failure in failures:
+        print("FAIL: " + failure)
+    if not failures:
+        print("PASS")
+    return 1 if failures else 0
+
+
+def run(stages, voyisctl, csv_path, duration, warmup, sample_interval):
+    start = time.monotonic()
+    next_sample = start
+    with open(csv_path, "w", newline="") as f:
+        writer = csv.writer(f)
+        writer.writerow(["elapsed_s", "process", "rss_mb", "heap_mb", "heap_in_use_mb",
+                         "heap_free_mb", "fragmentation", "minor_faults", "major_faults",
+                         "frames"])
+        while True:
+            # Sample on a fixed schedule however long the queries take
+            next_sample += sample_interval
+            time.sleep(max(0.0, next_sample - time.monotonic()))
+            elapsed = time.monotonic() - start
+            for stage in stages:
+                if stage.process.poll() is not None:
+                    return ["%s exited with code %d after %.0f s (see %s.err)" % (
+                        stage.name, stage.process.returncode, elapsed, stage.name)]
+                try:
+                    rss, minor, major = read_proc(stage.process.pid)
+                except OSError:
+                    continue
+                stats = query_stats(voyisctl, stage.endpoint)
+                heap = stats.get("heap_bytes", 0)
+                heap_free = stats.get("heap_free_bytes", 0)
+                fragmentation = heap_free / heap if heap > 0 else 0.0
+                stage.frames = int(stats.get(FRAME_STATS[stage.name], stage.frames))
+                stage.samples.append((elapsed, rss))
+                if elapsed >= warmup:
+                    stage.max_fragmentation = max(stage.max_fragmentation, fragmentation)
+
+                writer.writerow(["%.1f" % elapsed, stage.name, "%.2f" % (rss / MB),
+                                 "%.2f" % (heap / MB),
+                                 "%.2f" % (stats.get("heap_in_use_bytes", 0) / MB),
+                                 "%.2f" % (heap_free / MB), "%.3f" % fragmentation,
+                                 minor, major, stage.frames])
+                print("%7.0fs  %-17s rss %8.1f MB  heap %8.1f MB (%4.1f%% free)  frames %d" % (
+                    elapsed, stage.name, rss / MB, heap / MB, 100 * fragmentation,
+                    stage.frames))
+            f.flush()
+            if elapsed >= duration:
+                return []
+
+
+def summarize(stages, warmup, max_growth_mb):
+    failures = []
+    print("\n%-17s %12s %12s %10s %10s %10s" % (
+        "Process", "RSS start", "RSS end", "Growth", "MB/hour", "Max free"))
+    for stage in stages:
+        steady = [(t, rss) for t, rss in stage.samples if t >= warmup]
+        if not steady:
+            failures.append("%s: no samples after the warm-up" % stage.name)
+            continue
+        baseline = steady[0][1]
+        final = statistics.median(rss for _, rss in steady[-3:])
+        growth = (final - baseline) / MB
+        print("%-17s %9.1f MB %9.1f MB %7.1f MB %10.2f %9.1f%%" % (
+            stage.name, baseline / MB, final / MB, growth, slope_mb_per_hour(steady),
+            100 * stage.max_fragmentation))
+        if growth > max_growth_mb:
+            failures.append("%s grew by %.1f MB after the warm-up (limit %.1f MB)" % (
+                stage.name, growth, max_growth_mb))
+        if stage.frames == 0:
+            failures.append("%s handled no frames" % stage.name)
+    return failures
+
+
+if __name__ == "__main__":
+    sys.exit(main())
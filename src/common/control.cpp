@@ -0,0 +1,359 @@
+#include "control.h"
+#include "frame_allocator.h"
+#include "ipc.h"
+#include "json_escape.h"
+#include "options.h"
+#include <unistd.h>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace voyis {
+
+namespace {
+
+// How long a "set" waits for the processing loop to reach a frame boundary
+constexpr std::chrono::milliseconds kApplyTimeout(2000);
+
+// How long a running server on the same ipc socket gets to answer
+constexpr int kProbeTimeoutMs = 200;
+
+/**
+ * @brief Whether another process answers on this ipc:// socket
+ *
+ * Binding an ipc endpoint silently replaces the socket file of a running
+ * server, so it is probed first; a file left behind by a process that died
+ * does not answer and is reused.
+ */
+bool ipcEndpointInUse(const std::string& endpoint) {
+    const std::string scheme = "ipc://";
+    if (endpoint.compare(0, scheme.size(), scheme) != 0 ||
+        access(endpoint.c_str() + scheme.size(), F_OK) != 0) {
+        return false;
+    }
+
+    Requester probe(endpoint, kProbeTimeoutMs);
+    const std::string request = "get";
+    std::vector<uint8_t> reply;
+    return probe.request(std::vector<uint8_t>(request.begin(), request.end()), reply);
+}
+
+void appendNumber(std::string& out, double value) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.10g", value);
+    out += text;
+}
+
+double parseValue(const std::string& name, const std::string& text) {
+    if (text == "true" || text == "on" || text == "yes") {
+        return 1.0;
+    }
+    if (text == "false" || text == "off" || text == "no") {
+        return 0.0;
+    }
+    errno = 0;
+    char* end = nullptr;
+    double value = std::strtod(text.c_str(), &end);
+    if (text.empty() || *end != '\0' || errno == ERANGE || !std::isfinite(value)) {
+        throw std::invalid_argument("Invalid value for " + name + ": '" + text + "'");
+    }
+    return value;
+}
+
+void checkRange(const Tunables::Info& info, double value) {
+    if (value < info.min || value > info.max) {
+        std::ostringstream message;
+        message << info.name << " must be between " << info.min << " and " << info.max;
+        throw std::invalid_argument(message.str());
+    }
+    if (info.integer && value != std::floor(value)) {
+        throw std::invalid_argument(info.name + " must be a whole number");
+    }
+}
+
+std::string errorReply(const std::string& message) {
+    std::string json = "{\"ok\":false,\"error\":";
+    appendJsonString(json, message);
+    json += "}";
+    return json;
+}
+
+std::vector<std::string> splitWords(const std::string& text) {
+    std::istringstream stream(text);
+    std::vector<std::string> words;
+    std::string word;
+    while (stream >> word) {
+        words.push_back(word);
+    }
+    return words;
+}
+
+} // anonymous namespace
+
+void Tunables::add(const std::string& name, double value, double min, double max,
+                   const std::string& description, bool integer) {
+    Info info;
+    info.name = name;
+    info.value = value;
+    info.min = min;
+    info.max = max;
+    info.integer = integer;
+    info.description = description;
+    checkRange(info, value);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!entries_.emplace(name, info).second) {
+        throw std::invalid_argument("Duplicate tunable: " + name);
+    }
+}
+
+double Tunables::get(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(name);
+    if (it == entries_.end()) {
+        throw std::invalid_argument("Unknown tunable: " + name);
+    }
+    return it->second.value;
+}
+
+int64_t Tunables::getInt(const std::string& name) const {
+    return static_cast<int64_t>(std::llround(get(name)));
+}
+
+uint64_t Tunables::request(const std::vector<std::pair<std::string, std::string>>& changes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Validate the whole batch before queueing any of it
+    std::vector<std::pair<std::string, double>> batch;
+    for (const auto& change : changes) {
+        auto it = entries_.find(change.first);
+        if (it == entries_.end()) {
+            throw std::invalid_argument("Unknown tunable: " + change.first);
+        }
+        double value = parseValue(change.first, change.second);
+        checkRange(it->second, value);
+        batch.emplace_back(change.first, value);
+    }
+
+    pending_.insert(pending_.end(), batch.begin(), batch.end());
+    has_pending_.store(true, std::memory_order_release);
+    return ++requested_generation_;
+}
+
+bool Tunables::waitApplied(uint64_t generation, std::chrono::milliseconds timeout) const {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return applied_cv_.wait_for(lock, timeout,
+                                [&]() { return applied_generation_ >= generation; });
+}
+
+bool Tunables::applyPending() {
+    if (!has_pending_.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& change : pending_) {
+            entries_[change.first].value = change.second;
+        }
+        pending_.clear();
+        has_pending_.store(false, std::memory_order_relaxed);
+        applied_generation_ = requested_generation_;
+    }
+    applied_cv_.notify_all();
+    return true;
+}
+
+std::vector<Tunables::Info> Tunables::list() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<Info> infos;
+    for (const auto& entry : entries_) {
+        infos.push_back(entry.second);
+    }
+    return infos;
+}
+
+ControlServer::ControlServer(const std::string& endpoint, const std::string& process_name,
+                             Tunables& tunables)
+    : endpoint_(endpoint),
+      process_name_(process_name),
+      tunables_(tunables),
+      started_(std::chrono::steady_clock::now()) {
+    if (ipcEndpointInUse(endpoint)) {
+        throw std::runtime_error("Control endpoint " + endpoint + " is in use by another " +
+                                 "running process; pass --control=<endpoint> or --control=off");
+    }
+    server_ = std::make_unique<ReplyServer>(endpoint, [this](const std::vector<uint8_t>& request) {
+        std::string reply = handle(std::string(request.begin(), request.end()));
+        return std::vector<uint8_t>(reply.begin(), reply.end());
+    });
+}
+
+ControlServer::~ControlServer() = default;
+
+std::atomic<double>& ControlServer::stat(const std::string& name) {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    std::unique_ptr<std::atomic<double>>& counter = stats_[name];
+    if (!counter) {
+        counter = std::make_unique<std::atomic<double>>(0.0);
+    }
+    return *counter;
+}
+
+std::string ControlServer::handle(const std::string& request) {
+    std::vector<std::string> words = splitWords(request);
+    if (words.empty()) {
+        return errorReply("Empty request (expected get, set, list or stats)");
+    }
+    const std::string command = words[0];
+    words.erase(words.begin());
+
+    try {
+        if (command == "get") {
+            std::string json = "{\"ok\":true,\"process\":";
+            appendJsonString(json, process_name_);
+            json += ",\"tunables\":{";
+            bool first = true;
+            auto append = [&](const std::string& name, double value) {
+                json += first ? "" : ",";
+                first = false;
+                appendJsonString(json, name);
+                json += ':';
+                appendNumber(json, value);
+            };
+            if (words.empty()) {
+                for (const Tunables::Info& info : tunables_.list()) {
+                    append(info.name, info.value);
+                }
+            } else {
+                for (const std::string& name : words) {
+                    append(name, tunables_.get(name));
+                }
+            }
+            return json + "}}";
+        }
+        if (command == "set") {
+            return handleSet(words);
+        }
+        if (command == "list") {
+            std::string json = "{\"ok\":true,\"process\":";
+            appendJsonString(json, process_name_);
+            json += ",\"tunables\":[";
+            bool first = true;
+            for (const Tunables::Info& info : tunables_.list()) {
+                json += first ? "\n" : ",\n";
+                first = false;
+                json += "{\"name\":";
+                appendJsonString(json, info.name);
+                json += ",\"value\":";
+                appendNumber(json, info.value);
+                json += ",\"min\":";
+                appendNumber(json, info.min);
+                json += ",\"max\":";
+                appendNumber(json, info.max);
+                json += std::string(",\"integer\":") + (info.integer ? "true" : "false") +
+                        ",\"description\":";
+                appendJsonString(json, info.description);
+                json += "}";
+            }
+            return json + "\n]}";
+        }
+        if (command == "stats") {
+            return statsJson();
+        }
+    } catch (const std::exception& e) {
+        return errorReply(e.what());
+    }
+    return errorReply("Unknown command: " + command + " (expected get, set, list or stats)");
+}
+
+std::string ControlServer::handleSet(const std::vector<std::string>& args) {
+    if (args.empty()) {
+        return errorReply("Usage: set name=value [name=value ...]");
+    }
+    std::vector<std::pair<std::string, std::string>> changes;
+    for (const std::string& arg : args) {
+        size_t equals = arg.find('=');
+        if (equals == std::string::npos || equals == 0) {
+            return errorReply("Expected name=value, got '" + arg + "'");
+        }
+        changes.emplace_back(arg.substr(0, equals), arg.substr(equals + 1));
+    }
+
+    uint64_t generation = tunables_.request(changes);
+    bool applied = tunables_.waitApplied(generation, kApplyTimeout);
+
+    std::string json = std::string("{\"ok\":true,\"applied\":") + (applied ? "true" : "false") +
+                       ",\"tunables\":{";
+    for (size_t i = 0; i < changes.size(); ++i) {
+        json += i == 0 ? "" : ",";
+        appendJsonString(json, changes[i].first);
+        json += ':';
+        appendNumber(json, tunables_.get(changes[i].first));
+    }
+    json += "}}";
+    std::cerr << "Control: set " << (applied ? "applied" : "queued") << ":";
+    for (const auto& change : changes) {
+        std::cerr << " " << change.first << "=" << change.second;
+    }
+    std::cerr << std::endl;
+    return json;
+}
+
+std::string ControlServer::statsJson() {
+    std::string json = "{\"ok\":true,\"process\":";
+    appendJsonString(json, process_name_);
+    json += ",\"pid\":" + std::to_string(getpid()) + ",\"stats\":{\"uptime_s\":";
+    appendNumber(json, std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - started_).count());
+
+    PageFaults faults = PageFaults::now();
+    FramePool::Stats pool = FramePool::shared().stats();
+    HeapStats heap = HeapStats::now();
+    json += ",\"rss_bytes\":" + std::to_string(heap.resident) +
+            ",\"heap_bytes\":" + std::to_string(heap.heap) +
+            ",\"heap_in_use_bytes\":" + std::to_string(heap.heap_in_use) +
+            ",\"heap_free_bytes\":" + std::to_string(heap.heap_free) +
+            ",\"minor_faults\":" + std::to_string(faults.minor) +
+            ",\"major_faults\":" + std::to_string(faults.major) +
+            ",\"pool_mapped\":" + std::to_string(pool.mapped) +
+            ",\"pool_reused\":" + std::to_string(pool.reused) +
+            ",\"pool_cached_bytes\":" + std::to_string(pool.cached_bytes);
+
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    for (const auto& counter : stats_) {
+        json += ',';
+        appendJsonString(json, counter.first);
+        json += ':';
+        appendNumber(json, counter.second->load(std::memory_order_relaxed));
+    }
+    return json + "}}";
+}
+
+std::string defaultControlEndpoint(const std::string& process_name) {
+    return "ipc:///tmp/voyis-" + process_name + ".sock";
+}
+
+std::atomic<double>& controlStat(ControlServer* server, const std::string& name) {
+    static std::atomic<double> unused(0.0);
+    return server ? server->stat(name) : unused;
+}
+
+std::unique_ptr<ControlServer> configureControl(const Options& options,
+                                                const std::string& process_name,
+                                                Tunables& tunables) {
+    std::string endpoint = options.getString("control", "true");
+    if (endpoint == "off" || endpoint == "false") {
+        return nullptr;
+    }
+    if (endpoint == "true") {
+        endpoint = defaultControlEndpoint(process_name);
+    }
+    return std::make_unique<ControlServer>(endpoint, process_name, tunables);
+}
+
+} // namespace voyis
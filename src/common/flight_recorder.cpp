@@ -0,0 +1,289 @@
+#include "flight_recorder.h"
+#include "frame_allocator.h"
+#include "json_escape.h"
+#include "options.h"
+#include <unistd.h>
+#include <algorithm>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace voyis {
+
+thread_local FlightFrame* FlightTimer::current_ = nullptr;
+
+namespace {
+
+// Incremented by the SIGUSR1 handler; each recorder's dump thread polls it
+std::atomic<uint64_t> g_dump_signals{0};
+
+void onDumpSignal(int) {
+    g_dump_signals.fetch_add(1, std::memory_order_relaxed);
+}
+
+constexpr std::chrono::milliseconds kSignalPollInterval(100);
+
+int64_t unixMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void appendMs(std::string& out, float ms) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.3f", static_cast<double>(ms));
+    out += text;
+}
+
+void appendFrame(std::string& out, const FlightFrame& frame) {
+    out += "{\"frame\":";
+    appendJsonString(out, frame.frame_id);
+    out += ",\"end_unix_ms\":" + std::to_string(frame.end_unix_ms) + ",\"total_ms\":";
+    appendMs(out, frame.total_ms);
+    if (frame.age_ms >= 0.0f) {
+        out += ",\"age_ms\":";
+        appendMs(out, frame.age_ms);
+    }
+    out += ",\"queue_depth\":" + std::to_string(frame.queue_depth) + ",\"stages\":{";
+    for (uint32_t i = 0; i < frame.stage_count; ++i) {
+        if (i > 0) {
+            out += ',';
+        }
+        appendJsonString(out, frame.stages[i].name);
+        out += ':';
+        appendMs(out, frame.stages[i].ms);
+    }
+    out += "},\"minor_faults\":" + std::to_string(frame.minor_faults) +
+           ",\"pool\":{\"mapped\":" + std::to_string(frame.pool_mapped) +
+           ",\"reused\":" + std::to_string(frame.pool_reused) +
+           ",\"cached_bytes\":" + std::to_string(frame.pool_cached_bytes) + "}}";
+}
+
+} // anonymous namespace
+
+FlightRecorder::FlightRecorder(const std::string& process_name, size_t capacity,
+                               const std::string& dump_dir, double threshold_ms,
+                               std::chrono::milliseconds cooldown)
+    : process_name_(process_name),
+      dump_dir_(dump_dir.empty() ? "." : dump_dir),
+      threshold_ms_(threshold_ms),
+      cooldown_(cooldown) {
+    if (capacity == 0) {
+        throw std::invalid_argument("Flight recorder needs room for at least one frame");
+    }
+    ring_.resize(capacity);
+    signals_seen_ = g_dump_signals.load(std::memory_order_relaxed);
+    dumper_ = std::thread(&FlightRecorder::dumpLoop, this);
+}
+
+FlightRecorder::~FlightRecorder() {
+    {
+        std::lock_guard<std::mutex> lock(dump_mutex_);
+        stopping_ = true;
+    }
+    dump_cv_.notify_all();
+    dumper_.join();
+}
+
+void FlightRecorder::record(const FlightFrame& frame) {
+    bool slow = false;
+    {
+        std::lock_guard<std::mutex> lock(ring_mutex_);
+        ring_[recorded_ % ring_.size()] = frame;
+        ++recorded_;
+
+        if (threshold_ms_ > 0.0 && frame.total_ms > threshold_ms_) {
+            auto now = std::chrono::steady_clock::now();
+            if (!latency_dumped_ || now - last_latency_dump_ >= cooldown_) {
+                latency_dumped_ = true;
+                last_latency_dump_ = now;
+                slow = true;
+            }
+        }
+    }
+
+    if (slow) {
+        requestDump("latency");
+    }
+}
+
+void FlightRecorder::requestDump(const std::string& reason) {
+    {
+        std::lock_guard<std::mutex> lock(dump_mutex_);
+        pending_reasons_.push_back(reason);
+    }
+    dump_cv_.notify_one();
+}
+
+std::vector<FlightFrame> FlightRecorder::snapshot() const {
+    std::lock_guard<std::mutex> lock(ring_mutex_);
+    std::vector<FlightFrame> frames;
+    size_t count = std::min<uint64_t>(recorded_, ring_.size());
+    frames.reserve(count);
+    for (uint64_t i = recorded_ - count; i < recorded_; ++i) {
+        frames.push_back(ring_[i % ring_.size()]);
+    }
+    return frames;
+}
+
+std::string FlightRecorder::dumpNow(const std::string& reason) {
+    std::vector<FlightFrame> frames = snapshot();
+    const int64_t now_ms = unixMs();
+
+    std::string json = "{\"process\":";
+    appendJsonString(json, process_name_);
+    json += ",\"pid\":" + std::to_string(getpid()) + ",\"reason\":";
+    appendJsonString(json, reason);
+    json += ",\"unix_ms\":" + std::to_string(now_ms) + ",\"threshold_ms\":";
+    appendMs(json, static_cast<float>(threshold_ms_));
+    json += ",\"frames\":[";
+    for (size_t i = 0; i < frames.size(); ++i) {
+        json += i == 0 ? "\n" : ",\n";
+        appendFrame(json, frames[i]);
+    }
+    json += "\n]}\n";
+
+    // Written under a temporary name so readers never see a partial dump
+    std::string path = dump_dir_ + "/flight_" + process_name_ + "_" + std::to_string(getpid()) +
+                       "_" + std::to_string(now_ms) + "_" + reason + ".json";
+    std::string temp_path = path + ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::trunc);
+        if (!file || !file.write(json.data(), static_cast<std::streamsize>(json.size()))) {
+            throw std::runtime_error("Failed to write flight recorder dump: " + temp_path);
+        }
+    }
+    if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+        std::remove(temp_path.c_str());
+        throw std::runtime_error("Failed to write flight recorder dump: " + path);
+    }
+
+    std::lock_guard<std::mutex> lock(dump_mutex_);
+    last_dump_path_ = path;
+    dumps_.fetch_add(1, std::memory_order_relaxed);
+    return path;
+}
+
+std::string FlightRecorder::lastDumpPath() const {
+    std::lock_guard<std::mutex> lock(dump_mutex_);
+    return last_dump_path_;
+}
+
+std::string FlightRecorder::describe() const {
+    std::ostringstream out;
+    out << "last " << ring_.size() << " frames";
+    if (threshold_ms_ > 0.0) {
+        out << ", dumped after frames over " << threshold_ms_ << " ms";
+    }
+    out << " and on SIGUSR1 (kill -USR1 " << getpid() << ") to " << dump_dir_;
+    return out.str();
+}
+
+void FlightRecorder::dumpLoop() {
+    std::unique_lock<std::mutex> lock(dump_mutex_);
+    while (true) {
+        dump_cv_.wait_for(lock, kSignalPollInterval,
+                          [this]() { return stopping_ || !pending_reasons_.empty(); });
+
+        uint64_t signals = g_dump_signals.load(std::memory_order_relaxed);
+        if (signals != signals_seen_) {
+            signals_seen_ = signals;
+            pending_reasons_.push_back("signal");
+        }
+        if (pending_reasons_.empty()) {
+            if (stopping_) {
+                break;
+            }
+            continue;
+        }
+
+        std::vector<std::string> reasons;
+        reasons.swap(pending_reasons_);
+        lock.unlock();
+        for (const std::string& reason : reasons) {
+            try {
+                std::string path = dumpNow(reason);
+                std::cerr << "Flight recorder: wrote " << path << std::endl;
+            } catch (const std::exception& e) {
+                std::cerr << "Flight recorder: " << e.what() << std::endl;
+            }
+        }
+        lock.lock();
+    }
+}
+
+void FlightRecorder::installSignalHandler() {
+    std::signal(SIGUSR1, onDumpSignal);
+}
+
+FlightTimer::FlightTimer(FlightRecorder* recorder, const std::string& frame_id,
+                         int64_t capture_unix_ms)
+    : recorder_(recorder), capture_unix_ms_(capture_unix_ms) {
+    if (!recorder_) {
+        return;
+    }
+    setFrameId(frame_id, capture_unix_ms);
+    start_faults_ = PageFaults::now().minor;
+    start_ = std::chrono::steady_clock::now();
+    current_ = &frame_;
+}
+
+void FlightTimer::setFrameId(const std::string& frame_id, int64_t capture_unix_ms) {
+    if (recorder_) {
+        std::strncpy(frame_.frame_id, frame_id.c_str(), sizeof(frame_.frame_id) - 1);
+        capture_unix_ms_ = capture_unix_ms;
+    }
+}
+
+FlightTimer::~FlightTimer() {
+    finish();
+}
+
+void FlightTimer::finish(size_t queue_depth) {
+    if (!recorder_) {
+        return;
+    }
+    if (current_ == &frame_) {
+        current_ = nullptr;
+    }
+
+    frame_.total_ms = std::chrono::duration<float, std::milli>(
+        std::chrono::steady_clock::now() - start_).count();
+    frame_.end_unix_ms = unixMs();
+    if (capture_unix_ms_ > 0) {
+        frame_.age_ms = static_cast<float>(frame_.end_unix_ms - capture_unix_ms_);
+    }
+    frame_.queue_depth = static_cast<uint32_t>(queue_depth);
+    frame_.minor_faults = PageFaults::now().minor - start_faults_;
+
+    FramePool::Stats pool = FramePool::shared().stats();
+    frame_.pool_mapped = pool.mapped;
+    frame_.pool_reused = pool.reused;
+    frame_.pool_cached_bytes = pool.cached_bytes;
+
+    recorder_->record(frame_);
+    recorder_ = nullptr;
+}
+
+std::unique_ptr<FlightRecorder> configureFlightRecorder(const Options& options,
+                                                        const std::string& process_name) {
+    int64_t frames = options.getInt("flight-frames", 256);
+    if (frames <= 0) {
+        return nullptr;
+    }
+    int64_t cooldown_ms = options.getInt("flight-cooldown-ms", 10000);
+    if (cooldown_ms < 0) {
+        throw std::invalid_argument("--flight-cooldown-ms must not be negative");
+    }
+
+    auto recorder = std::make_unique<FlightRecorder>(
+        process_name, static_cast<size_t>(frames), options.getString("flight-dir", "."),
+        options.getDouble("flight-threshold-ms", 0.0), std::chrono::milliseconds(cooldown_ms));
+    FlightRecorder::installSignalHandler();
+    return recorder;
+}
+
+} // namespace voyis
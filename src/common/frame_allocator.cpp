@@ -0,0 +1,278 @@
+#include "frame_allocator.h"
+#include "options.h"
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <malloc.h>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace voyis {
+
+HugePageMode parseHugePageMode(const std::string& name) {
+    if (name == "off") {
+        return HugePageMode::Off;
+    }
+    if (name == "transparent") {
+        return HugePageMode::Transparent;
+    }
+    if (name == "explicit") {
+        return HugePageMode::Explicit;
+    }
+    throw std::invalid_argument("Unknown huge page mode: " + name +
+                                " (expected off, transparent or explicit)");
+}
+
+const char* hugePageModeName(HugePageMode mode) {
+    switch (mode) {
+        case HugePageMode::Off: return "off";
+        case HugePageMode::Transparent: return "transparent";
+        case HugePageMode::Explicit: return "explicit";
+    }
+    return "unknown";
+}
+
+FramePool::FramePool(HugePageMode mode, size_t max_cached_bytes)
+    : mode_(mode), max_cached_bytes_(max_cached_bytes) {}
+
+FramePool::~FramePool() {
+    trim();
+}
+
+FramePool& FramePool::shared() {
+    // Leaked so buffers freed during static destruction still find the pool
+    static FramePool* pool = new FramePool();
+    return *pool;
+}
+
+size_t FramePool::sizeClass(size_t bytes) {
+    size_t pages = bytes == 0 ? 1 : (bytes + kHugePageSize - 1) / kHugePageSize;
+    size_t step = 1;
+    while (step * 8 <= pages) {
+        step *= 2;
+    }
+    return (pages + step - 1) / step * step * kHugePageSize;
+}
+
+void FramePool::setMode(HugePageMode mode) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    mode_ = mode;
+}
+
+HugePageMode FramePool::mode() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return mode_;
+}
+
+void FramePool::setMaxCachedBytes(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    max_cached_bytes_ = bytes;
+
+    // Drop the largest buffers first until the cache fits
+    for (auto it = free_lists_.rbegin(); it != free_lists_.rend() && stats_.cached_bytes > bytes; ++it) {
+        while (!it->second.empty() && stats_.cached_bytes > bytes) {
+            unmap(it->second.back(), it->first);
+            it->second.pop_back();
+            stats_.cached_bytes -= it->first;
+        }
+    }
+}
+
+void* FramePool::allocate(size_t bytes) {
+    size_t size = sizeClass(bytes);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = free_lists_.find(size);
+    if (it != free_lists_.end() && !it->second.empty()) {
+        void* ptr = it->second.back();
+        it->second.pop_back();
+        stats_.cached_bytes -= size;
+        ++stats_.reused;
+        return ptr;
+    }
+    lock.unlock();
+
+    return map(size);
+}
+
+void FramePool::deallocate(void* ptr, size_t bytes) noexcept {
+    if (!ptr) {
+        return;
+    }
+    size_t size = sizeClass(bytes);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (stats_.cached_bytes + size <= max_cached_bytes_) {
+        try {
+            free_lists_[size].push_back(ptr);
+            stats_.cached_bytes += size;
+            return;
+        } catch (const std::bad_alloc&) {
+            // Unmap below
+        }
+    }
+    lock.unlock();
+
+    unmap(ptr, size);
+}
+
+void FramePool::prefault(size_t bytes, size_t count) {
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t size = sizeClass(bytes);
+
+    std::vector<void*> buffers;
+    buffers.reserve(count);
+    try {
+        for (size_t i = 0; i < count; ++i) {
+            buffers.push_back(allocate(size));
+            volatile uint8_t* bytes_ptr = static_cast<volatile uint8_t*>(buffers.back());
+            for (size_t offset = 0; offset < size; offset += page) {
+                bytes_ptr[offset] = 0;
+            }
+        }
+    } catch (...) {
+        for (void* ptr : buffers) {
+            deallocate(ptr, size);
+        }
+        throw;
+    }
+
+    for (void* ptr : buffers) {
+        deallocate(ptr, size);
+    }
+}
+
+void FramePool::trim() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& entry : free_lists_) {
+        for (void* ptr : entry.second) {
+            unmap(ptr, entry.first);
+        }
+    }
+    free_lists_.clear();
+    stats_.cached_bytes = 0;
+}
+
+FramePool::Stats FramePool::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void* FramePool::map(size_t size) {
+    HugePageMode mode = this->mode();
+
+#ifdef MAP_HUGETLB
+    // Reserved huge pages are taken at map time, so a failure here is a clean fallback
+    if (mode == HugePageMode::Explicit) {
+        void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (ptr != MAP_FAILED) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++stats_.mapped;
+            ++stats_.explicit_huge;
+            return ptr;
+        }
+    }
+#endif
+
+    // Over-map by one huge page and trim, so the buffer starts on a 2 MB boundary
+    // where transparent huge pages can back it from the first byte
+    size_t padded = size + kHugePageSize;
+    void* raw = mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+
+    uintptr_t start = reinterpret_cast<uintptr_t>(raw);
+    uintptr_t aligned = (start + kHugePageSize - 1) & ~(static_cast<uintptr_t>(kHugePageSize) - 1);
+    size_t head = aligned - start;
+    size_t tail = padded - head - size;
+    if (head > 0) {
+        munmap(raw, head);
+    }
+    if (tail > 0) {
+        munmap(reinterpret_cast<void*>(aligned + size), tail);
+    }
+
+    void* ptr = reinterpret_cast<void*>(aligned);
+#ifdef MADV_HUGEPAGE
+    if (mode != HugePageMode::Off) {
+        madvise(ptr, size, MADV_HUGEPAGE); // Advisory; THP may be disabled system-wide
+    }
+#endif
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.mapped;
+    return ptr;
+}
+
+void FramePool::unmap(void* ptr, size_t size) noexcept {
+    munmap(ptr, size);
+}
+
+PageFaults PageFaults::now() {
+    PageFaults faults;
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        faults.minor = usage.ru_minflt;
+        faults.major = usage.ru_majflt;
+    }
+    return faults;
+}
+
+HeapStats HeapStats::now() {
+    HeapStats stats;
+    std::ifstream statm("/proc/self/statm");
+    int64_t size_pages = 0;
+    int64_t resident_pages = 0;
+    if (statm >> size_pages >> resident_pages) {
+        stats.resident = resident_pages * static_cast<int64_t>(sysconf(_SC_PAGESIZE));
+    }
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+    stats.heap = static_cast<int64_t>(info.arena + info.hblkhd);
+    stats.heap_in_use = static_cast<int64_t>(info.uordblks + info.hblkhd);
+    stats.heap_free = static_cast<int64_t>(info.fordblks);
+#endif
+    return stats;
+}
+
+void configureFramePool(const Options& options, size_t default_prefault_bytes) {
+    FramePool& pool = FramePool::shared();
+    pool.setMode(parseHugePageMode(options.getString("huge-pages", "transparent")));
+
+    size_t prefault_bytes = default_prefault_bytes;
+    if (options.has("prefault-mb")) {
+        prefault_bytes = static_cast<size_t>(options.getDouble("prefault-mb") * 1024 * 1024);
+    }
+    int64_t count = options.getInt("prefault-frames", 2);
+    if (prefault_bytes < FramePool::kMinPooledBytes || count <= 0) {
+        return;
+    }
+    pool.prefault(prefault_bytes, static_cast<size_t>(count));
+
+    // Serialized messages carry headers and features on top of the image
+    size_t message_bytes = prefault_bytes + FramePool::kMinPooledBytes;
+    if (FramePool::sizeClass(message_bytes) != FramePool::sizeClass(prefault_bytes)) {
+        pool.prefault(message_bytes, static_cast<size_t>(count));
+    }
+}
+
+std::string frameMemoryReport(const PageFaults& faults, size_t frames) {
+    FramePool::Stats stats = FramePool::shared().stats();
+    std::ostringstream out;
+    out << "Page faults: " << faults.minor << " minor, " << faults.major << " major";
+    if (frames > 0) {
+        out << " (" << static_cast<double>(faults.minor + faults.major) / frames << " per frame)";
+    }
+    out << "; frame pool: " << stats.mapped << " mapped, " << stats.reused << " reused";
+    if (stats.explicit_huge > 0) {
+        out << ", " << stats.explicit_huge << " on reserved huge pages";
+    }
+    return out.str();
+}
+
+} // namespace voyis
@@ -1,10 +1,12 @@
 #include "ipc.h"
+#include "tracepoints.h"
 #include <zmq.h>
 #include <stdexcept>
 #include <cstring>
 #include <iostream>
 #include <thread>
 #include <chrono>
+#include <deque>
 
 namespace voyis {
 
@@ -55,13 +57,130 @@ Publisher::~Publisher() {
     }
 }
 
+namespace {
+
+// ZeroMQ free callback for zero-copy sends; may run on ZeroMQ's I/O thread
+void releaseFrameBuffer(void* /*data*/, void* hint) {
+    delete static_cast<FrameBuffer*>(hint);
+}
+
+void releaseOwner(void* /*data*/, void* hint) {
+    delete static_cast<std::shared_ptr<const void>*>(hint);
+}
+
+// Message that owns a pooled buffer from here on
+bool initOwnedMessage(zmq_msg_t* msg, FrameBuffer&& data) {
+    if (data.empty()) {
+        return zmq_msg_init(msg) == 0;
+    }
+    FrameBuffer* owned = new FrameBuffer(std::move(data));
+    if (zmq_msg_init_data(msg, owned->data(), owned->size(), releaseFrameBuffer, owned) != 0) {
+        delete owned;
+        return false;
+    }
+    return true;
+}
+
+// Message pointing into memory kept alive by owner
+bool initSharedMessage(zmq_msg_t* msg, const uint8_t* data, size_t size,
+                       const std::shared_ptr<const void>& owner) {
+    if (size == 0) {
+        return zmq_msg_init(msg) == 0;
+    }
+    auto* hint = new std::shared_ptr<const void>(owner);
+    if (zmq_msg_init_data(msg, const_cast<uint8_t*>(data), size, releaseOwner, hint) != 0) {
+        delete hint;
+        return false;
+    }
+    return true;
+}
+
+} // anonymous namespace
+
 bool Publisher::publish(const std::vector<uint8_t>& data) {
+    VOYIS_TRACE1(publish_start, data.size());
+    bool ok = send(data.data(), data.size(), ZMQ_DONTWAIT);
+    VOYIS_TRACE2(publish_done, data.size(), ok ? 1 : 0);
+    return ok;
+}
+
+bool Publisher::publish(FrameBuffer&& data) {
+    const size_t size = data.size();
+    VOYIS_TRACE1(publish_start, size);
+    bool ok = publishOwned(std::move(data));
+    VOYIS_TRACE2(publish_done, size, ok ? 1 : 0);
+    return ok;
+}
+
+bool Publisher::publishOwned(FrameBuffer&& data) {
+    if (!connected_) {
+        return false;
+    }
+    if (data.empty()) {
+        return send(nullptr, 0, ZMQ_DONTWAIT);
+    }
+
+    // The message owns the buffer from here on
+    zmq_msg_t msg;
+    if (!initOwnedMessage(&msg, std::move(data))) {
+        return false;
+    }
+
+    if (zmq_msg_send(&msg, socket_, ZMQ_DONTWAIT) == -1) {
+        int error = errno;
+        zmq_msg_close(&msg); // Releases the buffer
+        reportSendError(error);
+        return false;
+    }
+
+    return true;
+}
+
+bool Publisher::publish(FrameBuffer&& head, const uint8_t* payload, size_t size,
+                        std::shared_ptr<const void> owner, FrameBuffer&& tail) {
+    const size_t total = head.size() + size + tail.size();
+    VOYIS_TRACE1(publish_start, total);
+    zmq_msg_t parts[3];
+    bool ok = connected_ && initOwnedMessage(&parts[0], std::move(head));
+    if (ok && !initSharedMessage(&parts[1], payload, size, owner)) {
+        zmq_msg_close(&parts[0]);
+        ok = false;
+    }
+    if (ok && !initOwnedMessage(&parts[2], std::move(tail))) {
+        zmq_msg_close(&parts[0]);
+        zmq_msg_close(&parts[1]);
+        ok = false;
+    }
+
+    // Once the first part is queued, ZeroMQ accepts the rest of the message
+    for (int i = 0; ok && i < 3; ++i) {
+        if (zmq_msg_send(&parts[i], socket_, i < 2 ? ZMQ_SNDMORE | ZMQ_DONTWAIT : ZMQ_DONTWAIT) == -1) {
+            int error = errno;
+            for (int j = i; j < 3; ++j) {
+                zmq_msg_close(&parts[j]);
+            }
+            reportSendError(error);
+            ok = false;
+        }
+    }
+    VOYIS_TRACE2(publish_done, total, ok ? 1 : 0);
+    return ok;
+}
+
+void Publisher::reportSendError(int error) {
+    if (error != EAGAIN) {
+        std::cerr << "Error publishing message: " << zmq_strerror(error) << std::endl;
+    }
+    errno = error;
+}
+
+bool Publisher::send(const void* data, size_t size, int flags) {
     if (!connected_) {
         return false;
     }
 
     // Send message
-    int rc = zmq_send(socket_, data.data(), data.size(), ZMQ_DONTWAIT);
+    int rc = zmq_send(socket_, data, size, flags);
     if (rc == -1) {
         if (errno == EAGAIN) {
             // Would block, queue is full
@@ -129,7 +248,8 @@ Subscriber::~Subscriber() {
     }
 }
 
-bool Subscriber::receive(std::vector<uint8_t>& data) {
+template <typename Buffer>
+bool Subscriber::receiveMessage(Buffer& data, int flags) {
     if (!connected_) {
         return false;
     }
@@ -140,9 +260,11 @@ bool Subscriber::receive(std::vector<uint8_t>& data) {
     }
 
     // Receive message
-    int rc = zmq_msg_recv(&msg, socket_, 0);
+    int rc = zmq_msg_recv(&msg, socket_, flags);
     if (rc == -1) {
+        int error = errno;
         zmq_msg_close(&msg);
+        errno = error; // Callers tell timeouts from failures by errno
         if (errno == EAGAIN || errno == EINTR) {
             // Timeout or interrupted
             return false;
@@ -153,10 +275,61 @@ bool Subscriber::receive(std::vector<uint8_t>& data) {
 
     // Copy message data
     size_t size = zmq_msg_size(&msg);
-    data.resize(size);
-    std::memcpy(data.data(), zmq_msg_data(&msg), size);
+    if (!zmq_msg_more(&msg)) {
+        data.resize(size);
+        if (size > 0) {
+            std::memcpy(data.data(), zmq_msg_data(&msg), size);
+        }
+        zmq_msg_close(&msg);
+        return true;
+    }
 
+    // Multipart message: the remaining parts have already arrived; join them with one copy each
+    std::deque<zmq_msg_t> parts(1);
+    zmq_msg_init(&parts.front());
+    zmq_msg_move(&parts.front(), &msg);
     zmq_msg_close(&msg);
+    while (zmq_msg_more(&parts.back())) {
+        parts.emplace_back();
+        zmq_msg_init(&parts.back());
+        if (zmq_msg_recv(&parts.back(), socket_, 0) == -1) {
+            int error = errno;
+            for (zmq_msg_t& part : parts) {
+                zmq_msg_close(&part);
+            }
+            errno = error;
+            std::cerr << "Error receiving message part: " << zmq_strerror(errno) << std::endl;
+            return false;
+        }
+        size += zmq_msg_size(&parts.back());
+    }
+
+    data.resize(size);
+    size_t offset = 0;
+    for (zmq_msg_t& part : parts) {
+        size_t part_size = zmq_msg_size(&part);
+        if (part_size > 0) {
+            std::memcpy(data.data() + offset, zmq_msg_data(&part), part_size);
+        }
+        offset += part_size;
+        zmq_msg_close(&part);
+    }
+    return true;
+}
+
+bool Subscriber::receive(std::vector<uint8_t>& data) {
+    if (!receiveMessage(data, 0)) {
+        return false;
+    }
+    VOYIS_TRACE1(receive, data.size());
+    return true;
+}
+
+bool Subscriber::receive(FrameBuffer& data) {
+    if (!receiveMessage(data, 0)) {
+        return false;
+    }
+    VOYIS_TRACE1(receive, data.size());
     return true;
 }
 
@@ -167,4 +340,188 @@ void Subscriber::setTimeout(int timeout_ms) {
     }
 }
 
+namespace {
+
+// Receive one whole message; false on timeout (EAGAIN) or error
+bool receiveInto(void* socket, std::vector<uint8_t>& data) {
+    zmq_msg_t msg;
+    if (zmq_msg_init(&msg) != 0) {
+        return false;
+    }
+    if (zmq_msg_recv(&msg, socket, 0) == -1) {
+        int error = errno;
+        zmq_msg_close(&msg);
+        errno = error;
+        return false;
+    }
+    const uint8_t* bytes = static_cast<const uint8_t*>(zmq_msg_data(&msg));
+    data.assign(bytes, bytes + zmq_msg_size(&msg));
+    zmq_msg_close(&msg);
+    return true;
+}
+
+} // anonymous namespace
+
+// Replier implementation
+Replier::Replier(const std::string& endpoint, int timeout_ms)
+    : context_(nullptr), socket_(nullptr), endpoint_(endpoint) {
+
+    context_ = zmq_ctx_new();
+    if (!context_) {
+        throw std::runtime_error("Failed to create ZeroMQ context");
+    }
+
+    socket_ = zmq_socket(context_, ZMQ_REP);
+    if (!socket_) {
+        zmq_ctx_destroy(context_);
+        throw std::runtime_error("Failed to create ZeroMQ socket");
+    }
+
+    int linger = 0;
+    zmq_setsockopt(socket_, ZMQ_LINGER, &linger, sizeof(linger));
+    zmq_setsockopt(socket_, ZMQ_RCVTIMEO, &timeout_ms, sizeof(timeout_ms));
+
+    if (zmq_bind(socket_, endpoint_.c_str()) != 0) {
+        zmq_close(socket_);
+        zmq_ctx_destroy(context_);
+        throw std::runtime_error("Failed to bind to endpoint: " + endpoint_);
+    }
+}
+
+Replier::~Replier() {
+    if (socket_) {
+        zmq_close(socket_);
+    }
+    if (context_) {
+        zmq_ctx_destroy(context_);
+    }
+}
+
+bool Replier::receive(std::vector<uint8_t>& request) {
+    if (receiveInto(socket_, request)) {
+        return true;
+    }
+    if (errno != EAGAIN && errno != EINTR) {
+        std::cerr << "Error receiving request: " << zmq_strerror(errno) << std::endl;
+    }
+    return false;
+}
+
+bool Replier::reply(const std::vector<uint8_t>& data) {
+    if (zmq_send(socket_, data.data(), data.size(), 0) == -1) {
+        std::cerr << "Error sending reply: " << zmq_strerror(errno) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Requester implementation
+Requester::Requester(const std::string& endpoint, int timeout_ms)
+    : context_(nullptr), socket_(nullptr), endpoint_(endpoint) {
+
+    context_ = zmq_ctx_new();
+    if (!context_) {
+        throw std::runtime_error("Failed to create ZeroMQ context");
+    }
+
+    socket_ = zmq_socket(context_, ZMQ_REQ);
+    if (!socket_) {
+        zmq_ctx_destroy(context_);
+        throw std::runtime_error("Failed to create ZeroMQ socket");
+    }
+
+    int linger = 0;
+    zmq_setsockopt(socket_, ZMQ_LINGER, &linger, sizeof(linger));
+    zmq_setsockopt(socket_, ZMQ_RCVTIMEO, &timeout_ms, sizeof(timeout_ms));
+    zmq_setsockopt(socket_, ZMQ_SNDTIMEO, &timeout_ms, sizeof(timeout_ms));
+
+    // Allow a new request after a timed-out one, ignoring its late reply
+    int enable = 1;
+    zmq_setsockopt(socket_, ZMQ_REQ_RELAXED, &enable, sizeof(enable));
+    zmq_setsockopt(socket_, ZMQ_REQ_CORRELATE, &enable, sizeof(enable));
+
+    if (zmq_connect(socket_, endpoint_.c_str()) != 0) {
+        zmq_close(socket_);
+        zmq_ctx_destroy(context_);
+        throw std::runtime_error("Failed to connect to endpoint: " + endpoint_);
+    }
+}
+
+Requester::~Requester() {
+    if (socket_) {
+        zmq_close(socket_);
+    }
+    if (context_) {
+        zmq_ctx_destroy(context_);
+    }
+}
+
+bool Requester::request(const std::vector<uint8_t>& data, std::vector<uint8_t>& reply) {
+    if (zmq_send(socket_, data.data(), data.size(), 0) == -1) {
+        return false;
+    }
+    return receiveInto(socket_, reply);
+}
+
+// ReplyServer implementation
+namespace {
+
+// How often the server thread checks for shutdown
+constexpr int kReplyServerTimeoutMs = 200;
+
+} // anonymous namespace
+
+ReplyServer::ReplyServer(const std::string& endpoint, Handler handler)
+    : replier_(endpoint, kReplyServerTimeoutMs), handler_(std::move(handler)) {
+    server_ = std::thread(&ReplyServer::serve, this);
+}
+
+ReplyServer::~ReplyServer() {
+    stopping_ = true;
+    server_.join();
+}
+
+void ReplyServer::serve() {
+    std::vector<uint8_t> request;
+    while (!stopping_) {
+        if (replier_.receive(request)) {
+            replier_.reply(handler_(request));
+        }
+    }
+}
+
+#ifdef VOYIS_HAVE_COROUTINES
+Task<bool> Publisher::async_publish(Reactor& reactor, std::vector<uint8_t> data, int timeout_ms) {
+    const int64_t deadline = Reactor::deadline(timeout_ms);
+    for (;;) {
+        if (send(data.data(), data.size(), ZMQ_DONTWAIT)) {
+            co_return true;
+        }
+        if (!connected_ || (errno != EAGAIN && errno != EINTR)) {
+            co_return false;
+        }
+        // Send queue is full: yield the reactor until it drains
+        if (co_await reactor.wait(socket_, ZMQ_POLLOUT, deadline) != IoStatus::Ready) {
+            co_return false;
+        }
+    }
+}
+
+Task<std::optional<std::vector<uint8_t>>> Subscriber::async_receive(Reactor& reactor, int timeout_ms) {
+    const int64_t deadline = Reactor::deadline(timeout_ms);
+    std::vector<uint8_t> data;
+    for (;;) {
+        if (receiveMessage(data, ZMQ_DONTWAIT)) {
+            co_return data;
+        }
+        if (!connected_ || (errno != EAGAIN && errno != EINTR)) {
+            co_return std::nullopt;
+        }
+        if (co_await reactor.wait(socket_, ZMQ_POLLIN, deadline) != IoStatus::Ready) {
+            co_return std::nullopt;
+        }
+    }
+}
+#endif
+
 } // namespace voyis
@@ -1,182 +1,134 @@
 #include "message.h"
 #include <cstring>
+#include <limits>
 #include <stdexcept>
+#include <type_traits>
 
 namespace voyis {
 
-// Helper functions for serialization
-namespace {
+int rawBytesPerPixel(const std::string& format) {
+    static const char* const kRaw8[] = {
+        "mono8", "bayer_rggb8", "bayer_bggr8", "bayer_gbrg8", "bayer_grbg8"
+    };
+    static const char* const kRaw16[] = {
+        "mono16", "bayer_rggb16", "bayer_bggr16", "bayer_gbrg16", "bayer_grbg16"
+    };
+
+    for (const char* name : kRaw8) {
+        if (format == name) {
+            return 1;
+        }
+    }
+    for (const char* name : kRaw16) {
+        if (format == name) {
+            return 2;
+        }
+    }
+    return 0;
+}
 
-// Write a value to a byte vector
-template<typename T>
-void writeValue(std::vector<uint8_t>& buffer, const T& value) {
-    const uint8_t* data = reinterpret_cast<const uint8_t*>(&value);
-    buffer.insert(buffer.end(), data, data + sizeof(T));
+// Serialization is generated from each message's fields() list (see message_schema.h)
+
+std::vector<uint8_t> ImageMessage::serialize() const {
+    return schema::serialize(*this);
 }
 
-// Write a string to a byte vector (length-prefixed)
-void writeString(std::vector<uint8_t>& buffer, const std::string& str) {
-    uint32_t length = static_cast<uint32_t>(str.size());
-    writeValue(buffer, length);
-    buffer.insert(buffer.end(), str.begin(), str.end());
+ImageMessage ImageMessage::deserialize(const std::vector<uint8_t>& data) {
+    return schema::deserialize<ImageMessage>(data.data(), data.size());
 }
 
-// Write a byte vector to another byte vector (length-prefixed)
-void writeBytes(std::vector<uint8_t>& buffer, const std::vector<uint8_t>& bytes) {
-    uint32_t length = static_cast<uint32_t>(bytes.size());
-    writeValue(buffer, length);
-    buffer.insert(buffer.end(), bytes.begin(), bytes.end());
+FrameBuffer ImageMessage::serializeFrame() const {
+    return schema::serialize<FrameBuffer>(*this);
 }
 
-// Read a value from a byte vector
-template<typename T>
-T readValue(const uint8_t*& data, size_t& remaining) {
-    if (remaining < sizeof(T)) {
-        throw std::runtime_error("Insufficient data to read value");
+FrameParts ImageMessage::serializeParts(size_t image_size) const {
+    if (!image_data.empty()) {
+        throw std::logic_error("serializeParts needs a message without image_data");
     }
-    T value;
-    std::memcpy(&value, data, sizeof(T));
-    data += sizeof(T);
-    remaining -= sizeof(T);
-    return value;
-}
-
-// Read a string from a byte vector (length-prefixed)
-std::string readString(const uint8_t*& data, size_t& remaining) {
-    uint32_t length = readValue<uint32_t>(data, remaining);
-    if (remaining < length) {
-        throw std::runtime_error("Insufficient data to read string");
+    if (image_size > std::numeric_limits<uint32_t>::max()) {
+        throw std::logic_error("Image too large for one message");
     }
-    std::string str(reinterpret_cast<const char*>(data), length);
-    data += length;
-    remaining -= length;
-    return str;
+
+    // Bytes of the fields before image_data, plus its length prefix
+    size_t split = 0;
+    bool reached = false;
+    schema::forEachField(fields(), [&](const auto& f) {
+        if constexpr (std::is_same_v<decltype(f.member), FrameBuffer ImageMessage::*>) {
+            reached = reached || f.member == &ImageMessage::image_data;
+        }
+        if (!reached) {
+            split += schema::encodedSize(this->*(f.member));
+        }
+    });
+    split += sizeof(uint32_t);
+
+    FrameBuffer whole = serializeFrame();
+    FrameParts parts;
+    parts.head.assign(whole.begin(), whole.begin() + static_cast<std::ptrdiff_t>(split));
+    parts.tail.assign(whole.begin() + static_cast<std::ptrdiff_t>(split), whole.end());
+    uint32_t length = static_cast<uint32_t>(image_size);
+    std::memcpy(parts.head.data() + split - sizeof(length), &length, sizeof(length));
+    return parts;
 }
 
-// Read a byte vector from another byte vector (length-prefixed)
-std::vector<uint8_t> readBytes(const uint8_t*& data, size_t& remaining) {
-    uint32_t length = readValue<uint32_t>(data, remaining);
-    if (remaining < length) {
-        throw std::runtime_error("Insufficient data to read bytes");
-    }
-    std::vector<uint8_t> bytes(data, data + length);
-    data += length;
-    remaining -= length;
-    return bytes;
+ImageMessage ImageMessage::deserialize(const FrameBuffer& data) {
+    return schema::deserialize<ImageMessage>(data.data(), data.size());
 }
 
-} // anonymous namespace
+std::vector<uint8_t> ProcessedImageMessage::serialize() const {
+    return schema::serialize(*this);
+}
 
-// ImageMessage serialization
-std::vector<uint8_t> ImageMessage::serialize() const {
-    std::vector<uint8_t> buffer;
-    buffer.reserve(image_data.size() + 1024); // Estimate size
+ProcessedImageMessage ProcessedImageMessage::deserialize(const std::vector<uint8_t>& data) {
+    return schema::deserialize<ProcessedImageMessage>(data.data(), data.size());
+}
 
-    writeString(buffer, image_id);
-    writeBytes(buffer, image_data);
-    writeString(buffer, format);
-    writeValue(buffer, width);
-    writeValue(buffer, height);
-    writeValue(buffer, timestamp);
+FrameBuffer ProcessedImageMessage::serializeFrame() const {
+    return schema::serialize<FrameBuffer>(*this);
+}
 
-    return buffer;
+ProcessedImageMessage ProcessedImageMessage::deserialize(const FrameBuffer& data) {
+    return schema::deserialize<ProcessedImageMessage>(data.data(), data.size());
 }
 
-ImageMessage ImageMessage::deserialize(const std::vector<uint8_t>& data) {
-    const uint8_t* ptr = data.data();
-    size_t remaining = data.size();
+std::vector<uint8_t> DescriptorRequest::serialize() const {
+    return schema::serialize(*this);
+}
 
-    ImageMessage msg;
-    msg.image_id = readString(ptr, remaining);
-    msg.image_data = readBytes(ptr, remaining);
-    msg.format = readString(ptr, remaining);
-    msg.width = readValue<int>(ptr, remaining);
-    msg.height = readValue<int>(ptr, remaining);
-    msg.timestamp = readValue<int64_t>(ptr, remaining);
+DescriptorRequest DescriptorRequest::deserialize(const std::vector<uint8_t>& data) {
+    return schema::deserialize<DescriptorRequest>(data.data(), data.size());
+}
 
-    return msg;
+std::vector<uint8_t> DescriptorReply::serialize() const {
+    return schema::serialize(*this);
 }
 
-// ProcessedImageMessage serialization
-std::vector<uint8_t> ProcessedImageMessage::serialize() const {
-    std::vector<uint8_t> buffer;
-    buffer.reserve(image_data.size() + keypoints.size() * 64 + 1024);
-
-    writeString(buffer, image_id);
-    writeBytes(buffer, image_data);
-    writeString(buffer, format);
-    writeValue(buffer, width);
-    writeValue(buffer, height);
-    writeValue(buffer, timestamp);
-    writeValue(buffer, processed_timestamp);
-
-    // Write keypoints
-    uint32_t num_keypoints = static_cast<uint32_t>(keypoints.size());
-    writeValue(buffer, num_keypoints);
-    for (const auto& kp : keypoints) {
-        writeValue(buffer, kp.pt.x);
-        writeValue(buffer, kp.pt.y);
-        writeValue(buffer, kp.size);
-        writeValue(buffer, kp.angle);
-        writeValue(buffer, kp.response);
-        writeValue(buffer, kp.octave);
-    }
+DescriptorReply DescriptorReply::deserialize(const std::vector<uint8_t>& data) {
+    return schema::deserialize<DescriptorReply>(data.data(), data.size());
+}
 
-    // Write descriptors
-    uint32_t num_descriptors = static_cast<uint32_t>(descriptors.size());
-    writeValue(buffer, num_descriptors);
-    for (const auto& desc : descriptors) {
-        uint32_t desc_size = static_cast<uint32_t>(desc.size());
-        writeValue(buffer, desc_size);
-        for (float val : desc) {
-            writeValue(buffer, val);
-        }
-    }
+std::vector<uint8_t> FrameQuery::serialize() const {
+    return schema::serialize(*this);
+}
 
-    return buffer;
+FrameQuery FrameQuery::deserialize(const std::vector<uint8_t>& data) {
+    return schema::deserialize<FrameQuery>(data.data(), data.size());
 }
 
-ProcessedImageMessage ProcessedImageMessage::deserialize(const std::vector<uint8_t>& data) {
-    const uint8_t* ptr = data.data();
-    size_t remaining = data.size();
-
-    ProcessedImageMessage msg;
-    msg.image_id = readString(ptr, remaining);
-    msg.image_data = readBytes(ptr, remaining);
-    msg.format = readString(ptr, remaining);
-    msg.width = readValue<int>(ptr, remaining);
-    msg.height = readValue<int>(ptr, remaining);
-    msg.timestamp = readValue<int64_t>(ptr, remaining);
-    msg.processed_timestamp = readValue<int64_t>(ptr, remaining);
-
-    // Read keypoints
-    uint32_t num_keypoints = readValue<uint32_t>(ptr, remaining);
-    msg.keypoints.reserve(num_keypoints);
-    for (uint32_t i = 0; i < num_keypoints; ++i) {
-        KeyPoint kp;
-        kp.pt.x = readValue<float>(ptr, remaining);
-        kp.pt.y = readValue<float>(ptr, remaining);
-        kp.size = readValue<float>(ptr, remaining);
-        kp.angle = readValue<float>(ptr, remaining);
-        kp.response = readValue<float>(ptr, remaining);
-        kp.octave = readValue<int>(ptr, remaining);
-        msg.keypoints.push_back(kp);
-    }
+std::vector<uint8_t> FrameQueryReply::serialize() const {
+    return schema::serialize(*this);
+}
 
-    // Read descriptors
-    uint32_t num_descriptors = readValue<uint32_t>(ptr, remaining);
-    msg.descriptors.reserve(num_descriptors);
-    for (uint32_t i = 0; i < num_descriptors; ++i) {
-        uint32_t desc_size = readValue<uint32_t>(ptr, remaining);
-        std::vector<float> desc;
-        desc.reserve(desc_size);
-        for (uint32_t j = 0; j < desc_size; ++j) {
-            desc.push_back(readValue<float>(ptr, remaining));
-        }
-        msg.descriptors.push_back(desc);
-    }
+FrameQueryReply FrameQueryReply::deserialize(const std::vector<uint8_t>& data) {
+    return schema::deserialize<FrameQueryReply>(data.data(), data.size());
+}
+
+std::vector<uint8_t> MatchSetMessage::serialize() const {
+    return schema::serialize(*this);
+}
 
-    return msg;
+MatchSetMessage MatchSetMessage::deserialize(const std::vector<uint8_t>& data) {
+    return schema::deserialize<MatchSetMessage>(data.data(), data.size());
 }
 
 } // namespace voyis
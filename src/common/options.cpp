@@ -0,0 +1,138 @@
+#include "options.h"
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+namespace voyis {
+
+Options::Options(int argc, char* argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg.size() > 2 && arg.compare(0, 2, "--") == 0) {
+            size_t eq = arg.find('=');
+            if (eq == std::string::npos) {
+                values_[arg.substr(2)] = "true";
+            } else {
+                values_[arg.substr(2, eq - 2)] = arg.substr(eq + 1);
+            }
+        } else {
+            positional_.push_back(arg);
+        }
+    }
+}
+
+bool Options::has(const std::string& name) const {
+    return values_.count(name) > 0;
+}
+
+std::string Options::getString(const std::string& name, const std::string& def) const {
+    auto it = values_.find(name);
+    return it == values_.end() ? def : it->second;
+}
+
+namespace {
+
+int64_t parseInt(const std::string& name, const std::string& text) {
+    size_t pos = 0;
+    int64_t value = 0;
+    try {
+        value = std::stoll(text, &pos);
+    } catch (const std::exception&) {
+        pos = 0;
+    }
+    if (pos == 0 || pos != text.size()) {
+        throw std::invalid_argument("Invalid integer for --" + name + ": " + text);
+    }
+    return value;
+}
+
+double parseDouble(const std::string& name, const std::string& text) {
+    size_t pos = 0;
+    double value = 0.0;
+    try {
+        value = std::stod(text, &pos);
+    } catch (const std::exception&) {
+        pos = 0;
+    }
+    if (pos == 0 || pos != text.size()) {
+        throw std::invalid_argument("Invalid number for --" + name + ": " + text);
+    }
+    return value;
+}
+
+} // anonymous namespace
+
+int64_t Options::getInt(const std::string& name, int64_t def) const {
+    auto it = values_.find(name);
+    return it == values_.end() ? def : parseInt(name, it->second);
+}
+
+double Options::getDouble(const std::string& name, double def) const {
+    auto it = values_.find(name);
+    return it == values_.end() ? def : parseDouble(name, it->second);
+}
+
+bool Options::getBool(const std::string& name, bool def) const {
+    auto it = values_.find(name);
+    if (it == values_.end()) {
+        return def;
+    }
+
+    std::string value = it->second;
+    std::transform(value.begin(), value.end(), value.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    return value == "true" || value == "1" || value == "yes" || value == "on";
+}
+
+std::vector<std::string> Options::getList(const std::string& name) const {
+    std::vector<std::string> items;
+    auto it = values_.find(name);
+    if (it == values_.end()) {
+        return items;
+    }
+
+    size_t start = 0;
+    const std::string& value = it->second;
+    while (start <= value.size()) {
+        size_t comma = value.find(',', start);
+        if (comma == std::string::npos) {
+            comma = value.size();
+        }
+        if (comma > start) {
+            items.push_back(value.substr(start, comma - start));
+        }
+        start = comma + 1;
+    }
+    return items;
+}
+
+std::map<std::string, std::string> Options::getMap(const std::string& name) const {
+    std::map<std::string, std::string> entries;
+    for (const auto& item : getList(name)) {
+        size_t colon = item.rfind(':');
+        if (colon == std::string::npos) {
+            throw std::invalid_argument("Expected key:value in --" + name + ": " + item);
+        }
+        entries[item.substr(0, colon)] = item.substr(colon + 1);
+    }
+    return entries;
+}
+
+std::map<std::string, int64_t> Options::getIntMap(const std::string& name) const {
+    std::map<std::string, int64_t> entries;
+    for (const auto& entry : getMap(name)) {
+        entries[entry.first] = parseInt(name, entry.second);
+    }
+    return entries;
+}
+
+std::map<std::string, double> Options::getDoubleMap(const std::string& name) const {
+    std::map<std::string, double> entries;
+    for (const auto& entry : getMap(name)) {
+        entries[entry.first] = parseDouble(name, entry.second);
+    }
+    return entries;
+}
+
+} // namespace voyis
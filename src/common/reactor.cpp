@@ -0,0 +1,186 @@
+#include "reactor.h"
+#include <zmq.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace voyis {
+
+namespace {
+
+/**
+ * @brief Fire-and-forget coroutine that owns a spawned task until it finishes
+ */
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+Detached drive(Task<void> task, size_t& active_tasks) {
+    try {
+        co_await task;
+    } catch (const std::exception& e) {
+        std::cerr << "Reactor task failed: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "Reactor task failed" << std::endl;
+    }
+    --active_tasks;
+}
+
+} // anonymous namespace
+
+bool IoWait::await_suspend(std::coroutine_handle<> handle) {
+    if (reactor_.stopping()) {
+        status_ = IoStatus::Cancelled;
+        return false;
+    }
+    // A message may have arrived since the caller's last non-blocking attempt
+    if (socket_ && Reactor::socketReady(socket_, events_)) {
+        status_ = IoStatus::Ready;
+        return false;
+    }
+    handle_ = handle;
+    reactor_.add(this);
+    return true;
+}
+
+Reactor::Reactor() : epoll_fd_(-1), wake_fd_(-1) {
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+        throw std::runtime_error("Failed to create epoll instance: " + std::string(std::strerror(errno)));
+    }
+
+    wake_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wake_fd_ < 0) {
+        close(epoll_fd_);
+        throw std::runtime_error("Failed to create eventfd: " + std::string(std::strerror(errno)));
+    }
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = wake_fd_;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &event);
+}
+
+Reactor::~Reactor() {
+    close(wake_fd_);
+    close(epoll_fd_);
+}
+
+int64_t Reactor::now() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+bool Reactor::socketReady(void* socket, short events) {
+    int ready = 0;
+    size_t size = sizeof(ready);
+    if (zmq_getsockopt(socket, ZMQ_EVENTS, &ready, &size) != 0) {
+        return false;
+    }
+    return (ready & events) != 0;
+}
+
+void Reactor::add(IoWait* waiter) {
+    if (waiter->socket_) {
+        int fd = -1;
+        size_t size = sizeof(fd);
+        if (zmq_getsockopt(waiter->socket_, ZMQ_FD, &fd, &size) != 0) {
+            throw std::runtime_error("Failed to get ZeroMQ socket descriptor");
+        }
+
+        // The descriptor only signals that ZMQ_EVENTS may have changed, hence edge-triggered
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLET;
+        event.data.fd = fd;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) != 0 && errno != EEXIST) {
+            throw std::runtime_error("Failed to watch socket: " + std::string(std::strerror(errno)));
+        }
+    }
+    waiters_.push_back(waiter);
+}
+
+void Reactor::spawn(Task<void> task) {
+    ++active_tasks_;
+    drive(std::move(task), active_tasks_);
+}
+
+void Reactor::stop() {
+    stop_requested_.store(true, std::memory_order_release);
+    uint64_t one = 1;
+    ssize_t written = write(wake_fd_, &one, sizeof(one));
+    (void)written; // Only fails if the counter is already non-zero
+}
+
+void Reactor::run() {
+    std::vector<IoWait*> ready;
+    epoll_event events[16];
+
+    while (active_tasks_ > 0) {
+        // Sleep until the nearest deadline, a socket event or stop()
+        int timeout = -1;
+        if (!stopping()) {
+            int64_t current = now();
+            for (const IoWait* waiter : waiters_) {
+                if (waiter->deadline_ms_ >= 0) {
+                    int64_t remaining = std::max<int64_t>(0, waiter->deadline_ms_ - current);
+                    if (timeout < 0 || remaining < timeout) {
+                        timeout = static_cast<int>(remaining);
+                    }
+                }
+            }
+        } else {
+            timeout = 0;
+        }
+
+        int count = epoll_wait(epoll_fd_, events, 16, timeout);
+        if (count < 0 && errno != EINTR) {
+            throw std::runtime_error("epoll_wait failed: " + std::string(std::strerror(errno)));
+        }
+        for (int i = 0; i < count; ++i) {
+            if (events[i].data.fd == wake_fd_) {
+                uint64_t value;
+                ssize_t drained = read(wake_fd_, &value, sizeof(value));
+                (void)drained;
+            }
+        }
+
+        // Complete every wait whose condition holds; resuming may add new waiters
+        const bool cancel = stopping();
+        const int64_t current = now();
+        ready.clear();
+        auto done = [&](IoWait* waiter) {
+            if (cancel) {
+                waiter->status_ = IoStatus::Cancelled;
+            } else if (waiter->socket_ && socketReady(waiter->socket_, waiter->events_)) {
+                waiter->status_ = IoStatus::Ready;
+            } else if (waiter->deadline_ms_ >= 0 && current >= waiter->deadline_ms_) {
+                waiter->status_ = IoStatus::Timeout;
+            } else {
+                return false;
+            }
+            ready.push_back(waiter);
+            return true;
+        };
+        waiters_.erase(std::remove_if(waiters_.begin(), waiters_.end(), done), waiters_.end());
+
+        for (IoWait* waiter : ready) {
+            waiter->handle_.resume();
+        }
+    }
+}
+
+} // namespace voyis
@@ -0,0 +1,265 @@
+#include "trace_writer.h"
+#include "json_escape.h"
+#include "options.h"
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+namespace voyis {
+
+std::atomic<TraceWriter*> TraceWriter::active_{nullptr};
+
+namespace {
+
+std::atomic<uint64_t> g_next_writer_id{1};
+
+uint64_t clockNs(clockid_t clock) {
+    timespec ts;
+    clock_gettime(clock, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+uint32_t currentTid() {
+    return static_cast<uint32_t>(::syscall(SYS_gettid));
+}
+
+/**
+ * @brief Monotonic clocks are only comparable between processes of one boot
+ */
+std::string bootId() {
+    std::ifstream file("/proc/sys/kernel/random/boot_id");
+    std::string id;
+    std::getline(file, id);
+    return id;
+}
+
+std::string hostName() {
+    char name[256] = {};
+    if (gethostname(name, sizeof(name) - 1) != 0) {
+        return "";
+    }
+    return name;
+}
+
+/**
+ * @brief Trace timestamps are microseconds; keep nanosecond precision
+ */
+void appendMicros(std::string& out, uint64_t ns) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%llu.%03u", static_cast<unsigned long long>(ns / 1000),
+                  static_cast<unsigned>(ns % 1000));
+    out += text;
+}
+
+} // anonymous namespace
+
+TraceWriter::TraceWriter(const std::string& path, const std::string& process_name,
+                         std::chrono::milliseconds flush_interval, size_t events_per_thread)
+    : id_(g_next_writer_id.fetch_add(1)),
+      pid_(static_cast<uint32_t>(getpid())),
+      flush_interval_(flush_interval),
+      events_per_thread_(events_per_thread),
+      file_(path, std::ios::trunc) {
+    if (!file_) {
+        throw std::runtime_error("Failed to open trace file: " + path);
+    }
+
+    file_ << "[\n";
+    std::string json = "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" + std::to_string(pid_) +
+                       ",\"tid\":0,\"args\":{\"name\":";
+    appendJsonString(json, process_name);
+    json += "}}";
+    writeRaw(json);
+
+    // Clock offsets for merging traces of several processes
+    json = "{\"name\":\"clock_sync\",\"ph\":\"M\",\"pid\":" + std::to_string(pid_) +
+           ",\"tid\":0,\"args\":{\"monotonic_ns\":" + std::to_string(nowNs()) +
+           ",\"unix_ns\":" + std::to_string(clockNs(CLOCK_REALTIME)) + ",\"boot_id\":";
+    appendJsonString(json, bootId());
+    json += ",\"host\":";
+    appendJsonString(json, hostName());
+    json += "}}";
+    writeRaw(json);
+    file_ << pending_;
+    file_.flush();
+    pending_.clear();
+
+    flusher_ = std::thread(&TraceWriter::flushLoop, this);
+}
+
+TraceWriter::~TraceWriter() {
+    TraceWriter* self = this;
+    active_.compare_exchange_strong(self, nullptr);
+
+    {
+        std::lock_guard<std::mutex> lock(stop_mutex_);
+        stopping_ = true;
+    }
+    stop_cv_.notify_all();
+    flusher_.join();
+    flush();
+
+    std::lock_guard<std::mutex> lock(file_mutex_);
+    writeRaw("{\"name\":\"trace_stats\",\"ph\":\"M\",\"pid\":" + std::to_string(pid_) +
+             ",\"tid\":0,\"args\":{\"spans\":" + std::to_string(written()) +
+             ",\"dropped\":" + std::to_string(dropped()) + "}}");
+    file_ << pending_ << "\n]\n";
+}
+
+uint64_t TraceWriter::nowNs() {
+    return clockNs(CLOCK_MONOTONIC);
+}
+
+TraceWriter::ThreadBuffer& TraceWriter::threadBuffer() {
+    // One lookup per span; registration only on a thread's first span
+    thread_local uint64_t cached_writer = 0;
+    thread_local ThreadBuffer* cached_buffer = nullptr;
+    if (cached_writer == id_) {
+        return *cached_buffer;
+    }
+
+    auto buffer = std::make_unique<ThreadBuffer>(events_per_thread_);
+    buffer->tid = currentTid();
+    ThreadBuffer* raw = buffer.get();
+    {
+        std::lock_guard<std::mutex> lock(buffers_mutex_);
+        buffers_.push_back(std::move(buffer));
+    }
+    cached_writer = id_;
+    cached_buffer = raw;
+    return *raw;
+}
+
+void TraceWriter::record(const char* name, uint64_t start_ns, uint64_t end_ns,
+                         const std::string& frame_id, int port) {
+    ThreadBuffer& buffer = threadBuffer();
+
+    TraceEvent event;
+    event.name = name;
+    event.start_ns = start_ns;
+    event.duration_ns = end_ns > start_ns ? end_ns - start_ns : 0;
+    event.tid = buffer.tid;
+    event.port = port;
+    std::strncpy(event.frame_id, frame_id.c_str(), sizeof(event.frame_id) - 1);
+
+    if (!buffer.ring.tryPush(event)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void TraceWriter::nameThread(const std::string& name) {
+    ThreadBuffer& buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(buffers_mutex_);
+    buffer.name = name;
+    buffer.name_written = false;
+}
+
+void TraceWriter::flush() {
+    std::lock_guard<std::mutex> file_lock(file_mutex_);
+
+    std::vector<ThreadBuffer*> buffers;
+    {
+        std::lock_guard<std::mutex> lock(buffers_mutex_);
+        for (const auto& buffer : buffers_) {
+            buffers.push_back(buffer.get());
+            if (!buffer->name.empty() && !buffer->name_written) {
+                std::string json = "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" +
+                                   std::to_string(pid_) + ",\"tid\":" +
+                                   std::to_string(buffer->tid) + ",\"args\":{\"name\":";
+                appendJsonString(json, buffer->name);
+                json += "}}";
+                writeRaw(json);
+                buffer->name_written = true;
+            }
+        }
+    }
+
+    TraceEvent event;
+    for (ThreadBuffer* buffer : buffers) {
+        while (buffer->ring.tryPop(event)) {
+            writeEvent(event);
+        }
+    }
+
+    if (!pending_.empty()) {
+        file_ << pending_;
+        file_.flush();
+        pending_.clear();
+    }
+}
+
+void TraceWriter::flushLoop() {
+    std::unique_lock<std::mutex> lock(stop_mutex_);
+    while (!stopping_) {
+        stop_cv_.wait_for(lock, flush_interval_, [this]() { return stopping_; });
+        if (stopping_) {
+            break;
+        }
+        lock.unlock();
+        flush();
+        lock.lock();
+    }
+}
+
+void TraceWriter::writeEvent(const TraceEvent& event) {
+    std::string json = "{\"name\":";
+    appendJsonString(json, event.name);
+    json += ",\"cat\":\"frame\",\"ph\":\"X\",\"ts\":";
+    appendMicros(json, event.start_ns);
+    json += ",\"dur\":";
+    appendMicros(json, event.duration_ns);
+    json += ",\"pid\":" + std::to_string(pid_) + ",\"tid\":" + std::to_string(event.tid) +
+            ",\"args\":{\"frame\":";
+    appendJsonString(json, event.frame_id);
+    if (event.port != 0) {
+        json += ",\"port\":" + std::to_string(event.port);
+    }
+    json += "}}";
+    writeRaw(json);
+    written_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void TraceWriter::writeRaw(const std::string& json) {
+    if (!first_event_) {
+        pending_ += ",\n";
+    }
+    first_event_ = false;
+    pending_ += json;
+}
+
+int endpointPort(const std::string& endpoint) {
+    size_t colon = endpoint.rfind(':');
+    if (colon == std::string::npos || colon + 1 == endpoint.size()) {
+        return 0;
+    }
+    int port = 0;
+    for (size_t i = colon + 1; i < endpoint.size(); ++i) {
+        if (!std::isdigit(static_cast<unsigned char>(endpoint[i]))) {
+            return 0;
+        }
+        port = port * 10 + (endpoint[i] - '0');
+    }
+    return port;
+}
+
+std::unique_ptr<TraceWriter> configureTracing(const Options& options,
+                                              const std::string& process_name) {
+    if (!options.has("trace")) {
+        return nullptr;
+    }
+    int64_t flush_ms = options.getInt("trace-flush-ms", 1000);
+    if (flush_ms <= 0) {
+        throw std::invalid_argument("--trace-flush-ms must be positive");
+    }
+
+    auto writer = std::make_unique<TraceWriter>(options.getString("trace"), process_name,
+                                                 std::chrono::milliseconds(flush_ms));
+    TraceWriter::setActive(writer.get());
+    return writer;
+}
+
+} // namespace voyis
@@ -0,0 +1,312 @@
+#include "database.h"
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+
+namespace voyis {
+
+Database::Database(const std::string& db_path) : db_(nullptr) {
+    // Open database
+    int rc = sqlite3_open(db_path.c_str(), &db_);
+    if (rc != SQLITE_OK) {
+        std::string error = sqlite3_errmsg(db_);
+        sqlite3_close(db_);
+        db_ = nullptr;
+        throw std::runtime_error("Failed to open database: " + error);
+    }
+
+    // Create tables
+    createTables();
+
+    // Prepared once; each frame only binds and steps them
+    insert_image_ = prepareStatement(R"(
+        INSERT INTO images (
+            image_id, format, width, height, timestamp, processed_timestamp,
+            num_keypoints, image_data, created_at, sharpness, brightness,
+            contrast, dark_fraction, saturated_fraction, quality_flags,
+            stride, bit_depth, descriptor_dim, stream_id
+        ) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
+    )");
+    insert_keypoint_ = prepareStatement(R"(
+        INSERT INTO keypoints (
+            image_id, x, y, size, angle, response, octave, descriptor
+        ) VALUES (?, ?, ?, ?, ?, ?, ?, ?)
+    )");
+}
+
+Database::~Database() {
+    if (db_) {
+        try {
+            flush();
+        } catch (const std::exception& e) {
+            std::cerr << "Error committing last batch: " << e.what() << std::endl;
+        }
+        sqlite3_finalize(insert_image_);
+        sqlite3_finalize(insert_keypoint_);
+        sqlite3_close(db_);
+    }
+}
+
+void Database::setBatchSize(size_t frames) {
+    batch_size_ = frames > 0 ? frames : 1;
+    if (batched_frames_ >= batch_size_) {
+        flush();
+    }
+}
+
+void Database::enableWriteAheadLog() {
+    flush();
+    executeSQL("PRAGMA journal_mode=WAL");
+}
+
+void Database::flush() {
+    if (batched_frames_ > 0) {
+        if (keep_images_ > 0) {
+            std::string oldest_kept =
+                "(SELECT MAX(id) FROM images) - " + std::to_string(keep_images_);
+            executeSQL("DELETE FROM keypoints WHERE image_id <= " + oldest_kept);
+            executeSQL("DELETE FROM images WHERE id <= " + oldest_kept);
+        }
+        executeSQL("COMMIT");
+        batched_frames_ = 0;
+    }
+}
+
+bool Database::storeProcessedImage(const ProcessedImageMessage& msg, int64_t* row_id) {
+    // Begin transaction for better performance
+    if (batched_frames_ == 0) {
+        executeSQL("BEGIN TRANSACTION");
+    }
+    executeSQL("SAVEPOINT frame");
+
+    try {
+        // Insert image record
+        int64_t image_db_id = insertImage(msg);
+
+        // Insert keypoints with their descriptors (if available)
+        static const std::vector<float> no_descriptor;
+        for (size_t i = 0; i < msg.keypoints.size(); ++i) {
+            insertKeypoint(image_db_id, msg.keypoints[i],
+                           i < msg.descriptors.size() ? msg.descriptors[i] : no_descriptor);
+        }
+
+        executeSQL("RELEASE frame");
+        ++batched_frames_;
+        if (row_id) {
+            *row_id = image_db_id;
+        }
+
+    } catch (const std::exception& e) {
+        executeSQL("ROLLBACK TO frame");
+        executeSQL("RELEASE frame");
+        if (batched_frames_ == 0) {
+            executeSQL("ROLLBACK");
+        }
+        std::cerr << "Error storing image: " << e.what() << std::endl;
+        return false;
+    }
+
+    // Commit transaction once the batch is full
+    if (batched_frames_ >= batch_size_) {
+        flush();
+    }
+    return true;
+}
+
+void Database::printStatistics() {
+    auto stmt = prepareStatement(
+        "SELECT COUNT(*), SUM(num_keypoints) FROM images"
+    );
+
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        int64_t image_count = sqlite3_column_int64(stmt, 0);
+        int64_t total_keypoints = sqlite3_column_int64(stmt, 1);
+
+        std::cout << "\n=== Database Statistics ===" << std::endl;
+        std::cout << "Total images stored: " << image_count << std::endl;
+        std::cout << "Total keypoints stored: " << total_keypoints << std::endl;
+        if (image_count > 0) {
+            std::cout << "Average keypoints per image: "
+                      << total_keypoints / image_count << std::endl;
+        }
+        std::cout << "===========================" << std::endl;
+    }
+
+    sqlite3_finalize(stmt);
+}
+
+void Database::createTables() {
+    // Images table
+    std::string create_images_sql = R"(
+        CREATE TABLE IF NOT EXISTS images (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            image_id TEXT NOT NULL,
+            format TEXT NOT NULL,
+            width INTEGER NOT NULL,
+            height INTEGER NOT NULL,
+            stride INTEGER NOT NULL DEFAULT 0,
+            bit_depth INTEGER NOT NULL DEFAULT 0,
+            timestamp INTEGER NOT NULL,
+            processed_timestamp INTEGER NOT NULL,
+            num_keypoints INTEGER NOT NULL,
+            image_data BLOB NOT NULL,
+            created_at INTEGER NOT NULL,
+            sharpness REAL,
+            brightness REAL,
+            contrast REAL,
+            dark_fraction REAL,
+            saturated_fraction REAL,
+            quality_flags INTEGER NOT NULL DEFAULT 0,
+            descriptor_dim INTEGER NOT NULL DEFAULT 128,
+            stream_id TEXT NOT NULL DEFAULT ''
+        )
+    )";
+    executeSQL(create_images_sql);
+
+    // Databases created before raw pixel formats and quality scores were logged
+    addColumnIfMissing("images", "stride", "INTEGER NOT NULL DEFAULT 0");
+    addColumnIfMissing("images", "bit_depth", "INTEGER NOT NULL DEFAULT 0");
+    addColumnIfMissing("images", "sharpness", "REAL");
+    addColumnIfMissing("images", "brightness", "REAL");
+    addColumnIfMissing("images", "contrast", "REAL");
+    addColumnIfMissing("images", "dark_fraction", "REAL");
+    addColumnIfMissing("images", "saturated_fraction", "REAL");
+    addColumnIfMissing("images", "quality_flags", "INTEGER NOT NULL DEFAULT 0");
+
+    // Older rows always carried full 128-dimensional SIFT descriptors
+    addColumnIfMissing("images", "descriptor_dim", "INTEGER NOT NULL DEFAULT 128");
+    addColumnIfMissing("images", "stream_id", "TEXT NOT NULL DEFAULT ''");
+
+    // Keypoints table
+    std::string create_keypoints_sql = R"(
+        CREATE TABLE IF NOT EXISTS keypoints (
+            id INTEGER PRIMARY KEY AUTOINCREMENT,
+            image_id INTEGER NOT NULL,
+            x REAL NOT NULL,
+            y REAL NOT NULL,
+            size REAL NOT NULL,
+            angle REAL NOT NULL,
+            response REAL NOT NULL,
+            octave INTEGER NOT NULL,
+            descriptor BLOB,
+            FOREIGN KEY (image_id) REFERENCES images(id) ON DELETE CASCADE
+        )
+    )";
+    executeSQL(create_keypoints_sql);
+
+    // Create indices for better query performance
+    executeSQL("CREATE INDEX IF NOT EXISTS idx_images_image_id ON images(image_id)");
+    executeSQL("CREATE INDEX IF NOT EXISTS idx_keypoints_image_id ON keypoints(image_id)");
+    executeSQL("CREATE INDEX IF NOT EXISTS idx_images_quality_flags ON images(quality_flags)");
+    executeSQL("CREATE INDEX IF NOT EXISTS idx_images_sharpness ON images(sharpness)");
+}
+
+void Database::addColumnIfMissing(const std::string& table, const std::string& column,
+                                  const std::string& declaration) {
+    auto stmt = prepareStatement("PRAGMA table_info(" + table + ")");
+
+    bool exists = false;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const unsigned char* name = sqlite3_column_text(stmt, 1);
+        if (name && column == reinterpret_cast<const char*>(name)) {
+            exists = true;
+            break;
+        }
+    }
+    sqlite3_finalize(stmt);
+
+    if (!exists) {
+        executeSQL("ALTER TABLE " + table + " ADD COLUMN " + column + " " + declaration);
+    }
+}
+
+void Database::executeSQL(const std::string& sql) {
+    char* err_msg = nullptr;
+    int rc = sqlite3_exec(db_, sql.c_str(), nullptr, nullptr, &err_msg);
+    if (rc != SQLITE_OK) {
+        std::string error = err_msg ? err_msg : "Unknown error";
+        sqlite3_free(err_msg);
+        throw std::runtime_error("SQL error: " + error);
+    }
+}
+
+sqlite3_stmt* Database::prepareStatement(const std::string& sql) {
+    sqlite3_stmt* stmt;
+    int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+    if (rc != SQLITE_OK) {
+        throw std::runtime_error("Failed to prepare statement: " +
+                                 std::string(sqlite3_errmsg(db_)));
+    }
+    return stmt;
+}
+
+int64_t Database::insertImage(const ProcessedImageMessage& msg) {
+    sqlite3_stmt* stmt = insert_image_;
+
+    int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count();
+
+    // The message outlives the step, so its buffers are bound without copying
+    sqlite3_bind_text(stmt, 1, msg.image_id.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, msg.format.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 3, msg.width);
+    sqlite3_bind_int(stmt, 4, msg.height);
+    sqlite3_bind_int64(stmt, 5, msg.timestamp);
+    sqlite3_bind_int64(stmt, 6, msg.processed_timestamp);
+    sqlite3_bind_int(stmt, 7, static_cast<int>(msg.keypoints.size()));
+    sqlite3_bind_blob(stmt, 8, msg.image_data.data(),
+                      static_cast<int>(msg.image_data.size()), SQLITE_STATIC);
+    sqlite3_bind_int64(stmt, 9, now);
+    sqlite3_bind_double(stmt, 10, msg.quality.sharpness);
+    sqlite3_bind_double(stmt, 11, msg.quality.brightness);
+    sqlite3_bind_double(stmt, 12, msg.quality.contrast);
+    sqlite3_bind_double(stmt, 13, msg.quality.dark_fraction);
+    sqlite3_bind_double(stmt, 14, msg.quality.saturated_fraction);
+    sqlite3_bind_int64(stmt, 15, msg.quality.flags);
+    sqlite3_bind_int(stmt, 16, msg.stride);
+    sqlite3_bind_int(stmt, 17, msg.bit_depth);
+    sqlite3_bind_int64(stmt, 18, msg.descriptor_dim);
+    sqlite3_bind_text(stmt, 19, msg.stream_id.c_str(), -1, SQLITE_STATIC);
+
+    bool done = sqlite3_step(stmt) == SQLITE_DONE;
+    std::string error = done ? std::string() : sqlite3_errmsg(db_);
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    if (!done) {
+        throw std::runtime_error("Failed to insert image: " + error);
+    }
+
+    return sqlite3_last_insert_rowid(db_);
+}
+
+void Database::insertKeypoint(int64_t image_id, const KeyPoint& kp,
+                              const std::vector<float>& descriptor) {
+    sqlite3_stmt* stmt = insert_keypoint_;
+
+    sqlite3_bind_int64(stmt, 1, image_id);
+    sqlite3_bind_double(stmt, 2, kp.pt.x);
+    sqlite3_bind_double(stmt, 3, kp.pt.y);
+    sqlite3_bind_double(stmt, 4, kp.size);
+    sqlite3_bind_double(stmt, 5, kp.angle);
+    sqlite3_bind_double(stmt, 6, kp.response);
+    sqlite3_bind_int(stmt, 7, kp.octave);
+
+    // Store descriptor as binary blob
+    if (!descriptor.empty()) {
+        sqlite3_bind_blob(stmt, 8, descriptor.data(),
+                          static_cast<int>(descriptor.size() * sizeof(float)),
+                          SQLITE_STATIC);
+    } else {
+        sqlite3_bind_null(stmt, 8);
+    }
+
+    bool done = sqlite3_step(stmt) == SQLITE_DONE;
+    std::string error = done ? std::string() : sqlite3_errmsg(db_);
+    sqlite3_reset(stmt);
+    if (!done) {
+        throw std::runtime_error("Failed to insert keypoint: " + error);
+    }
+}
+
+} // namespace voyis
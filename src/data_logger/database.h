@@ -0,0 +1,90 @@
+#pragma once
+
+#include "message.h"
+#include <sqlite3.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace voyis {
+
+/**
+ * @brief Database manager class for storing processed images and keypoints
+ */
+class Database {
+public:
+    /**
+     * @throws std::runtime_error if the database cannot be opened or its tables created
+     */
+    explicit Database(const std::string& db_path);
+    ~Database();
+
+    // Disable copy
+    Database(const Database&) = delete;
+    Database& operator=(const Database&) = delete;
+
+    /**
+     * @brief Commit every N frames in one transaction (1 commits each frame)
+     *
+     * Fewer commits mean fewer fsyncs; frames of an open batch are lost if the
+     * process dies before flush().
+     */
+    void setBatchSize(size_t frames);
+
+    /**
+     * @brief Keep only the newest N images and their keypoints (0 keeps all)
+     *
+     * Older rows are deleted with each commit, so the file stops growing once
+     * SQLite reuses the freed pages.
+     */
+    void setRetention(size_t images) {
+        keep_images_ = images;
+    }
+
+    /**
+     * @brief Switch to write-ahead logging, so readers on other connections
+     *        never wait for a commit and never block one
+     */
+    void enableWriteAheadLog();
+
+    /**
+     * @brief Commit the open batch, if any
+     */
+    void flush();
+
+    /**
+     * @brief Store a processed image message in the database
+     *
+     * Each frame is written under its own savepoint, so a failing frame is
+     * rolled back without losing the rest of the batch.
+     *
+     * @param row_id Set to the id of the new images row, if given
+     */
+    bool storeProcessedImage(const ProcessedImageMessage& msg, int64_t* row_id = nullptr);
+
+    size_t batchedFrames() const { return batched_frames_; }
+
+    /**
+     * @brief Get statistics about stored data
+     */
+    void printStatistics();
+
+private:
+    sqlite3* db_;
+    sqlite3_stmt* insert_image_ = nullptr;    // Prepared once, reset after each frame
+    sqlite3_stmt* insert_keypoint_ = nullptr;
+    size_t batch_size_ = 1;
+    size_t batched_frames_ = 0; // Stored in the open transaction
+    size_t keep_images_ = 0;
+
+    void createTables();
+    void addColumnIfMissing(const std::string& table, const std::string& column,
+                            const std::string& declaration);
+    void executeSQL(const std::string& sql);
+    sqlite3_stmt* prepareStatement(const std::string& sql);
+    int64_t insertImage(const ProcessedImageMessage& msg);
+    void insertKeypoint(int64_t image_id, const KeyPoint& kp, const std::vector<float>& descriptor);
+};
+
+} // namespace voyis
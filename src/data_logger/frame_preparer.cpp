@@ -0,0 +1,137 @@
+#include "frame_preparer.h"
+#include "trace_writer.h"
+#include <sstream>
+#include <stdexcept>
+
+namespace voyis {
+
+FramePreparer::FramePreparer(size_t threads, size_t max_pending, int trace_port,
+                             std::ostream* log)
+    : max_pending_(max_pending), trace_port_(trace_port), log_(log) {
+    if (threads == 0) {
+        throw std::invalid_argument("Frame preparation needs at least one thread");
+    }
+    if (max_pending == 0) {
+        throw std::invalid_argument("Frame preparation needs room for at least one frame");
+    }
+    workers_.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        workers_.emplace_back(&FramePreparer::work, this);
+    }
+}
+
+FramePreparer::~FramePreparer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_ready_.notify_all();
+    space_ready_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void FramePreparer::submit(FrameBuffer&& raw) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    space_ready_.wait(lock, [this] { return stopping_ || submitted_ - returned_ < max_pending_; });
+    if (stopping_) {
+        return;
+    }
+    inbox_.emplace_back(submitted_++, std::move(raw));
+    lock.unlock();
+    work_ready_.notify_one();
+}
+
+bool FramePreparer::next(PreparedFrame& frame, std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    // Later frames may finish first; they wait until their turn
+    auto ready = [this] {
+        return !prepared_.empty() && prepared_.begin()->first == returned_;
+    };
+    if (!frame_ready_.wait_for(lock, timeout, ready)) {
+        return false;
+    }
+    frame = std::move(prepared_.begin()->second);
+    prepared_.erase(prepared_.begin());
+    ++returned_;
+    lock.unlock();
+    space_ready_.notify_one();
+    return true;
+}
+
+size_t FramePreparer::pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<size_t>(submitted_ - returned_);
+}
+
+PreparedFrame FramePreparer::prepare(const FrameBuffer& raw, int trace_port) {
+    auto start = std::chrono::steady_clock::now();
+    PreparedFrame frame;
+    TraceSpan receive_span("receive", "", trace_port);
+    try {
+        auto message = std::make_shared<ProcessedImageMessage>(ProcessedImageMessage::deserialize(raw));
+        receive_span.setFrameId(message->image_id);
+        // The writer binds one descriptor per keypoint straight from the message
+        if (!message->descriptors.empty() && message->descriptors.size() != message->keypoints.size()) {
+            throw std::runtime_error(std::to_string(message->descriptors.size()) +
+                                     " descriptors for " + std::to_string(message->keypoints.size()) +
+                                     " keypoints");
+        }
+        frame.message = std::move(message);
+    } catch (const std::exception& e) {
+        frame.error = e.what();
+    }
+    frame.prepare_ms =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return frame;
+}
+
+std::string FramePreparer::report(const PreparedFrame& frame) {
+    std::ostringstream out;
+    if (!frame.message) {
+        out << "Error processing message: " << frame.error << '\n';
+        return out.str();
+    }
+    const ProcessedImageMessage& msg = *frame.message;
+    out << "\nReceived processed image: " << msg.image_id << '\n'
+        << "  Dimensions: " << msg.width << "x" << msg.height << '\n'
+        << "  Keypoints: " << msg.keypoints.size() << '\n'
+        << "  Descriptors: " << msg.descriptors.size() << " x " << msg.descriptor_dim << '\n';
+    if (msg.quality.flags != kQualityOk) {
+        out << "  Failed quality check (flags " << msg.quality.flags << ")\n";
+    }
+    return out.str();
+}
+
+void FramePreparer::work() {
+    if (TraceWriter* trace = TraceWriter::active()) {
+        trace->nameThread("prepare");
+    }
+
+    while (true) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        work_ready_.wait(lock, [this] { return stopping_ || !inbox_.empty(); });
+        if (stopping_) {
+            return;
+        }
+        std::pair<uint64_t, FrameBuffer> job = std::move(inbox_.front());
+        inbox_.pop_front();
+        lock.unlock();
+
+        PreparedFrame frame = prepare(job.second, trace_port_);
+        job.second = FrameBuffer(); // Back to the pool before the writer catches up
+        if (log_) {
+            std::string lines = report(frame);
+            std::lock_guard<std::mutex> log_lock(log_mutex_);
+            *log_ << lines << std::flush;
+        }
+
+        lock.lock();
+        prepared_.emplace(job.first, std::move(frame));
+        lock.unlock();
+        frame_ready_.notify_one();
+    }
+}
+
+} // namespace voyis
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "message.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace voyis {
+
+/**
+ * @brief A received frame, ready for the database writer to bind
+ */
+struct PreparedFrame {
+    std::shared_ptr<const ProcessedImageMessage> message; // nullptr if the frame was malformed
+    std::string error;                                    // Why the frame could not be prepared
+    double prepare_ms = 0;                                // Time spent on a preparation thread
+};
+
+/**
+ * @brief Prepares received frames on a pool of threads for a single writer
+ *
+ * Deserializing and validating a frame is most of the work of logging it,
+ * and none of it needs the database. submit() hands raw messages to N
+ * threads; next() returns the prepared frames in submission order, so rows
+ * are still written in the order the frames arrived. At most max_pending
+ * frames are in flight; submit() blocks until the writer catches up.
+ * submit() and next() may be called from different threads. Per-frame log
+ * lines are written here too, so console output never stalls the writer;
+ * with several threads they may come out of arrival order.
+ */
+class FramePreparer {
+public:
+    /**
+     * @param trace_port Input port, for the "receive" spans of the trace
+     * @param log Where each prepared frame is reported, or nullptr
+     * @throws std::invalid_argument if threads or max_pending is 0
+     */
+    FramePreparer(size_t threads, size_t max_pending, int trace_port = 0,
+                  std::ostream* log = nullptr);
+
+    /**
+     * @brief Stops the threads; frames still in flight are discarded
+     */
+    ~FramePreparer();
+
+    FramePreparer(const FramePreparer&) = delete;
+    FramePreparer& operator=(const FramePreparer&) = delete;
+
+    /**
+     * @brief Queue a raw ProcessedImageMessage for preparation
+     */
+    void submit(FrameBuffer&& raw);
+
+    /**
+     * @brief Wait up to timeout for the next frame in submission order
+     * @return false on timeout
+     */
+    bool next(PreparedFrame& frame, std::chrono::milliseconds timeout);
+
+    /**
+     * @brief Frames submitted but not yet returned by next()
+     */
+    size_t pending() const;
+
+    size_t threads() const { return workers_.size(); }
+
+    /**
+     * @brief Prepare one frame (what each thread does per message)
+     */
+    static PreparedFrame prepare(const FrameBuffer& raw, int trace_port = 0);
+
+    /**
+     * @brief Log lines for a prepared frame (dimensions, keypoints, quality or the error)
+     */
+    static std::string report(const PreparedFrame& frame);
+
+private:
+    void work();
+
+    const size_t max_pending_;
+    const int trace_port_;
+    std::ostream* const log_;
+    std::mutex log_mutex_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable work_ready_;  // A raw frame was queued
+    std::condition_variable frame_ready_; // A frame finished preparing
+    std::condition_variable space_ready_; // The writer took a frame
+    std::deque<std::pair<uint64_t, FrameBuffer>> inbox_;
+    std::map<uint64_t, PreparedFrame> prepared_; // Finished, by submission number
+    uint64_t submitted_ = 0;
+    uint64_t returned_ = 0;
+    bool stopping_ = false;
+
+    std::vector<std::thread> workers_;
+};
+
+} // namespace voyis
@@ -1,6 +1,14 @@
 #include "ipc.h"
 #include "message.h"
-#include <sqlite3.h>
+#include "options.h"
+#include "frame_allocator.h"
+#include "tracepoints.h"
+#include "trace_writer.h"
+#include "flight_recorder.h"
+#include "control.h"
+#include "database.h"
+#include "frame_preparer.h"
+#include "query_service.h"
 #include <iostream>
 #include <string>
 #include <chrono>
@@ -8,6 +16,9 @@
 #include <atomic>
 #include <thread>
 #include <sstream>
+#include <memory>
+#include <functional>
+#include <stdexcept>
 
 // Global flag for graceful shutdown
 std::atomic<bool> g_running(true);
@@ -20,229 +31,33 @@ void signalHandler(int signal) {
 }
 
 /**
- * @brief Database manager class for storing processed images and keypoints
+ * @brief Receive processed messages and hand them to the preparation threads
+ *
+ * Runs on its own thread so that the ZeroMQ socket keeps being drained while
+ * the writer is committing.
  */
-class Database {
-public:
-    explicit Database(const std::string& db_path) : db_(nullptr) {
-        // Open database
-        int rc = sqlite3_open(db_path.c_str(), &db_);
-        if (rc != SQLITE_OK) {
-            throw std::runtime_error("Failed to open database: " +
-                                     std::string(sqlite3_errmsg(db_)));
-        }
-
-        // Create tables
-        createTables();
-    }
-
-    ~Database() {
-        if (db_) {
-            sqlite3_close(db_);
-        }
-    }
-
-    // Disable copy
-    Database(const Database&) = delete;
-    Database& operator=(const Database&) = delete;
-
-    /**
-     * @brief Store a processed image message in the database
-     */
-    bool storeProcessedImage(const voyis::ProcessedImageMessage& msg) {
-        // Begin transaction for better performance
-        executeSQL("BEGIN TRANSACTION");
-
-        try {
-            // Insert image record
-            int64_t image_db_id = insertImage(msg);
-
-            // Insert keypoints
-            for (size_t i = 0; i < msg.keypoints.size(); ++i) {
-                const auto& kp = msg.keypoints[i];
-
-                // Get descriptor for this keypoint (if available)
-                std::vector<float> descriptor;
-                if (i < msg.descriptors.size()) {
-                    descriptor = msg.descriptors[i];
-                }
-
-                insertKeypoint(image_db_id, kp, descriptor);
-            }
-
-            // Commit transaction
-            executeSQL("COMMIT");
-            return true;
-
-        } catch (const std::exception& e) {
-            executeSQL("ROLLBACK");
-            std::cerr << "Error storing image: " << e.what() << std::endl;
-            return false;
-        }
-    }
-
-    /**
-     * @brief Get statistics about stored data
-     */
-    void printStatistics() {
-        auto stmt = prepareStatement(
-            "SELECT COUNT(*), SUM(num_keypoints) FROM images"
-        );
-
-        if (sqlite3_step(stmt) == SQLITE_ROW) {
-            int64_t image_count = sqlite3_column_int64(stmt, 0);
-            int64_t total_keypoints = sqlite3_column_int64(stmt, 1);
-
-            std::cout << "\n=== Database Statistics ===" << std::endl;
-            std::cout << "Total images stored: " << image_count << std::endl;
-            std::cout << "Total keypoints stored: " << total_keypoints << std::endl;
-            if (image_count > 0) {
-                std::cout << "Average keypoints per image: "
-                          << total_keypoints / image_count << std::endl;
-            }
-            std::cout << "===========================" << std::endl;
-        }
-
-        sqlite3_finalize(stmt);
-    }
-
-private:
-    sqlite3* db_;
-
-    void createTables() {
-        // Images table
-        std::string create_images_sql = R"(
-            CREATE TABLE IF NOT EXISTS images (
-                id INTEGER PRIMARY KEY AUTOINCREMENT,
-                image_id TEXT NOT NULL,
-                format TEXT NOT NULL,
-                width INTEGER NOT NULL,
-                height INTEGER NOT NULL,
-                timestamp INTEGER NOT NULL,
-                processed_timestamp INTEGER NOT NULL,
-                num_keypoints INTEGER NOT NULL,
-                image_data BLOB NOT NULL,
-                created_at INTEGER NOT NULL
-            )
-        )";
-        executeSQL(create_images_sql);
-
-        // Keypoints table
-        std::string create_keypoints_sql = R"(
-            CREATE TABLE IF NOT EXISTS keypoints (
-                id INTEGER PRIMARY KEY AUTOINCREMENT,
-                image_id INTEGER NOT NULL,
-                x REAL NOT NULL,
-                y REAL NOT NULL,
-                size REAL NOT NULL,
-                angle REAL NOT NULL,
-                response REAL NOT NULL,
-                octave INTEGER NOT NULL,
-                descriptor BLOB,
-                FOREIGN KEY (image_id) REFERENCES images(id) ON DELETE CASCADE
-            )
-        )";
-        executeSQL(create_keypoints_sql);
-
-        // Create indices for better query performance
-        executeSQL("CREATE INDEX IF NOT EXISTS idx_images_image_id ON images(image_id)");
-        executeSQL("CREATE INDEX IF NOT EXISTS idx_keypoints_image_id ON keypoints(image_id)");
-    }
-
-    void executeSQL(const std::string& sql) {
-        char* err_msg = nullptr;
-        int rc = sqlite3_exec(db_, sql.c_str(), nullptr, nullptr, &err_msg);
-        if (rc != SQLITE_OK) {
-            std::string error = err_msg ? err_msg : "Unknown error";
-            sqlite3_free(err_msg);
-            throw std::runtime_error("SQL error: " + error);
-        }
-    }
-
-    sqlite3_stmt* prepareStatement(const std::string& sql) {
-        sqlite3_stmt* stmt;
-        int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
-        if (rc != SQLITE_OK) {
-            throw std::runtime_error("Failed to prepare statement: " +
-                                     std::string(sqlite3_errmsg(db_)));
-        }
-        return stmt;
-    }
-
-    int64_t insertImage(const voyis::ProcessedImageMessage& msg) {
-        auto stmt = prepareStatement(R"(
-            INSERT INTO images (
-                image_id, format, width, height, timestamp, processed_timestamp,
-                num_keypoints, image_data, created_at
-            ) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)
-        )");
-
-        int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
-            std::chrono::system_clock::now().time_since_epoch()
-        ).count();
-
-        sqlite3_bind_text(stmt, 1, msg.image_id.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_text(stmt, 2, msg.format.c_str(), -1, SQLITE_TRANSIENT);
-        sqlite3_bind_int(stmt, 3, msg.width);
-        sqlite3_bind_int(stmt, 4, msg.height);
-        sqlite3_bind_int64(stmt, 5, msg.timestamp);
-        sqlite3_bind_int64(stmt, 6, msg.processed_timestamp);
-        sqlite3_bind_int(stmt, 7, static_cast<int>(msg.keypoints.size()));
-        sqlite3_bind_blob(stmt, 8, msg.image_data.data(),
-                          static_cast<int>(msg.image_data.size()), SQLITE_TRANSIENT);
-        sqlite3_bind_int64(stmt, 9, now);
-
-        if (sqlite3_step(stmt) != SQLITE_DONE) {
-            sqlite3_finalize(stmt);
-            throw std::runtime_error("Failed to insert image: " +
-                                     std::string(sqlite3_errmsg(db_)));
-        }
-
-        int64_t id = sqlite3_last_insert_rowid(db_);
-        sqlite3_finalize(stmt);
-        return id;
+void receiveLoop(voyis::Subscriber& subscriber, voyis::FramePreparer& preparer,
+                 std::atomic<bool>& done) {
+    if (voyis::TraceWriter* trace = voyis::TraceWriter::active()) {
+        trace->nameThread("receiver");
     }
 
-    void insertKeypoint(int64_t image_id, const voyis::KeyPoint& kp,
-                       const std::vector<float>& descriptor) {
-        auto stmt = prepareStatement(R"(
-            INSERT INTO keypoints (
-                image_id, x, y, size, angle, response, octave, descriptor
-            ) VALUES (?, ?, ?, ?, ?, ?, ?, ?)
-        )");
-
-        sqlite3_bind_int64(stmt, 1, image_id);
-        sqlite3_bind_double(stmt, 2, kp.pt.x);
-        sqlite3_bind_double(stmt, 3, kp.pt.y);
-        sqlite3_bind_double(stmt, 4, kp.size);
-        sqlite3_bind_double(stmt, 5, kp.angle);
-        sqlite3_bind_double(stmt, 6, kp.response);
-        sqlite3_bind_int(stmt, 7, kp.octave);
-
-        // Store descriptor as binary blob
-        if (!descriptor.empty()) {
-            sqlite3_bind_blob(stmt, 8, descriptor.data(),
-                              static_cast<int>(descriptor.size() * sizeof(float)),
-                              SQLITE_TRANSIENT);
-        } else {
-            sqlite3_bind_null(stmt, 8);
+    voyis::FrameBuffer raw_data;
+    while (g_running) {
+        if (subscriber.receive(raw_data)) {
+            preparer.submit(std::move(raw_data));
+            raw_data = voyis::FrameBuffer();
         }
-
-        if (sqlite3_step(stmt) != SQLITE_DONE) {
-            sqlite3_finalize(stmt);
-            throw std::runtime_error("Failed to insert keypoint: " +
-                                     std::string(sqlite3_errmsg(db_)));
-        }
-
-        sqlite3_finalize(stmt);
     }
-};
+    done = true;
+}
 
 int main(int argc, char* argv[]) {
     // Parse command line arguments
+    voyis::Options options(argc, argv);
     std::string db_path = "image_data.db";
-    if (argc > 1) {
-        db_path = argv[1];
+    if (!options.positional().empty()) {
+        db_path = options.positional()[0];
     }
 
     // Set up signal handlers
@@ -253,58 +68,199 @@ int main(int argc, char* argv[]) {
         std::cout << "Data Logger starting..." << std::endl;
         std::cout << "Database: " << db_path << std::endl;
 
+        // Frame buffers for messages of --prefault-mb (none by default)
+        voyis::PageFaults startup_faults = voyis::PageFaults::now();
+        voyis::configureFramePool(options);
+        std::cout << "Huge pages: " << voyis::hugePageModeName(voyis::FramePool::shared().mode())
+                  << ", prefaulting took "
+                  << (voyis::PageFaults::now() - startup_faults).minor << " page faults" << std::endl;
+
+        // Optional per-frame span trace
+        std::unique_ptr<voyis::TraceWriter> trace = voyis::configureTracing(options, "data_logger");
+        if (trace) {
+            std::cout << "Tracing to: " << options.getString("trace") << std::endl;
+        }
+
+        // Always-on record of the last frames, dumped after latency spikes
+        std::unique_ptr<voyis::FlightRecorder> flight =
+            voyis::configureFlightRecorder(options, "data_logger");
+        if (flight) {
+            std::cout << "Flight recorder: " << flight->describe() << std::endl;
+        }
+
+        // Settings that voyisctl can change while running
+        voyis::Tunables tunables;
+        tunables.add("batch-size", static_cast<double>(options.getInt("batch-size", 1)), 1, 10000,
+                     "Frames committed per transaction", true);
+
         // Initialize database
-        Database database(db_path);
+        voyis::Database database(db_path);
+        database.setBatchSize(static_cast<size_t>(tunables.getInt("batch-size")));
+        if (options.has("keep-images")) {
+            int64_t keep_images = options.getInt("keep-images");
+            if (keep_images < 0) {
+                throw std::invalid_argument("--keep-images must not be negative");
+            }
+            database.setRetention(static_cast<size_t>(keep_images));
+            std::cout << "Keeping the newest " << keep_images << " images" << std::endl;
+        }
+
+        // Runtime control socket (voyisctl)
+        std::unique_ptr<voyis::ControlServer> control =
+            voyis::configureControl(options, "data_logger", tunables);
+        if (control) {
+            std::cout << "Control socket: " << control->endpoint() << std::endl;
+        }
+        std::atomic<double>& stored_stat = voyis::controlStat(control.get(), "frames_stored");
+        std::atomic<double>& keypoints_stat = voyis::controlStat(control.get(), "keypoints_total");
+        std::atomic<double>& batched_stat = voyis::controlStat(control.get(), "batched_frames");
+
+        // Recent frames served from memory, older ones from a read-only connection
+        std::unique_ptr<voyis::RecentFrameCache> recent_frames;
+        std::unique_ptr<voyis::QueryService> query_service;
+        if (options.has("query")) {
+            database.enableWriteAheadLog();
+            recent_frames = std::make_unique<voyis::RecentFrameCache>(
+                static_cast<size_t>(options.getInt("query-cache-frames", 64)),
+                static_cast<size_t>(options.getDouble("query-cache-mb", 256.0) * 1024 * 1024));
+            query_service = std::make_unique<voyis::QueryService>(
+                options.getString("query"), *recent_frames, db_path, control.get());
+            std::cout << "Frame queries on " << query_service->endpoint()
+                      << " (cache: " << recent_frames->maxFrames() << " frames, "
+                      << recent_frames->maxBytes() / (1024.0 * 1024.0) << " MB)" << std::endl;
+        }
+        std::atomic<double>& cached_frames_stat =
+            voyis::controlStat(control.get(), "query_cache_frames");
+        std::atomic<double>& cached_bytes_stat =
+            voyis::controlStat(control.get(), "query_cache_bytes");
+
+        // Deserialization and validation run on a pool, in front of the single writer
+        std::atomic<double>& writer_ms_stat = voyis::controlStat(control.get(), "writer_ms");
+        std::atomic<double>& prepare_ms_stat = voyis::controlStat(control.get(), "prepare_ms");
+        std::atomic<double>& pending_stat = voyis::controlStat(control.get(), "prepare_pending");
+        const int64_t prepare_threads = options.getInt("prepare-threads", 2);
+        const int64_t prepare_queue = options.getInt("prepare-queue", 64);
+        if (prepare_threads < 1 || prepare_queue < 1) {
+            throw std::invalid_argument("--prepare-threads and --prepare-queue must be at least 1");
+        }
 
         // Create subscriber for receiving processed images from Feature Extractor
         const std::string input_endpoint = "tcp://localhost:5556";
         voyis::Subscriber subscriber(input_endpoint, 1000); // 1 second timeout
         std::cout << "Subscriber connected to: " << input_endpoint << std::endl;
 
+        voyis::FramePreparer preparer(static_cast<size_t>(prepare_threads),
+                                      static_cast<size_t>(prepare_queue),
+                                      voyis::endpointPort(input_endpoint), &std::cout);
+        std::cout << "Preparation threads: " << preparer.threads() << std::endl;
+
         std::cout << "Waiting for processed images to log..." << std::endl;
         std::cout << "Press Ctrl+C to stop." << std::endl;
 
         size_t stored_count = 0;
         size_t total_keypoints = 0;
+        double total_writer_ms = 0;
+        size_t written_count = 0; // Frames the writer handled, stored or not
+        voyis::PageFaults steady_faults = voyis::PageFaults::now();
+
+        // The writer only binds and steps the prepared statements; the preparation
+        // threads already logged the frame, so nothing here touches the console
+        // unless a frame fails. writer_ms covers everything the writer does per frame.
+        auto writeFrame = [&](const voyis::PreparedFrame& frame) {
+            prepare_ms_stat.store(frame.prepare_ms, std::memory_order_relaxed);
+            if (!frame.message) {
+                return;
+            }
+            auto write_start = std::chrono::steady_clock::now();
+            const voyis::ProcessedImageMessage& msg = *frame.message;
+            voyis::FlightTimer flight_timer(flight.get(), "");
+            flight_timer.setFrameId(msg.image_id, msg.timestamp);
+
+            // Store in database
+            VOYIS_TRACE2(store_start, msg.image_id.c_str(), msg.keypoints.size());
+            voyis::TraceSpan commit_span("commit", msg.image_id);
+            int64_t row_id = 0;
+            bool stored = database.storeProcessedImage(msg, &row_id);
+            commit_span.end();
+            VOYIS_TRACE3(store_done, msg.image_id.c_str(), msg.keypoints.size(), stored ? 1 : 0);
+            if (stored) {
+                ++stored_count;
+                total_keypoints += msg.keypoints.size();
+                stored_stat.store(static_cast<double>(stored_count), std::memory_order_relaxed);
+                keypoints_stat.store(static_cast<double>(total_keypoints),
+                                     std::memory_order_relaxed);
+                if (recent_frames) {
+                    recent_frames->insert(row_id, frame.message);
+                    cached_frames_stat.store(static_cast<double>(recent_frames->size()),
+                                             std::memory_order_relaxed);
+                    cached_bytes_stat.store(static_cast<double>(recent_frames->bytes()),
+                                            std::memory_order_relaxed);
+                }
+            } else {
+                std::cerr << "Failed to store " << msg.image_id << " in database" << std::endl;
+            }
+            batched_stat.store(static_cast<double>(database.batchedFrames()),
+                               std::memory_order_relaxed);
+            flight_timer.finish();
+
+            double writer_ms = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - write_start).count();
+            writer_ms_stat.store(writer_ms, std::memory_order_relaxed);
+            total_writer_ms += writer_ms;
+            ++written_count;
+        };
+
+        std::atomic<bool> receiver_done(false);
+        std::thread receiver(receiveLoop, std::ref(subscriber), std::ref(preparer),
+                             std::ref(receiver_done));
 
         // Main logging loop
+        voyis::PreparedFrame frame;
         while (g_running) {
-            std::vector<uint8_t> raw_data;
+            // Control changes take effect between frames
+            if (tunables.applyPending()) {
+                database.setBatchSize(static_cast<size_t>(tunables.getInt("batch-size")));
+            }
 
-            // Receive processed message
-            if (!subscriber.receive(raw_data)) {
-                // Timeout or no data, continue waiting
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            if (!preparer.next(frame, std::chrono::milliseconds(1000))) {
+                // Timeout or no data: don't keep a partial batch uncommitted
+                database.flush();
+                batched_stat.store(0.0, std::memory_order_relaxed);
+                pending_stat.store(static_cast<double>(preparer.pending()), std::memory_order_relaxed);
                 continue;
             }
+            pending_stat.store(static_cast<double>(preparer.pending()), std::memory_order_relaxed);
 
             try {
-                // Deserialize processed message
-                voyis::ProcessedImageMessage msg =
-                    voyis::ProcessedImageMessage::deserialize(raw_data);
-
-                std::cout << "\nReceived processed image: " << msg.image_id << std::endl;
-                std::cout << "  Dimensions: " << msg.width << "x" << msg.height << std::endl;
-                std::cout << "  Keypoints: " << msg.keypoints.size() << std::endl;
-                std::cout << "  Descriptors: " << msg.descriptors.size() << std::endl;
-
-                // Store in database
-                if (database.storeProcessedImage(msg)) {
-                    ++stored_count;
-                    total_keypoints += msg.keypoints.size();
-                    std::cout << "  Successfully stored in database" << std::endl;
-                } else {
-                    std::cerr << "  Failed to store in database" << std::endl;
-                }
-
+                writeFrame(frame);
             } catch (const std::exception& e) {
                 std::cerr << "Error processing message: " << e.what() << std::endl;
             }
         }
 
+        // Write what was already received; the receiver may be waiting for room
+        while (!receiver_done || preparer.pending() > 0) {
+            if (preparer.next(frame, std::chrono::milliseconds(100))) {
+                try {
+                    writeFrame(frame);
+                } catch (const std::exception& e) {
+                    std::cerr << "Error processing message: " << e.what() << std::endl;
+                }
+            }
+        }
+        receiver.join();
+
+        database.flush();
+
         std::cout << "\nShutdown complete." << std::endl;
         std::cout << "Total images stored: " << stored_count << std::endl;
         std::cout << "Total keypoints stored: " << total_keypoints << std::endl;
+        if (written_count > 0) {
+            std::cout << "Average writer time: " << total_writer_ms / written_count << " ms/frame"
+                      << std::endl;
+        }
+        std::cout << voyis::frameMemoryReport(voyis::PageFaults::now() - steady_faults, stored_count)
+                  << std::endl;
 
         // Print final statistics
         database.printStatistics();
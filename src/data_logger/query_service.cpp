@@ -0,0 +1,314 @@
+#include "query_service.h"
+#include "control.h"
+#include "ipc.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace voyis {
+
+namespace {
+
+// How long a database read waits for the writer's checkpoint
+constexpr int kBusyTimeoutMs = 1000;
+
+// Columns of an images row, in the order the frame queries select them
+constexpr const char* kFrameColumns =
+    "id, image_id, format, width, height, stride, bit_depth, timestamp, "
+    "processed_timestamp, sharpness, brightness, contrast, dark_fraction, "
+    "saturated_fraction, quality_flags, descriptor_dim, stream_id, "
+    "CASE WHEN ?1 THEN image_data END";
+
+/**
+ * @brief Copy of a frame with only the parts the query asked for
+ */
+ProcessedImageMessage copyFrame(const ProcessedImageMessage& source, const FrameQuery& query) {
+    ProcessedImageMessage frame;
+    frame.image_id = source.image_id;
+    frame.stream_id = source.stream_id;
+    frame.format = source.format;
+    frame.width = source.width;
+    frame.height = source.height;
+    frame.stride = source.stride;
+    frame.bit_depth = source.bit_depth;
+    frame.timestamp = source.timestamp;
+    frame.processed_timestamp = source.processed_timestamp;
+    frame.quality = source.quality;
+    frame.descriptor_dim = source.descriptor_dim;
+    if (query.include_image) {
+        frame.image_data = source.image_data;
+    }
+    if (query.include_features) {
+        frame.keypoints = source.keypoints;
+        frame.descriptors = source.descriptors;
+    }
+    return frame;
+}
+
+std::string columnText(sqlite3_stmt* stmt, int column) {
+    const unsigned char* text = sqlite3_column_text(stmt, column);
+    return text ? reinterpret_cast<const char*>(text) : std::string();
+}
+
+} // anonymous namespace
+
+RecentFrameCache::RecentFrameCache(size_t max_frames, size_t max_bytes)
+    : frames_(max_frames, max_bytes) {}
+
+size_t RecentFrameCache::frameBytes(const ProcessedImageMessage& frame) {
+    size_t bytes = frame.image_data.size() + frame.keypoints.size() * sizeof(KeyPoint);
+    for (const auto& descriptor : frame.descriptors) {
+        bytes += descriptor.size() * sizeof(float);
+    }
+    return bytes;
+}
+
+void RecentFrameCache::insert(int64_t row_id, std::shared_ptr<const ProcessedImageMessage> frame) {
+    RecentFrame entry;
+    entry.row_id = row_id;
+    size_t bytes = frameBytes(*frame);
+    if (bytes > frames_.maxBytes()) {
+        // Keep the row in the run; its image and features stay on disk
+        auto metadata = std::make_shared<ProcessedImageMessage>();
+        metadata->image_id = frame->image_id;
+        metadata->stream_id = frame->stream_id;
+        metadata->format = frame->format;
+        metadata->width = frame->width;
+        metadata->height = frame->height;
+        metadata->stride = frame->stride;
+        metadata->bit_depth = frame->bit_depth;
+        metadata->timestamp = frame->timestamp;
+        metadata->processed_timestamp = frame->processed_timestamp;
+        metadata->quality = frame->quality;
+        metadata->descriptor_dim = frame->descriptor_dim;
+        entry.frame = std::move(metadata);
+        entry.complete = false;
+        bytes = 0;
+    } else {
+        entry.frame = std::move(frame);
+    }
+    frames_.insert(row_id, std::make_shared<const RecentFrame>(std::move(entry)), bytes);
+}
+
+RecentFrame RecentFrameCache::find(const std::string& image_id) const {
+    std::shared_ptr<const RecentFrame> entry =
+        frames_.findNewest([&](const RecentFrame& cached) {
+            return cached.frame->image_id == image_id;
+        }).second;
+    return entry ? *entry : RecentFrame();
+}
+
+std::vector<RecentFrame> RecentFrameCache::newest(size_t count) const {
+    std::vector<RecentFrame> frames;
+    for (const auto& entry : frames_.newest(count)) {
+        frames.push_back(*entry.second);
+    }
+    return frames;
+}
+
+QueryService::QueryService(const std::string& endpoint, const RecentFrameCache& cache,
+                           const std::string& db_path, ControlServer* control)
+    : endpoint_(endpoint),
+      cache_(cache),
+      queries_stat_(controlStat(control, "query_requests")),
+      hits_stat_(controlStat(control, "query_cache_hits")),
+      reads_stat_(controlStat(control, "query_database_reads")),
+      query_ms_stat_(controlStat(control, "last_query_ms")) {
+    // A connection of its own, so reads never wait on or disturb the writer
+    int rc = sqlite3_open_v2(db_path.c_str(), &db_, SQLITE_OPEN_READONLY, nullptr);
+    if (rc != SQLITE_OK) {
+        std::string error = sqlite3_errmsg(db_);
+        sqlite3_close(db_);
+        throw std::runtime_error("Failed to open database for queries: " + error);
+    }
+    sqlite3_busy_timeout(db_, kBusyTimeoutMs);
+
+    try {
+        by_image_id_ = prepare((std::string("SELECT ") + kFrameColumns +
+                                " FROM images WHERE image_id = ?2 ORDER BY id DESC LIMIT 1").c_str());
+        by_row_id_ = prepare((std::string("SELECT ") + kFrameColumns +
+                              " FROM images WHERE id = ?2").c_str());
+        newest_before_ = prepare((std::string("SELECT ") + kFrameColumns +
+                                  " FROM images WHERE id < ?2 ORDER BY id DESC LIMIT ?3").c_str());
+        keypoints_ = prepare("SELECT x, y, size, angle, response, octave, descriptor "
+                             "FROM keypoints WHERE image_id = ? ORDER BY id");
+        server_ = std::make_unique<ReplyServer>(
+            endpoint, [this](const std::vector<uint8_t>& request) { return serve(request); });
+    } catch (...) {
+        sqlite3_finalize(by_image_id_);
+        sqlite3_finalize(by_row_id_);
+        sqlite3_finalize(newest_before_);
+        sqlite3_finalize(keypoints_);
+        sqlite3_close(db_);
+        throw;
+    }
+}
+
+QueryService::~QueryService() {
+    server_.reset();
+    sqlite3_finalize(by_image_id_);
+    sqlite3_finalize(by_row_id_);
+    sqlite3_finalize(newest_before_);
+    sqlite3_finalize(keypoints_);
+    sqlite3_close(db_);
+}
+
+sqlite3_stmt* QueryService::prepare(const char* sql) {
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        throw std::runtime_error("Failed to prepare query: " + std::string(sqlite3_errmsg(db_)));
+    }
+    return stmt;
+}
+
+std::vector<uint8_t> QueryService::serve(const std::vector<uint8_t>& request) {
+    FrameQueryReply reply;
+    try {
+        reply = handle(FrameQuery::deserialize(request));
+    } catch (const std::exception& e) {
+        reply.error = std::string("Malformed frame query: ") + e.what();
+    }
+    return reply.serialize();
+}
+
+void QueryService::addCached(const RecentFrame& cached, const FrameQuery& query,
+                             FrameQueryReply& reply) {
+    if (cached.complete || (!query.include_image && !query.include_features)) {
+        reply.frames.push_back(copyFrame(*cached.frame, query));
+        ++reply.cache_hits;
+        return;
+    }
+    sqlite3_bind_int(by_row_id_, 1, query.include_image ? 1 : 0);
+    sqlite3_bind_int64(by_row_id_, 2, cached.row_id);
+    readFrames(by_row_id_, query, reply);
+}
+
+FrameQueryReply QueryService::handle(const FrameQuery& query) {
+    auto start = std::chrono::steady_clock::now();
+    FrameQueryReply reply;
+    queries_stat_.store(static_cast<double>(++queries_), std::memory_order_relaxed);
+
+    try {
+        if (!query.image_id.empty()) {
+            RecentFrame cached = cache_.find(query.image_id);
+            if (cached.frame) {
+                addCached(cached, query, reply);
+            } else {
+                sqlite3_bind_int(by_image_id_, 1, query.include_image ? 1 : 0);
+                sqlite3_bind_text(by_image_id_, 2, query.image_id.c_str(), -1, SQLITE_TRANSIENT);
+                readFrames(by_image_id_, query, reply);
+            }
+            if (reply.frames.empty()) {
+                reply.error = "Frame not found: " + query.image_id;
+            }
+        } else {
+            const size_t count = std::min(query.count, kMaxFrames);
+            int64_t oldest_cached = std::numeric_limits<int64_t>::max();
+            for (const RecentFrame& cached : cache_.newest(count)) {
+                addCached(cached, query, reply);
+                oldest_cached = cached.row_id;
+            }
+            // The cache holds every row since its oldest; older rows are only on disk
+            if (reply.frames.size() < count) {
+                sqlite3_bind_int(newest_before_, 1, query.include_image ? 1 : 0);
+                sqlite3_bind_int64(newest_before_, 2, oldest_cached);
+                sqlite3_bind_int64(newest_before_, 3, static_cast<int64_t>(count - reply.frames.size()));
+                readFrames(newest_before_, query, reply);
+            }
+        }
+    } catch (const std::exception& e) {
+        reply.error = std::string("Database read failed: ") + e.what();
+        reply.frames.clear();
+    }
+
+    hits_ += reply.cache_hits;
+    reads_ += reply.database_reads;
+    hits_stat_.store(static_cast<double>(hits_), std::memory_order_relaxed);
+    reads_stat_.store(static_cast<double>(reads_), std::memory_order_relaxed);
+    query_ms_stat_.store(
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(),
+        std::memory_order_relaxed);
+    return reply;
+}
+
+void QueryService::readFrames(sqlite3_stmt* stmt, const FrameQuery& query, FrameQueryReply& reply) {
+    std::vector<int64_t> row_ids;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        ProcessedImageMessage frame;
+        row_ids.push_back(sqlite3_column_int64(stmt, 0));
+        frame.image_id = columnText(stmt, 1);
+        frame.format = columnText(stmt, 2);
+        frame.width = sqlite3_column_int(stmt, 3);
+        frame.height = sqlite3_column_int(stmt, 4);
+        frame.stride = sqlite3_column_int(stmt, 5);
+        frame.bit_depth = sqlite3_column_int(stmt, 6);
+        frame.timestamp = sqlite3_column_int64(stmt, 7);
+        frame.processed_timestamp = sqlite3_column_int64(stmt, 8);
+        frame.quality.sharpness = static_cast<float>(sqlite3_column_double(stmt, 9));
+        frame.quality.brightness = static_cast<float>(sqlite3_column_double(stmt, 10));
+        frame.quality.contrast = static_cast<float>(sqlite3_column_double(stmt, 11));
+        frame.quality.dark_fraction = static_cast<float>(sqlite3_column_double(stmt, 12));
+        frame.quality.saturated_fraction = static_cast<float>(sqlite3_column_double(stmt, 13));
+        frame.quality.flags = static_cast<uint32_t>(sqlite3_column_int64(stmt, 14));
+        frame.descriptor_dim = static_cast<uint32_t>(sqlite3_column_int64(stmt, 15));
+        frame.stream_id = columnText(stmt, 16);
+        if (query.include_image) {
+            const auto* data = static_cast<const uint8_t*>(sqlite3_column_blob(stmt, 17));
+            frame.image_data.assign(data, data + sqlite3_column_bytes(stmt, 17));
+        }
+        reply.frames.push_back(std::move(frame));
+        ++reply.database_reads;
+    }
+    std::string error = rc == SQLITE_DONE ? std::string() : sqlite3_errmsg(db_);
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    if (!error.empty()) {
+        throw std::runtime_error(error);
+    }
+
+    if (query.include_features) {
+        const size_t first = reply.frames.size() - row_ids.size();
+        for (size_t i = 0; i < row_ids.size(); ++i) {
+            readFeatures(row_ids[i], reply.frames[first + i]);
+        }
+    }
+}
+
+void QueryService::readFeatures(int64_t row_id, ProcessedImageMessage& frame) {
+    sqlite3_bind_int64(keypoints_, 1, row_id);
+    bool has_descriptors = false;
+    int rc;
+    while ((rc = sqlite3_step(keypoints_)) == SQLITE_ROW) {
+        KeyPoint kp;
+        kp.pt.x = static_cast<float>(sqlite3_column_double(keypoints_, 0));
+        kp.pt.y = static_cast<float>(sqlite3_column_double(keypoints_, 1));
+        kp.size = static_cast<float>(sqlite3_column_double(keypoints_, 2));
+        kp.angle = static_cast<float>(sqlite3_column_double(keypoints_, 3));
+        kp.response = static_cast<float>(sqlite3_column_double(keypoints_, 4));
+        kp.octave = sqlite3_column_int(keypoints_, 5);
+        frame.keypoints.push_back(kp);
+
+        const void* blob = sqlite3_column_blob(keypoints_, 6);
+        std::vector<float> descriptor(static_cast<size_t>(sqlite3_column_bytes(keypoints_, 6)) /
+                                      sizeof(float));
+        if (!descriptor.empty()) {
+            std::memcpy(descriptor.data(), blob, descriptor.size() * sizeof(float));
+            has_descriptors = true;
+        }
+        frame.descriptors.push_back(std::move(descriptor));
+    }
+    std::string error = rc == SQLITE_DONE ? std::string() : sqlite3_errmsg(db_);
+    sqlite3_reset(keypoints_);
+    if (!error.empty()) {
+        throw std::runtime_error(error);
+    }
+    // Keypoints-only frames were logged without descriptors
+    if (!has_descriptors) {
+        frame.descriptors.clear();
+    }
+}
+
+} // namespace voyis
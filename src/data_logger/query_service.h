@@ -0,0 +1,140 @@
+#pragma once
+
+#include "message.h"
+#include "bounded_cache.h"
+#include <sqlite3.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace voyis {
+
+class ControlServer;
+class ReplyServer;
+
+/**
+ * @brief A logged frame kept in memory, with the images row it was stored as
+ */
+struct RecentFrame {
+    int64_t row_id = 0;
+    std::shared_ptr<const ProcessedImageMessage> frame; // nullptr if not cached
+    bool complete = true; // false: over the byte budget, only the metadata is cached
+};
+
+/**
+ * @brief In-memory copy of every logged frame since the oldest one it holds
+ *
+ * Frames are kept by row id, so the cache always covers a contiguous run
+ * of the newest rows: a frame larger than max_bytes on its own is kept
+ * without its image and features, marked incomplete, rather than leaving
+ * a hole in the run.
+ */
+class RecentFrameCache {
+public:
+    /**
+     * @throws std::invalid_argument if max_frames is 0
+     */
+    RecentFrameCache(size_t max_frames, size_t max_bytes);
+
+    /**
+     * @brief Add the frame just stored as row_id (row ids must increase)
+     */
+    void insert(int64_t row_id, std::shared_ptr<const ProcessedImageMessage> frame);
+
+    /**
+     * @brief Newest cached frame with this image id (frame is nullptr if none)
+     */
+    RecentFrame find(const std::string& image_id) const;
+
+    /**
+     * @brief Up to count newest frames, newest first
+     */
+    std::vector<RecentFrame> newest(size_t count) const;
+
+    size_t size() const { return frames_.size(); }
+    size_t bytes() const { return frames_.bytes(); }
+    size_t maxFrames() const { return frames_.maxEntries(); }
+    size_t maxBytes() const { return frames_.maxBytes(); }
+
+    /**
+     * @brief Memory a frame is accounted for (image, keypoints and descriptors)
+     */
+    static size_t frameBytes(const ProcessedImageMessage& frame);
+
+private:
+    BoundedCache<int64_t, RecentFrame> frames_;
+};
+
+/**
+ * @brief Serves recent frames to dashboards without touching the writer
+ *
+ * Answers FrameQuery messages on a ZeroMQ REP socket from its own thread:
+ * a frame by image id, or the newest N frames. Frames in the cache are
+ * answered from memory; older ones, and the image or features of frames
+ * too large to cache, are read through a separate read-only SQLite
+ * connection, so queries never use the write connection. Image bytes are
+ * only read when the query asks for them.
+ */
+class QueryService {
+public:
+    /**
+     * @param cache Recent frames, filled by the logging loop
+     * @param db_path Database to fall back to; it must already exist
+     * @param control Where the query counters are reported, or nullptr
+     * @throws std::runtime_error if the endpoint cannot be bound or the database opened
+     */
+    QueryService(const std::string& endpoint, const RecentFrameCache& cache,
+                 const std::string& db_path, ControlServer* control);
+
+    /**
+     * @brief Stops the server thread and closes the read-only connection
+     */
+    ~QueryService();
+
+    QueryService(const QueryService&) = delete;
+    QueryService& operator=(const QueryService&) = delete;
+
+    /**
+     * @brief Answer one query (what the server thread does per message)
+     */
+    FrameQueryReply handle(const FrameQuery& query);
+
+    const std::string& endpoint() const { return endpoint_; }
+
+    /**
+     * @brief Most frames one query returns
+     */
+    static constexpr uint32_t kMaxFrames = 1000;
+
+private:
+    std::vector<uint8_t> serve(const std::vector<uint8_t>& request);
+    sqlite3_stmt* prepare(const char* sql);
+    void addCached(const RecentFrame& cached, const FrameQuery& query, FrameQueryReply& reply);
+    void readFrames(sqlite3_stmt* stmt, const FrameQuery& query, FrameQueryReply& reply);
+    void readFeatures(int64_t row_id, ProcessedImageMessage& frame);
+
+    const std::string endpoint_;
+    const RecentFrameCache& cache_;
+
+    // Read-only connection and its statements, used by the server thread only
+    sqlite3* db_ = nullptr;
+    sqlite3_stmt* by_image_id_ = nullptr;
+    sqlite3_stmt* by_row_id_ = nullptr;
+    sqlite3_stmt* newest_before_ = nullptr;
+    sqlite3_stmt* keypoints_ = nullptr;
+
+    std::atomic<double>& queries_stat_;
+    std::atomic<double>& hits_stat_;
+    std::atomic<double>& reads_stat_;
+    std::atomic<double>& query_ms_stat_;
+    uint64_t queries_ = 0;
+    uint64_t hits_ = 0;
+    uint64_t reads_ = 0;
+
+    std::unique_ptr<ReplyServer> server_; // Last, so it stops before the state it reads
+};
+
+} // namespace voyis
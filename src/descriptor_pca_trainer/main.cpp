@@ -0,0 +1,90 @@
+#include "options.h"
+#include "descriptor_projection.h"
+#include <sqlite3.h>
+#include <opencv2/core.hpp>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+/**
+ * @brief Load a random sample of full SIFT descriptors from a logger database
+ * @return One descriptor per row (CV_32F)
+ */
+cv::Mat loadDescriptors(const std::string& db_path, int max_samples) {
+    const int sift_dim = voyis::DescriptorProjection::kSiftDim;
+    sqlite3* db = nullptr;
+    if (sqlite3_open_v2(db_path.c_str(), &db, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK) {
+        std::string error = db ? sqlite3_errmsg(db) : "out of memory";
+        sqlite3_close(db);
+        throw std::runtime_error("Failed to open database: " + error);
+    }
+
+    // Blob length selects unreduced descriptors, so PCA output is never retrained on
+    const char* sql =
+        "SELECT descriptor FROM keypoints WHERE length(descriptor) = ? "
+        "ORDER BY RANDOM() LIMIT ?";
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        std::string error = sqlite3_errmsg(db);
+        sqlite3_close(db);
+        throw std::runtime_error("Failed to prepare statement: " + error);
+    }
+    sqlite3_bind_int(stmt, 1, sift_dim * static_cast<int>(sizeof(float)));
+    sqlite3_bind_int(stmt, 2, max_samples);
+
+    cv::Mat samples(0, sift_dim, CV_32F);
+    samples.reserve(static_cast<size_t>(max_samples));
+    cv::Mat row(1, sift_dim, CV_32F);
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        std::memcpy(row.data, sqlite3_column_blob(stmt, 0), sift_dim * sizeof(float));
+        samples.push_back(row);
+    }
+
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+    return samples;
+}
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " <database> <output.yml> [--dim=32] [--max-samples=200000]"
+              << std::endl;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    try {
+        voyis::Options options(argc, argv);
+        if (options.positional().size() != 2) {
+            printUsage(argv[0]);
+            return 1;
+        }
+
+        const std::string db_path = options.positional()[0];
+        const std::string output_path = options.positional()[1];
+        int output_dim = static_cast<int>(options.getInt("dim", 32));
+        int max_samples = static_cast<int>(options.getInt("max-samples", 200000));
+
+        std::cout << "Loading up to " << max_samples << " descriptors from " << db_path << std::endl;
+        cv::Mat samples = loadDescriptors(db_path, max_samples);
+        std::cout << "Loaded " << samples.rows << " descriptors" << std::endl;
+
+        double explained = 0.0;
+        voyis::DescriptorProjection projection =
+            voyis::DescriptorProjection::train(samples, output_dim, &explained);
+        projection.save(output_path, explained);
+
+        std::cout << "Projection " << projection.inputDim() << " -> " << projection.outputDim()
+                  << " dimensions keeps " << explained * 100.0 << "% of the variance" << std::endl;
+        std::cout << "Written to " << output_path << std::endl;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
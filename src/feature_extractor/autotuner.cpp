@@ -0,0 +1,291 @@
+#include "autotuner.h"
+#include <unistd.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace voyis {
+
+namespace {
+
+// Frames estimated below this are scored as this many megapixels
+constexpr double kMinCost = 0.01;
+
+/**
+ * @brief mean + latency_weight * p99 of the samples
+ */
+double scoreOf(std::vector<double> samples, double latency_weight, double* mean_out) {
+    double sum = 0.0;
+    for (double sample : samples) {
+        sum += sample;
+    }
+    double mean = sum / static_cast<double>(samples.size());
+    std::sort(samples.begin(), samples.end());
+    size_t p99_index = static_cast<size_t>(std::ceil(0.99 * static_cast<double>(samples.size()))) - 1;
+    *mean_out = mean;
+    return mean + latency_weight * samples[p99_index];
+}
+
+size_t indexOf(const std::vector<int>& values, int value) {
+    return static_cast<size_t>(std::find(values.begin(), values.end(), value) - values.begin());
+}
+
+} // anonymous namespace
+
+Autotuner::Autotuner(std::vector<TuningKnob> knobs, const Setting& initial,
+                     const AutotunerConfig& config)
+    : knobs_(std::move(knobs)), config_(config) {
+    if (initial.size() != knobs_.size()) {
+        throw std::invalid_argument("Autotuner needs one initial value per knob");
+    }
+    for (const TuningKnob& knob : knobs_) {
+        if (knob.values.empty()) {
+            throw std::invalid_argument("Autotuner knob without values: " + knob.name);
+        }
+    }
+    if (config_.frames_per_trial == 0) {
+        config_.frames_per_trial = 1;
+    }
+
+    Setting start = snap(initial);
+    for (ClassState& state : classes_) {
+        state.best = start;
+        state.trial = start;
+    }
+}
+
+Autotuner::Setting Autotuner::snap(const Setting& setting) const {
+    Setting snapped(knobs_.size());
+    for (size_t i = 0; i < knobs_.size(); ++i) {
+        const std::vector<int>& values = knobs_[i].values;
+        snapped[i] = *std::min_element(values.begin(), values.end(), [&](int a, int b) {
+            return std::abs(a - setting[i]) < std::abs(b - setting[i]);
+        });
+    }
+    return snapped;
+}
+
+const Autotuner::Setting& Autotuner::select(FrameSizeClass size_class) const {
+    return classes_[static_cast<size_t>(size_class)].trial;
+}
+
+bool Autotuner::record(FrameSizeClass size_class, double cost, double ms) {
+    ClassState& state = classes_[static_cast<size_t>(size_class)];
+    if (state.converged) {
+        return false;
+    }
+
+    double sample = ms / std::max(cost, kMinCost);
+    state.samples.push_back(sample);
+
+    // Abandon a setting as soon as it is clearly worse
+    if (state.measured && sample > config_.abort_factor * state.best_mean) {
+        state.samples.clear();
+        advance(state);
+        nextTrial(state);
+        return state.converged;
+    }
+    if (state.samples.size() < config_.frames_per_trial) {
+        return false;
+    }
+
+    double mean = 0.0;
+    double score = scoreOf(state.samples, config_.latency_weight, &mean);
+    state.samples.clear();
+    if (!state.measured) {
+        state.best_score = score;
+        state.best_mean = mean;
+        state.measured = true;
+    } else if (score < state.best_score * (1.0 - config_.min_improvement)) {
+        // Adopt and keep moving the same knob in the same direction
+        state.best = state.trial;
+        state.best_score = score;
+        state.best_mean = mean;
+        state.moved = true;
+        state.improved = true;
+    } else {
+        advance(state);
+    }
+    nextTrial(state);
+    return state.converged;
+}
+
+void Autotuner::advance(ClassState& state) {
+    if (state.direction == 1 && !state.moved) {
+        state.direction = -1;
+    } else {
+        // Moving up paid off, so the value below is known to be worse
+        state.direction = 1;
+        state.moved = false;
+        ++state.knob;
+    }
+}
+
+void Autotuner::nextTrial(ClassState& state) {
+    for (;;) {
+        if (state.knob >= knobs_.size()) {
+            if (!state.improved) {
+                state.converged = true;
+                state.trial = state.best;
+                return;
+            }
+            state.knob = 0;
+            state.direction = 1;
+            state.moved = false;
+            state.improved = false;
+        }
+
+        const std::vector<int>& values = knobs_[state.knob].values;
+        size_t index = indexOf(values, state.best[state.knob]);
+        if (state.direction > 0 ? index + 1 < values.size() : index > 0) {
+            state.trial = state.best;
+            state.trial[state.knob] = values[state.direction > 0 ? index + 1 : index - 1];
+            return;
+        }
+        advance(state);
+    }
+}
+
+bool Autotuner::converged(FrameSizeClass size_class) const {
+    return classes_[static_cast<size_t>(size_class)].converged;
+}
+
+const Autotuner::Setting& Autotuner::best(FrameSizeClass size_class) const {
+    return classes_[static_cast<size_t>(size_class)].best;
+}
+
+double Autotuner::bestScore(FrameSizeClass size_class) const {
+    return classes_[static_cast<size_t>(size_class)].best_score;
+}
+
+std::string Autotuner::describe(const Setting& setting) const {
+    std::string text;
+    for (size_t i = 0; i < knobs_.size(); ++i) {
+        text += (i > 0 ? " " : "") + knobs_[i].name + "=" + std::to_string(setting[i]);
+    }
+    return text;
+}
+
+void Autotuner::save(const std::string& path, const std::string& host) const {
+    std::ostringstream profile;
+    profile << "# feature_extractor autotune profile\n";
+    profile << "host " << host << "\n";
+    profile << "knobs";
+    for (const TuningKnob& knob : knobs_) {
+        profile << " " << knob.name;
+    }
+    profile << "\n";
+    for (size_t i = 0; i < classes_.size(); ++i) {
+        const ClassState& state = classes_[i];
+        if (!state.measured) {
+            continue;
+        }
+        profile << "class " << frameSizeClassName(static_cast<FrameSizeClass>(i));
+        for (int value : state.best) {
+            profile << " " << value;
+        }
+        profile << " score " << state.best_score << " mean " << state.best_mean
+                << " converged " << (state.converged ? 1 : 0) << "\n";
+    }
+
+    // Written under a temporary name so a crash never leaves half a profile
+    std::string temp_path = path + ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::trunc);
+        std::string text = profile.str();
+        if (!file || !file.write(text.data(), static_cast<std::streamsize>(text.size()))) {
+            throw std::runtime_error("Failed to write autotune profile: " + temp_path);
+        }
+    }
+    if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+        std::remove(temp_path.c_str());
+        throw std::runtime_error("Failed to write autotune profile: " + path);
+    }
+}
+
+size_t Autotuner::load(const std::string& path, const std::string& host) {
+    std::ifstream file(path);
+    if (!file) {
+        return 0;
+    }
+
+    std::string line;
+    bool host_matches = false;
+    bool knobs_match = false;
+    size_t loaded = 0;
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        std::string key;
+        fields >> key;
+        if (key == "host") {
+            std::string saved_host;
+            fields >> saved_host;
+            host_matches = saved_host == host;
+        } else if (key == "knobs") {
+            std::vector<std::string> names;
+            std::string name;
+            while (fields >> name) {
+                names.push_back(name);
+            }
+            knobs_match = names.size() == knobs_.size();
+            for (size_t i = 0; knobs_match && i < names.size(); ++i) {
+                knobs_match = names[i] == knobs_[i].name;
+            }
+        } else if (key == "class" && host_matches && knobs_match) {
+            std::string class_name;
+            fields >> class_name;
+            Setting setting(knobs_.size());
+            for (int& value : setting) {
+                fields >> value;
+            }
+            std::string label;
+            double score = 0.0;
+            double mean = 0.0;
+            int converged = 0;
+            fields >> label >> score >> label >> mean >> label >> converged;
+            if (!fields) {
+                continue;
+            }
+
+            for (size_t i = 0; i < classes_.size(); ++i) {
+                if (class_name != frameSizeClassName(static_cast<FrameSizeClass>(i))) {
+                    continue;
+                }
+                ClassState& state = classes_[i];
+                state = ClassState();
+                state.best = snap(setting);
+                state.trial = state.best;
+                // An unfinished class measures its saved setting again before exploring
+                if (converged) {
+                    state.best_score = score;
+                    state.best_mean = mean;
+                    state.measured = true;
+                    state.converged = true;
+                }
+                ++loaded;
+            }
+        }
+    }
+    return loaded;
+}
+
+std::string autotuneHostName() {
+    char name[256] = {};
+    if (gethostname(name, sizeof(name) - 1) != 0 || name[0] == '\0') {
+        return "localhost";
+    }
+    return name;
+}
+
+std::string defaultAutotuneProfile(const std::string& host) {
+    return "extractor_autotune_" + host + ".txt";
+}
+
+std::string defaultTiledAutotuneProfile(const std::string& host) {
+    return "extractor_autotune_tiled_" + host + ".txt";
+}
+
+} // namespace voyis
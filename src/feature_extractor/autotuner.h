@@ -0,0 +1,139 @@
+#pragma once
+
+#include "frame_queue.h"
+#include <array>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace voyis {
+
+/**
+ * @brief One setting explored by the autotuner
+ */
+struct TuningKnob {
+    std::string name;        // e.g. "opencv-threads"
+    std::vector<int> values; // Allowed values in increasing order
+};
+
+/**
+ * @brief Autotuner parameters
+ */
+struct AutotunerConfig {
+    size_t frames_per_trial = 20;  // Frames measured per candidate setting
+    double latency_weight = 0.5;   // Weight of the p99 against the mean in the score
+    double min_improvement = 0.03; // Relative gain a neighbour needs to be adopted
+    double abort_factor = 3.0;     // A trial frame this much slower than the best mean ends the trial
+};
+
+/**
+ * @brief Hill-climbing tuner of processing settings on live traffic
+ *
+ * Each frame size class is tuned on its own. A class first measures its
+ * starting setting, then tries the neighbouring value of one knob at a time
+ * (next larger, then next smaller) for frames_per_trial frames and adopts it
+ * when its score improves by min_improvement. The score of a setting is
+ * mean + latency_weight * p99 of the processing time per megapixel, so
+ * frames of different sizes within a class are comparable and a setting
+ * that helps throughput but hurts the tail is not picked. A class has
+ * converged after a pass over all knobs adopts nothing.
+ *
+ * Only values listed in a knob are ever tried, and a trial is abandoned
+ * as soon as one of its frames is abort_factor times slower than the best
+ * setting's mean, so exploration stays within safe bounds. Not thread-safe.
+ */
+class Autotuner {
+public:
+    using Setting = std::vector<int>; // One value per knob
+
+    /**
+     * @param initial Starting value per knob, snapped to the nearest allowed value
+     * @throws std::invalid_argument if a knob has no values or initial has the wrong size
+     */
+    Autotuner(std::vector<TuningKnob> knobs, const Setting& initial,
+              const AutotunerConfig& config = AutotunerConfig());
+
+    /**
+     * @brief Setting to use for the next frame of a size class
+     */
+    const Setting& select(FrameSizeClass size_class) const;
+
+    /**
+     * @brief Report the processing time of a frame run with select()'s setting
+     * @param cost Estimated frame cost in megapixels (estimateFrameCost())
+     * @return true if the class converged with this frame
+     */
+    bool record(FrameSizeClass size_class, double cost, double ms);
+
+    bool converged(FrameSizeClass size_class) const;
+    const Setting& best(FrameSizeClass size_class) const;
+
+    /**
+     * @brief Best score of a class in ms per megapixel (0 before it is measured)
+     */
+    double bestScore(FrameSizeClass size_class) const;
+
+    /**
+     * @brief e.g. "opencv-threads=4 tile-size=2048"
+     */
+    std::string describe(const Setting& setting) const;
+
+    /**
+     * @brief Write the best setting of every measured class
+     * @throws std::runtime_error if the file cannot be written
+     */
+    void save(const std::string& path, const std::string& host) const;
+
+    /**
+     * @brief Start from a saved profile; converged classes stop exploring
+     *
+     * Profiles of another host or with other knobs are ignored.
+     * @return Number of size classes loaded
+     */
+    size_t load(const std::string& path, const std::string& host);
+
+    const std::vector<TuningKnob>& knobs() const { return knobs_; }
+
+private:
+    struct ClassState {
+        Setting best;
+        double best_score = 0.0;
+        double best_mean = 0.0;
+        bool measured = false;  // best_score is known
+        bool converged = false;
+        Setting trial;
+        std::vector<double> samples; // ms per megapixel of the current trial
+        size_t knob = 0;
+        int direction = 1;
+        bool moved = false;          // The current knob adopted a neighbour
+        bool improved = false;       // Something was adopted in this pass
+    };
+
+    // Move to the next neighbour of the best setting, or converge
+    void nextTrial(ClassState& state);
+
+    // Give up on the current knob direction
+    static void advance(ClassState& state);
+    Setting snap(const Setting& setting) const;
+
+    std::vector<TuningKnob> knobs_;
+    AutotunerConfig config_;
+    std::array<ClassState, kNumFrameSizeClasses> classes_;
+};
+
+/**
+ * @brief Host name used to key saved profiles
+ */
+std::string autotuneHostName();
+
+/**
+ * @brief Default profile path: extractor_autotune_<host>.txt
+ */
+std::string defaultAutotuneProfile(const std::string& host);
+
+/**
+ * @brief Default profile path of huge TIFF frames: extractor_autotune_tiled_<host>.txt
+ */
+std::string defaultTiledAutotuneProfile(const std::string& host);
+
+} // namespace voyis
@@ -0,0 +1,101 @@
+#include "descriptor_projection.h"
+#include <stdexcept>
+#include <string>
+
+namespace voyis {
+
+DescriptorProjection::DescriptorProjection(const cv::Mat& mean, const cv::Mat& components) {
+    if (components.empty() || mean.total() != static_cast<size_t>(components.cols) ||
+        components.rows > components.cols) {
+        throw std::invalid_argument("PCA mean and components have inconsistent shapes");
+    }
+
+    mean.reshape(1, 1).convertTo(mean_, CV_32F);
+    components.convertTo(components_, CV_32F);
+
+    // Fold the mean into a per-row offset: (d - m) * W^T = d * W^T - m * W^T
+    cv::gemm(mean_, components_, -1.0, cv::noArray(), 0.0, offset_, cv::GEMM_2_T);
+}
+
+DescriptorProjection DescriptorProjection::train(const cv::Mat& samples, int output_dim,
+                                                 double* explained_variance) {
+    if (output_dim <= 0 || samples.rows < output_dim || output_dim > samples.cols) {
+        throw std::invalid_argument("Need at least " + std::to_string(output_dim) +
+                                    " training descriptors of at least that many dimensions");
+    }
+
+    cv::Mat data;
+    samples.convertTo(data, CV_32F);
+    cv::PCA pca(data, cv::noArray(), cv::PCA::DATA_AS_ROW, output_dim);
+
+    if (explained_variance) {
+        // Eigenvalues are variances along the kept components
+        cv::Mat centered = data - cv::repeat(pca.mean, data.rows, 1);
+        double total = cv::norm(centered, cv::NORM_L2SQR) / data.rows;
+        *explained_variance = total > 0.0 ? cv::sum(pca.eigenvalues)[0] / total : 0.0;
+    }
+
+    return DescriptorProjection(pca.mean, pca.eigenvectors);
+}
+
+DescriptorProjection DescriptorProjection::load(const std::string& path, int input_dim) {
+    cv::FileStorage file(path, cv::FileStorage::READ);
+    if (!file.isOpened()) {
+        throw std::runtime_error("Cannot open PCA projection: " + path);
+    }
+
+    cv::Mat mean;
+    cv::Mat components;
+    file["mean"] >> mean;
+    file["components"] >> components;
+    if (mean.empty() || components.empty()) {
+        throw std::runtime_error("PCA projection is missing mean or components: " + path);
+    }
+
+    try {
+        DescriptorProjection projection(mean, components);
+        // Caught here rather than on the first frame's descriptors
+        if (projection.inputDim() != input_dim) {
+            throw std::invalid_argument("PCA projection expects " +
+                                        std::to_string(projection.inputDim()) +
+                                        "-dimensional descriptors, not " + std::to_string(input_dim));
+        }
+        return projection;
+    } catch (const std::invalid_argument& e) {
+        throw std::runtime_error(std::string(e.what()) + ": " + path);
+    }
+}
+
+void DescriptorProjection::save(const std::string& path, double explained_variance) const {
+    cv::FileStorage file(path, cv::FileStorage::WRITE);
+    if (!file.isOpened()) {
+        throw std::runtime_error("Cannot write PCA projection: " + path);
+    }
+
+    file << "input_dim" << inputDim();
+    file << "output_dim" << outputDim();
+    file << "explained_variance" << explained_variance;
+    file << "mean" << mean_;
+    file << "components" << components_;
+}
+
+cv::Mat DescriptorProjection::project(const cv::Mat& descriptors) const {
+    if (descriptors.empty()) {
+        return cv::Mat(0, outputDim(), CV_32F);
+    }
+    if (descriptors.cols != inputDim() || descriptors.type() != CV_32F) {
+        throw std::invalid_argument("Expected " + std::to_string(inputDim()) +
+                                    "-dimensional float descriptors, got " +
+                                    std::to_string(descriptors.cols));
+    }
+
+    cv::Mat projected;
+    cv::gemm(descriptors, components_, 1.0, cv::noArray(), 0.0, projected, cv::GEMM_2_T);
+    for (int i = 0; i < projected.rows; ++i) {
+        cv::Mat row = projected.row(i);
+        row += offset_;
+    }
+    return projected;
+}
+
+} // namespace voyis
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <string>
+
+namespace voyis {
+
+/**
+ * @brief Linear PCA projection of descriptors to fewer dimensions
+ *
+ * Maps each row d of a descriptor matrix to (d - mean) * components^T, so
+ * 128-dimensional SIFT descriptors become 32 or 64 floats that keep most of
+ * their variance. Projection files are OpenCV FileStorage documents (YAML
+ * or XML) written by save() or the descriptor_pca_trainer tool.
+ */
+class DescriptorProjection {
+public:
+    /**
+     * @brief Length of a SIFT descriptor, what the extractor projects
+     */
+    static constexpr int kSiftDim = 128;
+
+    /**
+     * @param mean 1 x input_dim mean of the training descriptors
+     * @param components output_dim x input_dim principal components, one per row
+     * @throws std::invalid_argument if the shapes do not match
+     */
+    DescriptorProjection(const cv::Mat& mean, const cv::Mat& components);
+
+    /**
+     * @brief Learn a projection from training descriptors (one per row)
+     * @param explained_variance Optional output for the fraction of variance kept
+     * @throws std::invalid_argument if there are fewer samples than output dimensions
+     */
+    static DescriptorProjection train(const cv::Mat& samples, int output_dim,
+                                      double* explained_variance = nullptr);
+
+    /**
+     * @brief Load a projection file
+     * @param input_dim Descriptor length the projection must accept
+     * @throws std::runtime_error if the file is missing or malformed, or was
+     *         trained on descriptors of another length
+     */
+    static DescriptorProjection load(const std::string& path, int input_dim = kSiftDim);
+
+    /**
+     * @brief Write the projection to a file (format from the extension)
+     * @param explained_variance Stored for reference, not used when loading
+     */
+    void save(const std::string& path, double explained_variance = 0.0) const;
+
+    /**
+     * @brief Project descriptors (N x inputDim(), CV_32F) to N x outputDim()
+     *
+     * Runs as one matrix product (cv::gemm, which uses OpenCV's vectorized
+     * or BLAS kernels) over all descriptors of a frame.
+     *
+     * @throws std::invalid_argument if the descriptors have the wrong width
+     */
+    cv::Mat project(const cv::Mat& descriptors) const;
+
+    int inputDim() const { return components_.cols; }
+    int outputDim() const { return components_.rows; }
+
+private:
+    cv::Mat mean_;       // 1 x input_dim
+    cv::Mat components_; // output_dim x input_dim
+    cv::Mat offset_;     // 1 x output_dim, -mean * components^T
+};
+
+} // namespace voyis
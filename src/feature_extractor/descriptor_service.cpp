@@ -0,0 +1,133 @@
+#include "descriptor_service.h"
+#include "control.h"
+#include "ipc.h"
+#include <chrono>
+#include <stdexcept>
+
+namespace voyis {
+
+FrameCache::FrameCache(size_t max_frames, size_t max_bytes) : frames_(max_frames, max_bytes) {}
+
+void FrameCache::insert(const std::string& image_id, CachedFrame frame) {
+    if (frame.bytes() > frames_.maxBytes()) {
+        return;
+    }
+    // Raw frames wrap the message payload, which is gone after publishing
+    if (!frame.image.u) {
+        frame.image = frame.image.clone();
+    }
+    const size_t bytes = frame.bytes();
+    frames_.insert(image_id, std::make_shared<const CachedFrame>(std::move(frame)), bytes);
+}
+
+bool FrameCache::alias(const std::string& image_id, const std::string& source_id) {
+    std::shared_ptr<const CachedFrame> source = find(source_id);
+    if (!source) {
+        return false;
+    }
+    const size_t bytes = source->bytes();
+    frames_.insert(image_id, std::move(source), bytes);
+    return true;
+}
+
+std::shared_ptr<const CachedFrame> FrameCache::find(const std::string& image_id) const {
+    return frames_.find(image_id);
+}
+
+DescriptorService::DescriptorService(const std::string& endpoint, const FrameCache& cache,
+                                     const DescriptorProjection* projection,
+                                     ControlServer* control)
+    : endpoint_(endpoint),
+      cache_(cache),
+      projection_(projection),
+      requests_stat_(controlStat(control, "descriptor_requests")),
+      misses_stat_(controlStat(control, "descriptor_cache_misses")),
+      compute_ms_stat_(controlStat(control, "last_descriptor_ms")) {
+    server_ = std::make_unique<ReplyServer>(
+        endpoint, [this](const std::vector<uint8_t>& request) { return serve(request); });
+}
+
+DescriptorService::~DescriptorService() = default;
+
+std::vector<uint8_t> DescriptorService::serve(const std::vector<uint8_t>& request) {
+    DescriptorReply reply;
+    try {
+        reply = handle(DescriptorRequest::deserialize(request));
+    } catch (const std::exception& e) {
+        reply.error = std::string("Malformed descriptor request: ") + e.what();
+    }
+    return reply.serialize();
+}
+
+DescriptorReply DescriptorService::handle(const DescriptorRequest& request) {
+    DescriptorReply reply;
+    reply.image_id = request.image_id;
+    requests_stat_.store(static_cast<double>(++requests_), std::memory_order_relaxed);
+
+    std::shared_ptr<const CachedFrame> frame = cache_.find(request.image_id);
+    if (!frame) {
+        misses_stat_.store(static_cast<double>(++misses_), std::memory_order_relaxed);
+        reply.error = "Frame not cached: " + request.image_id;
+        return reply;
+    }
+    reply.found = true;
+
+    std::vector<cv::KeyPoint> keypoints;
+    if (request.keypoint_indices.empty()) {
+        keypoints = frame->keypoints;
+        reply.keypoint_indices.resize(keypoints.size());
+        for (size_t i = 0; i < keypoints.size(); ++i) {
+            reply.keypoint_indices[i] = static_cast<uint32_t>(i);
+        }
+    } else {
+        keypoints.reserve(request.keypoint_indices.size());
+        for (uint32_t index : request.keypoint_indices) {
+            if (index >= frame->keypoints.size()) {
+                reply.error = "Keypoint index " + std::to_string(index) + " out of range (frame has " +
+                              std::to_string(frame->keypoints.size()) + " keypoints)";
+                reply.keypoint_indices.clear();
+                return reply;
+            }
+            keypoints.push_back(frame->keypoints[index]);
+        }
+        reply.keypoint_indices = request.keypoint_indices;
+    }
+    if (keypoints.empty()) {
+        return reply;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    cv::Mat descriptors;
+    try {
+        frame->detector->compute(frame->image, keypoints, descriptors);
+    } catch (const cv::Exception& e) {
+        reply.error = std::string("Descriptor computation failed: ") + e.what();
+        reply.keypoint_indices.clear();
+        return reply;
+    }
+    // The detector found these keypoints, so it keeps all of them
+    if (descriptors.rows != static_cast<int>(reply.keypoint_indices.size())) {
+        reply.error = "Detector dropped keypoints while computing descriptors";
+        reply.keypoint_indices.clear();
+        return reply;
+    }
+    if (descriptors.depth() != CV_32F) {
+        descriptors.convertTo(descriptors, CV_32F);
+    }
+    if (projection_) {
+        descriptors = projection_->project(descriptors);
+    }
+    compute_ms_stat_.store(
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(),
+        std::memory_order_relaxed);
+
+    reply.descriptor_dim = static_cast<uint32_t>(descriptors.cols);
+    reply.descriptors.resize(static_cast<size_t>(descriptors.rows));
+    for (int i = 0; i < descriptors.rows; ++i) {
+        const float* row = descriptors.ptr<float>(i);
+        reply.descriptors[static_cast<size_t>(i)].assign(row, row + descriptors.cols);
+    }
+    return reply;
+}
+
+} // namespace voyis
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "message.h"
+#include "bounded_cache.h"
+#include "descriptor_projection.h"
+#include <opencv2/core.hpp>
+#include <opencv2/features2d.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace voyis {
+
+class ControlServer;
+class ReplyServer;
+
+/**
+ * @brief A frame published with keypoints only, kept so descriptors can be computed later
+ */
+struct CachedFrame {
+    cv::Mat image;                       // Full-resolution 8-bit grayscale, as detected
+    std::vector<cv::KeyPoint> keypoints; // In published order, with the detector's octave data
+    cv::Ptr<cv::Feature2D> detector;     // Computes descriptors with the detection settings
+
+    size_t bytes() const { return image.total() * image.elemSize(); }
+};
+
+/**
+ * @brief Bounded cache of the most recently processed frames
+ *
+ * Holds up to max_frames frames and max_bytes of image data; the oldest
+ * frames are evicted first. Images that wrap memory owned by someone else
+ * (raw pixels over the message payload) are copied on insertion, decoded
+ * images are shared. Thread-safe: the processing loop inserts while the
+ * descriptor service looks frames up.
+ */
+class FrameCache {
+public:
+    /**
+     * @throws std::invalid_argument if max_frames is 0
+     */
+    FrameCache(size_t max_frames, size_t max_bytes);
+
+    /**
+     * @brief Add a frame, evicting old ones to stay within the limits
+     *
+     * A frame larger than max_bytes on its own is not cached.
+     */
+    void insert(const std::string& image_id, CachedFrame frame);
+
+    /**
+     * @brief Make image_id refer to the cached frame source_id (near-duplicates reuse its keypoints)
+     * @return false if source_id is not cached
+     */
+    bool alias(const std::string& image_id, const std::string& source_id);
+
+    /**
+     * @brief Cached frame, or nullptr; the frame stays valid after it is evicted
+     */
+    std::shared_ptr<const CachedFrame> find(const std::string& image_id) const;
+
+    size_t size() const { return frames_.size(); }
+    size_t bytes() const { return frames_.bytes(); }
+    size_t maxFrames() const { return frames_.maxEntries(); }
+    size_t maxBytes() const { return frames_.maxBytes(); }
+
+private:
+    // Aliases count the full frame, so the budget is never exceeded
+    BoundedCache<std::string, CachedFrame> frames_;
+};
+
+/**
+ * @brief Computes descriptors on request for frames published with keypoints only
+ *
+ * Serves DescriptorRequest messages on a ZeroMQ REP socket from its own
+ * thread. Descriptors are computed from the cached frame with the detector
+ * that found its keypoints, for all keypoints or the requested subset, and
+ * reduced with the PCA projection if the extractor uses one. Frames nobody
+ * asks about never pay for descriptors.
+ */
+class DescriptorService {
+public:
+    /**
+     * @param projection PCA applied to the descriptors, or nullptr; must outlive the service
+     * @param control Where the request counters are reported, or nullptr
+     * @throws std::runtime_error if the endpoint cannot be bound
+     */
+    DescriptorService(const std::string& endpoint, const FrameCache& cache,
+                      const DescriptorProjection* projection, ControlServer* control);
+
+    /**
+     * @brief Stops the server thread
+     */
+    ~DescriptorService();
+
+    DescriptorService(const DescriptorService&) = delete;
+    DescriptorService& operator=(const DescriptorService&) = delete;
+
+    /**
+     * @brief Answer one request (what the server thread does per message)
+     */
+    DescriptorReply handle(const DescriptorRequest& request);
+
+    const std::string& endpoint() const { return endpoint_; }
+
+private:
+    std::vector<uint8_t> serve(const std::vector<uint8_t>& request);
+
+    const std::string endpoint_;
+    const FrameCache& cache_;
+    const DescriptorProjection* projection_;
+
+    std::atomic<double>& requests_stat_;
+    std::atomic<double>& misses_stat_;
+    std::atomic<double>& compute_ms_stat_;
+    uint64_t requests_ = 0;
+    uint64_t misses_ = 0;
+
+    std::unique_ptr<ReplyServer> server_; // Last, so it stops before the state it reads
+};
+
+} // namespace voyis
@@ -0,0 +1,52 @@
+#include "duplicate_filter.h"
+#include <opencv2/imgproc.hpp>
+#include <bitset>
+#include <stdexcept>
+
+namespace voyis {
+
+uint64_t computeDHash(const cv::Mat& gray) {
+    if (gray.empty() || gray.type() != CV_8UC1) {
+        throw std::invalid_argument("dHash requires a non-empty 8-bit grayscale image");
+    }
+
+    cv::Mat small;
+    cv::resize(gray, small, cv::Size(9, 8), 0, 0, cv::INTER_AREA);
+
+    uint64_t hash = 0;
+    for (int y = 0; y < 8; ++y) {
+        const uint8_t* row = small.ptr<uint8_t>(y);
+        for (int x = 0; x < 8; ++x) {
+            hash = (hash << 1) | (row[x] > row[x + 1] ? 1u : 0u);
+        }
+    }
+    return hash;
+}
+
+int hammingDistance(uint64_t a, uint64_t b) {
+    return static_cast<int>(std::bitset<64>(a ^ b).count());
+}
+
+DuplicateFilter::DuplicateFilter(int max_distance)
+    : max_distance_(max_distance), skipped_(0) {}
+
+const FrameFeatures* DuplicateFilter::findDuplicate(
+    const std::string& stream_id, uint64_t hash,
+    const std::function<bool(const FrameFeatures&)>& usable) {
+    auto it = streams_.find(stream_id);
+    if (it == streams_.end() || hammingDistance(it->second.hash, hash) > max_distance_) {
+        return nullptr;
+    }
+    if (usable && !usable(it->second.features)) {
+        return nullptr;
+    }
+
+    ++skipped_;
+    return &it->second.features;
+}
+
+void DuplicateFilter::remember(const std::string& stream_id, uint64_t hash, FrameFeatures features) {
+    streams_[stream_id] = StreamState{hash, std::move(features)};
+}
+
+} // namespace voyis
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "message.h"
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace voyis {
+
+/**
+ * @brief 64-bit difference hash (dHash) of a grayscale image
+ *
+ * The image is shrunk to 9x8 pixels and each bit records whether a pixel is
+ * brighter than its right neighbour. Small changes in noise or exposure
+ * flip only a few bits, so near-identical frames have a small Hamming
+ * distance.
+ */
+uint64_t computeDHash(const cv::Mat& gray);
+
+/**
+ * @brief Number of differing bits between two hashes
+ */
+int hammingDistance(uint64_t a, uint64_t b);
+
+/**
+ * @brief Features computed for a frame, kept so that near-duplicates can reuse them
+ */
+struct FrameFeatures {
+    std::string image_id;
+    int width = 0;
+    int height = 0;
+    std::vector<KeyPoint> keypoints;
+    std::vector<std::vector<float>> descriptors;
+};
+
+/**
+ * @brief Skips feature extraction for frames nearly identical to the previous one
+ *
+ * Keeps the hash and features of the last processed frame of each stream.
+ * A new frame within max_distance bits of it reuses those features instead
+ * of running SIFT again. The reference is only replaced when a frame is
+ * actually processed, so slow drift eventually triggers a fresh extraction.
+ * Not thread-safe; used from the processing loop only.
+ */
+class DuplicateFilter {
+public:
+    explicit DuplicateFilter(int max_distance);
+
+    /**
+     * @brief Look up the previous features of a stream
+     * @param usable If given, features it rejects are not reused (nor counted as skipped)
+     * @return Features to reuse, or nullptr if the frame is not a near-duplicate
+     */
+    const FrameFeatures* findDuplicate(
+        const std::string& stream_id, uint64_t hash,
+        const std::function<bool(const FrameFeatures&)>& usable = nullptr);
+
+    /**
+     * @brief Record the features of a frame that was processed
+     */
+    void remember(const std::string& stream_id, uint64_t hash, FrameFeatures features);
+
+    /**
+     * @brief Number of frames that reused previous features
+     */
+    uint64_t skipped() const { return skipped_; }
+
+    int maxDistance() const { return max_distance_; }
+
+private:
+    struct StreamState {
+        uint64_t hash;
+        FrameFeatures features;
+    };
+
+    int max_distance_;
+    std::map<std::string, StreamState> streams_;
+    uint64_t skipped_;
+};
+
+} // namespace voyis
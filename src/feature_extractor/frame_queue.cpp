@@ -0,0 +1,228 @@
+#include "frame_queue.h"
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+namespace voyis {
+
+SchedulePolicy parseSchedulePolicy(const std::string& name) {
+    if (name == "fifo") {
+        return SchedulePolicy::Fifo;
+    }
+    if (name == "latest") {
+        return SchedulePolicy::LatestFirst;
+    }
+    if (name == "sjf") {
+        return SchedulePolicy::ShortestJobFirst;
+    }
+    if (name == "wfq") {
+        return SchedulePolicy::WeightedFair;
+    }
+    throw std::invalid_argument("Unknown schedule policy: " + name);
+}
+
+const char* schedulePolicyName(SchedulePolicy policy) {
+    switch (policy) {
+        case SchedulePolicy::Fifo: return "fifo";
+        case SchedulePolicy::LatestFirst: return "latest";
+        case SchedulePolicy::ShortestJobFirst: return "sjf";
+        case SchedulePolicy::WeightedFair: return "wfq";
+    }
+    return "unknown";
+}
+
+const char* frameSizeClassName(FrameSizeClass size_class) {
+    switch (size_class) {
+        case FrameSizeClass::Small: return "small";
+        case FrameSizeClass::Medium: return "medium";
+        case FrameSizeClass::Large: return "large";
+    }
+    return "unknown";
+}
+
+double estimateFrameCost(const ImageMessage& msg) {
+    if (msg.width > 0 && msg.height > 0) {
+        return static_cast<double>(msg.width) * msg.height / 1e6;
+    }
+
+    // Typical encoded bytes per pixel for each format
+    double bytes_per_pixel = 1.0;
+    if (msg.format == "jpg" || msg.format == "jpeg") {
+        bytes_per_pixel = 0.3;
+    } else if (msg.format == "png") {
+        bytes_per_pixel = 1.5;
+    } else if (msg.format == "bmp" || msg.format == "tif" || msg.format == "tiff") {
+        bytes_per_pixel = 3.0;
+    }
+    return static_cast<double>(msg.image_data.size()) / bytes_per_pixel / 1e6;
+}
+
+FrameSizeClass classifyFrameCost(double cost) {
+    if (cost < 1.0) {
+        return FrameSizeClass::Small;
+    }
+    if (cost < 16.0) {
+        return FrameSizeClass::Medium;
+    }
+    return FrameSizeClass::Large;
+}
+
+FrameQueue::FrameQueue(FrameQueueConfig config)
+    : config_(std::move(config)), virtual_time_(0.0), closed_(false) {
+    if (config_.capacity == 0) {
+        throw std::invalid_argument("Frame queue capacity must be positive");
+    }
+}
+
+bool FrameQueue::push(ImageMessage msg) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_) {
+            return false;
+        }
+
+        // Make room by dropping the oldest frame
+        if (entries_.size() >= config_.capacity) {
+            ++stats_[entries_.front().msg.stream_id].overflowed;
+            entries_.pop_front();
+        }
+
+        int64_t slo = sloFor(msg.stream_id);
+        int64_t deadline = (slo > 0 && msg.timestamp > 0) ? msg.timestamp + slo : 0;
+        double cost = estimateFrameCost(msg);
+
+        // Weighted fair queuing: a stream's frames are spaced by cost / weight
+        // in virtual time, starting no earlier than the current virtual time
+        double weight = 1.0;
+        auto weight_it = config_.stream_weight.find(msg.stream_id);
+        if (weight_it != config_.stream_weight.end() && weight_it->second > 0.0) {
+            weight = weight_it->second;
+        }
+        double& last_tag = last_finish_tag_[msg.stream_id];
+        double finish_tag = std::max(virtual_time_, last_tag) + cost / weight;
+        last_tag = finish_tag;
+
+        ++stats_[msg.stream_id].enqueued;
+        entries_.push_back(Entry{std::move(msg), deadline, now(), cost, finish_tag});
+    }
+
+    cv_.notify_one();
+    return true;
+}
+
+std::optional<ImageMessage> FrameQueue::pop(int timeout_ms) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+
+    while (true) {
+        dropExpiredLocked(now());
+
+        if (!entries_.empty()) {
+            break;
+        }
+        if (closed_ || cv_.wait_until(lock, until) == std::cv_status::timeout) {
+            dropExpiredLocked(now());
+            if (entries_.empty()) {
+                return std::nullopt;
+            }
+            break;
+        }
+    }
+
+    int64_t now_ms = now();
+    auto it = entries_.begin() + static_cast<std::ptrdiff_t>(selectLocked(now_ms));
+    Entry entry = std::move(*it);
+    entries_.erase(it);
+
+    virtual_time_ = std::max(virtual_time_, entry.finish_tag);
+    ++stats_[entry.msg.stream_id].dequeued;
+
+    QueueDelayStats& delay = delay_stats_[static_cast<size_t>(classifyFrameCost(entry.cost))];
+    int64_t waited_ms = std::max<int64_t>(0, now_ms - entry.enqueued_ms);
+    ++delay.count;
+    delay.total_ms += waited_ms;
+    delay.max_ms = std::max(delay.max_ms, waited_ms);
+
+    return std::move(entry.msg);
+}
+
+void FrameQueue::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+    }
+    cv_.notify_all();
+}
+
+int64_t FrameQueue::sloFor(const std::string& stream_id) const {
+    auto it = config_.stream_slo_ms.find(stream_id);
+    return it == config_.stream_slo_ms.end() ? config_.latency_slo_ms : it->second;
+}
+
+size_t FrameQueue::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+std::map<std::string, StreamQueueStats> FrameQueue::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+std::array<QueueDelayStats, kNumFrameSizeClasses> FrameQueue::delayStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return delay_stats_;
+}
+
+int64_t FrameQueue::now() const {
+    if (config_.clock) {
+        return config_.clock();
+    }
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count();
+}
+
+void FrameQueue::dropExpiredLocked(int64_t now_ms) {
+    // Streams may have different SLOs, so expired frames are not
+    // necessarily at the front of the queue
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        if (it->deadline != 0 && it->deadline < now_ms) {
+            ++stats_[it->msg.stream_id].expired;
+            it = entries_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+size_t FrameQueue::selectLocked(int64_t now_ms) const {
+    switch (config_.policy) {
+        case SchedulePolicy::Fifo:
+            return 0;
+        case SchedulePolicy::LatestFirst:
+            return entries_.size() - 1;
+        case SchedulePolicy::ShortestJobFirst:
+        case SchedulePolicy::WeightedFair:
+            break;
+    }
+
+    // Starvation protection: entries are in arrival order, so the front one
+    // has waited longest
+    if (config_.max_wait_ms > 0 && now_ms - entries_.front().enqueued_ms >= config_.max_wait_ms) {
+        return 0;
+    }
+
+    bool by_cost = config_.policy == SchedulePolicy::ShortestJobFirst;
+    size_t best = 0;
+    for (size_t i = 1; i < entries_.size(); ++i) {
+        double key = by_cost ? entries_[i].cost : entries_[i].finish_tag;
+        double best_key = by_cost ? entries_[best].cost : entries_[best].finish_tag;
+        if (key < best_key) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+} // namespace voyis
@@ -0,0 +1,184 @@
+#pragma once
+
+#include "message.h"
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace voyis {
+
+/**
+ * @brief Order in which queued frames are handed to the processing loop
+ */
+enum class SchedulePolicy {
+    Fifo,             // Oldest frame first (frames past their deadline are dropped)
+    LatestFirst,      // Newest frame first, older frames wait and may expire
+    ShortestJobFirst, // Cheapest frame first (by estimated cost)
+    WeightedFair      // Weighted fair queuing of estimated cost across streams
+};
+
+/**
+ * @brief Parse a policy name ("fifo", "latest", "sjf" or "wfq")
+ * @throws std::invalid_argument for unknown names
+ */
+SchedulePolicy parseSchedulePolicy(const std::string& name);
+
+/**
+ * @brief Name of a policy as accepted by parseSchedulePolicy()
+ */
+const char* schedulePolicyName(SchedulePolicy policy);
+
+/**
+ * @brief Size class of a frame, used to report queueing delay
+ */
+enum class FrameSizeClass {
+    Small,  // Below 1 megapixel (thumbnails)
+    Medium, // Below 16 megapixels
+    Large   // Survey frames and mosaics
+};
+
+constexpr size_t kNumFrameSizeClasses = 3;
+
+/**
+ * @brief Name of a size class ("small", "medium" or "large")
+ */
+const char* frameSizeClassName(FrameSizeClass size_class);
+
+/**
+ * @brief Estimate the processing cost of a frame in megapixels
+ *
+ * SIFT time grows with the pixel count. When the sender did not fill in the
+ * dimensions, the pixel count is estimated from the encoded size using a
+ * typical compression ratio for the format.
+ */
+double estimateFrameCost(const ImageMessage& msg);
+
+/**
+ * @brief Size class of a frame with the given estimated cost
+ */
+FrameSizeClass classifyFrameCost(double cost);
+
+/**
+ * @brief Configuration of the extractor's frame queue
+ */
+struct FrameQueueConfig {
+    SchedulePolicy policy = SchedulePolicy::Fifo;
+    int64_t latency_slo_ms = 0;                   // Default latency SLO (0 disables dropping)
+    std::map<std::string, int64_t> stream_slo_ms; // Per-stream SLO overrides
+    std::map<std::string, double> stream_weight;  // Per-stream weights for "wfq" (default 1)
+    int64_t max_wait_ms = 2000;                   // "sjf"/"wfq" serve any frame older than this first
+    size_t capacity = 1000;                       // Oldest frame is dropped when full
+    std::function<int64_t()> clock;               // Wall clock in ms (defaults to system clock)
+};
+
+/**
+ * @brief Per-stream queue counters
+ */
+struct StreamQueueStats {
+    uint64_t enqueued = 0;   // Frames accepted into the queue
+    uint64_t dequeued = 0;   // Frames handed out for processing
+    uint64_t expired = 0;    // Frames dropped because their deadline had passed
+    uint64_t overflowed = 0; // Frames dropped because the queue was full
+};
+
+/**
+ * @brief Time frames of one size class spent waiting in the queue
+ */
+struct QueueDelayStats {
+    uint64_t count = 0;
+    int64_t total_ms = 0;
+    int64_t max_ms = 0;
+
+    double meanMs() const { return count > 0 ? static_cast<double>(total_ms) / count : 0.0; }
+};
+
+/**
+ * @brief Thread-safe queue between the receive thread and the processing loop
+ *
+ * Each frame gets a deadline of `timestamp + SLO` for its stream. Frames whose
+ * deadline has passed are dropped (and counted) before they are handed out, so
+ * the expensive decode and SIFT steps are never spent on stale frames.
+ * Timestamps are set by the image generator, so both hosts' clocks are
+ * assumed to be synchronized.
+ *
+ * With the "sjf" and "wfq" policies small frames overtake large ones; any
+ * frame that has waited longer than max_wait_ms is served first so that
+ * large frames are delayed but never starved.
+ */
+class FrameQueue {
+public:
+    explicit FrameQueue(FrameQueueConfig config = FrameQueueConfig());
+
+    // Disable copy
+    FrameQueue(const FrameQueue&) = delete;
+    FrameQueue& operator=(const FrameQueue&) = delete;
+
+    /**
+     * @brief Add a frame to the queue
+     * @return false if the queue has been closed
+     */
+    bool push(ImageMessage msg);
+
+    /**
+     * @brief Take the next frame according to the schedule policy
+     * @param timeout_ms Maximum time to wait for a frame
+     * @return The frame, or std::nullopt on timeout or when closed and empty
+     */
+    std::optional<ImageMessage> pop(int timeout_ms);
+
+    /**
+     * @brief Wake up waiting consumers and reject further frames
+     */
+    void close();
+
+    /**
+     * @brief Latency SLO in ms applied to a stream (0 if disabled)
+     */
+    int64_t sloFor(const std::string& stream_id) const;
+
+    /**
+     * @brief Number of frames currently queued
+     */
+    size_t size() const;
+
+    /**
+     * @brief Snapshot of the per-stream counters
+     */
+    std::map<std::string, StreamQueueStats> stats() const;
+
+    /**
+     * @brief Queueing delay of the frames handed out so far, by size class
+     */
+    std::array<QueueDelayStats, kNumFrameSizeClasses> delayStats() const;
+
+private:
+    struct Entry {
+        ImageMessage msg;
+        int64_t deadline;    // 0 means no deadline
+        int64_t enqueued_ms; // Clock value when the frame was queued
+        double cost;         // Estimated cost in megapixels
+        double finish_tag;   // Virtual finish time for weighted fair queuing
+    };
+
+    int64_t now() const;
+    void dropExpiredLocked(int64_t now_ms);
+    size_t selectLocked(int64_t now_ms) const;
+
+    FrameQueueConfig config_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Entry> entries_;
+    std::map<std::string, StreamQueueStats> stats_;
+    std::array<QueueDelayStats, kNumFrameSizeClasses> delay_stats_;
+    std::map<std::string, double> last_finish_tag_; // Per-stream, for weighted fair queuing
+    double virtual_time_;
+    bool closed_;
+};
+
+} // namespace voyis
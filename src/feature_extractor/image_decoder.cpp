@@ -0,0 +1,353 @@
+#include "image_decoder.h"
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+#ifdef VOYIS_HAVE_TURBOJPEG
+#include <turbojpeg.h>
+#endif
+
+#ifdef VOYIS_HAVE_SPNG
+#include <spng.h>
+#endif
+
+namespace voyis {
+
+namespace {
+
+// Resize to 1/reduction of the original size (no-op for reduction 1)
+cv::Mat reduceBy(const cv::Mat& image, int reduction) {
+    if (reduction <= 1 || image.empty()) {
+        return image;
+    }
+    cv::Mat reduced;
+    cv::resize(image, reduced,
+               cv::Size((image.cols + reduction - 1) / reduction,
+                        (image.rows + reduction - 1) / reduction),
+               0, 0, cv::INTER_AREA);
+    return reduced;
+}
+
+cv::Mat decodeWithOpenCV(const uint8_t* data, size_t size, int reduction) {
+    int flags = cv::IMREAD_GRAYSCALE;
+    switch (reduction) {
+        case 2: flags = cv::IMREAD_REDUCED_GRAYSCALE_2; break;
+        case 4: flags = cv::IMREAD_REDUCED_GRAYSCALE_4; break;
+        case 8: flags = cv::IMREAD_REDUCED_GRAYSCALE_8; break;
+        default: break;
+    }
+
+    // Wrap the input without copying it
+    cv::Mat buffer(1, static_cast<int>(size), CV_8UC1, const_cast<uint8_t*>(data));
+    return cv::imdecode(buffer, flags);
+}
+
+#ifdef VOYIS_HAVE_TURBOJPEG
+// One decompressor per thread; TurboJPEG handles are not thread-safe
+struct TurboJpegDecompressor {
+    tjhandle handle;
+
+    TurboJpegDecompressor() : handle(tjInitDecompress()) {}
+    ~TurboJpegDecompressor() {
+        if (handle) {
+            tjDestroy(handle);
+        }
+    }
+};
+
+cv::Mat decodeWithTurboJpeg(const uint8_t* data, size_t size, int reduction) {
+    thread_local TurboJpegDecompressor decompressor;
+    if (!decompressor.handle) {
+        return cv::Mat();
+    }
+
+    int width = 0;
+    int height = 0;
+    int subsampling = 0;
+    int colorspace = 0;
+    if (tjDecompressHeader3(decompressor.handle, data, static_cast<unsigned long>(size),
+                            &width, &height, &subsampling, &colorspace) != 0) {
+        return cv::Mat();
+    }
+
+    // Asking for the scaled size selects DCT-domain scaling
+    tjscalingfactor factor = {1, std::max(reduction, 1)};
+    int out_width = TJSCALED(width, factor);
+    int out_height = TJSCALED(height, factor);
+
+    // Only the luma channel is decoded for grayscale output
+    cv::Mat image = DecodeBufferPool::shared().acquire(out_height, out_width);
+    if (tjDecompress2(decompressor.handle, data, static_cast<unsigned long>(size), image.data,
+                      out_width, static_cast<int>(image.step), out_height, TJPF_GRAY, 0) != 0) {
+        return cv::Mat();
+    }
+    return image;
+}
+#endif
+
+#ifdef VOYIS_HAVE_SPNG
+cv::Mat decodeWithSpng(const uint8_t* data, size_t size, int reduction) {
+    std::unique_ptr<spng_ctx, decltype(&spng_ctx_free)> ctx(spng_ctx_new(0), spng_ctx_free);
+    if (!ctx || spng_set_png_buffer(ctx.get(), data, size) != 0) {
+        return cv::Mat();
+    }
+
+    struct spng_ihdr ihdr;
+    if (spng_get_ihdr(ctx.get(), &ihdr) != 0) {
+        return cv::Mat();
+    }
+
+    // Gray sources decode straight to 8-bit gray, others go through RGB
+    bool gray = ihdr.color_type == SPNG_COLOR_TYPE_GRAYSCALE && ihdr.bit_depth <= 8;
+    int fmt = gray ? SPNG_FMT_G8 : SPNG_FMT_RGB8;
+    size_t decoded_size = 0;
+    if (spng_decoded_image_size(ctx.get(), fmt, &decoded_size) != 0) {
+        return cv::Mat();
+    }
+
+    int rows = static_cast<int>(ihdr.height);
+    int cols = static_cast<int>(ihdr.width);
+    cv::Mat image = DecodeBufferPool::shared().acquire(rows, cols);
+    if (gray) {
+        if (spng_decode_image(ctx.get(), image.data, decoded_size, fmt, 0) != 0) {
+            return cv::Mat();
+        }
+    } else {
+        cv::Mat rgb(rows, cols, CV_8UC3);
+        if (spng_decode_image(ctx.get(), rgb.data, decoded_size, fmt, 0) != 0) {
+            return cv::Mat();
+        }
+        cv::cvtColor(rgb, image, cv::COLOR_RGB2GRAY);
+    }
+    return reduceBy(image, reduction);
+}
+#endif
+
+// Shrink an image so that its longest side is at most max_side
+cv::Mat shrinkTo(const cv::Mat& image, int max_side) {
+    int longest = std::max(image.cols, image.rows);
+    if (longest <= max_side) {
+        return image;
+    }
+
+    double scale = static_cast<double>(max_side) / longest;
+    cv::Mat resized;
+    cv::resize(image, resized, cv::Size(), scale, scale, cv::INTER_AREA);
+    return resized;
+}
+
+// Demosaicing code for a Bayer format (OpenCV names patterns by the second row)
+int bayerToGrayCode(const std::string& format) {
+    if (format.compare(0, 10, "bayer_rggb") == 0) {
+        return cv::COLOR_BayerBG2GRAY;
+    }
+    if (format.compare(0, 10, "bayer_bggr") == 0) {
+        return cv::COLOR_BayerRG2GRAY;
+    }
+    if (format.compare(0, 10, "bayer_gbrg") == 0) {
+        return cv::COLOR_BayerGR2GRAY;
+    }
+    if (format.compare(0, 10, "bayer_grbg") == 0) {
+        return cv::COLOR_BayerGB2GRAY;
+    }
+    return -1;
+}
+
+// Wrap uncompressed pixels as an 8-bit grayscale image. mono8 frames are
+// referenced in place; Bayer and 16-bit frames need one conversion pass.
+cv::Mat wrapRawPixels(const ImageMessage& msg) {
+    int bytes_per_pixel = rawBytesPerPixel(msg.format);
+    if (msg.width <= 0 || msg.height <= 0) {
+        throw std::runtime_error("Raw image without dimensions: " + msg.image_id);
+    }
+
+    size_t row_bytes = static_cast<size_t>(msg.width) * bytes_per_pixel;
+    size_t stride = msg.stride > 0 ? static_cast<size_t>(msg.stride) : row_bytes;
+    if (stride < row_bytes || stride % bytes_per_pixel != 0 ||
+        msg.image_data.size() < stride * (msg.height - 1) + row_bytes) {
+        throw std::runtime_error("Invalid raw image geometry: " + msg.image_id);
+    }
+
+    cv::Mat pixels(msg.height, msg.width, bytes_per_pixel == 1 ? CV_8UC1 : CV_16UC1,
+                   const_cast<uint8_t*>(msg.image_data.data()), stride);
+
+    int bayer_code = bayerToGrayCode(msg.format);
+    if (bayer_code >= 0) {
+        cv::Mat gray;
+        cv::cvtColor(pixels, gray, bayer_code);
+        pixels = gray;
+    }
+
+    if (bytes_per_pixel == 2) {
+        // Keep the most significant 8 of the bit_depth valid bits
+        int bit_depth = (msg.bit_depth > 0 && msg.bit_depth <= 16) ? msg.bit_depth : 16;
+        double scale = bit_depth > 8 ? 1.0 / (1 << (bit_depth - 8)) : 1.0;
+        cv::Mat gray8;
+        pixels.convertTo(gray8, CV_8U, scale);
+        pixels = gray8;
+    }
+
+    return pixels;
+}
+
+} // anonymous namespace
+
+const char* decodeBackendName(DecodeBackend backend) {
+    switch (backend) {
+        case DecodeBackend::OpenCV: return "opencv";
+        case DecodeBackend::TurboJpeg: return "turbojpeg";
+        case DecodeBackend::Spng: return "spng";
+    }
+    return "unknown";
+}
+
+DecodeBufferPool::DecodeBufferPool(size_t max_buffers) : max_buffers_(max_buffers) {}
+
+DecodeBufferPool& DecodeBufferPool::shared() {
+    static DecodeBufferPool pool;
+    return pool;
+}
+
+void DecodeBufferPool::setMaxBuffers(size_t max_buffers) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    max_buffers_ = max_buffers;
+}
+
+size_t DecodeBufferPool::maxBuffers() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return max_buffers_;
+}
+
+cv::Mat DecodeBufferPool::acquire(int rows, int cols) {
+    size_t needed = static_cast<size_t>(rows) * static_cast<size_t>(cols);
+    if (needed == 0 || needed > static_cast<size_t>(std::numeric_limits<int>::max())) {
+        return cv::Mat(rows, cols, CV_8UC1);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // A buffer is free when the pool holds the only reference to it. Views are
+    // released on other threads (the descriptor service) with atomic decrements,
+    // so the count is read atomically too: CV_XADD of 0 returns it unchanged
+    cv::Mat* free_buffer = nullptr;
+    for (cv::Mat& buffer : buffers_) {
+        if (buffer.u && CV_XADD(&buffer.u->refcount, 0) == 1) {
+            if (static_cast<size_t>(buffer.cols) >= needed) {
+                free_buffer = &buffer;
+                break;
+            }
+            if (!free_buffer) {
+                free_buffer = &buffer;
+            }
+        }
+    }
+
+    if (!free_buffer && buffers_.size() < max_buffers_) {
+        buffers_.emplace_back();
+        free_buffer = &buffers_.back();
+    }
+    if (!free_buffer) {
+        return cv::Mat(rows, cols, CV_8UC1);
+    }
+
+    // Grow a free buffer that is too small
+    if (static_cast<size_t>(free_buffer->cols) < needed) {
+        *free_buffer = cv::Mat(1, static_cast<int>(needed), CV_8UC1);
+    }
+
+    // Continuous view sharing the buffer's reference count
+    return free_buffer->colRange(0, static_cast<int>(needed)).reshape(1, rows);
+}
+
+bool isJpegData(const uint8_t* data, size_t size) {
+    return size >= 3 && data[0] == 0xFF && data[1] == 0xD8 && data[2] == 0xFF;
+}
+
+bool isPngData(const uint8_t* data, size_t size) {
+    static const uint8_t kSignature[] = {0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A};
+    return size >= sizeof(kSignature) && std::equal(kSignature, kSignature + sizeof(kSignature), data);
+}
+
+bool isTiffData(const uint8_t* data, size_t size) {
+    if (size < 4) {
+        return false;
+    }
+    // "II" little-endian or "MM" big-endian, then 42 (classic) or 43 (BigTIFF)
+    bool little = data[0] == 'I' && data[1] == 'I' && data[3] == 0 && (data[2] == 42 || data[2] == 43);
+    bool big = data[0] == 'M' && data[1] == 'M' && data[2] == 0 && (data[3] == 42 || data[3] == 43);
+    return little || big;
+}
+
+cv::Mat decodeGrayscale(const uint8_t* data, size_t size, int reduction,
+                        DecodeBackend* backend_used) {
+    if (!data || size == 0) {
+        return cv::Mat();
+    }
+
+#ifdef VOYIS_HAVE_TURBOJPEG
+    if (isJpegData(data, size)) {
+        cv::Mat image = decodeWithTurboJpeg(data, size, reduction);
+        if (!image.empty()) {
+            if (backend_used) {
+                *backend_used = DecodeBackend::TurboJpeg;
+            }
+            return image;
+        }
+    }
+#endif
+
+#ifdef VOYIS_HAVE_SPNG
+    if (isPngData(data, size)) {
+        cv::Mat image = decodeWithSpng(data, size, reduction);
+        if (!image.empty()) {
+            if (backend_used) {
+                *backend_used = DecodeBackend::Spng;
+            }
+            return image;
+        }
+    }
+#endif
+
+    cv::Mat image = decodeWithOpenCV(data, size, reduction);
+    if (!image.empty() && backend_used) {
+        *backend_used = DecodeBackend::OpenCV;
+    }
+    return image;
+}
+
+DecodedFrame::DecodedFrame(const ImageMessage& msg) : msg_(msg) {}
+
+const cv::Mat& DecodedFrame::full() {
+    if (full_.empty() && isRawPixelFormat(msg_.format)) {
+        full_ = wrapRawPixels(msg_);
+    } else if (full_.empty()) {
+        full_ = decodeGrayscale(msg_.image_data.data(), msg_.image_data.size());
+        if (full_.empty()) {
+            throw std::runtime_error("Failed to decode image: " + msg_.image_id);
+        }
+    }
+    return full_;
+}
+
+const cv::Mat& DecodedFrame::preview() {
+    if (!preview_.empty()) {
+        return preview_;
+    }
+
+    if (full_.empty() && isJpegData(msg_.image_data.data(), msg_.image_data.size())) {
+        // JPEG scales down in the DCT domain, so a reduced decode skips most of the work
+        cv::Mat reduced = decodeGrayscale(msg_.image_data.data(), msg_.image_data.size(), 4);
+        if (reduced.empty()) {
+            throw std::runtime_error("Failed to decode image: " + msg_.image_id);
+        }
+        preview_ = shrinkTo(reduced, kPreviewSize);
+    } else {
+        preview_ = shrinkTo(full(), kPreviewSize);
+    }
+    return preview_;
+}
+
+} // namespace voyis
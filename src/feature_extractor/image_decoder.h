@@ -0,0 +1,142 @@
+#pragma once
+
+#include "message.h"
+#include <opencv2/core.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace voyis {
+
+/**
+ * @brief Codec used to decode an image
+ */
+enum class DecodeBackend {
+    OpenCV,     // cv::imdecode (any format OpenCV supports)
+    TurboJpeg,  // libjpeg-turbo, JPEG only (built with VOYIS_HAVE_TURBOJPEG)
+    Spng        // libspng, PNG only (built with VOYIS_HAVE_SPNG)
+};
+
+/**
+ * @brief Name of a decode backend for logs and benchmarks
+ */
+const char* decodeBackendName(DecodeBackend backend);
+
+/**
+ * @brief Reusable 8-bit image buffers for decoded frames
+ *
+ * Decoding a 30 MB frame into a freshly allocated buffer costs thousands of
+ * page faults per frame. The pool hands out cv::Mat views of buffers it
+ * owns; a buffer is reused once every view of it has been released.
+ */
+class DecodeBufferPool {
+public:
+    static constexpr size_t kDefaultBuffers = 4;
+
+    explicit DecodeBufferPool(size_t max_buffers = kDefaultBuffers);
+
+    /**
+     * @brief The pool every decode in the process uses
+     */
+    static DecodeBufferPool& shared();
+
+    /**
+     * @brief Get a continuous CV_8UC1 image of the given size
+     *
+     * Falls back to a plain allocation when all pooled buffers are in use.
+     */
+    cv::Mat acquire(int rows, int cols);
+
+    /**
+     * @brief Change how many buffers the pool may hold
+     *
+     * Raise it when decoded images are kept beyond the frame (such as in a
+     * frame cache), so the pool is not left with no free buffer. Buffers
+     * already allocated are kept.
+     */
+    void setMaxBuffers(size_t max_buffers);
+
+    size_t maxBuffers();
+
+private:
+    std::mutex mutex_;
+    std::vector<cv::Mat> buffers_; // 1 x capacity byte buffers
+    size_t max_buffers_;
+};
+
+/**
+ * @brief Decode an encoded image (JPEG, PNG, TIFF, ...) to 8-bit grayscale
+ *
+ * JPEG uses TurboJPEG and PNG uses libspng when they are available, decoding
+ * directly into a buffer from the shared pool; every other case (and any
+ * error in a fast codec) falls back to cv::imdecode.
+ *
+ * @param reduction Downscale factor: 1, 2, 4 or 8. JPEG scales in the DCT
+ *                  domain, other formats are resized after decoding.
+ * @param backend_used Optional output for the codec that produced the image
+ * @return The image, or an empty Mat if it cannot be decoded
+ */
+cv::Mat decodeGrayscale(const uint8_t* data, size_t size, int reduction = 1,
+                        DecodeBackend* backend_used = nullptr);
+
+/**
+ * @brief Whether the data starts with a JPEG signature
+ */
+bool isJpegData(const uint8_t* data, size_t size);
+
+/**
+ * @brief Whether the data starts with a PNG signature
+ */
+bool isPngData(const uint8_t* data, size_t size);
+
+/**
+ * @brief Whether the data starts with a TIFF (or BigTIFF) signature
+ */
+bool isTiffData(const uint8_t* data, size_t size);
+
+/**
+ * @brief Lazily decoded view of an image message
+ *
+ * Gate checks (duplicate detection, quality checks) only need a small
+ * preview, which for JPEG can be decoded at reduced resolution far more
+ * cheaply than the full frame. The full-resolution image is decoded only if
+ * a stage asks for it, and the preview is derived from it when available.
+ *
+ * Raw pixel formats are not decoded at all: mono8 frames are wrapped as a
+ * cv::Mat over the message payload without a copy, so the message must
+ * outlive the DecodedFrame.
+ */
+class DecodedFrame {
+public:
+    /**
+     * @brief Longest side of the preview image in pixels (approximate for JPEG)
+     */
+    static constexpr int kPreviewSize = 512;
+
+    explicit DecodedFrame(const ImageMessage& msg);
+
+    /**
+     * @brief Full-resolution 8-bit grayscale image
+     * @throws std::runtime_error if the image cannot be decoded
+     */
+    const cv::Mat& full();
+
+    /**
+     * @brief Reduced-resolution 8-bit grayscale image
+     * @throws std::runtime_error if the image cannot be decoded
+     */
+    const cv::Mat& preview();
+
+    /**
+     * @brief Whether the full-resolution image has been decoded
+     */
+    bool hasFull() const { return !full_.empty(); }
+
+private:
+    const ImageMessage& msg_;
+    cv::Mat full_;
+    cv::Mat preview_;
+};
+
+} // namespace voyis
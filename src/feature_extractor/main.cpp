@@ -1,5 +1,26 @@
 #include "ipc.h"
 #include "message.h"
+#include "options.h"
+#include "frame_allocator.h"
+#include "tracepoints.h"
+#include "trace_writer.h"
+#include "flight_recorder.h"
+#include "control.h"
+#include "frame_queue.h"
+#include "image_decoder.h"
+#include "duplicate_filter.h"
+#include "quality_gate.h"
+#include "tiled_extractor.h"
+#include "descriptor_projection.h"
+#include "autotuner.h"
+#include "descriptor_service.h"
+#ifdef VOYIS_HAVE_TIFF
+#include "tiff_region_reader.h"
+#else
+namespace voyis {
+class TiffRegionReader; // Without libtiff, huge TIFF frames are decoded in one piece
+}
+#endif
 #include <opencv2/opencv.hpp>
 #include <opencv2/features2d.hpp>
 #include <iostream>
@@ -7,6 +28,11 @@
 #include <csignal>
 #include <atomic>
 #include <thread>
+#include <optional>
+#include <functional>
+#include <memory>
+#include <algorithm>
+#include <stdexcept>
 
 // Global flag for graceful shutdown
 std::atomic<bool> g_running(true);
@@ -63,38 +89,401 @@ std::vector<std::vector<float>> convertDescriptors(const cv::Mat& cv_descriptors
 }
 
 /**
- * @brief Process an image with SIFT feature detection
+ * @brief Current wall clock time in milliseconds since epoch
+ */
+int64_t nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count();
+}
+
+/**
+ * @brief Outcome of processing one image
+ */
+struct ProcessingResult {
+    voyis::ProcessedImageMessage msg;
+    std::string reused_from; // Image whose features were reused, empty if SIFT ran
+    size_t regions = 0;      // Regions processed by the tiled path, 0 if decoded whole
+};
+
+/**
+ * @brief Keypoints-only mode: descriptors are computed on request from cached frames
+ */
+struct DeferredDescriptors {
+    voyis::FrameCache* cache = nullptr; // nullptr computes descriptors for every frame
+    cv::Ptr<cv::SIFT> detector;         // Used only by the descriptor service thread
+};
+
+/**
+ * @brief When and how huge frames are processed region by region
+ */
+struct TilingConfig {
+    int64_t min_pixels = 0;               // Smallest frame for the tiled path, 0 disables it
+    voyis::TiledExtractionConfig regions; // Target region size and overlap
+};
+
+#ifdef VOYIS_HAVE_TIFF
+/**
+ * @brief Open a TIFF payload for region-wise decoding if it is large enough
+ * @return The reader, or nullptr to decode the frame in one piece
  */
-voyis::ProcessedImageMessage processImage(const voyis::ImageMessage& input_msg) {
-    // Decode image from bytes
-    cv::Mat image = cv::imdecode(input_msg.image_data, cv::IMREAD_GRAYSCALE);
-    if (image.empty()) {
-        throw std::runtime_error("Failed to decode image: " + input_msg.image_id);
+std::shared_ptr<voyis::TiffRegionReader> openLargeTiff(const voyis::ImageMessage& msg,
+                                                       int64_t min_pixels) {
+    if (min_pixels <= 0 || !voyis::isTiffData(msg.image_data.data(), msg.image_data.size())) {
+        return nullptr;
     }
 
-    // Create SIFT detector
-    cv::Ptr<cv::SIFT> sift = cv::SIFT::create();
+    try {
+        auto reader = std::make_shared<voyis::TiffRegionReader>(msg.image_data.data(),
+                                                                msg.image_data.size());
+        if (static_cast<int64_t>(reader->size().area()) >= min_pixels) {
+            return reader;
+        }
+    } catch (const std::exception& e) {
+        // Layouts the reader does not handle still go through cv::imdecode
+        std::cerr << "  Tiled decode unavailable for " << msg.image_id << ": " << e.what() << std::endl;
+    }
+    return nullptr;
+}
+#endif
 
-    // Detect keypoints and compute descriptors
-    std::vector<cv::KeyPoint> cv_keypoints;
-    cv::Mat cv_descriptors;
-    sift->detectAndCompute(image, cv::noArray(), cv_keypoints, cv_descriptors);
+/**
+ * @brief Human-readable list of failed quality checks
+ */
+std::string describeQualityFlags(uint32_t flags) {
+    std::string description;
+    auto append = [&description](const char* name) {
+        description += description.empty() ? name : std::string(", ") + name;
+    };
+    if (flags & voyis::kQualityBlurry) {
+        append("blurry");
+    }
+    if (flags & voyis::kQualityUnderexposed) {
+        append("underexposed");
+    }
+    if (flags & voyis::kQualityOverexposed) {
+        append("overexposed");
+    }
+    if (flags & voyis::kQualityLowContrast) {
+        append("low contrast");
+    }
+    return description;
+}
+
+/**
+ * @brief Register the settings that voyisctl can change while running
+ *
+ * Start-up values come from the options of the same name.
+ */
+void addTunables(voyis::Tunables& tunables, const voyis::Options& options) {
+    tunables.add("sift-features", static_cast<double>(options.getInt("sift-features", 0)), 0, 100000,
+                 "Keep the strongest N keypoints per frame (0 keeps all)", true);
+    tunables.add("sift-octave-layers", static_cast<double>(options.getInt("sift-octave-layers", 3)),
+                 1, 10, "Scale-space layers per octave", true);
+    tunables.add("sift-contrast-threshold", options.getDouble("sift-contrast-threshold", 0.04),
+                 0.0, 1.0, "Reject weak keypoints in low-contrast regions");
+    tunables.add("sift-edge-threshold", options.getDouble("sift-edge-threshold", 10.0), 1.0, 100.0,
+                 "Reject edge-like keypoints");
+    tunables.add("sift-sigma", options.getDouble("sift-sigma", 1.6), 0.5, 10.0,
+                 "Gaussian blur of the first octave");
+    // While autotuning, the autotuner owns the thread count
+    if (!options.getBool("autotune", false)) {
+        tunables.add("opencv-threads",
+                     static_cast<double>(options.getInt("opencv-threads", cv::getNumThreads())),
+                     0, 256, "Threads OpenCV may use (0 runs single-threaded)", true);
+    }
+
+    tunables.add("min-sharpness", options.getDouble("min-sharpness", 0.0), 0.0, 1e9,
+                 "Quality gate: minimum Laplacian variance");
+    tunables.add("min-brightness", options.getDouble("min-brightness", 0.0), 0.0, 255.0,
+                 "Quality gate: minimum mean intensity");
+    tunables.add("max-brightness", options.getDouble("max-brightness", 255.0), 0.0, 255.0,
+                 "Quality gate: maximum mean intensity");
+    tunables.add("max-dark-fraction", options.getDouble("max-dark-fraction", 1.0), 0.0, 1.0,
+                 "Quality gate: maximum fraction of pixels below 16");
+    tunables.add("max-saturated-fraction", options.getDouble("max-saturated-fraction", 1.0),
+                 0.0, 1.0, "Quality gate: maximum fraction of pixels above 239");
+    tunables.add("min-contrast", options.getDouble("min-contrast", 0.0), 0.0, 255.0,
+                 "Quality gate: minimum intensity standard deviation");
+}
+
+/**
+ * @brief SIFT detector with the current settings
+ */
+cv::Ptr<cv::SIFT> createSift(const voyis::Tunables& tunables) {
+    return cv::SIFT::create(static_cast<int>(tunables.getInt("sift-features")),
+                            static_cast<int>(tunables.getInt("sift-octave-layers")),
+                            tunables.get("sift-contrast-threshold"),
+                            tunables.get("sift-edge-threshold"),
+                            tunables.get("sift-sigma"));
+}
+
+/**
+ * @brief Quality gate thresholds with the current settings
+ */
+voyis::QualityThresholds qualityThresholds(const voyis::Tunables& tunables) {
+    voyis::QualityThresholds thresholds;
+    thresholds.min_sharpness = tunables.get("min-sharpness");
+    thresholds.min_brightness = tunables.get("min-brightness");
+    thresholds.max_brightness = tunables.get("max-brightness");
+    thresholds.max_dark_fraction = tunables.get("max-dark-fraction");
+    thresholds.max_saturated_fraction = tunables.get("max-saturated-fraction");
+    thresholds.min_contrast = tunables.get("min-contrast");
+    return thresholds;
+}
+
+/**
+ * @brief OpenCV thread counts to tune: the powers of two below the core count, and the core count
+ */
+std::vector<int> autotuneThreadCounts() {
+    int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<int> threads;
+    for (int count = 1; count < cores; count *= 2) {
+        threads.push_back(count);
+    }
+    threads.push_back(cores);
+    return threads;
+}
+
+/**
+ * @brief Autotuner over the given settings, or nullptr without --autotune
+ *
+ * A saved profile for this host is loaded from profile.
+ */
+std::unique_ptr<voyis::Autotuner> configureAutotune(const voyis::Options& options,
+                                                   std::vector<voyis::TuningKnob> knobs,
+                                                   const voyis::Autotuner::Setting& initial,
+                                                   const std::string& profile,
+                                                   const std::string& host) {
+    if (!options.getBool("autotune", false)) {
+        return nullptr;
+    }
+
+    voyis::AutotunerConfig config;
+    config.frames_per_trial = static_cast<size_t>(options.getInt("autotune-trial-frames", 20));
+    auto autotuner = std::make_unique<voyis::Autotuner>(std::move(knobs), initial, config);
+
+    size_t loaded = autotuner->load(profile, host);
+    std::cout << "Autotune: profile " << profile << " (" << loaded << " size classes loaded)"
+              << std::endl;
+    for (size_t i = 0; i < voyis::kNumFrameSizeClasses; ++i) {
+        auto size_class = static_cast<voyis::FrameSizeClass>(i);
+        if (autotuner->converged(size_class)) {
+            std::cout << "  " << voyis::frameSizeClassName(size_class) << " frames: "
+                      << autotuner->describe(autotuner->best(size_class)) << std::endl;
+        }
+    }
+    return autotuner;
+}
+
+/**
+ * @brief Process an image with SIFT feature detection
+ * @param sift Detector, reused across frames
+ * @param quality_thresholds Frames failing these are tagged and not processed; with the
+ *                           defaults no frame can fail, so quality is not measured
+ * @param duplicate_filter Near-duplicate gate, or nullptr to always run SIFT
+ * @param tiling Region layout for huge TIFF frames
+ * @param tiff Huge TIFF frame to decode and process region by region, or nullptr
+ * @param projection PCA applied to descriptors before publishing, or nullptr
+ * @param deferred Publish keypoints only and cache the frame for the descriptor service
+ *                 (huge tiled frames still get their descriptors inline)
+ */
+ProcessingResult processImage(const voyis::ImageMessage& input_msg,
+                              cv::SIFT& sift,
+                              const voyis::QualityThresholds& quality_thresholds,
+                              voyis::DuplicateFilter* duplicate_filter,
+                              const TilingConfig& tiling,
+                              voyis::TiffRegionReader* tiff,
+                              const voyis::DescriptorProjection* projection,
+                              const DeferredDescriptors& deferred) {
+    voyis::DecodedFrame frame(input_msg);
+
+    // Region source for frames too large to decode in one piece
+    voyis::RegionReader read_region;
+    cv::Size tiled_size;
+    voyis::TiledExtractionConfig region_config = tiling.regions;
+#ifdef VOYIS_HAVE_TIFF
+    if (tiff) {
+        read_region = [tiff](const cv::Rect& rect) { return tiff->readRegion(rect); };
+        tiled_size = tiff->size();
+        region_config.region_size = tiff->regionSize(tiling.regions.region_size.width);
+    }
+#else
+    (void)tiff;
+#endif
 
     // Create processed message
-    voyis::ProcessedImageMessage processed_msg;
+    ProcessingResult result;
+    voyis::ProcessedImageMessage& processed_msg = result.msg;
     processed_msg.image_id = input_msg.image_id;
+    processed_msg.stream_id = input_msg.stream_id;
     processed_msg.image_data = input_msg.image_data;
     processed_msg.format = input_msg.format;
-    processed_msg.width = image.cols;
-    processed_msg.height = image.rows;
     processed_msg.timestamp = input_msg.timestamp;
-    processed_msg.processed_timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::system_clock::now().time_since_epoch()
-    ).count();
+    processed_msg.width = input_msg.width;
+    processed_msg.height = input_msg.height;
+    processed_msg.stride = input_msg.stride;
+    processed_msg.bit_depth = input_msg.bit_depth;
+
+    // The preview is only decoded for the gates that are enabled
+    const bool check_quality = !voyis::acceptsEveryFrame(quality_thresholds);
+    const bool need_preview = check_quality || duplicate_filter;
+
+    cv::Mat preview;
+    if (need_preview) {
+        // Huge frames are shrunk region by region, so the gates still run before SIFT
+        voyis::TraceSpan preview_span("preview", input_msg.image_id);
+        preview = read_region
+            ? voyis::buildPreview(tiled_size, read_region, region_config.region_size,
+                                  voyis::DecodedFrame::kPreviewSize)
+            : frame.preview();
+    }
+
+    // Cheap quality check on the preview; failing frames are published without features
+    if (check_quality) {
+        processed_msg.quality = voyis::measureQuality(preview);
+        if (voyis::applyQualityThresholds(processed_msg.quality, quality_thresholds) !=
+            voyis::kQualityOk) {
+            processed_msg.processed_timestamp = nowMs();
+            return result;
+        }
+    }
+
+    // Reuse the previous frame's features if this one is nearly identical
+    uint64_t hash = 0;
+    if (duplicate_filter) {
+        hash = voyis::computeDHash(preview);
+        // Keypoints-only features are reusable only while the descriptor service can still
+        // serve them under this frame's id; otherwise the frame runs detection itself
+        auto servable = [&](const voyis::FrameFeatures& features) {
+            return !deferred.cache || !features.descriptors.empty() ||
+                   deferred.cache->alias(processed_msg.image_id, features.image_id);
+        };
+        const voyis::FrameFeatures* previous =
+            duplicate_filter->findDuplicate(input_msg.stream_id, hash, servable);
+        if (previous) {
+            processed_msg.width = previous->width;
+            processed_msg.height = previous->height;
+            processed_msg.keypoints = previous->keypoints;
+            processed_msg.descriptors = previous->descriptors;
+            processed_msg.descriptor_dim = previous->descriptors.empty()
+                ? 0 : static_cast<uint32_t>(previous->descriptors.front().size());
+            processed_msg.processed_timestamp = nowMs();
+            result.reused_from = previous->image_id;
+            return result;
+        }
+    }
+
+    // Detect keypoints and compute descriptors
+    std::vector<cv::KeyPoint> cv_keypoints;
+    cv::Mat cv_descriptors;
+    if (read_region) {
+        // Decode one region at a time while SIFT runs on the previous one
+        voyis::TraceSpan detect_span("detect", input_msg.image_id);
+        voyis::TiledFeatures features =
+            voyis::extractTiled(tiled_size, read_region, sift, region_config);
+        cv_keypoints = std::move(features.keypoints);
+        cv_descriptors = features.descriptors;
+        result.regions = features.regions;
+        processed_msg.width = tiled_size.width;
+        processed_msg.height = tiled_size.height;
+    } else {
+        // Decode image from bytes
+        voyis::TraceSpan decode_span("decode", input_msg.image_id);
+        const cv::Mat& image = frame.full();
+        decode_span.end();
+
+        voyis::TraceSpan detect_span("detect", input_msg.image_id);
+        if (deferred.cache) {
+            // Descriptors are roughly half of SIFT time; compute them only when asked
+            sift.detect(image, cv_keypoints);
+            deferred.cache->insert(input_msg.image_id, {image, cv_keypoints, deferred.detector});
+        } else {
+            sift.detectAndCompute(image, cv::noArray(), cv_keypoints, cv_descriptors);
+        }
+        processed_msg.width = image.cols;
+        processed_msg.height = image.rows;
+    }
+
+    // Reduce all descriptors of the frame in one matrix product
+    if (projection && !cv_descriptors.empty()) {
+        cv_descriptors = projection->project(cv_descriptors);
+    }
+
+    processed_msg.processed_timestamp = nowMs();
     processed_msg.keypoints = convertKeyPoints(cv_keypoints);
     processed_msg.descriptors = convertDescriptors(cv_descriptors);
+    processed_msg.descriptor_dim = cv_descriptors.empty()
+        ? 0 : static_cast<uint32_t>(cv_descriptors.cols);
+
+    if (duplicate_filter) {
+        voyis::FrameFeatures features;
+        features.image_id = processed_msg.image_id;
+        features.width = processed_msg.width;
+        features.height = processed_msg.height;
+        features.keypoints = processed_msg.keypoints;
+        features.descriptors = processed_msg.descriptors;
+        duplicate_filter->remember(input_msg.stream_id, hash, std::move(features));
+    }
+
+    return result;
+}
+
+/**
+ * @brief Receive image messages and hand them to the frame queue
+ *
+ * Runs on its own thread so that the ZeroMQ socket keeps being drained while
+ * the processing loop is busy; the queue then decides what to process next.
+ */
+void receiveLoop(voyis::Subscriber& subscriber, voyis::FrameQueue& queue, int port) {
+    if (voyis::TraceWriter* trace = voyis::TraceWriter::active()) {
+        trace->nameThread("receiver");
+    }
 
-    return processed_msg;
+    voyis::FrameBuffer raw_data; // Reused across frames
+    while (g_running) {
+        // Receive image message
+        if (!subscriber.receive(raw_data)) {
+            // Timeout or no data, continue waiting
+            continue;
+        }
+
+        try {
+            voyis::TraceSpan receive_span("receive", "", port);
+            voyis::ImageMessage msg = voyis::ImageMessage::deserialize(raw_data);
+            receive_span.setFrameId(msg.image_id);
+            VOYIS_TRACE2(frame_received, msg.image_id.c_str(), msg.image_data.size());
+            queue.push(std::move(msg));
+        } catch (const std::exception& e) {
+            std::cerr << "Error decoding image message: " << e.what() << std::endl;
+        }
+    }
+
+    queue.close();
+}
+
+/**
+ * @brief Print per-stream queue counters and per-size-class queueing delay
+ */
+void printQueueStatistics(const voyis::FrameQueue& queue) {
+    for (const auto& entry : queue.stats()) {
+        const std::string& stream = entry.first.empty() ? "(default)" : entry.first;
+        const voyis::StreamQueueStats& stats = entry.second;
+        std::cout << "Stream " << stream << ": received " << stats.enqueued
+                  << ", processed " << stats.dequeued
+                  << ", expired " << stats.expired
+                  << ", overflowed " << stats.overflowed << std::endl;
+    }
+
+    auto delays = queue.delayStats();
+    for (size_t i = 0; i < delays.size(); ++i) {
+        if (delays[i].count == 0) {
+            continue;
+        }
+        std::cout << "Queue delay (" << voyis::frameSizeClassName(static_cast<voyis::FrameSizeClass>(i))
+                  << " frames): mean " << delays[i].meanMs() << " ms, max "
+                  << delays[i].max_ms << " ms over " << delays[i].count << " frame(s)" << std::endl;
+    }
 }
 
 int main(int argc, char* argv[]) {
@@ -103,7 +492,160 @@ int main(int argc, char* argv[]) {
     std::signal(SIGTERM, signalHandler);
 
     try {
+        // Parse command line options
+        voyis::Options options(argc, argv);
+        voyis::FrameQueueConfig queue_config;
+        queue_config.policy = voyis::parseSchedulePolicy(options.getString("schedule", "fifo"));
+        queue_config.latency_slo_ms = options.getInt("latency-slo-ms", 0);
+        const int64_t queue_capacity = options.getInt("queue-capacity", 1000);
+        if (queue_capacity <= 0) {
+            throw std::invalid_argument("--queue-capacity must be positive");
+        }
+        queue_config.capacity = static_cast<size_t>(queue_capacity);
+        queue_config.max_wait_ms = options.getInt("max-wait-ms", 2000);
+        queue_config.stream_slo_ms = options.getIntMap("stream-slo");
+        queue_config.stream_weight = options.getDoubleMap("stream-weight");
+
+        // SIFT, threading and quality gate settings (every frame passes the gate by default)
+        voyis::Tunables tunables;
+        addTunables(tunables, options);
+        const bool autotune = options.getBool("autotune", false);
+        int opencv_threads = static_cast<int>(options.getInt("opencv-threads", cv::getNumThreads()));
+        cv::setNumThreads(opencv_threads);
+        cv::Ptr<cv::SIFT> sift = createSift(tunables);
+        voyis::QualityThresholds quality_thresholds = qualityThresholds(tunables);
+
+        // Region-wise processing of huge TIFF frames
+        TilingConfig tiling;
+        tiling.min_pixels = static_cast<int64_t>(options.getDouble("tiled-min-mp", 100.0) * 1e6);
+        int tile_size = static_cast<int>(options.getInt("tile-size", 2048));
+        tiling.regions.region_size = cv::Size(tile_size, tile_size);
+        tiling.regions.overlap = static_cast<int>(options.getInt("tile-overlap", 64));
+
+        // Optional search for the fastest settings per frame size class: the thread count
+        // for frames decoded whole, and also the tile size for huge TIFF frames, the only
+        // ones it affects
+        const std::string host = voyis::autotuneHostName();
+        const std::string autotune_profile =
+            options.getString("autotune-profile", voyis::defaultAutotuneProfile(host));
+        const std::string tiled_autotune_profile =
+            options.getString("autotune-tiled-profile", voyis::defaultTiledAutotuneProfile(host));
+        const std::vector<int> thread_counts = autotuneThreadCounts();
+        std::unique_ptr<voyis::Autotuner> autotuner =
+            configureAutotune(options, {{"opencv-threads", thread_counts}}, {opencv_threads},
+                              autotune_profile, host);
+        std::unique_ptr<voyis::Autotuner> tiled_autotuner;
+#ifdef VOYIS_HAVE_TIFF
+        if (tiling.min_pixels > 0) {
+            tiled_autotuner =
+                configureAutotune(options,
+                                  {{"opencv-threads", thread_counts},
+                                   {"tile-size", {512, 1024, 2048, 4096}}},
+                                  {opencv_threads, tile_size}, tiled_autotune_profile, host);
+        }
+#endif
+        auto saveAutotuneProfiles = [&]() {
+            auto save = [&host](const voyis::Autotuner* tuner, const std::string& profile) {
+                try {
+                    if (tuner) {
+                        tuner->save(profile, host);
+                    }
+                } catch (const std::exception& e) {
+                    std::cerr << "Autotune: " << e.what() << std::endl;
+                }
+            };
+            save(autotuner.get(), autotune_profile);
+            save(tiled_autotuner.get(), tiled_autotune_profile);
+        };
+
+        // Optional PCA reduction of descriptors
+        std::unique_ptr<voyis::DescriptorProjection> projection;
+        if (options.has("pca")) {
+            projection = std::make_unique<voyis::DescriptorProjection>(
+                voyis::DescriptorProjection::load(options.getString("pca")));
+        }
+
+        // Near-duplicate gate (disabled unless a Hamming threshold is given)
+        std::unique_ptr<voyis::DuplicateFilter> duplicate_filter;
+        if (options.has("dedup-hamming")) {
+            duplicate_filter = std::make_unique<voyis::DuplicateFilter>(
+                static_cast<int>(options.getInt("dedup-hamming")));
+        }
+
+        // Frame buffers for messages of --prefault-mb (none by default)
+        voyis::PageFaults startup_faults = voyis::PageFaults::now();
+        voyis::configureFramePool(options);
+
         std::cout << "Feature Extractor starting..." << std::endl;
+        std::cout << "Huge pages: " << voyis::hugePageModeName(voyis::FramePool::shared().mode())
+                  << ", prefaulting took "
+                  << (voyis::PageFaults::now() - startup_faults).minor << " page faults" << std::endl;
+
+        // Optional per-frame span trace
+        std::unique_ptr<voyis::TraceWriter> trace =
+            voyis::configureTracing(options, "feature_extractor");
+        if (trace) {
+            trace->nameThread("processing");
+            std::cout << "Tracing to: " << options.getString("trace") << std::endl;
+        }
+
+        // Always-on record of the last frames, dumped after latency spikes
+        std::unique_ptr<voyis::FlightRecorder> flight =
+            voyis::configureFlightRecorder(options, "feature_extractor");
+        if (flight) {
+            std::cout << "Flight recorder: " << flight->describe() << std::endl;
+        }
+
+        // Runtime control socket (voyisctl)
+        std::unique_ptr<voyis::ControlServer> control =
+            voyis::configureControl(options, "feature_extractor", tunables);
+        if (control) {
+            std::cout << "Control socket: " << control->endpoint() << std::endl;
+        }
+        std::atomic<double>& processed_stat = voyis::controlStat(control.get(), "frames_processed");
+        std::atomic<double>& rejected_stat = voyis::controlStat(control.get(), "frames_rejected");
+        std::atomic<double>& keypoints_stat = voyis::controlStat(control.get(), "keypoints_total");
+        std::atomic<double>& process_ms_stat = voyis::controlStat(control.get(), "last_process_ms");
+        std::atomic<double>& queued_stat = voyis::controlStat(control.get(), "queue_depth");
+
+        std::cout << "Schedule policy: " << voyis::schedulePolicyName(queue_config.policy)
+                  << ", latency SLO: " << queue_config.latency_slo_ms << " ms" << std::endl;
+        if (duplicate_filter) {
+            std::cout << "Near-duplicate skipping: Hamming distance <= "
+                      << duplicate_filter->maxDistance() << std::endl;
+        }
+        if (projection) {
+            std::cout << "PCA descriptors: " << projection->inputDim() << " -> "
+                      << projection->outputDim() << " dimensions" << std::endl;
+        }
+
+        // Keypoints-only publishing with descriptors computed on request
+        std::unique_ptr<voyis::FrameCache> frame_cache;
+        std::unique_ptr<voyis::DescriptorService> descriptor_service;
+        DeferredDescriptors deferred;
+        if (options.has("descriptor-service")) {
+            frame_cache = std::make_unique<voyis::FrameCache>(
+                static_cast<size_t>(options.getInt("descriptor-cache-frames", 32)),
+                static_cast<size_t>(options.getDouble("descriptor-cache-mb", 512.0) * 1024 * 1024));
+            descriptor_service = std::make_unique<voyis::DescriptorService>(
+                options.getString("descriptor-service"), *frame_cache, projection.get(),
+                control.get());
+            deferred.cache = frame_cache.get();
+            deferred.detector = createSift(tunables);
+
+            // Cached frames hold on to their decode buffers; keep enough for the next frames
+            voyis::DecodeBufferPool::shared().setMaxBuffers(
+                voyis::DecodeBufferPool::kDefaultBuffers + frame_cache->maxFrames());
+            std::cout << "Keypoints only; descriptor service on " << descriptor_service->endpoint()
+                      << " (cache: " << frame_cache->maxFrames() << " frames, "
+                      << frame_cache->maxBytes() / (1024.0 * 1024.0) << " MB)" << std::endl;
+        }
+        std::atomic<double>& cached_frames_stat =
+            voyis::controlStat(control.get(), "descriptor_cache_frames");
+        std::atomic<double>& cached_bytes_stat =
+            voyis::controlStat(control.get(), "descriptor_cache_bytes");
+
+        voyis::FrameQueue queue(queue_config);
 
         // Create subscriber for receiving images from Image Generator
         const std::string input_endpoint = "tcp://localhost:5555";
@@ -112,6 +654,7 @@ int main(int argc, char* argv[]) {
 
         // Create publisher for sending processed images to Data Logger
         const std::string output_endpoint = "tcp://*:5556";
+        const int output_port = voyis::endpointPort(output_endpoint);
         voyis::Publisher publisher(output_endpoint);
         std::cout << "Publisher bound to: " << output_endpoint << std::endl;
 
@@ -119,29 +662,75 @@ int main(int argc, char* argv[]) {
         std::cout << "Press Ctrl+C to stop." << std::endl;
 
         size_t processed_count = 0;
+        size_t rejected_count = 0;
         size_t total_keypoints = 0;
 
+        voyis::PageFaults steady_faults = voyis::PageFaults::now();
+        std::thread receiver(receiveLoop, std::ref(subscriber), std::ref(queue),
+                             voyis::endpointPort(input_endpoint));
+
         // Main processing loop
         while (g_running) {
-            std::vector<uint8_t> raw_data;
+            // Control changes take effect between frames
+            if (tunables.applyPending()) {
+                if (!autotune) {
+                    opencv_threads = static_cast<int>(tunables.getInt("opencv-threads"));
+                    cv::setNumThreads(opencv_threads);
+                }
+                sift = createSift(tunables);
+                quality_thresholds = qualityThresholds(tunables);
+                if (deferred.cache) {
+                    // Frames already cached keep the detector that found their keypoints
+                    deferred.detector = createSift(tunables);
+                }
+            }
 
-            // Receive image message
-            if (!subscriber.receive(raw_data)) {
-                // Timeout or no data, continue waiting
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            // Frames past their deadline are dropped by the queue before decode
+            std::optional<voyis::ImageMessage> next = queue.pop(100);
+            if (!next) {
                 continue;
             }
 
             try {
-                // Deserialize image message
-                voyis::ImageMessage img_msg = voyis::ImageMessage::deserialize(raw_data);
+                const voyis::ImageMessage& img_msg = *next;
+                voyis::FlightTimer flight_timer(flight.get(), img_msg.image_id, img_msg.timestamp);
 
                 std::cout << "\nReceived image: " << img_msg.image_id
-                          << " (" << img_msg.image_data.size() / 1024.0 << " KB)" << std::endl;
+                          << " (" << img_msg.image_data.size() / 1024.0 << " KB, "
+                          << queue.size() << " queued)" << std::endl;
+
+                // Huge TIFF frames are processed region by region
+                std::shared_ptr<voyis::TiffRegionReader> tiff;
+#ifdef VOYIS_HAVE_TIFF
+                tiff = openLargeTiff(img_msg, tiling.min_pixels);
+#endif
+
+                // The autotuner of the frame's path picks the setting for its size class
+                const double frame_cost = voyis::estimateFrameCost(img_msg);
+                const voyis::FrameSizeClass size_class = voyis::classifyFrameCost(frame_cost);
+                voyis::Autotuner* frame_tuner = tiff ? tiled_autotuner.get() : autotuner.get();
+                if (frame_tuner) {
+                    const voyis::Autotuner::Setting& setting = frame_tuner->select(size_class);
+                    if (setting[0] != opencv_threads) {
+                        opencv_threads = setting[0];
+                        cv::setNumThreads(opencv_threads);
+                    }
+                    if (tiff) {
+                        tiling.regions.region_size = cv::Size(setting[1], setting[1]);
+                    }
+                }
 
                 // Process image with SIFT
                 auto start_time = std::chrono::high_resolution_clock::now();
-                voyis::ProcessedImageMessage processed_msg = processImage(img_msg);
+                VOYIS_TRACE2(process_start, img_msg.image_id.c_str(), img_msg.image_data.size());
+                voyis::TraceSpan process_span("process", img_msg.image_id);
+                ProcessingResult result =
+                    processImage(img_msg, *sift, quality_thresholds, duplicate_filter.get(),
+                                 tiling, tiff.get(), projection.get(), deferred);
+                process_span.end();
+                voyis::ProcessedImageMessage& processed_msg = result.msg;
+                VOYIS_TRACE3(process_done, processed_msg.image_id.c_str(),
+                             processed_msg.keypoints.size(), processed_msg.quality.flags);
                 auto end_time = std::chrono::high_resolution_clock::now();
 
                 auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -153,30 +742,95 @@ int main(int argc, char* argv[]) {
 
                 std::cout << "  Dimensions: " << processed_msg.width << "x"
                           << processed_msg.height << std::endl;
-                std::cout << "  SIFT keypoints detected: " << processed_msg.keypoints.size()
-                          << std::endl;
+                if (!voyis::acceptsEveryFrame(quality_thresholds)) {
+                    std::cout << "  Quality: sharpness " << processed_msg.quality.sharpness
+                              << ", brightness " << processed_msg.quality.brightness << std::endl;
+                }
+                processed_stat.store(static_cast<double>(processed_count), std::memory_order_relaxed);
+                keypoints_stat.store(static_cast<double>(total_keypoints), std::memory_order_relaxed);
+                process_ms_stat.store(static_cast<double>(duration), std::memory_order_relaxed);
+                queued_stat.store(static_cast<double>(queue.size()), std::memory_order_relaxed);
+                if (frame_cache) {
+                    cached_frames_stat.store(static_cast<double>(frame_cache->size()),
+                                             std::memory_order_relaxed);
+                    cached_bytes_stat.store(static_cast<double>(frame_cache->bytes()),
+                                            std::memory_order_relaxed);
+                }
+                if (processed_msg.quality.flags != voyis::kQualityOk) {
+                    ++rejected_count;
+                    rejected_stat.store(static_cast<double>(rejected_count), std::memory_order_relaxed);
+                    std::cout << "  Skipped, failed quality check ("
+                              << describeQualityFlags(processed_msg.quality.flags) << ")"
+                              << std::endl;
+                } else if (!result.reused_from.empty()) {
+                    std::cout << "  Near-duplicate of " << result.reused_from
+                              << ", reusing " << processed_msg.keypoints.size()
+                              << " keypoints" << std::endl;
+                } else {
+                    std::cout << "  SIFT keypoints detected: " << processed_msg.keypoints.size();
+                    if (result.regions > 0) {
+                        std::cout << " (tiled, " << result.regions << " regions)";
+                    }
+                    std::cout << std::endl;
+                }
                 std::cout << "  Processing time: " << duration << " ms" << std::endl;
 
-                // Serialize and publish processed message
-                std::vector<uint8_t> serialized = processed_msg.serialize();
-                if (publisher.publish(serialized)) {
+                // Only full SIFT runs say anything about the setting
+                if (frame_tuner && processed_msg.quality.flags == voyis::kQualityOk &&
+                    result.reused_from.empty()) {
+                    double ms = std::chrono::duration<double, std::milli>(end_time - start_time).count();
+                    if (frame_tuner->record(size_class, frame_cost, ms)) {
+                        std::cout << "  Autotune: " << voyis::frameSizeClassName(size_class)
+                                  << (tiff ? " tiled" : "") << " frames converged on "
+                                  << frame_tuner->describe(frame_tuner->best(size_class))
+                                  << std::endl;
+                        saveAutotuneProfiles();
+                    }
+                }
+
+                // Serialize into a pooled buffer that ZeroMQ sends without copying
+                voyis::TraceSpan serialize_span("serialize", processed_msg.image_id);
+                voyis::FrameBuffer serialized = processed_msg.serializeFrame();
+                const size_t serialized_size = serialized.size();
+                serialize_span.end();
+
+                voyis::TraceSpan publish_span("publish", processed_msg.image_id, output_port);
+                bool published = publisher.publish(std::move(serialized));
+                publish_span.end();
+                if (published) {
+                    VOYIS_TRACE2(frame_published, processed_msg.image_id.c_str(), serialized_size);
                     std::cout << "  Published processed image ("
-                              << serialized.size() / 1024.0 << " KB)" << std::endl;
+                              << serialized_size / 1024.0 << " KB)" << std::endl;
                 } else {
                     std::cerr << "  Failed to publish processed image" << std::endl;
                 }
+                flight_timer.finish(queue.size());
 
             } catch (const std::exception& e) {
                 std::cerr << "Error processing image: " << e.what() << std::endl;
             }
         }
 
+        queue.close();
+        receiver.join();
+        if (autotuner) {
+            saveAutotuneProfiles();
+        }
+
         std::cout << "\nShutdown complete." << std::endl;
         std::cout << "Total images processed: " << processed_count << std::endl;
         if (processed_count > 0) {
             std::cout << "Average keypoints per image: "
                       << total_keypoints / processed_count << std::endl;
         }
+        std::cout << "Frames failing the quality check: " << rejected_count << std::endl;
+        if (duplicate_filter) {
+            std::cout << "Near-duplicate frames skipped: " << duplicate_filter->skipped()
+                      << std::endl;
+        }
+        printQueueStatistics(queue);
+        std::cout << voyis::frameMemoryReport(voyis::PageFaults::now() - steady_faults, processed_count)
+                  << std::endl;
 
     } catch (const std::exception& e) {
         std::cerr << "Fatal error: " << e.what() << std::endl;
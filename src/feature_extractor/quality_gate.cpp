@@ -0,0 +1,89 @@
+#include "quality_gate.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace voyis {
+
+QualityMetrics measureQuality(const cv::Mat& gray) {
+    if (gray.empty() || gray.type() != CV_8UC1) {
+        throw std::invalid_argument("Quality check requires a non-empty 8-bit grayscale image");
+    }
+
+    QualityMetrics metrics;
+
+    // Sharpness: blurry images have little high-frequency energy
+    cv::Mat laplacian;
+    cv::Laplacian(gray, laplacian, CV_32F);
+    cv::Scalar lap_mean, lap_stddev;
+    cv::meanStdDev(laplacian, lap_mean, lap_stddev);
+    metrics.sharpness = static_cast<float>(lap_stddev[0] * lap_stddev[0]);
+
+    // Exposure from the intensity histogram
+    int channels[] = {0};
+    int hist_size[] = {256};
+    float range[] = {0.0f, 256.0f};
+    const float* ranges[] = {range};
+    cv::Mat hist;
+    cv::calcHist(&gray, 1, channels, cv::Mat(), hist, 1, hist_size, ranges);
+
+    double total = static_cast<double>(gray.total());
+    double sum = 0.0;
+    double sum_sq = 0.0;
+    double dark = 0.0;
+    double saturated = 0.0;
+    for (int i = 0; i < 256; ++i) {
+        double count = hist.at<float>(i);
+        sum += count * i;
+        sum_sq += count * i * i;
+        if (i < 16) {
+            dark += count;
+        } else if (i > 239) {
+            saturated += count;
+        }
+    }
+
+    double mean = sum / total;
+    double variance = sum_sq / total - mean * mean;
+    metrics.brightness = static_cast<float>(mean);
+    metrics.contrast = static_cast<float>(std::sqrt(std::max(variance, 0.0)));
+    metrics.dark_fraction = static_cast<float>(dark / total);
+    metrics.saturated_fraction = static_cast<float>(saturated / total);
+
+    return metrics;
+}
+
+uint32_t applyQualityThresholds(QualityMetrics& metrics, const QualityThresholds& thresholds) {
+    uint32_t flags = kQualityOk;
+
+    if (metrics.sharpness < thresholds.min_sharpness) {
+        flags |= kQualityBlurry;
+    }
+    if (metrics.brightness < thresholds.min_brightness ||
+        metrics.dark_fraction > thresholds.max_dark_fraction) {
+        flags |= kQualityUnderexposed;
+    }
+    if (metrics.brightness > thresholds.max_brightness ||
+        metrics.saturated_fraction > thresholds.max_saturated_fraction) {
+        flags |= kQualityOverexposed;
+    }
+    if (metrics.contrast < thresholds.min_contrast) {
+        flags |= kQualityLowContrast;
+    }
+
+    metrics.flags = flags;
+    return flags;
+}
+
+bool acceptsEveryFrame(const QualityThresholds& thresholds) {
+    const QualityThresholds defaults;
+    return thresholds.min_sharpness <= defaults.min_sharpness &&
+           thresholds.min_brightness <= defaults.min_brightness &&
+           thresholds.max_brightness >= defaults.max_brightness &&
+           thresholds.max_dark_fraction >= defaults.max_dark_fraction &&
+           thresholds.max_saturated_fraction >= defaults.max_saturated_fraction &&
+           thresholds.min_contrast <= defaults.min_contrast;
+}
+
+} // namespace voyis
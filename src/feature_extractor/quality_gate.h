@@ -0,0 +1,42 @@
+#pragma once
+
+#include "message.h"
+#include <opencv2/core.hpp>
+
+namespace voyis {
+
+/**
+ * @brief Thresholds for the pre-extraction quality check
+ *
+ * Scores are measured on the reduced-resolution preview (see DecodedFrame),
+ * so sharpness thresholds refer to that scale. The defaults accept every
+ * frame.
+ */
+struct QualityThresholds {
+    double min_sharpness = 0.0;            // Minimum Laplacian variance
+    double min_brightness = 0.0;           // Minimum mean intensity
+    double max_brightness = 255.0;         // Maximum mean intensity
+    double max_dark_fraction = 1.0;        // Maximum fraction of pixels below 16
+    double max_saturated_fraction = 1.0;   // Maximum fraction of pixels above 239
+    double min_contrast = 0.0;             // Minimum intensity standard deviation
+};
+
+/**
+ * @brief Measure sharpness and exposure of an 8-bit grayscale image
+ *
+ * Flags are left at kQualityOk; see applyQualityThresholds().
+ */
+QualityMetrics measureQuality(const cv::Mat& gray);
+
+/**
+ * @brief Set the QualityFlags of metrics that fail the thresholds
+ * @return The resulting flags (kQualityOk if the frame passes)
+ */
+uint32_t applyQualityThresholds(QualityMetrics& metrics, const QualityThresholds& thresholds);
+
+/**
+ * @brief Whether every threshold is at its default, so no frame can fail the check
+ */
+bool acceptsEveryFrame(const QualityThresholds& thresholds);
+
+} // namespace voyis
@@ -0,0 +1,280 @@
+#include "tiff_region_reader.h"
+#include <opencv2/imgproc.hpp>
+#include <tiffio.h>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace voyis {
+
+namespace {
+
+// libtiff client callbacks over a read-only memory buffer
+
+using Stream = TiffRegionReader::MemoryStream;
+
+tmsize_t streamRead(thandle_t handle, void* buffer, tmsize_t count) {
+    Stream* stream = static_cast<Stream*>(handle);
+    if (count <= 0 || stream->position >= stream->size) {
+        return 0;
+    }
+    uint64_t available = stream->size - stream->position;
+    uint64_t n = std::min<uint64_t>(static_cast<uint64_t>(count), available);
+    std::memcpy(buffer, stream->data + stream->position, static_cast<size_t>(n));
+    stream->position += n;
+    return static_cast<tmsize_t>(n);
+}
+
+tmsize_t streamWrite(thandle_t, void*, tmsize_t) {
+    return -1;
+}
+
+toff_t streamSeek(thandle_t handle, toff_t offset, int whence) {
+    Stream* stream = static_cast<Stream*>(handle);
+    uint64_t base = 0;
+    if (whence == SEEK_CUR) {
+        base = stream->position;
+    } else if (whence == SEEK_END) {
+        base = stream->size;
+    }
+    stream->position = base + offset;
+    return stream->position;
+}
+
+int streamClose(thandle_t) {
+    return 0;
+}
+
+toff_t streamSize(thandle_t handle) {
+    return static_cast<Stream*>(handle)->size;
+}
+
+// Let libtiff read directly from the buffer instead of copying through streamRead
+int streamMap(thandle_t handle, void** base, toff_t* size) {
+    Stream* stream = static_cast<Stream*>(handle);
+    *base = const_cast<uint8_t*>(stream->data);
+    *size = stream->size;
+    return 1;
+}
+
+void streamUnmap(thandle_t, void*, toff_t) {}
+
+} // anonymous namespace
+
+TiffRegionReader::TiffRegionReader(const uint8_t* data, size_t size)
+    : stream_{data, size, 0}, tiff_(nullptr), width_(0), height_(0),
+      bits_per_sample_(0), samples_per_pixel_(0), min_is_white_(false),
+      tiled_(false), chunk_width_(0), chunk_height_(0), raw_strips_(false),
+      rows_per_strip_(0), strip_offsets_(nullptr) {
+    tiff_ = TIFFClientOpen("memory", "r", reinterpret_cast<thandle_t>(&stream_),
+                           streamRead, streamWrite, streamSeek, streamClose, streamSize,
+                           streamMap, streamUnmap);
+    if (!tiff_) {
+        throw std::runtime_error("Not a readable TIFF");
+    }
+
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint16_t bits = 0;
+    uint16_t samples = 0;
+    uint16_t planar = PLANARCONFIG_CONTIG;
+    uint16_t photometric = PHOTOMETRIC_MINISBLACK;
+    uint16_t sample_format = SAMPLEFORMAT_UINT;
+    TIFFGetField(tiff_, TIFFTAG_IMAGEWIDTH, &width);
+    TIFFGetField(tiff_, TIFFTAG_IMAGELENGTH, &height);
+    TIFFGetFieldDefaulted(tiff_, TIFFTAG_BITSPERSAMPLE, &bits);
+    TIFFGetFieldDefaulted(tiff_, TIFFTAG_SAMPLESPERPIXEL, &samples);
+    TIFFGetFieldDefaulted(tiff_, TIFFTAG_PLANARCONFIG, &planar);
+    TIFFGetFieldDefaulted(tiff_, TIFFTAG_SAMPLEFORMAT, &sample_format);
+    TIFFGetField(tiff_, TIFFTAG_PHOTOMETRIC, &photometric);
+
+    // JPEG-compressed YCbCr is converted to RGB by libtiff on request
+    if (photometric == PHOTOMETRIC_YCBCR) {
+        uint16_t compression = COMPRESSION_NONE;
+        TIFFGetFieldDefaulted(tiff_, TIFFTAG_COMPRESSION, &compression);
+        if (compression == COMPRESSION_JPEG) {
+            TIFFSetField(tiff_, TIFFTAG_JPEGCOLORMODE, JPEGCOLORMODE_RGB);
+            photometric = PHOTOMETRIC_RGB;
+        }
+    }
+
+    bool supported = width > 0 && height > 0 &&
+                     (bits == 8 || bits == 16) &&
+                     sample_format == SAMPLEFORMAT_UINT &&
+                     (samples == 1 || ((samples == 3 || samples == 4) && photometric == PHOTOMETRIC_RGB)) &&
+                     (samples == 1 || planar == PLANARCONFIG_CONTIG) &&
+                     (photometric == PHOTOMETRIC_MINISBLACK || photometric == PHOTOMETRIC_MINISWHITE ||
+                      photometric == PHOTOMETRIC_RGB);
+    if (!supported) {
+        TIFFClose(tiff_);
+        throw std::runtime_error("Unsupported TIFF layout (" + std::to_string(bits) + " bits, " +
+                                 std::to_string(samples) + " samples)");
+    }
+
+    width_ = static_cast<int>(width);
+    height_ = static_cast<int>(height);
+    bits_per_sample_ = bits;
+    samples_per_pixel_ = samples;
+    min_is_white_ = photometric == PHOTOMETRIC_MINISWHITE;
+    tiled_ = TIFFIsTiled(tiff_) != 0;
+
+    uint64_t chunk_bytes = 0;
+    if (tiled_) {
+        uint32_t tile_width = 0;
+        uint32_t tile_height = 0;
+        TIFFGetField(tiff_, TIFFTAG_TILEWIDTH, &tile_width);
+        TIFFGetField(tiff_, TIFFTAG_TILELENGTH, &tile_height);
+        chunk_width_ = static_cast<int>(tile_width);
+        chunk_height_ = static_cast<int>(tile_height);
+        chunk_bytes = static_cast<uint64_t>(TIFFTileSize64(tiff_));
+    } else {
+        uint32_t rows_per_strip = 0;
+        TIFFGetFieldDefaulted(tiff_, TIFFTAG_ROWSPERSTRIP, &rows_per_strip);
+        chunk_width_ = width_;
+        chunk_height_ = static_cast<int>(std::min(rows_per_strip, height));
+        chunk_bytes = static_cast<uint64_t>(TIFFStripSize64(tiff_));
+    }
+
+    if (chunk_width_ <= 0 || chunk_height_ <= 0 || chunk_bytes == 0) {
+        TIFFClose(tiff_);
+        throw std::runtime_error("Invalid TIFF tile or strip size");
+    }
+
+    uint16_t compression = COMPRESSION_NONE;
+    TIFFGetFieldDefaulted(tiff_, TIFFTAG_COMPRESSION, &compression);
+    if (!tiled_ && compression == COMPRESSION_NONE &&
+        (bits_per_sample_ == 8 || !TIFFIsByteSwapped(tiff_))) {
+        // Rows of uncompressed strips are addressed directly, so strip height does not matter
+        uint64_t* offsets = nullptr;
+        uint64_t* byte_counts = nullptr;
+        TIFFGetField(tiff_, TIFFTAG_STRIPOFFSETS, &offsets);
+        TIFFGetField(tiff_, TIFFTAG_STRIPBYTECOUNTS, &byte_counts);
+        const uint64_t row_bytes = static_cast<uint64_t>(width_) * samples_per_pixel_ *
+                                   (bits_per_sample_ / 8);
+        rows_per_strip_ = chunk_height_;
+        bool complete = offsets && byte_counts;
+        for (uint32_t strip = 0; complete && strip < TIFFNumberOfStrips(tiff_); ++strip) {
+            uint64_t rows = std::min<uint64_t>(rows_per_strip_,
+                                               height - static_cast<uint64_t>(strip) * rows_per_strip_);
+            complete = byte_counts[strip] >= rows * row_bytes &&
+                       offsets[strip] <= size && rows * row_bytes <= size - offsets[strip];
+        }
+        if (!complete) {
+            TIFFClose(tiff_);
+            throw std::runtime_error("Truncated uncompressed TIFF strips");
+        }
+        raw_strips_ = true;
+        strip_offsets_ = offsets;
+        chunk_height_ = 1;
+        return;
+    }
+
+    if (chunk_bytes > kMaxChunkBytes) {
+        TIFFClose(tiff_);
+        throw std::runtime_error("TIFF " + std::string(tiled_ ? "tiles" : "strips") + " of " +
+                                 std::to_string(chunk_bytes >> 20) +
+                                 " MB are too large to decode region by region");
+    }
+    chunk_.resize(static_cast<size_t>(chunk_bytes));
+}
+
+TiffRegionReader::~TiffRegionReader() {
+    TIFFClose(tiff_);
+}
+
+cv::Size TiffRegionReader::regionSize(int target) const {
+    auto roundUp = [](int value, int multiple) {
+        return std::max((value + multiple - 1) / multiple, 1) * multiple;
+    };
+
+    int height = roundUp(target, chunk_height_);
+    if (!tiled_) {
+        return cv::Size(width_, height);
+    }
+    return cv::Size(roundUp(target, chunk_width_), height);
+}
+
+void TiffRegionReader::toGray(const cv::Mat& samples, cv::Mat& dst) const {
+    cv::Mat gray = samples;
+    if (samples_per_pixel_ == 3) {
+        cv::cvtColor(samples, gray, cv::COLOR_RGB2GRAY);
+    } else if (samples_per_pixel_ == 4) {
+        cv::cvtColor(samples, gray, cv::COLOR_RGBA2GRAY);
+    }
+
+    if (bits_per_sample_ == 16) {
+        gray.convertTo(dst, CV_8U, 1.0 / 256.0);
+    } else {
+        gray.copyTo(dst);
+    }
+
+    if (min_is_white_) {
+        cv::bitwise_not(dst, dst);
+    }
+}
+
+void TiffRegionReader::readRawRows(const cv::Rect& roi, cv::Mat& region) const {
+    const int type = CV_MAKETYPE(bits_per_sample_ == 16 ? CV_16U : CV_8U, samples_per_pixel_);
+    const size_t row_bytes = static_cast<size_t>(width_) * samples_per_pixel_ * (bits_per_sample_ / 8);
+
+    // Rows within one strip are contiguous, so each strip is converted as one block
+    for (int y = roi.y; y < roi.y + roi.height;) {
+        int strip = y / rows_per_strip_;
+        int end = std::min((strip + 1) * rows_per_strip_, roi.y + roi.height);
+        const uint8_t* first = stream_.data + strip_offsets_[strip] +
+                               static_cast<size_t>(y - strip * rows_per_strip_) * row_bytes;
+        cv::Mat rows(end - y, width_, type, const_cast<uint8_t*>(first), row_bytes);
+        cv::Mat dst = region(cv::Rect(0, y - roi.y, roi.width, end - y));
+        toGray(rows.colRange(roi.x, roi.x + roi.width), dst);
+        y = end;
+    }
+}
+
+cv::Mat TiffRegionReader::readRegion(const cv::Rect& roi) {
+    const cv::Rect bounds(0, 0, width_, height_);
+    if (roi.empty() || (roi & bounds) != roi) {
+        throw std::runtime_error("TIFF region out of bounds");
+    }
+
+    cv::Mat region(roi.size(), CV_8UC1);
+    if (raw_strips_) {
+        readRawRows(roi, region);
+        return region;
+    }
+
+    const int type = CV_MAKETYPE(bits_per_sample_ == 16 ? CV_16U : CV_8U, samples_per_pixel_);
+    const size_t row_bytes = static_cast<size_t>(chunk_width_) * samples_per_pixel_ * (bits_per_sample_ / 8);
+
+    int first_y = (roi.y / chunk_height_) * chunk_height_;
+    int first_x = (roi.x / chunk_width_) * chunk_width_;
+    for (int y = first_y; y < roi.y + roi.height; y += chunk_height_) {
+        for (int x = first_x; x < roi.x + roi.width; x += chunk_width_) {
+            tmsize_t decoded = tiled_
+                ? TIFFReadEncodedTile(tiff_, TIFFComputeTile(tiff_, x, y, 0, 0),
+                                      chunk_.data(), static_cast<tmsize_t>(chunk_.size()))
+                : TIFFReadEncodedStrip(tiff_, TIFFComputeStrip(tiff_, y, 0),
+                                       chunk_.data(), static_cast<tmsize_t>(chunk_.size()));
+            if (decoded < 0) {
+                throw std::runtime_error("Failed to decode TIFF " +
+                                         std::string(tiled_ ? "tile" : "strip") +
+                                         " at row " + std::to_string(y));
+            }
+
+            // The last strip may be short; tiles are always padded to full size
+            int rows = std::min(chunk_height_, height_ - y);
+            cv::Mat chunk(rows, chunk_width_, type, chunk_.data(), row_bytes);
+
+            cv::Rect overlap = cv::Rect(x, y, chunk_width_, rows) & roi;
+            if (overlap.empty()) {
+                continue;
+            }
+            cv::Mat dst = region(overlap - roi.tl());
+            toGray(chunk(overlap - cv::Point(x, y)), dst);
+        }
+    }
+
+    return region;
+}
+
+} // namespace voyis
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Forward declaration of the libtiff handle
+typedef struct tiff TIFF;
+
+namespace voyis {
+
+/**
+ * @brief Decodes rectangles of an in-memory TIFF without decoding the whole image
+ *
+ * Works on tiled and striped TIFFs (8 or 16 bits per sample, gray or RGB,
+ * any compression libtiff supports). Only the tiles or strips overlapping a
+ * requested rectangle are decompressed, one at a time, so memory use is
+ * bounded by the rectangle plus one tile or strip. Uncompressed strips are
+ * read row by row in place, however tall they are; compressed strips larger
+ * than kMaxChunkBytes (such as a whole image stored as one strip) are
+ * rejected, since each would have to be decoded whole for every region. The
+ * payload is read in place and must outlive the reader.
+ *
+ * Only available when built with libtiff (VOYIS_HAVE_TIFF).
+ */
+class TiffRegionReader {
+public:
+    /**
+     * @throws std::runtime_error if the data is not a TIFF this reader supports
+     */
+    TiffRegionReader(const uint8_t* data, size_t size);
+    ~TiffRegionReader();
+
+    TiffRegionReader(const TiffRegionReader&) = delete;
+    TiffRegionReader& operator=(const TiffRegionReader&) = delete;
+
+    /**
+     * @brief Largest tile or compressed strip decoded at once
+     */
+    static constexpr size_t kMaxChunkBytes = 64 << 20;
+
+    cv::Size size() const { return cv::Size(width_, height_); }
+
+    bool isTiled() const { return tiled_; }
+
+    /**
+     * @brief Size of one tile, or of one strip for striped TIFFs (one row if uncompressed)
+     */
+    cv::Size chunkSize() const { return cv::Size(chunk_width_, chunk_height_); }
+
+    /**
+     * @brief Region size close to target that avoids decoding chunks twice
+     *
+     * Rounds up to whole tiles. Strips always span the full width, so
+     * regions of a striped TIFF are full-width bands.
+     */
+    cv::Size regionSize(int target) const;
+
+    /**
+     * @brief Decode a rectangle to 8-bit grayscale
+     *
+     * 16-bit samples keep their most significant byte. Not thread-safe, but
+     * may be called from different threads one at a time.
+     *
+     * @throws std::runtime_error on a decode error
+     */
+    cv::Mat readRegion(const cv::Rect& roi);
+
+    /**
+     * @brief Read position in the payload, used by the libtiff callbacks
+     */
+    struct MemoryStream {
+        const uint8_t* data;
+        uint64_t size;
+        uint64_t position;
+    };
+
+private:
+    // Convert a block of decoded samples to 8-bit gray in dst
+    void toGray(const cv::Mat& samples, cv::Mat& dst) const;
+
+    // Copy the rows of roi straight from uncompressed strips
+    void readRawRows(const cv::Rect& roi, cv::Mat& region) const;
+
+    MemoryStream stream_;
+    TIFF* tiff_;
+    int width_;
+    int height_;
+    int bits_per_sample_;
+    int samples_per_pixel_;
+    bool min_is_white_;
+    bool tiled_;
+    int chunk_width_;
+    int chunk_height_;
+    std::vector<uint8_t> chunk_;
+    bool raw_strips_;            // Uncompressed strips, read in place
+    int rows_per_strip_;
+    const uint64_t* strip_offsets_; // Owned by libtiff
+};
+
+} // namespace voyis
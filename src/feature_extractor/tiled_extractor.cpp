@@ -0,0 +1,113 @@
+#include "tiled_extractor.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <stdexcept>
+
+namespace voyis {
+
+std::vector<cv::Rect> planRegions(const cv::Size& image_size, const cv::Size& region_size) {
+    if (region_size.width <= 0 || region_size.height <= 0) {
+        throw std::invalid_argument("Region size must be positive");
+    }
+
+    std::vector<cv::Rect> regions;
+    for (int y = 0; y < image_size.height; y += region_size.height) {
+        for (int x = 0; x < image_size.width; x += region_size.width) {
+            regions.emplace_back(x, y,
+                                 std::min(region_size.width, image_size.width - x),
+                                 std::min(region_size.height, image_size.height - y));
+        }
+    }
+    return regions;
+}
+
+TiledFeatures extractTiled(const cv::Size& image_size, const RegionReader& read,
+                           cv::Feature2D& detector, const TiledExtractionConfig& config) {
+    const cv::Rect bounds(cv::Point(0, 0), image_size);
+    const std::vector<cv::Rect> regions = planRegions(image_size, config.region_size);
+
+    auto padded = [&](const cv::Rect& core) {
+        cv::Rect rect(core.x - config.overlap, core.y - config.overlap,
+                      core.width + 2 * config.overlap, core.height + 2 * config.overlap);
+        return rect & bounds;
+    };
+    auto readAsync = [&](size_t index) {
+        cv::Rect rect = padded(regions[index]);
+        return std::async(std::launch::async, [&read, rect]() { return read(rect); });
+    };
+
+    TiledFeatures result;
+    if (regions.empty()) {
+        return result;
+    }
+
+    std::future<cv::Mat> next = readAsync(0);
+    for (size_t i = 0; i < regions.size(); ++i) {
+        cv::Mat pixels = next.get();
+
+        // Start reading the following region before detecting on this one
+        if (i + 1 < regions.size()) {
+            next = readAsync(i + 1);
+        }
+
+        const cv::Rect& core = regions[i];
+        const cv::Rect area = padded(core);
+        if (pixels.size() != area.size()) {
+            throw std::runtime_error("Region reader returned an image of the wrong size");
+        }
+
+        std::vector<cv::KeyPoint> keypoints;
+        cv::Mat descriptors;
+        detector.detectAndCompute(pixels, cv::noArray(), keypoints, descriptors);
+
+        for (size_t k = 0; k < keypoints.size(); ++k) {
+            cv::KeyPoint kp = keypoints[k];
+            kp.pt.x += static_cast<float>(area.x);
+            kp.pt.y += static_cast<float>(area.y);
+
+            // Keypoints in the margin belong to a neighbouring region
+            if (kp.pt.x < core.x || kp.pt.y < core.y ||
+                kp.pt.x >= core.x + core.width || kp.pt.y >= core.y + core.height) {
+                continue;
+            }
+
+            result.keypoints.push_back(kp);
+            if (!descriptors.empty()) {
+                result.descriptors.push_back(descriptors.row(static_cast<int>(k)));
+            }
+        }
+        ++result.regions;
+    }
+
+    return result;
+}
+
+cv::Mat buildPreview(const cv::Size& image_size, const RegionReader& read,
+                     const cv::Size& region_size, int max_side) {
+    int longest = std::max(image_size.width, image_size.height);
+    double scale = longest > max_side ? static_cast<double>(max_side) / longest : 1.0;
+
+    auto scaled = [scale](int v) { return static_cast<int>(std::lround(v * scale)); };
+    cv::Mat preview = cv::Mat::zeros(std::max(scaled(image_size.height), 1),
+                                     std::max(scaled(image_size.width), 1), CV_8UC1);
+
+    for (const cv::Rect& region : planRegions(image_size, region_size)) {
+        // Destination rectangle from rounded edges, so neighbours line up exactly
+        cv::Rect dest(cv::Point(scaled(region.x), scaled(region.y)),
+                      cv::Point(scaled(region.x + region.width), scaled(region.y + region.height)));
+        dest &= cv::Rect(0, 0, preview.cols, preview.rows);
+        if (dest.empty()) {
+            continue;
+        }
+
+        cv::Mat pixels = read(region);
+        cv::Mat target = preview(dest);
+        cv::resize(pixels, target, dest.size(), 0, 0, cv::INTER_AREA);
+    }
+
+    return preview;
+}
+
+} // namespace voyis
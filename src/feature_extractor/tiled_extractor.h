@@ -0,0 +1,64 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <opencv2/features2d.hpp>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace voyis {
+
+/**
+ * @brief Reads one rectangle of an image as 8-bit grayscale
+ *
+ * Calls are made one at a time, but not always from the same thread.
+ */
+using RegionReader = std::function<cv::Mat(const cv::Rect&)>;
+
+/**
+ * @brief Region layout for tiled feature extraction
+ */
+struct TiledExtractionConfig {
+    cv::Size region_size{2048, 2048}; // Core size of each region
+    int overlap = 64;                 // Margin read around each region, in pixels
+};
+
+/**
+ * @brief Features of a whole image extracted region by region
+ */
+struct TiledFeatures {
+    std::vector<cv::KeyPoint> keypoints; // In full-image coordinates
+    cv::Mat descriptors;                 // One row per keypoint
+    size_t regions = 0;                  // Number of regions processed
+};
+
+/**
+ * @brief Split an image into non-overlapping core regions, row by row
+ */
+std::vector<cv::Rect> planRegions(const cv::Size& image_size, const cv::Size& region_size);
+
+/**
+ * @brief Detect features on an image that is never held in memory as a whole
+ *
+ * Each core region is read with an overlap margin so that features near its
+ * edges see their full neighbourhood; only keypoints whose centre falls in
+ * the core region are kept, so every feature is reported once. The next
+ * region is read on a background thread while the detector runs on the
+ * current one, so peak memory is about two padded regions and decoding
+ * overlaps with detection.
+ */
+TiledFeatures extractTiled(const cv::Size& image_size, const RegionReader& read,
+                           cv::Feature2D& detector, const TiledExtractionConfig& config);
+
+/**
+ * @brief Build a reduced-resolution image region by region
+ *
+ * Each region is shrunk into its place in the output, so the full image is
+ * never decoded at once.
+ *
+ * @param max_side Longest side of the result in pixels
+ */
+cv::Mat buildPreview(const cv::Size& image_size, const RegionReader& read,
+                     const cv::Size& region_size, int max_side);
+
+} // namespace voyis
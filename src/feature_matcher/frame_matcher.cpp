@@ -0,0 +1,170 @@
+#include "frame_matcher.h"
+#include <opencv2/calib3d.hpp>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace voyis {
+
+cv::Mat descriptorMatrix(const ProcessedImageMessage& msg) {
+    if (msg.descriptors.empty()) {
+        return cv::Mat();
+    }
+
+    const size_t dim = msg.descriptors.front().size();
+    cv::Mat matrix(static_cast<int>(msg.descriptors.size()), static_cast<int>(dim), CV_32F);
+    for (size_t i = 0; i < msg.descriptors.size(); ++i) {
+        if (msg.descriptors[i].size() != dim) {
+            throw std::runtime_error("Descriptors of different lengths in " + msg.image_id);
+        }
+        std::memcpy(matrix.ptr<float>(static_cast<int>(i)), msg.descriptors[i].data(),
+                    dim * sizeof(float));
+    }
+    return matrix;
+}
+
+MatchMethod parseMatchMethod(const std::string& name) {
+    if (name == "bf") {
+        return MatchMethod::BruteForce;
+    }
+    if (name == "flann") {
+        return MatchMethod::Flann;
+    }
+    throw std::invalid_argument("Unknown match method: " + name);
+}
+
+const char* matchMethodName(MatchMethod method) {
+    switch (method) {
+        case MatchMethod::BruteForce: return "bf";
+        case MatchMethod::Flann: return "flann";
+    }
+    return "unknown";
+}
+
+FrameMatcher::FrameMatcher(const FrameMatcherConfig& config) : config_(config) {}
+
+std::vector<FeatureMatch> FrameMatcher::matchAgainst(const cv::Mat& query,
+                                                     const WindowFrame& reference) const {
+    std::vector<std::vector<cv::DMatch>> knn;
+    if (reference.index) {
+        reference.index->knnMatch(query, knn, 2);
+    } else {
+        cv::BFMatcher matcher(cv::NORM_L2);
+        matcher.knnMatch(query, reference.descriptors, knn, 2);
+    }
+
+    std::vector<FeatureMatch> matches;
+    for (const auto& neighbours : knn) {
+        if (neighbours.size() < 2) {
+            continue;
+        }
+        if (neighbours[0].distance < config_.ratio * neighbours[1].distance) {
+            matches.emplace_back(static_cast<uint32_t>(neighbours[0].queryIdx),
+                                 static_cast<uint32_t>(neighbours[0].trainIdx),
+                                 neighbours[0].distance);
+        }
+    }
+    return matches;
+}
+
+MatchSetMessage FrameMatcher::process(const ProcessedImageMessage& msg) {
+    MatchSetMessage result;
+    result.image_id = msg.image_id;
+    result.stream_id = msg.stream_id;
+    result.timestamp = msg.timestamp;
+
+    WindowFrame frame;
+    frame.image_id = msg.image_id;
+    frame.descriptors = descriptorMatrix(msg);
+    if (frame.descriptors.empty()) {
+        return result;
+    }
+
+    frame.points.reserve(msg.keypoints.size());
+    for (const auto& kp : msg.keypoints) {
+        frame.points.emplace_back(kp.pt.x, kp.pt.y);
+    }
+    if (frame.points.size() < static_cast<size_t>(frame.descriptors.rows)) {
+        throw std::runtime_error("Fewer keypoints than descriptors in " + msg.image_id);
+    }
+
+    std::deque<WindowFrame>& window = windows_[msg.stream_id];
+    for (const WindowFrame& reference : window) {
+        // Descriptors from a different projection cannot be compared, and the
+        // ratio test needs two neighbours
+        if (reference.descriptors.cols != frame.descriptors.cols || reference.descriptors.rows < 2) {
+            continue;
+        }
+
+        FrameMatch frame_match;
+        frame_match.reference_id = reference.image_id;
+        std::vector<FeatureMatch> matches = matchAgainst(frame.descriptors, reference);
+
+        if (matches.size() >= static_cast<size_t>(std::max(config_.min_homography_matches, 4))) {
+            std::vector<cv::Point2f> src;
+            std::vector<cv::Point2f> dst;
+            src.reserve(matches.size());
+            dst.reserve(matches.size());
+            for (const auto& match : matches) {
+                src.push_back(frame.points[match.query_idx]);
+                dst.push_back(reference.points[match.train_idx]);
+            }
+
+            std::vector<uint8_t> inlier_mask;
+            cv::Mat homography = cv::findHomography(src, dst, cv::RANSAC,
+                                                    config_.ransac_threshold, inlier_mask);
+            if (!homography.empty()) {
+                frame_match.has_homography = true;
+                for (int i = 0; i < 9; ++i) {
+                    frame_match.homography[i] = homography.at<double>(i / 3, i % 3);
+                }
+
+                // Only geometrically consistent matches are published
+                std::vector<FeatureMatch> inliers;
+                for (size_t i = 0; i < matches.size(); ++i) {
+                    if (inlier_mask[i]) {
+                        inliers.push_back(matches[i]);
+                    }
+                }
+                matches.swap(inliers);
+                frame_match.num_inliers = static_cast<uint32_t>(matches.size());
+            }
+        }
+
+        frame_match.matches = std::move(matches);
+        result.frames.push_back(std::move(frame_match));
+    }
+
+    // Index the frame once for all the frames that will be matched against it
+    if (config_.method == MatchMethod::Flann) {
+        frame.index = cv::FlannBasedMatcher::create();
+        frame.index->add(std::vector<cv::Mat>{frame.descriptors});
+        frame.index->train();
+    }
+
+    window.push_front(std::move(frame));
+    while (window.size() > config_.window) {
+        window.pop_back();
+    }
+
+    return result;
+}
+
+void FrameMatcher::setConfig(const FrameMatcherConfig& config) {
+    if (config.method != config_.method) {
+        throw std::invalid_argument("The match method cannot change while frames are windowed");
+    }
+    config_ = config;
+    for (auto& entry : windows_) {
+        while (entry.second.size() > config_.window) {
+            entry.second.pop_back();
+        }
+    }
+}
+
+size_t FrameMatcher::windowSize(const std::string& stream_id) const {
+    auto it = windows_.find(stream_id);
+    return it == windows_.end() ? 0 : it->second.size();
+}
+
+} // namespace voyis
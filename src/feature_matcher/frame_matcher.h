@@ -0,0 +1,102 @@
+#pragma once
+
+#include "message.h"
+#include <opencv2/core.hpp>
+#include <opencv2/features2d.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace voyis {
+
+/**
+ * @brief Nearest-neighbour search used to match descriptors
+ */
+enum class MatchMethod {
+    BruteForce, // Exact L2 kNN (cv::BFMatcher, vectorized)
+    Flann       // Approximate kNN over a KD-tree forest built once per frame
+};
+
+/**
+ * @brief Parse a match method name ("bf" or "flann")
+ * @throws std::invalid_argument for unknown names
+ */
+MatchMethod parseMatchMethod(const std::string& name);
+
+/**
+ * @brief Name of a match method
+ */
+const char* matchMethodName(MatchMethod method);
+
+/**
+ * @brief Copy the descriptors of a message into one N x dim CV_32F matrix
+ * @return The matrix, empty if the message has no descriptors
+ * @throws std::runtime_error if descriptor lengths differ
+ */
+cv::Mat descriptorMatrix(const ProcessedImageMessage& msg);
+
+/**
+ * @brief Matching parameters
+ */
+struct FrameMatcherConfig {
+    size_t window = 3;               // Earlier frames of the same stream to match against
+    MatchMethod method = MatchMethod::BruteForce;
+    float ratio = 0.8f;              // Lowe's ratio test on the two nearest neighbours
+    int min_homography_matches = 8;  // Fewer ratio-test matches skip homography estimation
+    double ransac_threshold = 3.0;   // RANSAC reprojection threshold in pixels
+};
+
+/**
+ * @brief Matches each frame against the previous frames of its stream as it arrives
+ *
+ * Keeps a rolling window of descriptor matrices (and, for FLANN, their
+ * search indexes) per stream, so every frame is converted and indexed once
+ * and matched once against each of the N frames before it. Frames without
+ * descriptors (e.g. rejected by the quality check) are not added to the
+ * window. Not thread-safe.
+ */
+class FrameMatcher {
+public:
+    explicit FrameMatcher(const FrameMatcherConfig& config);
+
+    /**
+     * @brief Match a frame against its stream's window, then add it to the window
+     * @return One FrameMatch per window frame with compatible descriptors, newest first
+     */
+    MatchSetMessage process(const ProcessedImageMessage& msg);
+
+    /**
+     * @brief Change the parameters between frames
+     *
+     * A smaller window drops the oldest frames right away.
+     * @throws std::invalid_argument if the method changes (window frames
+     *         keep search indexes built for the current one)
+     */
+    void setConfig(const FrameMatcherConfig& config);
+
+    const FrameMatcherConfig& config() const { return config_; }
+
+    /**
+     * @brief Number of frames currently held for a stream
+     */
+    size_t windowSize(const std::string& stream_id) const;
+
+private:
+    struct WindowFrame {
+        std::string image_id;
+        cv::Mat descriptors;              // N x dim, CV_32F
+        std::vector<cv::Point2f> points;  // Keypoint positions
+        cv::Ptr<cv::DescriptorMatcher> index; // Trained on descriptors (FLANN only)
+    };
+
+    // Ratio-test matches of query descriptors against a window frame
+    std::vector<FeatureMatch> matchAgainst(const cv::Mat& query, const WindowFrame& reference) const;
+
+    FrameMatcherConfig config_;
+    std::map<std::string, std::deque<WindowFrame>> windows_; // Newest frame first
+};
+
+} // namespace voyis
@@ -0,0 +1,317 @@
+#include "ipc.h"
+#include "message.h"
+#include "options.h"
+#include "frame_allocator.h"
+#include "tracepoints.h"
+#include "trace_writer.h"
+#include "flight_recorder.h"
+#include "control.h"
+#include "frame_matcher.h"
+#include "place_index.h"
+#include "place_index_store.h"
+#include <iostream>
+#include <chrono>
+#include <csignal>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Global flag for graceful shutdown
+std::atomic<bool> g_running(true);
+
+void signalHandler(int signal) {
+    if (signal == SIGINT || signal == SIGTERM) {
+        std::cout << "\nReceived shutdown signal. Exiting gracefully..." << std::endl;
+        g_running = false;
+    }
+}
+
+/**
+ * @brief Current wall clock time in milliseconds since epoch
+ */
+int64_t nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count();
+}
+
+/**
+ * @brief Fill in the descriptors of a frame the extractor published with keypoints only
+ * @param service Connected to the extractor's --descriptor-service endpoint
+ * @return Why no descriptors were filled in, empty on success
+ */
+std::string fetchDescriptors(voyis::Requester& service, voyis::ProcessedImageMessage& msg) {
+    voyis::DescriptorRequest request;
+    request.image_id = msg.image_id;
+    std::vector<uint8_t> reply_data;
+    if (!service.request(request.serialize(), reply_data)) {
+        return "no reply from the descriptor service";
+    }
+
+    voyis::DescriptorReply reply = voyis::DescriptorReply::deserialize(reply_data);
+    if (!reply.found || !reply.error.empty()) {
+        return reply.error.empty() ? "frame not found" : reply.error;
+    }
+    msg.descriptors = std::move(reply.descriptors);
+    msg.descriptor_dim = reply.descriptor_dim;
+    return "";
+}
+
+int main(int argc, char* argv[]) {
+    // Set up signal handlers
+    std::signal(SIGINT, signalHandler);
+    std::signal(SIGTERM, signalHandler);
+
+    try {
+        // Parse command line options
+        voyis::Options options(argc, argv);
+        voyis::FrameMatcherConfig config;
+        config.window = static_cast<size_t>(options.getInt("window", 3));
+        config.method = voyis::parseMatchMethod(options.getString("matcher", "bf"));
+        config.ratio = static_cast<float>(options.getDouble("ratio", 0.8));
+        config.min_homography_matches = static_cast<int>(options.getInt("min-matches", 8));
+        config.ransac_threshold = options.getDouble("ransac-threshold", 3.0);
+
+        // Frame buffers for messages of --prefault-mb (none by default)
+        voyis::PageFaults startup_faults = voyis::PageFaults::now();
+        voyis::configureFramePool(options);
+
+        std::cout << "Feature Matcher starting..." << std::endl;
+        std::cout << "Huge pages: " << voyis::hugePageModeName(voyis::FramePool::shared().mode())
+                  << ", prefaulting took "
+                  << (voyis::PageFaults::now() - startup_faults).minor << " page faults" << std::endl;
+        std::unique_ptr<voyis::TraceWriter> trace = voyis::configureTracing(options, "feature_matcher");
+        std::cout << "Matching against the previous " << config.window << " frame(s) with "
+                  << voyis::matchMethodName(config.method) << ", ratio " << config.ratio
+                  << std::endl;
+        if (trace) {
+            std::cout << "Tracing to: " << options.getString("trace") << std::endl;
+        }
+
+        // Always-on record of the last frames, dumped after latency spikes
+        std::unique_ptr<voyis::FlightRecorder> flight =
+            voyis::configureFlightRecorder(options, "feature_matcher");
+        if (flight) {
+            std::cout << "Flight recorder: " << flight->describe() << std::endl;
+        }
+
+        voyis::FrameMatcher matcher(config);
+
+        // Descriptors of frames from an extractor that publishes keypoints only
+        std::unique_ptr<voyis::Requester> descriptor_service;
+        if (options.has("descriptor-service")) {
+            descriptor_service = std::make_unique<voyis::Requester>(
+                options.getString("descriptor-service"),
+                static_cast<int>(options.getInt("descriptor-timeout-ms", 1000)));
+            std::cout << "Descriptors of keypoints-only frames from: "
+                      << options.getString("descriptor-service") << std::endl;
+        }
+
+        // Settings that voyisctl can change while running
+        voyis::Tunables tunables;
+        tunables.add("window", static_cast<double>(config.window), 1, 1000,
+                     "Earlier frames of the same stream to match against", true);
+        tunables.add("ratio", config.ratio, 0.1, 1.0, "Lowe's ratio test threshold");
+        tunables.add("min-matches", config.min_homography_matches, 4, 100000,
+                     "Fewer ratio-test matches skip homography estimation", true);
+        tunables.add("ransac-threshold", config.ransac_threshold, 0.1, 100.0,
+                     "RANSAC reprojection threshold in pixels");
+
+        // Runtime control socket (voyisctl)
+        std::unique_ptr<voyis::ControlServer> control =
+            voyis::configureControl(options, "feature_matcher", tunables);
+        if (control) {
+            std::cout << "Control socket: " << control->endpoint() << std::endl;
+        }
+        std::atomic<double>& matched_stat = voyis::controlStat(control.get(), "frames_matched");
+        std::atomic<double>& homography_stat = voyis::controlStat(control.get(), "homographies");
+        std::atomic<double>& match_ms_stat = voyis::controlStat(control.get(), "last_match_ms");
+        std::atomic<double>& no_descriptors_stat =
+            voyis::controlStat(control.get(), "frames_without_descriptors");
+
+        // Optional loop-closure candidates from a bag-of-words place index
+        std::unique_ptr<voyis::PlaceRecognizer> places;
+        if (options.has("places")) {
+            voyis::VocabularyConfig vocabulary_config;
+            vocabulary_config.num_words = static_cast<int>(options.getInt("vocab-words", 500));
+            vocabulary_config.training_samples =
+                static_cast<int>(options.getInt("vocab-samples", 20000));
+
+            voyis::PlaceIndexConfig index_config;
+            index_config.top_k = static_cast<size_t>(options.getInt("loop-top-k", 5));
+            index_config.exclude_recent =
+                static_cast<size_t>(options.getInt("loop-exclude-recent", 20));
+            index_config.min_score = static_cast<float>(options.getDouble("loop-min-score", 0.05));
+
+            voyis::Vocabulary vocabulary;
+            if (options.has("vocabulary")) {
+                vocabulary = voyis::Vocabulary::load(options.getString("vocabulary", ""));
+            }
+
+            const std::string place_db = options.getString("place-db", "image_data_places.db");
+            places = std::make_unique<voyis::PlaceRecognizer>(
+                std::move(vocabulary), vocabulary_config, index_config,
+                std::make_unique<voyis::PlaceIndexStore>(place_db));
+
+            std::cout << "Place index: " << place_db << " (" << places->indexedFrames()
+                      << " frames indexed";
+            if (places->hasVocabulary()) {
+                std::cout << ", " << places->vocabulary().size() << " words)" << std::endl;
+            } else {
+                std::cout << ", learning " << vocabulary_config.num_words << " words from the first "
+                          << vocabulary_config.training_samples << " descriptors)" << std::endl;
+            }
+        }
+
+        // Create subscriber for receiving features from Feature Extractor
+        const std::string input_endpoint = "tcp://localhost:5556";
+        const int input_port = voyis::endpointPort(input_endpoint);
+        voyis::Subscriber subscriber(input_endpoint, 1000); // 1 second timeout
+        std::cout << "Subscriber connected to: " << input_endpoint << std::endl;
+
+        // Create publisher for match sets
+        const std::string output_endpoint = "tcp://*:5557";
+        const int output_port = voyis::endpointPort(output_endpoint);
+        voyis::Publisher publisher(output_endpoint);
+        std::cout << "Publisher bound to: " << output_endpoint << std::endl;
+
+        std::cout << "Waiting for features to match..." << std::endl;
+        std::cout << "Press Ctrl+C to stop." << std::endl;
+
+        size_t matched_count = 0;
+        size_t homography_count = 0;
+        size_t pair_count = 0;
+        size_t loop_count = 0;
+        size_t no_descriptors_count = 0;
+        voyis::PageFaults steady_faults = voyis::PageFaults::now();
+
+        // Main matching loop
+        voyis::FrameBuffer raw_data; // Reused across frames
+        while (g_running) {
+            // Control changes take effect between frames
+            if (tunables.applyPending()) {
+                config.window = static_cast<size_t>(tunables.getInt("window"));
+                config.ratio = static_cast<float>(tunables.get("ratio"));
+                config.min_homography_matches = static_cast<int>(tunables.getInt("min-matches"));
+                config.ransac_threshold = tunables.get("ransac-threshold");
+                matcher.setConfig(config);
+            }
+
+            // Receive processed message
+            if (!subscriber.receive(raw_data)) {
+                // Timeout or no data, continue waiting
+                continue;
+            }
+
+            try {
+                voyis::FlightTimer flight_timer(flight.get(), "");
+                voyis::TraceSpan receive_span("receive", "", input_port);
+                voyis::ProcessedImageMessage msg =
+                    voyis::ProcessedImageMessage::deserialize(raw_data);
+                receive_span.setFrameId(msg.image_id);
+                flight_timer.setFrameId(msg.image_id, msg.timestamp);
+                receive_span.end();
+
+                // Keypoints without descriptors cannot be matched or indexed
+                if (msg.descriptors.empty() && !msg.keypoints.empty()) {
+                    std::string error = "extractor publishes keypoints only; pass "
+                                        "--descriptor-service=<endpoint> to fetch descriptors";
+                    if (descriptor_service) {
+                        voyis::TraceSpan fetch_span("fetch", msg.image_id);
+                        error = fetchDescriptors(*descriptor_service, msg);
+                    }
+                    if (!error.empty()) {
+                        // Warn on the first frame, then only count
+                        if (no_descriptors_count++ == 0) {
+                            std::cerr << "Warning: no descriptors for " << msg.image_id << ": "
+                                      << error << std::endl;
+                        }
+                        no_descriptors_stat.store(static_cast<double>(no_descriptors_count),
+                                                  std::memory_order_relaxed);
+                    }
+                }
+
+                auto start_time = std::chrono::high_resolution_clock::now();
+                VOYIS_TRACE2(match_start, msg.image_id.c_str(), msg.keypoints.size());
+                voyis::TraceSpan match_span("match", msg.image_id);
+                voyis::MatchSetMessage match_set = matcher.process(msg);
+                if (places) {
+                    match_set.loop_candidates = places->process(msg);
+                }
+                match_span.end();
+                VOYIS_TRACE3(match_done, msg.image_id.c_str(), match_set.frames.size(),
+                             match_set.loop_candidates.size());
+                match_set.matched_timestamp = nowMs();
+                auto end_time = std::chrono::high_resolution_clock::now();
+
+                auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    end_time - start_time
+                ).count();
+
+                std::cout << "\nMatched image: " << msg.image_id << " ("
+                          << msg.descriptors.size() << " descriptors, "
+                          << duration << " ms)" << std::endl;
+                for (const auto& frame : match_set.frames) {
+                    ++pair_count;
+                    std::cout << "  vs " << frame.reference_id << ": " << frame.matches.size()
+                              << " matches";
+                    if (frame.has_homography) {
+                        ++homography_count;
+                        std::cout << ", homography with " << frame.num_inliers << " inliers";
+                    }
+                    std::cout << std::endl;
+                }
+                for (const auto& candidate : match_set.loop_candidates) {
+                    ++loop_count;
+                    std::cout << "  revisits " << candidate.image_id << " (" << candidate.stream_id
+                              << ", score " << candidate.score << ")" << std::endl;
+                }
+                ++matched_count;
+                matched_stat.store(static_cast<double>(matched_count), std::memory_order_relaxed);
+                homography_stat.store(static_cast<double>(homography_count),
+                                      std::memory_order_relaxed);
+                match_ms_stat.store(static_cast<double>(duration), std::memory_order_relaxed);
+
+                // Serialize and publish match set
+                voyis::TraceSpan serialize_span("serialize", msg.image_id);
+                std::vector<uint8_t> serialized = match_set.serialize();
+                serialize_span.end();
+
+                voyis::TraceSpan publish_span("publish", msg.image_id, output_port);
+                bool published = publisher.publish(serialized);
+                publish_span.end();
+                if (!published) {
+                    std::cerr << "  Failed to publish match set" << std::endl;
+                }
+                flight_timer.finish();
+
+            } catch (const std::exception& e) {
+                std::cerr << "Error matching features: " << e.what() << std::endl;
+            }
+        }
+
+        std::cout << "\nShutdown complete." << std::endl;
+        std::cout << "Total frames matched: " << matched_count << std::endl;
+        std::cout << "Frame pairs with a homography: " << homography_count << " of "
+                  << pair_count << std::endl;
+        if (no_descriptors_count > 0) {
+            std::cout << "Frames with keypoints but no descriptors: " << no_descriptors_count
+                      << std::endl;
+        }
+        if (places) {
+            std::cout << "Loop-closure candidates: " << loop_count << " ("
+                      << places->indexedFrames() << " frames indexed, "
+                      << places->mismatchedFrames() << " with another descriptor length skipped)"
+                      << std::endl;
+        }
+        std::cout << voyis::frameMemoryReport(voyis::PageFaults::now() - steady_faults, matched_count)
+                  << std::endl;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Fatal error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,293 @@
+#include "place_index.h"
+#include "place_index_store.h"
+#include "frame_matcher.h"
+#include <opencv2/features2d.hpp>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace voyis {
+
+Vocabulary::Vocabulary(const cv::Mat& words) {
+    if (words.empty() || words.channels() != 1) {
+        throw std::invalid_argument("Vocabulary needs a non-empty single-channel word matrix");
+    }
+    words.convertTo(words_, CV_32F);
+}
+
+Vocabulary Vocabulary::train(const cv::Mat& samples, int num_words, int iterations) {
+    if (num_words <= 0 || samples.rows < num_words) {
+        throw std::invalid_argument("Need at least " + std::to_string(num_words) +
+                                    " descriptors to learn a vocabulary");
+    }
+
+    cv::Mat data;
+    samples.convertTo(data, CV_32F);
+
+    cv::Mat labels;
+    cv::Mat centers;
+    cv::kmeans(data, num_words, labels,
+               cv::TermCriteria(cv::TermCriteria::MAX_ITER | cv::TermCriteria::EPS, iterations, 1e-3),
+               1, cv::KMEANS_PP_CENTERS, centers);
+    return Vocabulary(centers);
+}
+
+Vocabulary Vocabulary::load(const std::string& path) {
+    cv::FileStorage file(path, cv::FileStorage::READ);
+    if (!file.isOpened()) {
+        throw std::runtime_error("Cannot open vocabulary: " + path);
+    }
+
+    cv::Mat words;
+    file["words"] >> words;
+    if (words.empty()) {
+        throw std::runtime_error("Vocabulary is missing words: " + path);
+    }
+
+    try {
+        return Vocabulary(words);
+    } catch (const std::invalid_argument& e) {
+        throw std::runtime_error(std::string(e.what()) + ": " + path);
+    }
+}
+
+std::vector<uint32_t> Vocabulary::quantize(const cv::Mat& descriptors) const {
+    std::vector<uint32_t> assignments;
+    if (descriptors.empty() || empty()) {
+        return assignments;
+    }
+    if (descriptors.cols != dim()) {
+        throw std::invalid_argument("Expected " + std::to_string(dim()) +
+                                    "-dimensional descriptors");
+    }
+
+    cv::BFMatcher matcher(cv::NORM_L2);
+    std::vector<cv::DMatch> nearest;
+    matcher.match(descriptors, words_, nearest);
+
+    assignments.resize(static_cast<size_t>(descriptors.rows));
+    for (const cv::DMatch& match : nearest) {
+        assignments[static_cast<size_t>(match.queryIdx)] = static_cast<uint32_t>(match.trainIdx);
+    }
+    return assignments;
+}
+
+BagOfWords Vocabulary::bagOfWords(const cv::Mat& descriptors) const {
+    std::vector<uint32_t> assignments = quantize(descriptors);
+    BagOfWords bow;
+    if (assignments.empty()) {
+        return bow;
+    }
+
+    std::vector<uint32_t> counts(static_cast<size_t>(size()), 0);
+    for (uint32_t word : assignments) {
+        ++counts[word];
+    }
+
+    const float total = static_cast<float>(assignments.size());
+    for (size_t word = 0; word < counts.size(); ++word) {
+        if (counts[word] > 0) {
+            bow.emplace_back(static_cast<uint32_t>(word), counts[word] / total);
+        }
+    }
+    return bow;
+}
+
+PlaceIndex::PlaceIndex(size_t num_words, const PlaceIndexConfig& config)
+    : config_(config), postings_(num_words) {}
+
+float PlaceIndex::idf(uint32_t word) const {
+    // Smoothed so that words present in every frame still carry some weight
+    const float frames = static_cast<float>(frames_.size());
+    const float containing = static_cast<float>(postings_[word].size());
+    return std::log((1.0f + frames) / (1.0f + containing)) + 1.0f;
+}
+
+float PlaceIndex::norm(const BagOfWords& bow) const {
+    float sum = 0.0f;
+    for (const auto& [word, tf] : bow) {
+        if (word < postings_.size()) {
+            const float weight = tf * idf(word);
+            sum += weight * weight;
+        }
+    }
+    return std::sqrt(sum);
+}
+
+std::vector<PlaceCandidate> PlaceIndex::query(const BagOfWords& bow,
+                                              const std::string& stream_id) const {
+    std::vector<PlaceCandidate> candidates;
+    if (bow.empty() || frames_.empty()) {
+        return candidates;
+    }
+
+    // Dot products with every frame sharing a word, via the posting lists
+    std::unordered_map<uint32_t, float> dots;
+    for (const auto& [word, tf] : bow) {
+        if (word >= postings_.size()) {
+            continue;
+        }
+        const float weight = idf(word);
+        const float query_weight = tf * weight;
+        for (const Posting& posting : postings_[word]) {
+            dots[posting.frame] += query_weight * posting.tf * weight;
+        }
+    }
+    const float query_norm = norm(bow);
+    if (query_norm <= 0.0f) {
+        return candidates;
+    }
+
+    // The query's own stream has this many frames; its latest ones are trivially similar
+    auto own = stream_sizes_.find(stream_id);
+    const size_t own_size = own != stream_sizes_.end() ? own->second : 0;
+
+    for (const auto& [index, dot] : dots) {
+        const Frame& frame = frames_[index];
+        if (frame.stream_id == stream_id &&
+            own_size - frame.stream_position <= config_.exclude_recent) {
+            continue;
+        }
+        const float frame_norm = norm(frame.bow);
+        if (frame_norm <= 0.0f) {
+            continue;
+        }
+
+        float score = dot / (query_norm * frame_norm);
+        if (score >= config_.min_score) {
+            candidates.push_back(PlaceCandidate{frame.image_id, frame.stream_id, score});
+        }
+    }
+
+    auto by_score = [](const PlaceCandidate& a, const PlaceCandidate& b) { return a.score > b.score; };
+    if (candidates.size() > config_.top_k) {
+        std::partial_sort(candidates.begin(), candidates.begin() + config_.top_k, candidates.end(),
+                          by_score);
+        candidates.resize(config_.top_k);
+    } else {
+        std::sort(candidates.begin(), candidates.end(), by_score);
+    }
+    return candidates;
+}
+
+void PlaceIndex::add(const std::string& image_id, const std::string& stream_id,
+                     const BagOfWords& bow) {
+    const uint32_t index = static_cast<uint32_t>(frames_.size());
+    size_t& stream_size = stream_sizes_[stream_id];
+    frames_.push_back(Frame{image_id, stream_id, stream_size, bow});
+    ++stream_size;
+
+    for (const auto& [word, tf] : bow) {
+        if (word < postings_.size()) {
+            postings_[word].push_back(Posting{index, tf});
+        }
+    }
+}
+
+PlaceRecognizer::PlaceRecognizer(Vocabulary vocabulary, const VocabularyConfig& vocabulary_config,
+                                 const PlaceIndexConfig& index_config,
+                                 std::unique_ptr<PlaceIndexStore> store)
+    : vocabulary_config_(vocabulary_config),
+      index_config_(index_config),
+      store_(std::move(store)) {
+    // Learning needs at least one descriptor per word
+    vocabulary_config_.training_samples =
+        std::max(vocabulary_config_.training_samples, vocabulary_config_.num_words);
+
+    if (!store_) {
+        if (!vocabulary.empty()) {
+            useVocabulary(std::move(vocabulary));
+        }
+        return;
+    }
+
+    Vocabulary stored = store_->loadVocabulary();
+    bool same = !vocabulary.empty() && !stored.empty() &&
+                vocabulary.words().size() == stored.words().size() &&
+                cv::norm(vocabulary.words(), stored.words(), cv::NORM_INF) == 0.0;
+
+    if (vocabulary.empty() || same) {
+        // Resume the persisted index
+        if (!stored.empty()) {
+            useVocabulary(std::move(stored));
+            store_->forEachFrame([this](const std::string& image_id, const std::string& stream_id,
+                                        const BagOfWords& bow) {
+                index_->add(image_id, stream_id, bow);
+            });
+        }
+    } else {
+        // A different vocabulary invalidates everything indexed with the stored one
+        store_->saveVocabulary(vocabulary);
+        useVocabulary(std::move(vocabulary));
+    }
+}
+
+PlaceRecognizer::~PlaceRecognizer() = default;
+
+void PlaceRecognizer::useVocabulary(Vocabulary vocabulary) {
+    vocabulary_ = std::move(vocabulary);
+    index_ = std::make_unique<PlaceIndex>(static_cast<size_t>(vocabulary_.size()), index_config_);
+}
+
+void PlaceRecognizer::addFrame(const std::string& image_id, const std::string& stream_id,
+                               int64_t timestamp, const BagOfWords& bow) {
+    index_->add(image_id, stream_id, bow);
+    if (store_) {
+        store_->saveFrame(image_id, stream_id, timestamp, bow);
+    }
+}
+
+std::vector<PlaceCandidate> PlaceRecognizer::process(const ProcessedImageMessage& msg) {
+    cv::Mat descriptors = descriptorMatrix(msg);
+    if (descriptors.empty()) {
+        return {};
+    }
+
+    if (vocabulary_.empty()) {
+        // Learn from frames with the first frame's descriptor length only; others could
+        // never be indexed with the learned words, so they are not kept
+        if (!pending_.empty() && descriptors.cols != pending_.front().descriptors.cols) {
+            ++mismatched_frames_;
+            return {};
+        }
+
+        pending_.push_back(PendingFrame{msg.image_id, msg.stream_id, msg.timestamp, descriptors});
+        pending_descriptors_ += descriptors.rows;
+        if (pending_descriptors_ < std::max(vocabulary_config_.training_samples,
+                                            vocabulary_config_.num_words)) {
+            return {};
+        }
+
+        cv::Mat samples;
+        for (const PendingFrame& frame : pending_) {
+            samples.push_back(frame.descriptors);
+        }
+
+        Vocabulary learned = Vocabulary::train(samples, vocabulary_config_.num_words);
+        if (store_) {
+            store_->saveVocabulary(learned);
+        }
+        useVocabulary(std::move(learned));
+
+        for (const PendingFrame& frame : pending_) {
+            addFrame(frame.image_id, frame.stream_id, frame.timestamp,
+                     vocabulary_.bagOfWords(frame.descriptors));
+        }
+        pending_.clear();
+        pending_descriptors_ = 0;
+        return {};
+    }
+
+    if (descriptors.cols != vocabulary_.dim()) {
+        ++mismatched_frames_;
+        return {};
+    }
+
+    BagOfWords bow = vocabulary_.bagOfWords(descriptors);
+    std::vector<PlaceCandidate> candidates = index_->query(bow, msg.stream_id);
+    addFrame(msg.image_id, msg.stream_id, msg.timestamp, bow);
+    return candidates;
+}
+
+} // namespace voyis
@@ -0,0 +1,191 @@
+#pragma once
+
+#include "message.h"
+#include <opencv2/core.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace voyis {
+
+class PlaceIndexStore;
+
+/**
+ * @brief Sparse bag of visual words: (word, term frequency) sorted by word
+ *
+ * Term frequencies are the fraction of the frame's descriptors assigned to
+ * the word, so they sum to 1.
+ */
+using BagOfWords = std::vector<std::pair<uint32_t, float>>;
+
+/**
+ * @brief Flat visual vocabulary of k-means cluster centres
+ */
+class Vocabulary {
+public:
+    Vocabulary() = default;
+
+    /**
+     * @param words K x dim cluster centres, one per row
+     */
+    explicit Vocabulary(const cv::Mat& words);
+
+    /**
+     * @brief Cluster sample descriptors into num_words words
+     * @throws std::invalid_argument if there are fewer samples than words
+     */
+    static Vocabulary train(const cv::Mat& samples, int num_words, int iterations = 10);
+
+    /**
+     * @brief Load cluster centres ("words") from an OpenCV FileStorage file
+     * @throws std::runtime_error if the file is missing or malformed
+     */
+    static Vocabulary load(const std::string& path);
+
+    /**
+     * @brief Nearest word of each descriptor row
+     */
+    std::vector<uint32_t> quantize(const cv::Mat& descriptors) const;
+
+    /**
+     * @brief Quantize descriptors into a normalized bag of words
+     */
+    BagOfWords bagOfWords(const cv::Mat& descriptors) const;
+
+    bool empty() const { return words_.empty(); }
+    int size() const { return words_.rows; }
+    int dim() const { return words_.cols; }
+    const cv::Mat& words() const { return words_; }
+
+private:
+    cv::Mat words_; // K x dim, CV_32F
+};
+
+/**
+ * @brief Retrieval parameters for loop-closure candidates
+ */
+struct PlaceIndexConfig {
+    size_t top_k = 5;           // Candidates returned per query
+    size_t exclude_recent = 20; // Skip this many latest frames of the query's own stream
+    float min_score = 0.05f;    // Candidates scoring below this are dropped
+};
+
+/**
+ * @brief Inverted index of bags of words with TF-IDF cosine scoring
+ *
+ * Each word keeps a posting list of the frames containing it, so a query
+ * only touches frames sharing at least one word with it. Inverse document
+ * frequencies change as the index grows, so the norms of the query and of
+ * each candidate are computed with the same current values at query time.
+ */
+class PlaceIndex {
+public:
+    PlaceIndex(size_t num_words, const PlaceIndexConfig& config);
+
+    /**
+     * @brief Most similar earlier frames, best first
+     */
+    std::vector<PlaceCandidate> query(const BagOfWords& bow, const std::string& stream_id) const;
+
+    /**
+     * @brief Add a frame to the index
+     */
+    void add(const std::string& image_id, const std::string& stream_id, const BagOfWords& bow);
+
+    /**
+     * @brief Number of indexed frames
+     */
+    size_t size() const { return frames_.size(); }
+
+private:
+    struct Frame {
+        std::string image_id;
+        std::string stream_id;
+        size_t stream_position; // Index of the frame within its stream
+        BagOfWords bow;         // For the frame's norm under the current idf values
+    };
+
+    struct Posting {
+        uint32_t frame;
+        float tf;
+    };
+
+    float idf(uint32_t word) const;
+    float norm(const BagOfWords& bow) const;
+
+    PlaceIndexConfig config_;
+    std::vector<std::vector<Posting>> postings_; // One posting list per word
+    std::vector<Frame> frames_;
+    std::map<std::string, size_t> stream_sizes_;
+};
+
+/**
+ * @brief Settings for bootstrapping a vocabulary from the live stream
+ */
+struct VocabularyConfig {
+    int num_words = 500;         // Words learned when no vocabulary is given
+    int training_samples = 20000; // Descriptors collected before learning
+};
+
+/**
+ * @brief Live place recognition over the frames flowing through the pipeline
+ *
+ * Uses a given or persisted vocabulary; otherwise buffers the first frames
+ * until enough descriptors are collected, learns a vocabulary from them and
+ * indexes the buffered frames. With a store, the vocabulary and each indexed
+ * frame's bag of words are saved as they are produced, and reloaded on
+ * start so restarts do not rebuild the index.
+ */
+class PlaceRecognizer {
+public:
+    /**
+     * @param vocabulary Vocabulary to use, or empty to load or learn one
+     * @param store Persistence, or nullptr to keep the index in memory only
+     */
+    PlaceRecognizer(Vocabulary vocabulary, const VocabularyConfig& vocabulary_config,
+                    const PlaceIndexConfig& index_config, std::unique_ptr<PlaceIndexStore> store);
+    ~PlaceRecognizer();
+
+    /**
+     * @brief Find earlier frames similar to this one, then index it
+     * @return Candidates, best first (empty while the vocabulary is being learned)
+     */
+    std::vector<PlaceCandidate> process(const ProcessedImageMessage& msg);
+
+    bool hasVocabulary() const { return !vocabulary_.empty(); }
+    const Vocabulary& vocabulary() const { return vocabulary_; }
+    size_t indexedFrames() const { return index_ ? index_->size() : 0; }
+
+    /**
+     * @brief Frames not indexed because their descriptor length differs from
+     *        the vocabulary's (or, while learning, from the first frame's)
+     */
+    size_t mismatchedFrames() const { return mismatched_frames_; }
+
+private:
+    struct PendingFrame {
+        std::string image_id;
+        std::string stream_id;
+        int64_t timestamp;
+        cv::Mat descriptors;
+    };
+
+    void useVocabulary(Vocabulary vocabulary);
+    void addFrame(const std::string& image_id, const std::string& stream_id, int64_t timestamp,
+                  const BagOfWords& bow);
+
+    Vocabulary vocabulary_;
+    VocabularyConfig vocabulary_config_;
+    PlaceIndexConfig index_config_;
+    std::unique_ptr<PlaceIndexStore> store_;
+    std::unique_ptr<PlaceIndex> index_;
+    std::vector<PendingFrame> pending_;
+    int pending_descriptors_ = 0;
+    size_t mismatched_frames_ = 0;
+};
+
+} // namespace voyis
@@ -0,0 +1,176 @@
+#include "place_index_store.h"
+#include <sqlite3.h>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace voyis {
+
+namespace {
+
+// Bags of words are stored as packed (uint32 word, float tf) pairs
+std::vector<uint8_t> packBagOfWords(const BagOfWords& bow) {
+    std::vector<uint8_t> bytes(bow.size() * 8);
+    for (size_t i = 0; i < bow.size(); ++i) {
+        std::memcpy(&bytes[i * 8], &bow[i].first, 4);
+        std::memcpy(&bytes[i * 8 + 4], &bow[i].second, 4);
+    }
+    return bytes;
+}
+
+BagOfWords unpackBagOfWords(const void* data, int size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    BagOfWords bow(static_cast<size_t>(size) / 8);
+    for (size_t i = 0; i < bow.size(); ++i) {
+        std::memcpy(&bow[i].first, bytes + i * 8, 4);
+        std::memcpy(&bow[i].second, bytes + i * 8 + 4, 4);
+    }
+    return bow;
+}
+
+} // anonymous namespace
+
+PlaceIndexStore::PlaceIndexStore(const std::string& path) : db_(nullptr), insert_frame_(nullptr) {
+    if (sqlite3_open(path.c_str(), &db_) != SQLITE_OK) {
+        std::string error = db_ ? sqlite3_errmsg(db_) : "out of memory";
+        sqlite3_close(db_);
+        throw std::runtime_error("Failed to open place index: " + error);
+    }
+
+    try {
+        // Frames are appended one at a time; WAL keeps each append cheap
+        executeSQL("PRAGMA journal_mode=WAL");
+        executeSQL("PRAGMA synchronous=NORMAL");
+
+        executeSQL(R"(
+            CREATE TABLE IF NOT EXISTS vocabulary (
+                id INTEGER PRIMARY KEY CHECK (id = 1),
+                num_words INTEGER NOT NULL,
+                dim INTEGER NOT NULL,
+                words BLOB NOT NULL
+            )
+        )");
+        executeSQL(R"(
+            CREATE TABLE IF NOT EXISTS frames (
+                id INTEGER PRIMARY KEY AUTOINCREMENT,
+                image_id TEXT NOT NULL,
+                stream_id TEXT NOT NULL,
+                timestamp INTEGER NOT NULL,
+                words BLOB NOT NULL
+            )
+        )");
+
+        insert_frame_ = prepareStatement(
+            "INSERT INTO frames (image_id, stream_id, timestamp, words) VALUES (?, ?, ?, ?)");
+    } catch (...) {
+        sqlite3_close(db_);
+        throw;
+    }
+}
+
+PlaceIndexStore::~PlaceIndexStore() {
+    sqlite3_finalize(insert_frame_);
+    sqlite3_close(db_);
+}
+
+void PlaceIndexStore::executeSQL(const std::string& sql) {
+    char* err_msg = nullptr;
+    int rc = sqlite3_exec(db_, sql.c_str(), nullptr, nullptr, &err_msg);
+    if (rc != SQLITE_OK) {
+        std::string error = err_msg ? err_msg : "Unknown error";
+        sqlite3_free(err_msg);
+        throw std::runtime_error("SQL error: " + error);
+    }
+}
+
+sqlite3_stmt* PlaceIndexStore::prepareStatement(const std::string& sql) {
+    sqlite3_stmt* stmt;
+    int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+    if (rc != SQLITE_OK) {
+        throw std::runtime_error("Failed to prepare statement: " +
+                                 std::string(sqlite3_errmsg(db_)));
+    }
+    return stmt;
+}
+
+Vocabulary PlaceIndexStore::loadVocabulary() {
+    sqlite3_stmt* stmt = prepareStatement("SELECT num_words, dim, words FROM vocabulary WHERE id = 1");
+
+    Vocabulary vocabulary;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        int rows = sqlite3_column_int(stmt, 0);
+        int cols = sqlite3_column_int(stmt, 1);
+        int bytes = sqlite3_column_bytes(stmt, 2);
+        // In 64 bits: a corrupt row's rows * cols must not overflow into a match
+        if (rows > 0 && cols > 0 &&
+            static_cast<int64_t>(bytes) ==
+                static_cast<int64_t>(rows) * cols * static_cast<int64_t>(sizeof(float))) {
+            cv::Mat words(rows, cols, CV_32F);
+            std::memcpy(words.data, sqlite3_column_blob(stmt, 2), static_cast<size_t>(bytes));
+            vocabulary = Vocabulary(words);
+        }
+    }
+
+    sqlite3_finalize(stmt);
+    return vocabulary;
+}
+
+void PlaceIndexStore::saveVocabulary(const Vocabulary& vocabulary) {
+    cv::Mat words = vocabulary.words().isContinuous() ? vocabulary.words() : vocabulary.words().clone();
+
+    executeSQL("BEGIN TRANSACTION");
+    try {
+        // Bags of words refer to word numbers of the previous vocabulary
+        executeSQL("DELETE FROM frames");
+
+        sqlite3_stmt* stmt = prepareStatement(
+            "INSERT OR REPLACE INTO vocabulary (id, num_words, dim, words) VALUES (1, ?, ?, ?)");
+        sqlite3_bind_int(stmt, 1, words.rows);
+        sqlite3_bind_int(stmt, 2, words.cols);
+        sqlite3_bind_blob(stmt, 3, words.data, static_cast<int>(words.total() * words.elemSize()),
+                          SQLITE_TRANSIENT);
+        int rc = sqlite3_step(stmt);
+        sqlite3_finalize(stmt);
+        if (rc != SQLITE_DONE) {
+            throw std::runtime_error("Failed to save vocabulary: " + std::string(sqlite3_errmsg(db_)));
+        }
+
+        executeSQL("COMMIT");
+    } catch (...) {
+        executeSQL("ROLLBACK");
+        throw;
+    }
+}
+
+void PlaceIndexStore::forEachFrame(const std::function<void(const std::string&, const std::string&,
+                                                            const BagOfWords&)>& visit) {
+    sqlite3_stmt* stmt = prepareStatement("SELECT image_id, stream_id, words FROM frames ORDER BY id");
+
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const unsigned char* image_id = sqlite3_column_text(stmt, 0);
+        const unsigned char* stream_id = sqlite3_column_text(stmt, 1);
+        BagOfWords bow = unpackBagOfWords(sqlite3_column_blob(stmt, 2), sqlite3_column_bytes(stmt, 2));
+        visit(image_id ? reinterpret_cast<const char*>(image_id) : "",
+              stream_id ? reinterpret_cast<const char*>(stream_id) : "", bow);
+    }
+
+    sqlite3_finalize(stmt);
+}
+
+void PlaceIndexStore::saveFrame(const std::string& image_id, const std::string& stream_id,
+                                int64_t timestamp, const BagOfWords& bow) {
+    std::vector<uint8_t> words = packBagOfWords(bow);
+
+    sqlite3_reset(insert_frame_);
+    sqlite3_bind_text(insert_frame_, 1, image_id.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(insert_frame_, 2, stream_id.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int64(insert_frame_, 3, timestamp);
+    sqlite3_bind_blob(insert_frame_, 4, words.data(), static_cast<int>(words.size()), SQLITE_TRANSIENT);
+
+    if (sqlite3_step(insert_frame_) != SQLITE_DONE) {
+        throw std::runtime_error("Failed to save place index frame: " +
+                                 std::string(sqlite3_errmsg(db_)));
+    }
+}
+
+} // namespace voyis
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "place_index.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+namespace voyis {
+
+/**
+ * @brief SQLite persistence of the place-recognition vocabulary and index
+ *
+ * Stores the vocabulary once and appends each indexed frame's bag of words
+ * as it is added, so the index survives restarts without re-quantizing any
+ * descriptors. Kept in its own database file (normally next to the logger
+ * database) so the logger's schema is unaffected.
+ */
+class PlaceIndexStore {
+public:
+    /**
+     * @brief Open or create a store
+     * @throws std::runtime_error if the database cannot be opened
+     */
+    explicit PlaceIndexStore(const std::string& path);
+    ~PlaceIndexStore();
+
+    PlaceIndexStore(const PlaceIndexStore&) = delete;
+    PlaceIndexStore& operator=(const PlaceIndexStore&) = delete;
+
+    /**
+     * @brief The stored vocabulary, or an empty one if none was saved
+     */
+    Vocabulary loadVocabulary();
+
+    /**
+     * @brief Replace the stored vocabulary, discarding frames indexed with another one
+     */
+    void saveVocabulary(const Vocabulary& vocabulary);
+
+    /**
+     * @brief Visit stored frames in the order they were added
+     */
+    void forEachFrame(const std::function<void(const std::string& image_id,
+                                               const std::string& stream_id,
+                                               const BagOfWords& bow)>& visit);
+
+    /**
+     * @brief Append an indexed frame
+     */
+    void saveFrame(const std::string& image_id, const std::string& stream_id, int64_t timestamp,
+                   const BagOfWords& bow);
+
+private:
+    void executeSQL(const std::string& sql);
+    sqlite3_stmt* prepareStatement(const std::string& sql);
+
+    sqlite3* db_;
+    sqlite3_stmt* insert_frame_; // Prepared once, reused for every frame
+};
+
+} // namespace voyis
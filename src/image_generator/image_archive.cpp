@@ -0,0 +1,297 @@
+#include "image_archive.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+namespace voyis {
+
+namespace {
+
+constexpr size_t kTarBlock = 512;
+
+constexpr uint32_t kZipLocalHeader = 0x04034b50;
+constexpr uint32_t kZipCentralHeader = 0x02014b50;
+constexpr uint32_t kZipEnd = 0x06054b50;
+constexpr uint32_t kZip64End = 0x06064b50;
+constexpr uint32_t kZip64Locator = 0x07064b50;
+constexpr size_t kZipEndSize = 22;
+
+uint64_t readLe(const uint8_t* p, int bytes) {
+    uint64_t value = 0;
+    for (int i = bytes - 1; i >= 0; --i) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+// NUL-terminated string of at most size bytes
+std::string fixedString(const uint8_t* p, size_t size) {
+    const uint8_t* end = std::find(p, p + size, 0);
+    return std::string(reinterpret_cast<const char*>(p), reinterpret_cast<const char*>(end));
+}
+
+// Octal number padded with spaces or NULs, or GNU base-256 when the top bit is set
+uint64_t tarNumber(const uint8_t* p, size_t size) {
+    uint64_t value = 0;
+    if (p[0] & 0x80) {
+        value = p[0] & 0x7f;
+        for (size_t i = 1; i < size; ++i) {
+            value = (value << 8) | p[i];
+        }
+        return value;
+    }
+    size_t i = 0;
+    while (i < size && (p[i] == ' ' || p[i] == 0)) {
+        ++i;
+    }
+    for (; i < size && p[i] >= '0' && p[i] <= '7'; ++i) {
+        value = value * 8 + static_cast<uint64_t>(p[i] - '0');
+    }
+    return value;
+}
+
+bool tarChecksumValid(const uint8_t* header) {
+    uint64_t expected = tarNumber(header + 148, 8);
+    uint64_t unsigned_sum = 0;
+    int64_t signed_sum = 0; // Some old writers summed signed chars
+    for (size_t i = 0; i < kTarBlock; ++i) {
+        uint8_t byte = (i >= 148 && i < 156) ? ' ' : header[i];
+        unsigned_sum += byte;
+        signed_sum += static_cast<int8_t>(byte);
+    }
+    return expected == unsigned_sum || static_cast<int64_t>(expected) == signed_sum;
+}
+
+bool allZero(const uint8_t* p, size_t size) {
+    return std::all_of(p, p + size, [](uint8_t byte) { return byte == 0; });
+}
+
+// Records of a pax extended header: "<length> <key>=<value>\n"
+void parsePax(const uint8_t* p, size_t size, std::string& path, uint64_t& file_size,
+              bool& has_size) {
+    size_t pos = 0;
+    while (pos < size) {
+        size_t length = 0;
+        size_t digits = pos;
+        while (digits < size && std::isdigit(p[digits])) {
+            length = length * 10 + static_cast<size_t>(p[digits] - '0');
+            ++digits;
+        }
+        if (length == 0 || pos + length > size) {
+            return;
+        }
+        std::string record(reinterpret_cast<const char*>(p + digits + 1),
+                           reinterpret_cast<const char*>(p + pos + length - 1));
+        size_t equals = record.find('=');
+        if (equals != std::string::npos) {
+            std::string key = record.substr(0, equals);
+            if (key == "path") {
+                path = record.substr(equals + 1);
+            } else if (key == "size") {
+                file_size = std::stoull(record.substr(equals + 1));
+                has_size = true;
+            }
+        }
+        pos += length;
+    }
+}
+
+} // anonymous namespace
+
+ImageArchive::ImageArchive(const std::string& path) : path_(path) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open archive: " + path + ": " + std::strerror(errno));
+    }
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        throw std::runtime_error("Empty or unreadable archive: " + path);
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    void* mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Failed to map archive: " + path + ": " + std::strerror(errno));
+    }
+    base_ = static_cast<const uint8_t*>(mapping);
+
+    // Members are published in order, so let the kernel read ahead
+    madvise(mapping, size_, MADV_SEQUENTIAL);
+
+    try {
+        if (size_ >= 4 && (readLe(base_, 4) == kZipLocalHeader || readLe(base_, 4) == kZipEnd)) {
+            indexZip();
+        } else if (size_ >= kTarBlock && tarChecksumValid(base_)) {
+            indexTar();
+        } else {
+            throw std::runtime_error("Not a tar or zip archive: " + path);
+        }
+    } catch (...) {
+        munmap(const_cast<uint8_t*>(base_), size_);
+        throw;
+    }
+}
+
+ImageArchive::~ImageArchive() {
+    munmap(const_cast<uint8_t*>(base_), size_);
+}
+
+void ImageArchive::indexTar() {
+    std::string long_name; // From a preceding GNU 'L' or pax header
+    uint64_t pax_size = 0;
+    bool has_pax_size = false;
+
+    size_t pos = 0;
+    while (pos + kTarBlock <= size_) {
+        const uint8_t* header = base_ + pos;
+        if (allZero(header, kTarBlock)) {
+            break; // End-of-archive marker
+        }
+        if (!tarChecksumValid(header)) {
+            throw std::runtime_error("Corrupt tar header at offset " + std::to_string(pos) +
+                                     " in " + path_);
+        }
+
+        uint64_t size = has_pax_size ? pax_size : tarNumber(header + 124, 12);
+        uint64_t data = pos + kTarBlock;
+        if (size > size_ - data) {
+            throw std::runtime_error("Truncated tar member at offset " + std::to_string(pos) +
+                                     " in " + path_);
+        }
+
+        char type = static_cast<char>(header[156]);
+        if (type == 'L') {
+            long_name = fixedString(base_ + data, static_cast<size_t>(size));
+        } else if (type == 'x') {
+            has_pax_size = false;
+            parsePax(base_ + data, static_cast<size_t>(size), long_name, pax_size, has_pax_size);
+        } else {
+            if (type == '0' || type == '\0' || type == '7') {
+                std::string name = long_name;
+                if (name.empty()) {
+                    name = fixedString(header, 100);
+                    std::string prefix = fixedString(header + 345, 155);
+                    if (std::memcmp(header + 257, "ustar", 5) == 0 && !prefix.empty()) {
+                        name = prefix + "/" + name;
+                    }
+                }
+                members_.push_back({name, data, size});
+            }
+            long_name.clear();
+            has_pax_size = false;
+        }
+        pos = static_cast<size_t>(data + (size + kTarBlock - 1) / kTarBlock * kTarBlock);
+    }
+}
+
+void ImageArchive::indexZip() {
+    auto need = [&](uint64_t offset, uint64_t bytes, const char* what) {
+        if (offset > size_ || bytes > size_ - offset) {
+            throw std::runtime_error(std::string("Truncated zip ") + what + " in " + path_);
+        }
+        return base_ + offset;
+    };
+
+    // The end record is last, followed by a comment of up to 64 KB
+    if (size_ < kZipEndSize) {
+        throw std::runtime_error("Truncated zip archive: " + path_);
+    }
+    size_t end = size_ - kZipEndSize;
+    size_t lowest = size_ > kZipEndSize + 0xffff ? size_ - kZipEndSize - 0xffff : 0;
+    while (readLe(base_ + end, 4) != kZipEnd) {
+        if (end == lowest) {
+            throw std::runtime_error("No zip central directory in " + path_);
+        }
+        --end;
+    }
+
+    uint64_t entries = readLe(base_ + end + 10, 2);
+    uint64_t directory = readLe(base_ + end + 16, 4);
+    if (entries == 0xffff || directory == 0xffffffff) {
+        const uint8_t* locator = need(end >= 20 ? end - 20 : size_, 20, "zip64 locator");
+        if (readLe(locator, 4) != kZip64Locator) {
+            throw std::runtime_error("Missing zip64 end record in " + path_);
+        }
+        const uint8_t* end64 = need(readLe(locator + 8, 8), 56, "zip64 end record");
+        if (readLe(end64, 4) != kZip64End) {
+            throw std::runtime_error("Corrupt zip64 end record in " + path_);
+        }
+        entries = readLe(end64 + 32, 8);
+        directory = readLe(end64 + 48, 8);
+    }
+
+    members_.reserve(static_cast<size_t>(std::min<uint64_t>(entries, size_ / 46)));
+    uint64_t pos = directory;
+    for (uint64_t i = 0; i < entries; ++i) {
+        const uint8_t* entry = need(pos, 46, "central directory");
+        if (readLe(entry, 4) != kZipCentralHeader) {
+            throw std::runtime_error("Corrupt zip central directory in " + path_);
+        }
+        uint64_t flags = readLe(entry + 8, 2);
+        uint64_t method = readLe(entry + 10, 2);
+        uint64_t size = readLe(entry + 24, 4);
+        uint64_t name_length = readLe(entry + 28, 2);
+        uint64_t extra_length = readLe(entry + 30, 2);
+        uint64_t comment_length = readLe(entry + 32, 2);
+        uint64_t local = readLe(entry + 42, 4);
+        const uint8_t* name_start = need(pos + 46, name_length + extra_length, "file name");
+        std::string name(reinterpret_cast<const char*>(name_start), name_length);
+
+        // zip64 extra field: 64-bit values for the fields that are saturated above
+        const uint8_t* extra = name_start + name_length;
+        for (uint64_t at = 0; at + 4 <= extra_length;) {
+            uint64_t id = readLe(extra + at, 2);
+            uint64_t length = readLe(extra + at + 2, 2);
+            if (id == 0x0001) {
+                uint64_t field = at + 4;
+                if (size == 0xffffffff && field + 8 <= extra_length) {
+                    size = readLe(extra + field, 8);
+                    field += 8;
+                }
+                if (readLe(entry + 20, 4) == 0xffffffff && field + 8 <= extra_length) {
+                    field += 8; // Compressed size, equal to size for stored members
+                }
+                if (local == 0xffffffff && field + 8 <= extra_length) {
+                    local = readLe(extra + field, 8);
+                }
+            }
+            at += 4 + length;
+        }
+        pos += 46 + name_length + extra_length + comment_length;
+
+        if (!name.empty() && name.back() == '/') {
+            continue; // Directory
+        }
+        if (flags & 0x1) {
+            throw std::runtime_error("Encrypted zip member " + name + " in " + path_);
+        }
+        if (method != 0) {
+            throw std::runtime_error("Compressed zip member " + name + " in " + path_ +
+                                     " (store images without compression, e.g. zip -0)");
+        }
+
+        const uint8_t* header = need(local, 30, "local header");
+        if (readLe(header, 4) != kZipLocalHeader) {
+            throw std::runtime_error("Corrupt zip local header for " + name + " in " + path_);
+        }
+        uint64_t data = local + 30 + readLe(header + 26, 2) + readLe(header + 28, 2);
+        need(data, size, "member");
+        members_.push_back({name, data, size});
+    }
+}
+
+bool isImageArchive(const std::string& path) {
+    std::string ext = path.size() >= 4 ? path.substr(path.size() - 4) : "";
+    std::transform(ext.begin(), ext.end(), ext.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return ext == ".tar" || ext == ".zip";
+}
+
+} // namespace voyis
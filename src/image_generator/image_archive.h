@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace voyis {
+
+/**
+ * @brief One file stored in an archive
+ */
+struct ArchiveMember {
+    std::string name;    // Path inside the archive
+    uint64_t offset = 0; // First byte of the contents within the archive
+    uint64_t size = 0;
+};
+
+/**
+ * @brief Memory-mapped tar or uncompressed zip archive of image files
+ *
+ * The member offsets are indexed once when the archive is opened; after
+ * that, the contents of a member are a pointer into the mapping, so reading
+ * a member costs no system call and no copy. Tar archives (ustar, GNU long
+ * names and pax headers) and zip archives whose members are stored without
+ * compression (zip -0), including zip64, are supported.
+ */
+class ImageArchive {
+public:
+    /**
+     * @throws std::runtime_error if the file cannot be mapped, is not a tar or
+     *         zip archive, or has compressed or encrypted zip members
+     */
+    explicit ImageArchive(const std::string& path);
+    ~ImageArchive();
+
+    // Disable copy
+    ImageArchive(const ImageArchive&) = delete;
+    ImageArchive& operator=(const ImageArchive&) = delete;
+
+    /**
+     * @brief Regular files in archive order (directories are left out)
+     */
+    const std::vector<ArchiveMember>& members() const { return members_; }
+
+    /**
+     * @brief Contents of a member, valid while the archive is open
+     */
+    const uint8_t* data(const ArchiveMember& member) const { return base_ + member.offset; }
+
+    const std::string& path() const { return path_; }
+    size_t size() const { return size_; }
+
+private:
+    void indexTar();
+    void indexZip();
+
+    std::string path_;
+    const uint8_t* base_ = nullptr;
+    size_t size_ = 0;
+    std::vector<ArchiveMember> members_;
+};
+
+/**
+ * @brief Whether a path names an archive ImageArchive can read (.tar or .zip)
+ */
+bool isImageArchive(const std::string& path);
+
+} // namespace voyis
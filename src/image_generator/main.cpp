@@ -1,5 +1,13 @@
 #include "ipc.h"
 #include "message.h"
+#include "options.h"
+#include "frame_allocator.h"
+#include "tracepoints.h"
+#include "trace_writer.h"
+#include "flight_recorder.h"
+#include "control.h"
+#include "image_archive.h"
+#include "video_source.h"
 #include <iostream>
 #include <filesystem>
 #include <fstream>
@@ -9,6 +17,11 @@
 #include <thread>
 #include <csignal>
 #include <atomic>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
 
 namespace fs = std::filesystem;
 
@@ -23,9 +36,9 @@ void signalHandler(int signal) {
 }
 
 /**
- * @brief Read all bytes from a file
+ * @brief Read all bytes from a file into a pooled frame buffer
  */
-std::vector<uint8_t> readFile(const std::string& filepath) {
+voyis::FrameBuffer readFile(const std::string& filepath) {
     std::ifstream file(filepath, std::ios::binary | std::ios::ate);
     if (!file) {
         throw std::runtime_error("Failed to open file: " + filepath);
@@ -34,7 +47,7 @@ std::vector<uint8_t> readFile(const std::string& filepath) {
     std::streamsize size = file.tellg();
     file.seekg(0, std::ios::beg);
 
-    std::vector<uint8_t> buffer(size);
+    voyis::FrameBuffer buffer(static_cast<size_t>(size));
     if (!file.read(reinterpret_cast<char*>(buffer.data()), size)) {
         throw std::runtime_error("Failed to read file: " + filepath);
     }
@@ -64,7 +77,111 @@ std::string getFileExtension(const std::string& filepath) {
 bool isImageFile(const std::string& filepath) {
     std::string ext = getFileExtension(filepath);
     return ext == "jpg" || ext == "jpeg" || ext == "png" ||
-           ext == "bmp" || ext == "tiff" || ext == "tif";
+           ext == "bmp" || ext == "tiff" || ext == "tif" ||
+           ext == "pgm" || ext == "raw";
+}
+
+/**
+ * @brief Layout of headerless ".raw" camera dumps (given on the command line)
+ */
+struct RawGeometry {
+    std::string format; // Raw pixel format, e.g. "mono8" or "bayer_rggb8"
+    int width = 0;
+    int height = 0;
+    int stride = 0;     // 0 means tightly packed rows
+    int bit_depth = 0;  // 0 means the full sample size
+};
+
+/**
+ * @brief Turn a binary PGM (P5) file into raw mono8/mono16 pixels in place
+ *
+ * The header is stripped and 16-bit samples are converted from PGM's
+ * big-endian order to the little-endian order used on the wire, so the
+ * extractor can use the pixels without decoding.
+ */
+void convertPgm(voyis::ImageMessage& msg, const std::string& filepath) {
+    voyis::FrameBuffer& data = msg.image_data;
+    size_t pos = 0;
+
+    // Read the next whitespace-separated header token, skipping comments
+    auto next_token = [&]() {
+        while (pos < data.size()) {
+            if (data[pos] == '#') {
+                while (pos < data.size() && data[pos] != '\n') {
+                    ++pos;
+                }
+            } else if (std::isspace(data[pos])) {
+                ++pos;
+            } else {
+                break;
+            }
+        }
+        std::string token;
+        while (pos < data.size() && !std::isspace(data[pos]) && data[pos] != '#') {
+            token += static_cast<char>(data[pos++]);
+        }
+        return token;
+    };
+
+    if (next_token() != "P5") {
+        throw std::runtime_error("Not a binary PGM file: " + filepath);
+    }
+    int width = std::atoi(next_token().c_str());
+    int height = std::atoi(next_token().c_str());
+    int maxval = std::atoi(next_token().c_str());
+    ++pos; // Single whitespace character before the pixel data
+
+    if (width <= 0 || height <= 0 || maxval <= 0 || maxval > 65535) {
+        throw std::runtime_error("Invalid PGM header: " + filepath);
+    }
+
+    int bytes_per_pixel = maxval < 256 ? 1 : 2;
+    size_t pixel_bytes = static_cast<size_t>(width) * height * bytes_per_pixel;
+    if (pos > data.size() || data.size() - pos < pixel_bytes) {
+        throw std::runtime_error("Truncated PGM file: " + filepath);
+    }
+
+    data.erase(data.begin(), data.begin() + static_cast<std::ptrdiff_t>(pos));
+    data.resize(pixel_bytes);
+    if (bytes_per_pixel == 2) {
+        for (size_t i = 0; i < pixel_bytes; i += 2) {
+            std::swap(data[i], data[i + 1]);
+        }
+    }
+
+    int bit_depth = 0;
+    while ((maxval >> bit_depth) != 0) {
+        ++bit_depth;
+    }
+
+    msg.format = bytes_per_pixel == 1 ? "mono8" : "mono16";
+    msg.width = width;
+    msg.height = height;
+    msg.stride = width * bytes_per_pixel;
+    msg.bit_depth = bit_depth;
+}
+
+/**
+ * @brief Describe a headerless raw file of data_size bytes using the command line geometry
+ */
+void describeRawFile(voyis::ImageMessage& msg, size_t data_size, const RawGeometry& geometry,
+                     const std::string& filepath) {
+    int bytes_per_pixel = voyis::rawBytesPerPixel(geometry.format);
+    if (bytes_per_pixel == 0 || geometry.width <= 0 || geometry.height <= 0) {
+        throw std::runtime_error("Raw file needs --raw-format, --raw-width and --raw-height: " +
+                                 filepath);
+    }
+
+    int stride = geometry.stride > 0 ? geometry.stride : geometry.width * bytes_per_pixel;
+    if (data_size < static_cast<size_t>(stride) * geometry.height) {
+        throw std::runtime_error("Raw file smaller than its geometry: " + filepath);
+    }
+
+    msg.format = geometry.format;
+    msg.width = geometry.width;
+    msg.height = geometry.height;
+    msg.stride = stride;
+    msg.bit_depth = geometry.bit_depth > 0 ? geometry.bit_depth : bytes_per_pixel * 8;
 }
 
 /**
@@ -91,14 +208,61 @@ std::vector<std::string> collectImageFiles(const std::string& directory) {
     return image_files;
 }
 
+/**
+ * @brief One image to publish: a file, or a member of the mapped archive
+ */
+struct ImageSource {
+    std::string name;                             // File path or path inside the archive
+    const voyis::ArchiveMember* member = nullptr; // Set for archive members
+};
+
+/**
+ * @brief Default stream id: the name of the image directory, or of the archive or video without extension
+ */
+std::string defaultStreamId(const std::string& directory) {
+    if (voyis::isImageArchive(directory) || voyis::isVideoFile(directory)) {
+        return fs::path(directory).stem().string();
+    }
+    fs::path dir = fs::path(directory).lexically_normal();
+    if (!dir.has_filename()) {
+        dir = dir.parent_path(); // Trailing separator
+    }
+    return dir.filename().string();
+}
+
 int main(int argc, char* argv[]) {
     // Parse command line arguments
-    if (argc != 2) {
-        std::cerr << "Usage: " << argv[0] << " <image_directory>" << std::endl;
+    voyis::Options options(argc, argv);
+    if (options.positional().size() != 1) {
+        std::cerr << "Usage: " << argv[0] << " <image_directory|archive.tar|archive.zip|video>"
+                  << " [--stream=<id>]"
+                  << " [--video-encoding=<raw|jpg|png>] [--jpeg-quality=<q>] [--video-fps=<rate>]"
+                  << " [--video-pace=<timestamps|interval>] [--video-queue=<n>] [--video-loop=<bool>]"
+                  << " [--raw-format=<fmt> --raw-width=<w> --raw-height=<h>"
+                  << " [--raw-stride=<bytes>] [--raw-bit-depth=<bits>]]"
+                  << " [--huge-pages=<off|transparent|explicit>] [--prefault-mb=<mb>]"
+                  << " [--prefault-frames=<n>] [--trace=<file> [--trace-flush-ms=<ms>]]"
+                  << " [--flight-frames=<n>] [--flight-threshold-ms=<ms>] [--flight-dir=<dir>]"
+                  << " [--interval-ms=<ms>] [--control=<endpoint|off>]"
+                  << std::endl;
         return 1;
     }
 
-    std::string image_dir = argv[1];
+    std::string image_dir = options.positional()[0];
+
+    std::string stream_id = options.getString("stream", defaultStreamId(image_dir));
+
+    RawGeometry raw_geometry;
+    raw_geometry.format = options.getString("raw-format");
+    raw_geometry.width = static_cast<int>(options.getInt("raw-width", 0));
+    raw_geometry.height = static_cast<int>(options.getInt("raw-height", 0));
+    raw_geometry.stride = static_cast<int>(options.getInt("raw-stride", 0));
+    raw_geometry.bit_depth = static_cast<int>(options.getInt("raw-bit-depth", 0));
+
+    // Settings that voyisctl can change while running
+    voyis::Tunables tunables;
+    tunables.add("interval-ms", static_cast<double>(options.getInt("interval-ms", 100)), 0, 60000,
+                 "Delay after each published frame", true);
 
     // Set up signal handlers
     std::signal(SIGINT, signalHandler);
@@ -106,19 +270,98 @@ int main(int argc, char* argv[]) {
 
     try {
         std::cout << "Image Generator starting..." << std::endl;
-        std::cout << "Image directory: " << image_dir << std::endl;
+        std::cout << "Stream: " << stream_id << std::endl;
+
+        // Collect the images of the directory, index the archive's members once,
+        // or start decoding the video
+        std::shared_ptr<voyis::ImageArchive> archive;
+        std::unique_ptr<voyis::VideoSource> video;
+        std::vector<ImageSource> sources;
+        uintmax_t largest_file = 0; // Largest image copied into a frame buffer
+        bool pace_by_timestamps = true;
+        if (voyis::isVideoFile(image_dir) && fs::is_regular_file(image_dir)) {
+            voyis::VideoSourceConfig video_config;
+            video_config.encoding = options.getString("video-encoding", "raw");
+            video_config.jpeg_quality = static_cast<int>(options.getInt("jpeg-quality", 90));
+            video_config.fps = options.getDouble("video-fps", 0.0);
+            video_config.queue_frames = static_cast<size_t>(options.getInt("video-queue", 8));
+            video_config.loop = options.getBool("video-loop", true);
+            std::string pace = options.getString("video-pace", "timestamps");
+            if (pace != "timestamps" && pace != "interval") {
+                throw std::invalid_argument("--video-pace must be timestamps or interval");
+            }
+            pace_by_timestamps = pace == "timestamps";
 
-        // Collect all image files
-        std::vector<std::string> image_files = collectImageFiles(image_dir);
-        if (image_files.empty()) {
-            std::cerr << "No image files found in directory: " << image_dir << std::endl;
+            video = std::make_unique<voyis::VideoSource>(image_dir, video_config);
+            std::cout << "Video file: " << image_dir << " (" << video->width() << "x"
+                      << video->height() << ", " << video->nativeFps() << " fps, "
+                      << video->frameCount() << " frames)" << std::endl;
+            std::cout << "Video frames: " << video_config.encoding << " at "
+                      << (video_config.fps > 0.0 ? std::to_string(video_config.fps) + " fps"
+                                                 : std::string("the native rate"))
+                      << ", paced by " << pace << std::endl;
+            // Raw mono8 frames; encoded frames are smaller
+            largest_file = static_cast<uintmax_t>(video->width()) * video->height();
+        } else if (voyis::isImageArchive(image_dir) && fs::is_regular_file(image_dir)) {
+            archive = std::make_shared<voyis::ImageArchive>(image_dir);
+            std::cout << "Image archive: " << image_dir << " ("
+                      << archive->size() / (1024.0 * 1024.0) << " MB mapped)" << std::endl;
+            for (const voyis::ArchiveMember& member : archive->members()) {
+                if (isImageFile(member.name)) {
+                    sources.push_back({member.name, &member});
+                    // Only PGM members are copied, to strip their header
+                    if (getFileExtension(member.name) == "pgm") {
+                        largest_file = std::max<uintmax_t>(largest_file, member.size);
+                    }
+                }
+            }
+        } else {
+            std::cout << "Image directory: " << image_dir << std::endl;
+            for (const std::string& file : collectImageFiles(image_dir)) {
+                sources.push_back({file, nullptr});
+                largest_file = std::max(largest_file, fs::file_size(file));
+            }
+        }
+        if (!video && sources.empty()) {
+            std::cerr << "No image files found in: " << image_dir << std::endl;
             return 1;
         }
 
-        std::cout << "Found " << image_files.size() << " image file(s)" << std::endl;
+        if (!video) {
+            std::cout << "Found " << sources.size() << " image file(s)" << std::endl;
+        }
+
+        // Fault in frame buffers for the largest file before publishing starts
+        voyis::PageFaults startup_faults = voyis::PageFaults::now();
+        voyis::configureFramePool(options, static_cast<size_t>(largest_file));
+        std::cout << "Huge pages: " << voyis::hugePageModeName(voyis::FramePool::shared().mode())
+                  << ", prefaulting took "
+                  << (voyis::PageFaults::now() - startup_faults).minor << " page faults" << std::endl;
+
+        // Optional per-frame span trace
+        std::unique_ptr<voyis::TraceWriter> trace = voyis::configureTracing(options, "image_generator");
+        if (trace) {
+            std::cout << "Tracing to: " << options.getString("trace") << std::endl;
+        }
+
+        // Always-on record of the last frames, dumped after latency spikes
+        std::unique_ptr<voyis::FlightRecorder> flight =
+            voyis::configureFlightRecorder(options, "image_generator");
+        if (flight) {
+            std::cout << "Flight recorder: " << flight->describe() << std::endl;
+        }
+
+        // Runtime control socket (voyisctl)
+        std::unique_ptr<voyis::ControlServer> control =
+            voyis::configureControl(options, "image_generator", tunables);
+        std::atomic<double>& published_stat = voyis::controlStat(control.get(), "frames_published");
+        if (control) {
+            std::cout << "Control socket: " << control->endpoint() << std::endl;
+        }
 
         // Create publisher
         const std::string endpoint = "tcp://*:5555";
+        const int port = voyis::endpointPort(endpoint);
         voyis::Publisher publisher(endpoint);
         std::cout << "Publisher bound to: " << endpoint << std::endl;
         std::cout << "Publishing images in a continuous loop..." << std::endl;
@@ -126,42 +369,167 @@ int main(int argc, char* argv[]) {
 
         size_t image_count = 0;
         size_t total_bytes = 0;
+        std::chrono::milliseconds interval(tunables.getInt("interval-ms"));
+        voyis::PageFaults steady_faults = voyis::PageFaults::now();
+
+        // Serialize into pooled buffers that ZeroMQ sends without copying; mapped
+        // archive members are sent straight from the mapping
+        auto publishFrame = [&](voyis::ImageMessage& msg, const uint8_t* mapped, size_t image_size,
+                                const std::string& label) {
+            voyis::TraceSpan serialize_span("serialize", msg.image_id);
+            voyis::FrameParts parts;
+            voyis::FrameBuffer serialized;
+            if (mapped) {
+                parts = msg.serializeParts(image_size);
+            } else {
+                serialized = msg.serializeFrame();
+            }
+            serialize_span.end();
+
+            voyis::TraceSpan publish_span("publish", msg.image_id, port);
+            bool published = mapped
+                ? publisher.publish(std::move(parts.head), mapped, image_size, archive,
+                                    std::move(parts.tail))
+                : publisher.publish(std::move(serialized));
+            publish_span.end();
+            if (published) {
+                VOYIS_TRACE2(frame_published, msg.image_id.c_str(), image_size);
+                ++image_count;
+                published_stat.store(static_cast<double>(image_count), std::memory_order_relaxed);
+                std::cout << "[" << image_count << "] Published: " << label
+                          << " (" << image_size / 1024.0 << " KB)"
+                          << std::endl;
+            } else {
+                std::cerr << "Failed to publish image: " << label << std::endl;
+            }
+        };
+
+        // Video frames go out at their presentation times, measured from the first frame
+        const std::string video_name = fs::path(image_dir).filename().string();
+        std::chrono::steady_clock::time_point video_start;
+        int64_t video_start_ms = 0;
+        bool video_started = false;
 
         // Continuously loop through images
         while (g_running) {
-            for (size_t i = 0; i < image_files.size() && g_running; ++i) {
-                const std::string& filepath = image_files[i];
+            if (video) {
+                voyis::VideoFrame frame;
+                if (!video->next(frame, 100)) {
+                    if (video->finished()) {
+                        if (!video->error().empty()) {
+                            std::cerr << "Video decoding stopped: " << video->error() << std::endl;
+                        }
+                        break;
+                    }
+                    continue; // Decoder still behind
+                }
+
+                // Control changes take effect between frames
+                if (tunables.applyPending()) {
+                    interval = std::chrono::milliseconds(tunables.getInt("interval-ms"));
+                }
+
+                try {
+                    if (!video_started) {
+                        video_start = std::chrono::steady_clock::now() -
+                            std::chrono::microseconds(std::llround(frame.pts_ms * 1000.0));
+                        video_start_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            std::chrono::system_clock::now().time_since_epoch()
+                        ).count() - std::llround(frame.pts_ms);
+                        video_started = true;
+                    }
+                    if (pace_by_timestamps) {
+                        std::this_thread::sleep_until(
+                            video_start + std::chrono::microseconds(std::llround(frame.pts_ms * 1000.0)));
+                    }
+
+                    const std::string image_id = video_name + "_" + std::to_string(frame.index);
+                    voyis::FlightTimer flight_timer(flight.get(), image_id);
+
+                    voyis::ImageMessage msg;
+                    msg.image_id = image_id;
+                    msg.stream_id = stream_id;
+                    msg.format = frame.format;
+                    msg.width = frame.width;
+                    msg.height = frame.height;
+                    msg.stride = frame.stride;
+                    msg.bit_depth = frame.bit_depth;
+                    msg.timestamp = video_start_ms + std::llround(frame.pts_ms);
+                    msg.image_data = std::move(frame.data);
+                    size_t image_size = msg.image_data.size();
+                    total_bytes += image_size;
+
+                    publishFrame(msg, nullptr, image_size, image_id);
+                    flight_timer.finish();
+
+                    if (!pace_by_timestamps) {
+                        std::this_thread::sleep_for(interval);
+                    }
+                } catch (const std::exception& e) {
+                    std::cerr << "Error processing video frame " << frame.index << ": "
+                              << e.what() << std::endl;
+                }
+                continue;
+            }
+
+            for (size_t i = 0; i < sources.size() && g_running; ++i) {
+                const ImageSource& source = sources[i];
+                const std::string& filepath = source.name;
+
+                // Control changes take effect between frames
+                if (tunables.applyPending()) {
+                    interval = std::chrono::milliseconds(tunables.getInt("interval-ms"));
+                }
 
                 try {
-                    // Read image file
-                    std::vector<uint8_t> image_data = readFile(filepath);
-                    total_bytes += image_data.size();
+                    const std::string image_id = fs::path(filepath).filename().string() +
+                                                 "_" + std::to_string(image_count);
+                    voyis::FlightTimer flight_timer(flight.get(), image_id);
 
                     // Create message
                     voyis::ImageMessage msg;
-                    msg.image_id = fs::path(filepath).filename().string() +
-                                   "_" + std::to_string(image_count);
-                    msg.image_data = std::move(image_data);
+                    msg.image_id = image_id;
+                    msg.stream_id = stream_id;
                     msg.format = getFileExtension(filepath);
                     msg.width = 0;  // Will be determined by receiver
                     msg.height = 0;
+
+                    // Archive members are sent straight from the mapping; files are read
+                    VOYIS_TRACE1(read_start, filepath.c_str());
+                    voyis::TraceSpan read_span("read", image_id);
+                    const uint8_t* mapped = nullptr;
+                    size_t image_size = 0;
+                    if (source.member && msg.format != "pgm") {
+                        mapped = archive->data(*source.member);
+                        image_size = static_cast<size_t>(source.member->size);
+                    } else if (source.member) {
+                        const uint8_t* member_data = archive->data(*source.member);
+                        msg.image_data.assign(member_data, member_data + source.member->size);
+                        image_size = msg.image_data.size();
+                    } else {
+                        msg.image_data = readFile(filepath);
+                        image_size = msg.image_data.size();
+                    }
+                    read_span.end();
+                    VOYIS_TRACE2(read_done, filepath.c_str(), image_size);
+                    total_bytes += image_size;
+
+                    // Uncompressed sources are sent as raw pixels, skipping any decode
+                    if (msg.format == "pgm") {
+                        convertPgm(msg, filepath);
+                        image_size = msg.image_data.size();
+                    } else if (msg.format == "raw") {
+                        describeRawFile(msg, image_size, raw_geometry, filepath);
+                    }
                     msg.timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
                         std::chrono::system_clock::now().time_since_epoch()
                     ).count();
 
-                    // Serialize and publish
-                    std::vector<uint8_t> serialized = msg.serialize();
-                    if (publisher.publish(serialized)) {
-                        ++image_count;
-                        std::cout << "[" << image_count << "] Published: " << filepath
-                                  << " (" << msg.image_data.size() / 1024.0 << " KB)"
-                                  << std::endl;
-                    } else {
-                        std::cerr << "Failed to publish image: " << filepath << std::endl;
-                    }
+                    publishFrame(msg, mapped, image_size, filepath);
+                    flight_timer.finish();
 
                     // Small delay to avoid overwhelming the system
-                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                    std::this_thread::sleep_for(interval);
 
                 } catch (const std::exception& e) {
                     std::cerr << "Error processing image " << filepath << ": "
@@ -173,6 +541,8 @@ int main(int argc, char* argv[]) {
         std::cout << "\nShutdown complete." << std::endl;
         std::cout << "Total images published: " << image_count << std::endl;
         std::cout << "Total data sent: " << total_bytes / (1024.0 * 1024.0) << " MB" << std::endl;
+        std::cout << voyis::frameMemoryReport(voyis::PageFaults::now() - steady_faults, image_count)
+                  << std::endl;
 
     } catch (const std::exception& e) {
         std::cerr << "Fatal error: " << e.what() << std::endl;
@@ -0,0 +1,199 @@
+#include "video_source.h"
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace voyis {
+
+namespace {
+
+// Used when the container does not report a frame rate (e.g. raw .h264 streams)
+constexpr double kFallbackFps = 30.0;
+
+} // anonymous namespace
+
+VideoSource::VideoSource(const std::string& path, const VideoSourceConfig& config)
+    : path_(path), config_(config), queue_(std::max<size_t>(config.queue_frames, 1)) {
+    if (config_.encoding != "raw" && config_.encoding != "jpg" && config_.encoding != "png") {
+        throw std::invalid_argument("Unknown video encoding '" + config_.encoding +
+                                    "' (expected raw, jpg or png)");
+    }
+    if (config_.fps < 0.0) {
+        throw std::invalid_argument("Video frame rate must not be negative");
+    }
+
+    open();
+    native_fps_ = capture_.get(cv::CAP_PROP_FPS);
+    if (!(native_fps_ > 0.0 && native_fps_ < 1000.0)) {
+        native_fps_ = kFallbackFps;
+    }
+    frame_count_ = static_cast<int64_t>(capture_.get(cv::CAP_PROP_FRAME_COUNT));
+    width_ = static_cast<int>(capture_.get(cv::CAP_PROP_FRAME_WIDTH));
+    height_ = static_cast<int>(capture_.get(cv::CAP_PROP_FRAME_HEIGHT));
+
+    decoder_ = std::thread(&VideoSource::decodeLoop, this);
+}
+
+VideoSource::~VideoSource() {
+    stopping_ = true;
+    if (decoder_.joinable()) {
+        decoder_.join();
+    }
+}
+
+void VideoSource::open() {
+    capture_.release();
+    if (!capture_.open(path_)) {
+        throw std::runtime_error("Failed to open video: " + path_);
+    }
+}
+
+void VideoSource::decodeLoop() {
+    const double frame_period = 1000.0 / native_fps_;
+    const double keep_period = config_.fps > 0.0 ? 1000.0 / config_.fps : 0.0;
+    double pass_start = 0.0; // Timeline position of the current pass over the file
+    double next_keep = 0.0;
+    double last_pts = -1.0;
+    int64_t pass_frames = 0;
+    int64_t index = 0;
+    cv::Mat image;
+
+    try {
+        while (!stopping_) {
+            if (!capture_.grab()) {
+                if (!config_.loop || pass_frames == 0) {
+                    break;
+                }
+                // Reopening rewinds with every backend, unlike seeking to frame 0
+                pass_start += last_pts + frame_period;
+                open();
+                last_pts = -1.0;
+                pass_frames = 0;
+                continue;
+            }
+
+            // Some backends report no or non-increasing timestamps; count frames instead
+            double pts = capture_.get(cv::CAP_PROP_POS_MSEC);
+            if (!(pts > last_pts)) {
+                pts = static_cast<double>(pass_frames) * frame_period;
+            }
+            last_pts = pts;
+            ++pass_frames;
+            const int64_t frame_index = index++;
+            const double timeline = pass_start + pts;
+
+            // Rate limit: frames dropped here are never converted or encoded
+            if (keep_period > 0.0) {
+                if (timeline + frame_period / 2 < next_keep) {
+                    continue;
+                }
+                next_keep = std::max(next_keep + keep_period, timeline + frame_period / 2);
+            }
+
+            if (!capture_.retrieve(image) || image.empty()) {
+                throw std::runtime_error("Failed to decode frame " + std::to_string(frame_index) +
+                                         " of " + path_);
+            }
+            VideoFrame frame;
+            frame.index = frame_index;
+            frame.pts_ms = timeline;
+            convert(image, frame);
+
+            // The ring is bounded: wait for the publisher rather than decode further ahead
+            while (!queue_.tryPush(std::move(frame))) {
+                if (stopping_) {
+                    break;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+    } catch (const std::exception& e) {
+        std::lock_guard<std::mutex> lock(error_mutex_);
+        error_ = e.what();
+    }
+    done_.store(true, std::memory_order_release);
+}
+
+void VideoSource::convert(const cv::Mat& image, VideoFrame& frame) const {
+    frame.width = image.cols;
+    frame.height = image.rows;
+
+    if (config_.encoding == "raw") {
+        // Raw wire formats are single channel, so colour frames are sent as gray
+        cv::Mat gray = image;
+        if (image.channels() == 3) {
+            cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+        } else if (image.channels() == 4) {
+            cv::cvtColor(image, gray, cv::COLOR_BGRA2GRAY);
+        }
+        if (gray.depth() != CV_8U && gray.depth() != CV_16U) {
+            gray.convertTo(gray, CV_8U);
+        }
+
+        const size_t row_bytes = static_cast<size_t>(gray.cols) * gray.elemSize();
+        frame.data.resize(row_bytes * static_cast<size_t>(gray.rows));
+        for (int y = 0; y < gray.rows; ++y) {
+            std::memcpy(frame.data.data() + row_bytes * static_cast<size_t>(y), gray.ptr(y),
+                        row_bytes);
+        }
+        bool wide = gray.depth() == CV_16U;
+        frame.format = wide ? "mono16" : "mono8";
+        frame.stride = static_cast<int>(row_bytes);
+        frame.bit_depth = wide ? 16 : 8;
+        return;
+    }
+
+    std::vector<int> params;
+    if (config_.encoding == "jpg") {
+        params = {cv::IMWRITE_JPEG_QUALITY, config_.jpeg_quality};
+    }
+    std::vector<uchar> encoded;
+    if (!cv::imencode("." + config_.encoding, image, encoded, params)) {
+        throw std::runtime_error("Failed to encode frame " + std::to_string(frame.index) +
+                                 " as " + config_.encoding);
+    }
+    frame.data.assign(encoded.begin(), encoded.end());
+    frame.format = config_.encoding;
+}
+
+bool VideoSource::next(VideoFrame& frame, int timeout_ms) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (!queue_.tryPop(frame)) {
+        if (done_.load(std::memory_order_acquire)) {
+            return queue_.tryPop(frame); // Pushed just before the decoder stopped
+        }
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+bool VideoSource::finished() const {
+    return done_.load(std::memory_order_acquire) && queue_.sizeApprox() == 0;
+}
+
+std::string VideoSource::error() const {
+    std::lock_guard<std::mutex> lock(error_mutex_);
+    return error_;
+}
+
+bool isVideoFile(const std::string& path) {
+    std::string ext;
+    size_t dot = path.find_last_of('.');
+    if (dot != std::string::npos && path.find('/', dot) == std::string::npos) {
+        ext = path.substr(dot + 1);
+    }
+    std::transform(ext.begin(), ext.end(), ext.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return ext == "mp4" || ext == "mov" || ext == "avi" || ext == "mkv" || ext == "h264" ||
+           ext == "264" || ext == "mjpeg" || ext == "mjpg";
+}
+
+} // namespace voyis
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "frame_allocator.h"
+#include "lockfree_queue.h"
+#include <opencv2/core.hpp>
+#include <opencv2/videoio.hpp>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace voyis {
+
+/**
+ * @brief How frames are taken out of a video file
+ */
+struct VideoSourceConfig {
+    std::string encoding = "raw"; // "raw" (mono8/mono16 pixels), "jpg" or "png"
+    int jpeg_quality = 90;
+    double fps = 0.0;             // Keep frames at this rate, decimating by timestamp (0 keeps all)
+    size_t queue_frames = 8;      // Decoded frames buffered ahead of the publisher
+    bool loop = true;             // Start over at the end of the file
+};
+
+/**
+ * @brief One decoded frame, ready to publish
+ */
+struct VideoFrame {
+    FrameBuffer data;
+    std::string format;    // "mono8", "mono16", "jpg" or "png"
+    int width = 0;
+    int height = 0;
+    int stride = 0;        // Row bytes of raw frames, 0 for encoded frames
+    int bit_depth = 0;
+    int64_t index = 0;     // Frame number in the file, counting on across loops
+    double pts_ms = 0.0;   // Presentation time since the start of the first pass
+};
+
+/**
+ * @brief H.264/MJPEG (or any format OpenCV can open) video file read on a decode thread
+ *
+ * cv::VideoCapture decodes on its own thread into a lock-free single
+ * producer, single consumer ring, so decoding the next frames overlaps with
+ * publishing the current one. Frames dropped by the rate limit are only
+ * grabbed, never converted or encoded. Timestamps come from the container
+ * (falling back to frame number / frame rate), so they stay frame-accurate
+ * however the frames are paced on the way out.
+ */
+class VideoSource {
+public:
+    /**
+     * @throws std::invalid_argument for an unknown encoding
+     * @throws std::runtime_error if the file cannot be opened
+     */
+    VideoSource(const std::string& path, const VideoSourceConfig& config);
+    ~VideoSource();
+
+    // Disable copy
+    VideoSource(const VideoSource&) = delete;
+    VideoSource& operator=(const VideoSource&) = delete;
+
+    /**
+     * @brief Take the next frame, waiting up to timeout_ms for the decoder
+     * @return false if no frame was ready; check finished() to tell the end of the video
+     */
+    bool next(VideoFrame& frame, int timeout_ms);
+
+    /**
+     * @brief The decoder stopped (end of file without looping, or an error) and the queue is empty
+     */
+    bool finished() const;
+
+    /**
+     * @brief Why decoding stopped early, or empty
+     */
+    std::string error() const;
+
+    double nativeFps() const { return native_fps_; }
+    int64_t frameCount() const { return frame_count_; }
+    int width() const { return width_; }
+    int height() const { return height_; }
+
+private:
+    void open();
+    void decodeLoop();
+    void convert(const cv::Mat& image, VideoFrame& frame) const;
+
+    std::string path_;
+    VideoSourceConfig config_;
+    cv::VideoCapture capture_;
+    double native_fps_ = 0.0;
+    int64_t frame_count_ = 0;
+    int width_ = 0;
+    int height_ = 0;
+
+    SpscRing<VideoFrame> queue_;
+    std::atomic<bool> stopping_{false};
+    std::atomic<bool> done_{false};
+    mutable std::mutex error_mutex_;
+    std::string error_;
+    std::thread decoder_;
+};
+
+/**
+ * @brief Whether a path names a video file (mp4, mov, avi, mkv, h264, mjpeg)
+ */
+bool isVideoFile(const std::string& path);
+
+} // namespace voyis
@@ -0,0 +1,59 @@
+#include "control.h"
+#include "ipc.h"
+#include "options.h"
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " <process|endpoint> <command> [args...] [--timeout-ms=5000]\n"
+              << "  <process> is image_generator, feature_extractor, data_logger or\n"
+              << "  feature_matcher (their default --control socket); anything with\n"
+              << "  \"://\" is used as the endpoint.\n"
+              << "Commands:\n"
+              << "  get [name...]           current settings\n"
+              << "  set name=value [...]    change settings at the next frame boundary\n"
+              << "  list                    settings with ranges and descriptions\n"
+              << "  stats                   process counters" << std::endl;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    try {
+        voyis::Options options(argc, argv);
+        const std::vector<std::string>& args = options.positional();
+        if (args.size() < 2) {
+            printUsage(argv[0]);
+            return 1;
+        }
+
+        std::string endpoint = args[0];
+        if (endpoint.find("://") == std::string::npos) {
+            endpoint = voyis::defaultControlEndpoint(endpoint);
+        }
+
+        std::string request = args[1];
+        for (size_t i = 2; i < args.size(); ++i) {
+            request += " " + args[i];
+        }
+
+        // A "set" waits up to 2 s for the next frame boundary on the other side
+        voyis::Requester requester(endpoint, static_cast<int>(options.getInt("timeout-ms", 5000)));
+        std::vector<uint8_t> reply;
+        if (!requester.request(std::vector<uint8_t>(request.begin(), request.end()), reply)) {
+            std::cerr << "No reply from " << endpoint << " (is the process running?)" << std::endl;
+            return 2;
+        }
+
+        std::string text(reply.begin(), reply.end());
+        std::cout << text << std::endl;
+        return text.rfind("{\"ok\":true", 0) == 0 ? 0 : 1;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,105 @@
+#include "ipc.h"
+#include <gtest/gtest.h>
+
+#ifdef VOYIS_HAVE_COROUTINES
+
+#include <chrono>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace voyis;
+
+namespace {
+
+// Coroutines take their state as parameters: lambda captures would dangle once suspended
+
+Task<void> receiveInto(Reactor& reactor, Subscriber& sub, int timeout_ms,
+                       std::optional<std::vector<uint8_t>>& result) {
+    result = co_await sub.async_receive(reactor, timeout_ms);
+}
+
+Task<void> publishLater(Reactor& reactor, Publisher& pub, std::vector<uint8_t> data, bool& sent) {
+    co_await reactor.sleep(50);
+    sent = co_await pub.async_publish(reactor, data);
+}
+
+Task<int> failing() {
+    throw std::runtime_error("corrupt frame");
+    co_return 0;
+}
+
+Task<void> catchFailure(bool& caught) {
+    try {
+        co_await failing();
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+}
+
+} // anonymous namespace
+
+TEST(AsyncIpcTest, ReceivesFromPublisherCoroutine) {
+    Publisher pub("tcp://*:5980");
+    Subscriber sub("tcp://localhost:5980", 1000);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200)); // Slow joiner
+
+    Reactor reactor;
+    std::optional<std::vector<uint8_t>> received;
+    bool sent = false;
+    reactor.spawn(receiveInto(reactor, sub, 2000, received));
+    reactor.spawn(publishLater(reactor, pub, {1, 2, 3}, sent));
+    reactor.run();
+
+    EXPECT_TRUE(sent);
+    ASSERT_TRUE(received.has_value());
+    EXPECT_EQ((std::vector<uint8_t>{1, 2, 3}), *received);
+}
+
+TEST(AsyncIpcTest, ReceiveTimesOut) {
+    Subscriber sub("tcp://localhost:5981", 1000);
+
+    Reactor reactor;
+    std::optional<std::vector<uint8_t>> received = std::vector<uint8_t>{};
+    auto start = std::chrono::steady_clock::now();
+    reactor.spawn(receiveInto(reactor, sub, 100, received));
+    reactor.run();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_FALSE(received.has_value());
+    EXPECT_GE(elapsed, std::chrono::milliseconds(90));
+    EXPECT_FALSE(reactor.stopping());
+}
+
+TEST(AsyncIpcTest, StopCancelsEveryPendingReceive) {
+    Subscriber a("tcp://localhost:5982", 1000);
+    Subscriber b("tcp://localhost:5983", 1000);
+
+    Reactor reactor;
+    std::optional<std::vector<uint8_t>> from_a = std::vector<uint8_t>{};
+    std::optional<std::vector<uint8_t>> from_b = std::vector<uint8_t>{};
+    reactor.spawn(receiveInto(reactor, a, -1, from_a));
+    reactor.spawn(receiveInto(reactor, b, -1, from_b));
+
+    std::thread stopper([&reactor]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        reactor.stop();
+    });
+    reactor.run();
+    stopper.join();
+
+    EXPECT_TRUE(reactor.stopping());
+    EXPECT_FALSE(from_a.has_value());
+    EXPECT_FALSE(from_b.has_value());
+}
+
+TEST(AsyncIpcTest, ExceptionsReachTheAwaiter) {
+    Reactor reactor;
+    bool caught = false;
+    reactor.spawn(catchFailure(caught));
+    reactor.run();
+    EXPECT_TRUE(caught);
+}
+
+#endif // VOYIS_HAVE_COROUTINES
@@ -0,0 +1,98 @@
+#include "feature_extractor/autotuner.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdio>
+
+using namespace voyis;
+
+namespace {
+
+std::vector<TuningKnob> makeKnobs() {
+    return {{"opencv-threads", {1, 2, 4, 8, 16}}, {"tile-size", {512, 1024, 2048, 4096}}};
+}
+
+/**
+ * @brief Synthetic host: fastest with 4 threads and 2048 pixel tiles
+ */
+double frameMs(const Autotuner::Setting& setting, double cost) {
+    double threads_penalty = std::abs(std::log2(setting[0]) - 2.0) * 3.0;
+    double tile_penalty = std::abs(std::log2(setting[1] / 2048.0)) * 2.0;
+    return (10.0 + threads_penalty + tile_penalty) * cost;
+}
+
+size_t runUntilConverged(Autotuner& tuner, FrameSizeClass size_class, double cost) {
+    size_t frames = 0;
+    while (!tuner.converged(size_class) && frames < 10000) {
+        tuner.record(size_class, cost, frameMs(tuner.select(size_class), cost));
+        ++frames;
+    }
+    return frames;
+}
+
+AutotunerConfig quickConfig() {
+    AutotunerConfig config;
+    config.frames_per_trial = 3;
+    return config;
+}
+
+} // anonymous namespace
+
+TEST(AutotunerTest, ClimbsToTheFastestSetting) {
+    Autotuner tuner(makeKnobs(), {1, 512}, quickConfig());
+    EXPECT_EQ((Autotuner::Setting{1, 512}), tuner.select(FrameSizeClass::Medium));
+
+    size_t frames = runUntilConverged(tuner, FrameSizeClass::Medium, 4.0);
+    ASSERT_TRUE(tuner.converged(FrameSizeClass::Medium));
+    EXPECT_LT(frames, 100u);
+    EXPECT_EQ((Autotuner::Setting{4, 2048}), tuner.best(FrameSizeClass::Medium));
+    EXPECT_EQ(tuner.best(FrameSizeClass::Medium), tuner.select(FrameSizeClass::Medium));
+    EXPECT_NEAR(15.0, tuner.bestScore(FrameSizeClass::Medium), 1e-9); // 10 ms/MP, mean + p99 / 2
+    EXPECT_EQ("opencv-threads=4 tile-size=2048", tuner.describe(tuner.best(FrameSizeClass::Medium)));
+
+    // Other classes are tuned separately
+    EXPECT_FALSE(tuner.converged(FrameSizeClass::Large));
+    EXPECT_EQ((Autotuner::Setting{1, 512}), tuner.select(FrameSizeClass::Large));
+}
+
+TEST(AutotunerTest, SnapsStartToAllowedValues) {
+    Autotuner tuner(makeKnobs(), {3, 5000}, quickConfig());
+    EXPECT_EQ((Autotuner::Setting{2, 4096}), tuner.select(FrameSizeClass::Small));
+    EXPECT_THROW(Autotuner(makeKnobs(), {4}), std::invalid_argument);
+    EXPECT_THROW(Autotuner({{"empty", {}}}, {1}), std::invalid_argument);
+}
+
+TEST(AutotunerTest, AbandonsAMuchSlowerSettingAfterOneFrame) {
+    Autotuner tuner({{"opencv-threads", {4, 8}}}, {4}, quickConfig());
+    for (int i = 0; i < 3; ++i) {
+        tuner.record(FrameSizeClass::Medium, 1.0, 10.0);
+    }
+    ASSERT_EQ((Autotuner::Setting{8}), tuner.select(FrameSizeClass::Medium));
+
+    EXPECT_TRUE(tuner.record(FrameSizeClass::Medium, 1.0, 100.0));
+    EXPECT_EQ((Autotuner::Setting{4}), tuner.select(FrameSizeClass::Medium));
+}
+
+TEST(AutotunerTest, ProfileRoundTripPerHost) {
+    std::string path = testing::TempDir() + "voyis_autotune_test.txt";
+    {
+        Autotuner tuner(makeKnobs(), {1, 512}, quickConfig());
+        runUntilConverged(tuner, FrameSizeClass::Large, 50.0);
+        tuner.save(path, "vessel-1");
+    }
+
+    Autotuner resumed(makeKnobs(), {1, 512}, quickConfig());
+    EXPECT_EQ(1u, resumed.load(path, "vessel-1"));
+    EXPECT_TRUE(resumed.converged(FrameSizeClass::Large));
+    EXPECT_EQ((Autotuner::Setting{4, 2048}), resumed.select(FrameSizeClass::Large));
+    EXPECT_FALSE(resumed.converged(FrameSizeClass::Small));
+
+    Autotuner other_host(makeKnobs(), {1, 512}, quickConfig());
+    EXPECT_EQ(0u, other_host.load(path, "vessel-2"));
+    EXPECT_FALSE(other_host.converged(FrameSizeClass::Large));
+
+    Autotuner other_knobs({{"opencv-threads", {1, 2, 4}}}, {1}, quickConfig());
+    EXPECT_EQ(0u, other_knobs.load(path, "vessel-1"));
+
+    std::remove(path.c_str());
+    EXPECT_EQ(0u, resumed.load(path, "vessel-1"));
+}
@@ -0,0 +1,99 @@
+#include "bounded_cache.h"
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace voyis;
+
+namespace {
+
+std::shared_ptr<const int> value(int v) {
+    return std::make_shared<const int>(v);
+}
+
+} // anonymous namespace
+
+TEST(BoundedCacheTest, EvictsOldestByCount) {
+    BoundedCache<std::string, int> cache(3, 1000);
+    for (int i = 1; i <= 4; ++i) {
+        EXPECT_TRUE(cache.insert("k" + std::to_string(i), value(i), 10));
+    }
+    EXPECT_EQ(3u, cache.size());
+    EXPECT_EQ(30u, cache.bytes());
+    EXPECT_EQ(nullptr, cache.find("k1"));
+    EXPECT_EQ(4, *cache.find("k4"));
+    EXPECT_THROW((BoundedCache<std::string, int>(0, 1000)), std::invalid_argument);
+}
+
+TEST(BoundedCacheTest, EvictsAsManyAsTheByteBudgetNeeds) {
+    BoundedCache<int, int> cache(10, 100);
+    for (int i = 0; i < 5; ++i) {
+        cache.insert(i, value(i), 20);
+    }
+    // 50 bytes need three of the 20-byte entries to go
+    EXPECT_TRUE(cache.insert(5, value(5), 50));
+    EXPECT_EQ(3u, cache.size());
+    EXPECT_EQ(90u, cache.bytes());
+    EXPECT_EQ(nullptr, cache.find(2));
+    EXPECT_NE(nullptr, cache.find(3));
+
+    // Larger than the whole budget: rejected without evicting anything
+    EXPECT_FALSE(cache.insert(6, value(6), 101));
+    EXPECT_EQ(3u, cache.size());
+}
+
+TEST(BoundedCacheTest, ReinsertingAKeyMakesItNewest) {
+    BoundedCache<std::string, int> cache(2, 1000);
+    cache.insert("a", value(1), 10);
+    cache.insert("b", value(2), 10);
+    cache.insert("a", value(3), 30);
+    EXPECT_EQ(2u, cache.size());
+    EXPECT_EQ(40u, cache.bytes());
+
+    cache.insert("c", value(4), 10);
+    EXPECT_EQ(nullptr, cache.find("b"));
+    EXPECT_EQ(3, *cache.find("a"));
+
+    std::vector<BoundedCache<std::string, int>::Entry> newest = cache.newest(5);
+    ASSERT_EQ(2u, newest.size());
+    EXPECT_EQ("c", newest[0].first);
+    EXPECT_EQ("a", newest[1].first);
+}
+
+TEST(BoundedCacheTest, FindsNewestMatchingValue) {
+    BoundedCache<int, int> cache(4, 1000);
+    cache.insert(1, value(7), 1);
+    cache.insert(2, value(8), 1);
+    cache.insert(3, value(7), 1);
+    EXPECT_EQ(3, cache.findNewest([](int v) { return v == 7; }).first);
+    EXPECT_EQ(nullptr, cache.findNewest([](int v) { return v == 9; }).second);
+}
+
+TEST(BoundedCacheTest, EvictedValuesStayAliveForReaders) {
+    BoundedCache<int, std::string> cache(1, 1000);
+    cache.insert(1, std::make_shared<const std::string>("first"), 5);
+    std::shared_ptr<const std::string> held = cache.find(1);
+    cache.insert(2, std::make_shared<const std::string>("second"), 6);
+    EXPECT_EQ(nullptr, cache.find(1));
+    EXPECT_EQ("first", *held);
+}
+
+TEST(BoundedCacheTest, ConcurrentInsertsStayWithinLimits) {
+    BoundedCache<int, int> cache(16, 64);
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 4; ++t) {
+        writers.emplace_back([&cache, t] {
+            for (int i = 0; i < 1000; ++i) {
+                cache.insert(t * 1000 + i, value(i), static_cast<size_t>(i % 8));
+                cache.newest(4);
+            }
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    EXPECT_LE(cache.size(), 16u);
+    EXPECT_LE(cache.bytes(), 64u);
+}
@@ -0,0 +1,132 @@
+#include "control.h"
+#include "ipc.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace voyis;
+
+namespace {
+
+void addTunables(Tunables& tunables) {
+    tunables.add("interval-ms", 100, 0, 60000, "Delay between frames", true);
+    tunables.add("contrast", 0.04, 0.0, 1.0, "SIFT contrast threshold");
+}
+
+std::string roundTrip(Requester& requester, const std::string& request) {
+    std::vector<uint8_t> reply;
+    if (!requester.request(std::vector<uint8_t>(request.begin(), request.end()), reply)) {
+        return "";
+    }
+    return std::string(reply.begin(), reply.end());
+}
+
+} // anonymous namespace
+
+TEST(TunablesTest, ChangesApplyOnlyAtFrameBoundary) {
+    Tunables tunables;
+    addTunables(tunables);
+    EXPECT_FALSE(tunables.applyPending());
+
+    uint64_t generation = tunables.request({{"interval-ms", "50"}, {"contrast", "0.06"}});
+    EXPECT_EQ(100, tunables.getInt("interval-ms")); // Queued, not applied
+    EXPECT_FALSE(tunables.waitApplied(generation, std::chrono::milliseconds(1)));
+
+    EXPECT_TRUE(tunables.applyPending());
+    EXPECT_TRUE(tunables.waitApplied(generation, std::chrono::milliseconds(1)));
+    EXPECT_EQ(50, tunables.getInt("interval-ms"));
+    EXPECT_DOUBLE_EQ(0.06, tunables.get("contrast"));
+    EXPECT_FALSE(tunables.applyPending());
+}
+
+TEST(TunablesTest, InvalidBatchIsRejectedAsAWhole) {
+    Tunables tunables;
+    addTunables(tunables);
+    EXPECT_THROW(tunables.request({{"interval-ms", "50"}, {"contrast", "2"}}), std::invalid_argument);
+    EXPECT_THROW(tunables.request({{"interval-ms", "12.5"}}), std::invalid_argument);
+    EXPECT_THROW(tunables.request({{"interval-ms", "fast"}}), std::invalid_argument);
+    EXPECT_THROW(tunables.request({{"unknown", "1"}}), std::invalid_argument);
+    EXPECT_FALSE(tunables.applyPending());
+    EXPECT_EQ(100, tunables.getInt("interval-ms"));
+
+    EXPECT_THROW(tunables.add("contrast", 0.1, 0.0, 1.0, "Duplicate"), std::invalid_argument);
+    EXPECT_THROW(tunables.add("threads", 500, 0, 256, "Out of range", true), std::invalid_argument);
+}
+
+TEST(ControlServerTest, AnswersGetListAndStats) {
+    Tunables tunables;
+    addTunables(tunables);
+    ControlServer server("inproc://control_get", "test_process", tunables);
+    server.stat("frames").store(42);
+
+    EXPECT_EQ("{\"ok\":true,\"process\":\"test_process\",\"tunables\":"
+              "{\"contrast\":0.04,\"interval-ms\":100}}", server.handle("get"));
+    EXPECT_EQ("{\"ok\":true,\"process\":\"test_process\",\"tunables\":{\"interval-ms\":100}}",
+              server.handle("get interval-ms"));
+    EXPECT_NE(std::string::npos, server.handle("list").find(
+        "{\"name\":\"interval-ms\",\"value\":100,\"min\":0,\"max\":60000,\"integer\":true,"
+        "\"description\":\"Delay between frames\"}"));
+
+    std::string stats = server.handle("stats");
+    EXPECT_NE(std::string::npos, stats.find("\"uptime_s\":"));
+    EXPECT_NE(std::string::npos, stats.find("\"pool_mapped\":"));
+    EXPECT_NE(std::string::npos, stats.find("\"rss_bytes\":"));
+    EXPECT_NE(std::string::npos, stats.find("\"heap_free_bytes\":"));
+    EXPECT_NE(std::string::npos, stats.find("\"frames\":42"));
+
+    EXPECT_EQ(0u, server.handle("get nope").find("{\"ok\":false"));
+    EXPECT_EQ(0u, server.handle("restart").find("{\"ok\":false"));
+    EXPECT_EQ(0u, server.handle("set interval-ms").find("{\"ok\":false"));
+    EXPECT_EQ(0u, server.handle("").find("{\"ok\":false"));
+}
+
+TEST(ControlServerTest, SetOverSocketWaitsForFrameBoundary) {
+    Tunables tunables;
+    addTunables(tunables);
+    std::string endpoint = "ipc://" + testing::TempDir() + "voyis_control_test.sock";
+    ControlServer server(endpoint, "test_process", tunables);
+
+    // Stand-in for a processing loop
+    std::atomic<bool> running(true);
+    std::thread loop([&]() {
+        while (running) {
+            tunables.applyPending();
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    });
+
+    Requester requester(endpoint, 5000);
+    EXPECT_EQ("{\"ok\":true,\"applied\":true,\"tunables\":{\"interval-ms\":25,\"contrast\":0.08}}",
+              roundTrip(requester, "set interval-ms=25 contrast=0.08"));
+    EXPECT_EQ(25, tunables.getInt("interval-ms"));
+
+    std::string rejected = roundTrip(requester, "set interval-ms=-5");
+    EXPECT_EQ(0u, rejected.find("{\"ok\":false"));
+    EXPECT_NE(std::string::npos, rejected.find("between 0 and 60000"));
+    EXPECT_EQ(25, tunables.getInt("interval-ms"));
+
+    running = false;
+    loop.join();
+}
+
+TEST(ControlServerTest, RefusesSocketOfARunningServer) {
+    Tunables tunables;
+    addTunables(tunables);
+    std::string endpoint = "ipc://" + testing::TempDir() + "voyis_control_busy.sock";
+
+    {
+        ControlServer first(endpoint, "first", tunables);
+        EXPECT_THROW(ControlServer(endpoint, "second", tunables), std::runtime_error);
+
+        // The first server keeps its socket
+        Requester requester(endpoint, 5000);
+        EXPECT_NE(std::string::npos, roundTrip(requester, "stats").find("\"process\":\"first\""));
+    }
+
+    // A socket nobody answers on any more is taken over
+    ControlServer replacement(endpoint, "replacement", tunables);
+    EXPECT_EQ(endpoint, replacement.endpoint());
+}
+
+TEST(ControlServerTest, DefaultEndpointIsPerProcess) {
+    EXPECT_EQ("ipc:///tmp/voyis-feature_extractor.sock", defaultControlEndpoint("feature_extractor"));
+}
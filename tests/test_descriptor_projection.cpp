@@ -0,0 +1,73 @@
+#include "feature_extractor/descriptor_projection.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <string>
+
+using namespace voyis;
+
+namespace {
+
+// 128-dimensional samples lying close to a 4-dimensional subspace
+cv::Mat makeLowRankSamples(int count) {
+    cv::Mat basis(4, 128, CV_32F);
+    cv::randn(basis, 0.0, 1.0);
+    cv::Mat weights(count, 4, CV_32F);
+    cv::randn(weights, 0.0, 10.0);
+    cv::Mat noise(count, 128, CV_32F);
+    cv::randn(noise, 0.0, 0.01);
+    cv::Mat offset(1, 128, CV_32F, cv::Scalar(5.0));
+    return weights * basis + noise + cv::repeat(offset, count, 1);
+}
+
+} // anonymous namespace
+
+TEST(DescriptorProjectionTest, MatchesOpenCVPca) {
+    cv::Mat samples = makeLowRankSamples(500);
+
+    double explained = 0.0;
+    DescriptorProjection projection = DescriptorProjection::train(samples, 8, &explained);
+    EXPECT_EQ(128, projection.inputDim());
+    EXPECT_EQ(8, projection.outputDim());
+    EXPECT_GT(explained, 0.99);
+
+    cv::PCA reference(samples, cv::noArray(), cv::PCA::DATA_AS_ROW, 8);
+    cv::Mat expected = reference.project(samples.rowRange(0, 10));
+    cv::Mat projected = projection.project(samples.rowRange(0, 10));
+    ASSERT_EQ(expected.size(), projected.size());
+    EXPECT_LT(cv::norm(expected, projected, cv::NORM_INF), 1e-3);
+}
+
+TEST(DescriptorProjectionTest, SaveAndLoad) {
+    cv::Mat samples = makeLowRankSamples(200);
+    DescriptorProjection trained = DescriptorProjection::train(samples, 32);
+
+    std::string path = testing::TempDir() + "voyis_pca_test.yml";
+    trained.save(path, 0.9);
+    DescriptorProjection loaded = DescriptorProjection::load(path);
+    std::remove(path.c_str());
+
+    EXPECT_EQ(32, loaded.outputDim());
+    EXPECT_LT(cv::norm(trained.project(samples), loaded.project(samples), cv::NORM_INF), 1e-4);
+}
+
+TEST(DescriptorProjectionTest, RejectsBadInput) {
+    DescriptorProjection projection = DescriptorProjection::train(makeLowRankSamples(100), 16);
+
+    EXPECT_THROW(projection.project(cv::Mat::zeros(3, 64, CV_32F)), std::invalid_argument);
+    EXPECT_EQ(0, projection.project(cv::Mat()).rows);
+    EXPECT_THROW(DescriptorProjection::train(makeLowRankSamples(10), 32), std::invalid_argument);
+    EXPECT_THROW(DescriptorProjection::load(testing::TempDir() + "missing_pca.yml"),
+                 std::runtime_error);
+}
+
+TEST(DescriptorProjectionTest, LoadRejectsOtherInputDimensions) {
+    cv::Mat samples(100, 64, CV_32F);
+    cv::randn(samples, 0.0, 1.0);
+    DescriptorProjection trained = DescriptorProjection::train(samples, 8);
+
+    std::string path = testing::TempDir() + "voyis_pca_64.yml";
+    trained.save(path, 0.5);
+    EXPECT_THROW(DescriptorProjection::load(path), std::runtime_error);
+    EXPECT_EQ(64, DescriptorProjection::load(path, 64).inputDim());
+    std::remove(path.c_str());
+}
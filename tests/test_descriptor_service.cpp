@@ -0,0 +1,157 @@
+#include "feature_extractor/descriptor_service.h"
+#include "ipc.h"
+#include <gtest/gtest.h>
+#include <opencv2/imgproc.hpp>
+#include <string>
+#include <vector>
+
+using namespace voyis;
+
+namespace {
+
+/**
+ * @brief Textured test image with plenty of SIFT keypoints
+ */
+cv::Mat makeScene() {
+    cv::Mat image(240, 320, CV_8UC1, cv::Scalar(90));
+    cv::RNG rng(7);
+    for (int i = 0; i < 60; ++i) {
+        cv::Point center(rng.uniform(10, 310), rng.uniform(10, 230));
+        cv::circle(image, center, rng.uniform(3, 14), cv::Scalar(rng.uniform(0, 256)), cv::FILLED);
+    }
+    return image;
+}
+
+CachedFrame detectFrame(const cv::Mat& image) {
+    CachedFrame frame;
+    frame.image = image;
+    frame.detector = cv::SIFT::create();
+    frame.detector->detect(image, frame.keypoints);
+    return frame;
+}
+
+CachedFrame blankFrame(int rows, int cols) {
+    CachedFrame frame;
+    frame.image = cv::Mat(rows, cols, CV_8UC1, cv::Scalar(0));
+    return frame;
+}
+
+} // anonymous namespace
+
+TEST(FrameCacheTest, EvictsOldestByFramesAndBytes) {
+    FrameCache cache(3, 10000);
+    cache.insert("a", blankFrame(10, 100));
+    cache.insert("b", blankFrame(10, 100));
+    cache.insert("c", blankFrame(10, 100));
+    cache.insert("d", blankFrame(10, 100));
+    EXPECT_EQ(3u, cache.size());
+    EXPECT_EQ(nullptr, cache.find("a"));
+    EXPECT_NE(nullptr, cache.find("d"));
+
+    // 8500 bytes leaves room for only one of the 1000-byte frames
+    cache.insert("big", blankFrame(85, 100));
+    EXPECT_EQ(2u, cache.size());
+    EXPECT_EQ(9500u, cache.bytes());
+    EXPECT_EQ(nullptr, cache.find("c"));
+
+    cache.insert("too_big", blankFrame(101, 100));
+    EXPECT_EQ(nullptr, cache.find("too_big"));
+    EXPECT_THROW(FrameCache(0, 100), std::invalid_argument);
+}
+
+TEST(FrameCacheTest, CopiesWrappedPixelsAndSharesAliases) {
+    FrameCache cache(4, 1 << 20);
+    std::vector<uint8_t> payload(64 * 32, 200);
+    CachedFrame wrapped;
+    wrapped.image = cv::Mat(32, 64, CV_8UC1, payload.data()); // Like raw message pixels
+    cache.insert("raw", wrapped);
+    payload.assign(payload.size(), 0);
+
+    std::shared_ptr<const CachedFrame> cached = cache.find("raw");
+    ASSERT_NE(nullptr, cached);
+    EXPECT_EQ(200, cached->image.at<uint8_t>(5, 5));
+
+    EXPECT_TRUE(cache.alias("duplicate", "raw"));
+    EXPECT_EQ(cached, cache.find("duplicate"));
+    EXPECT_FALSE(cache.alias("orphan", "missing"));
+    EXPECT_EQ(2u * 64 * 32, cache.bytes());
+}
+
+TEST(DescriptorServiceTest, ComputesAllOrRequestedKeypoints) {
+    FrameCache cache(4, 1 << 24);
+    CachedFrame frame = detectFrame(makeScene());
+    ASSERT_GT(frame.keypoints.size(), 5u);
+    cache.insert("frame_1", frame);
+    DescriptorService service("tcp://127.0.0.1:5987", cache, nullptr, nullptr);
+
+    std::vector<cv::KeyPoint> keypoints = frame.keypoints;
+    cv::Mat expected;
+    frame.detector->compute(frame.image, keypoints, expected);
+
+    DescriptorRequest request;
+    request.image_id = "frame_1";
+    DescriptorReply all = service.handle(request);
+    EXPECT_TRUE(all.found);
+    EXPECT_TRUE(all.error.empty()) << all.error;
+    EXPECT_EQ(128u, all.descriptor_dim);
+    ASSERT_EQ(frame.keypoints.size(), all.descriptors.size());
+    ASSERT_EQ(frame.keypoints.size(), all.keypoint_indices.size());
+    EXPECT_EQ(3u, all.keypoint_indices[3]);
+    for (int j = 0; j < expected.cols; ++j) {
+        EXPECT_FLOAT_EQ(expected.at<float>(4, j), all.descriptors[4][j]);
+    }
+
+    // A subset comes back in request order
+    uint32_t last = static_cast<uint32_t>(frame.keypoints.size() - 1);
+    request.keypoint_indices = {last, 0};
+    std::vector<cv::KeyPoint> subset = {frame.keypoints[last], frame.keypoints[0]};
+    cv::Mat subset_expected;
+    frame.detector->compute(frame.image, subset, subset_expected);
+    DescriptorReply some = service.handle(request);
+    ASSERT_EQ(2u, some.descriptors.size());
+    EXPECT_EQ(request.keypoint_indices, some.keypoint_indices);
+    for (int j = 0; j < subset_expected.cols; ++j) {
+        EXPECT_FLOAT_EQ(subset_expected.at<float>(0, j), some.descriptors[0][j]);
+        EXPECT_FLOAT_EQ(subset_expected.at<float>(1, j), some.descriptors[1][j]);
+    }
+}
+
+TEST(DescriptorServiceTest, ReportsMissingFramesAndBadIndices) {
+    FrameCache cache(4, 1 << 24);
+    cache.insert("frame_1", detectFrame(makeScene()));
+    DescriptorService service("tcp://127.0.0.1:5988", cache, nullptr, nullptr);
+
+    DescriptorRequest request;
+    request.image_id = "evicted";
+    DescriptorReply missing = service.handle(request);
+    EXPECT_FALSE(missing.found);
+    EXPECT_NE(std::string::npos, missing.error.find("not cached"));
+
+    request.image_id = "frame_1";
+    request.keypoint_indices = {100000};
+    DescriptorReply bad = service.handle(request);
+    EXPECT_TRUE(bad.found);
+    EXPECT_NE(std::string::npos, bad.error.find("out of range"));
+    EXPECT_TRUE(bad.descriptors.empty());
+}
+
+TEST(DescriptorServiceTest, AnswersOverRequestReply) {
+    FrameCache cache(4, 1 << 24);
+    CachedFrame frame = detectFrame(makeScene());
+    cache.insert("frame_1", frame);
+    DescriptorService service("tcp://127.0.0.1:5989", cache, nullptr, nullptr);
+    Requester requester("tcp://127.0.0.1:5989", 5000);
+
+    DescriptorRequest request;
+    request.image_id = "frame_1";
+    request.keypoint_indices = {1};
+    std::vector<uint8_t> reply_data;
+    ASSERT_TRUE(requester.request(request.serialize(), reply_data));
+    DescriptorReply reply = DescriptorReply::deserialize(reply_data);
+    EXPECT_TRUE(reply.found);
+    ASSERT_EQ(1u, reply.descriptors.size());
+    EXPECT_EQ(128u, reply.descriptors[0].size());
+
+    ASSERT_TRUE(requester.request({1, 2, 3}, reply_data));
+    EXPECT_NE(std::string::npos, DescriptorReply::deserialize(reply_data).error.find("Malformed"));
+}
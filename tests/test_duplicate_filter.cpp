@@ -0,0 +1,120 @@
+#include "feature_extractor/duplicate_filter.h"
+#include "feature_extractor/image_decoder.h"
+#include <gtest/gtest.h>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+
+using namespace voyis;
+
+namespace {
+
+// Deterministic textured test image
+cv::Mat makeScene(int width, int height, int seed) {
+    cv::Mat image(height, width, CV_8UC1);
+    cv::RNG rng(seed);
+    rng.fill(image, cv::RNG::UNIFORM, 0, 256);
+    cv::GaussianBlur(image, image, cv::Size(0, 0), width / 40.0);
+    cv::normalize(image, image, 0, 255, cv::NORM_MINMAX);
+    return image;
+}
+
+FrameFeatures makeFeatures(const std::string& image_id, size_t num_keypoints) {
+    FrameFeatures features;
+    features.image_id = image_id;
+    features.width = 640;
+    features.height = 480;
+    features.keypoints.resize(num_keypoints);
+    features.descriptors.assign(num_keypoints, std::vector<float>(128, 0.5f));
+    return features;
+}
+
+} // anonymous namespace
+
+TEST(DHashTest, NearDuplicatesAreClose) {
+    cv::Mat scene = makeScene(640, 480, 1);
+
+    // Sensor noise and a small exposure change
+    cv::Mat noisy = scene.clone();
+    cv::Mat noise(scene.size(), CV_8UC1);
+    cv::randu(noise, 0, 4);
+    noisy += noise;
+    noisy.convertTo(noisy, CV_8UC1, 1.0, 3.0);
+
+    cv::Mat other = makeScene(640, 480, 2);
+
+    uint64_t scene_hash = computeDHash(scene);
+    EXPECT_LE(hammingDistance(scene_hash, computeDHash(noisy)), 4);
+    EXPECT_GT(hammingDistance(scene_hash, computeDHash(other)), 10);
+}
+
+TEST(DHashTest, RejectsInvalidInput) {
+    EXPECT_THROW(computeDHash(cv::Mat()), std::invalid_argument);
+    EXPECT_THROW(computeDHash(cv::Mat(8, 8, CV_32FC1)), std::invalid_argument);
+}
+
+TEST(DHashTest, HammingDistance) {
+    EXPECT_EQ(0, hammingDistance(0x1234u, 0x1234u));
+    EXPECT_EQ(64, hammingDistance(0u, ~0ull));
+    EXPECT_EQ(2, hammingDistance(0x3u, 0x0u));
+}
+
+TEST(DuplicateFilterTest, ReusesFeaturesPerStream) {
+    DuplicateFilter filter(4);
+
+    EXPECT_EQ(nullptr, filter.findDuplicate("cam0", 0xFF));
+    filter.remember("cam0", 0xFF, makeFeatures("frame_0", 3));
+
+    const FrameFeatures* reused = filter.findDuplicate("cam0", 0xFE);
+    ASSERT_NE(nullptr, reused);
+    EXPECT_EQ("frame_0", reused->image_id);
+    EXPECT_EQ(3u, reused->keypoints.size());
+
+    // Other streams and distant hashes are not duplicates
+    EXPECT_EQ(nullptr, filter.findDuplicate("cam1", 0xFF));
+    EXPECT_EQ(nullptr, filter.findDuplicate("cam0", 0xFF00));
+    EXPECT_EQ(1u, filter.skipped());
+}
+
+TEST(DuplicateFilterTest, SkipsFeaturesTheCallerCannotUse) {
+    DuplicateFilter filter(4);
+    filter.remember("cam0", 0xFF, makeFeatures("frame_0", 3));
+
+    auto evicted = [](const FrameFeatures&) { return false; };
+    EXPECT_EQ(nullptr, filter.findDuplicate("cam0", 0xFF, evicted));
+    EXPECT_EQ(0u, filter.skipped());
+
+    auto cached = [](const FrameFeatures& features) { return features.image_id == "frame_0"; };
+    EXPECT_NE(nullptr, filter.findDuplicate("cam0", 0xFF, cached));
+    EXPECT_EQ(1u, filter.skipped());
+}
+
+TEST(DecodedFrameTest, PreviewIsReduced) {
+    cv::Mat scene = makeScene(2048, 1536, 3);
+    std::vector<uint8_t> encoded;
+    ASSERT_TRUE(cv::imencode(".jpg", scene, encoded));
+
+    ImageMessage msg;
+    msg.image_id = "large";
+    msg.image_data.assign(encoded.begin(), encoded.end());
+    msg.format = "jpg";
+
+    DecodedFrame frame(msg);
+    const cv::Mat& preview = frame.preview();
+    EXPECT_LE(std::max(preview.cols, preview.rows), DecodedFrame::kPreviewSize);
+    EXPECT_FALSE(frame.hasFull());
+
+    const cv::Mat& full = frame.full();
+    EXPECT_EQ(2048, full.cols);
+    EXPECT_EQ(1536, full.rows);
+}
+
+TEST(DecodedFrameTest, InvalidData) {
+    ImageMessage msg;
+    msg.image_id = "garbage";
+    msg.image_data = {1, 2, 3};
+    msg.format = "png";
+
+    DecodedFrame frame(msg);
+    EXPECT_THROW(frame.full(), std::runtime_error);
+}
@@ -0,0 +1,149 @@
+#include "flight_recorder.h"
+#include "trace_writer.h"
+#include <gtest/gtest.h>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+using namespace voyis;
+
+namespace {
+
+FlightFrame makeFrame(const std::string& id, float total_ms) {
+    FlightFrame frame;
+    std::strncpy(frame.frame_id, id.c_str(), sizeof(frame.frame_id) - 1);
+    frame.total_ms = total_ms;
+    return frame;
+}
+
+bool waitForDumps(const FlightRecorder& recorder, uint64_t count) {
+    for (int i = 0; i < 400 && recorder.dumps() < count; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return recorder.dumps() >= count;
+}
+
+std::string readAndRemove(const std::string& path) {
+    std::ifstream file(path);
+    std::stringstream content;
+    content << file.rdbuf();
+    std::remove(path.c_str());
+    return content.str();
+}
+
+int64_t unixMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+} // anonymous namespace
+
+TEST(FlightRecorderTest, KeepsTheLastFrames) {
+    FlightRecorder recorder("test", 3, testing::TempDir());
+    EXPECT_TRUE(recorder.snapshot().empty());
+
+    for (int i = 0; i < 5; ++i) {
+        recorder.record(makeFrame("frame_" + std::to_string(i), 1.0f));
+    }
+    std::vector<FlightFrame> frames = recorder.snapshot();
+    ASSERT_EQ(3u, frames.size());
+    EXPECT_STREQ("frame_2", frames[0].frame_id);
+    EXPECT_STREQ("frame_4", frames[2].frame_id);
+    EXPECT_EQ(0u, recorder.dumps()); // No threshold set
+}
+
+TEST(FlightRecorderTest, TimerCollectsSpansAsStages) {
+    FlightRecorder recorder("test", 4, testing::TempDir());
+    {
+        FlightTimer timer(&recorder, "frame_1", unixMs() - 50);
+        EXPECT_NE(nullptr, FlightTimer::current());
+        {
+            TraceSpan decode("decode", "frame_1");
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        TraceSpan detect("detect", "frame_1");
+        detect.end();
+        timer.finish(7);
+        EXPECT_EQ(nullptr, FlightTimer::current());
+        TraceSpan after("publish", "frame_1"); // Not part of the frame any more
+    }
+
+    std::vector<FlightFrame> frames = recorder.snapshot();
+    ASSERT_EQ(1u, frames.size());
+    const FlightFrame& frame = frames[0];
+    EXPECT_STREQ("frame_1", frame.frame_id);
+    ASSERT_EQ(2u, frame.stage_count);
+    EXPECT_STREQ("decode", frame.stages[0].name);
+    EXPECT_STREQ("detect", frame.stages[1].name);
+    EXPECT_GE(frame.stages[0].ms, 2.0f);
+    EXPECT_GE(frame.total_ms, frame.stages[0].ms + frame.stages[1].ms);
+    EXPECT_GE(frame.age_ms, 50.0f);
+    EXPECT_EQ(7u, frame.queue_depth);
+}
+
+TEST(FlightRecorderTest, TimerWithoutRecorderDoesNothing) {
+    FlightTimer timer(nullptr, "frame");
+    EXPECT_EQ(nullptr, FlightTimer::current());
+    timer.finish();
+}
+
+TEST(FlightRecorderTest, ExtraStagesAreDropped) {
+    FlightFrame frame;
+    for (size_t i = 0; i < FlightFrame::kMaxStages + 3; ++i) {
+        frame.addStage("stage", 1000000);
+    }
+    EXPECT_EQ(FlightFrame::kMaxStages, frame.stage_count);
+    EXPECT_FLOAT_EQ(1.0f, frame.stages[0].ms);
+}
+
+TEST(FlightRecorderTest, SlowFrameTriggersOneDumpPerCooldown) {
+    FlightRecorder recorder("test", 8, testing::TempDir(), 10.0, std::chrono::hours(1));
+    recorder.record(makeFrame("fast", 5.0f));
+    recorder.record(makeFrame("spike", 25.0f));
+    ASSERT_TRUE(waitForDumps(recorder, 1));
+
+    recorder.record(makeFrame("second_spike", 30.0f));
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    EXPECT_EQ(1u, recorder.dumps());
+
+    std::string dump = readAndRemove(recorder.lastDumpPath());
+    EXPECT_NE(std::string::npos, dump.find("\"reason\":\"latency\""));
+    EXPECT_NE(std::string::npos, dump.find("\"threshold_ms\":10.000"));
+    EXPECT_LT(dump.find("\"frame\":\"fast\""), dump.find("\"frame\":\"spike\""));
+}
+
+TEST(FlightRecorderTest, SignalTriggersDump) {
+    FlightRecorder recorder("test", 8, testing::TempDir());
+    FlightRecorder::installSignalHandler();
+    recorder.record(makeFrame("frame_0", 1.0f));
+
+    std::raise(SIGUSR1);
+    ASSERT_TRUE(waitForDumps(recorder, 1));
+    std::string dump = readAndRemove(recorder.lastDumpPath());
+    EXPECT_NE(std::string::npos, dump.find("\"reason\":\"signal\""));
+    EXPECT_NE(std::string::npos, dump.find("\"frame\":\"frame_0\""));
+}
+
+TEST(FlightRecorderTest, DumpLayout) {
+    FlightRecorder recorder("extractor", 4, testing::TempDir());
+    FlightFrame frame = makeFrame("img\"1", 12.5f);
+    frame.addStage("detect", 10250000);
+    frame.queue_depth = 3;
+    recorder.record(frame);
+
+    std::string path = recorder.dumpNow("manual");
+    EXPECT_NE(std::string::npos, path.find("flight_extractor_"));
+    EXPECT_EQ(path, recorder.lastDumpPath());
+    std::string dump = readAndRemove(path);
+    EXPECT_EQ(0u, dump.find("{\"process\":\"extractor\""));
+    EXPECT_NE(std::string::npos, dump.find("{\"frame\":\"img\\\"1\",\"end_unix_ms\":0,"
+                                           "\"total_ms\":12.500,\"queue_depth\":3,"
+                                           "\"stages\":{\"detect\":10.250}"));
+}
+
+TEST(FlightRecorderTest, RejectsZeroCapacity) {
+    EXPECT_THROW(FlightRecorder("test", 0, "."), std::invalid_argument);
+}
@@ -0,0 +1,129 @@
+#include "frame_allocator.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+using namespace voyis;
+
+namespace {
+
+constexpr size_t kMB = 1024 * 1024;
+
+bool hugePageAligned(const void* ptr) {
+    return reinterpret_cast<uintptr_t>(ptr) % FramePool::kHugePageSize == 0;
+}
+
+} // anonymous namespace
+
+TEST(FramePoolTest, SizeClassesAreHugePageMultiples) {
+    EXPECT_EQ(2 * kMB, FramePool::sizeClass(1));
+    EXPECT_EQ(2 * kMB, FramePool::sizeClass(2 * kMB));
+    EXPECT_EQ(4 * kMB, FramePool::sizeClass(2 * kMB + 1));
+    EXPECT_EQ(16 * kMB, FramePool::sizeClass(15 * kMB));
+    EXPECT_EQ(20 * kMB, FramePool::sizeClass(17 * kMB));
+
+    // Four classes per doubling bound the waste to a quarter of the buffer
+    for (size_t bytes = kMB; bytes < 200 * kMB; bytes += 3 * kMB + 12345) {
+        size_t size = FramePool::sizeClass(bytes);
+        EXPECT_GE(size, bytes);
+        EXPECT_EQ(0u, size % FramePool::kHugePageSize);
+        EXPECT_LE(size - bytes, std::max(FramePool::kHugePageSize, size / 4)) << bytes;
+    }
+}
+
+TEST(FramePoolTest, BuffersAreAlignedAndRecycled) {
+    FramePool pool(HugePageMode::Off);
+    void* first = pool.allocate(5 * kMB);
+    EXPECT_TRUE(hugePageAligned(first));
+    pool.deallocate(first, 5 * kMB);
+
+    // Same size class, so the freed buffer comes back
+    void* second = pool.allocate(5 * kMB + kMB / 2);
+    EXPECT_EQ(first, second);
+    pool.deallocate(second, 5 * kMB + kMB / 2);
+
+    FramePool::Stats stats = pool.stats();
+    EXPECT_EQ(1u, stats.mapped);
+    EXPECT_EQ(1u, stats.reused);
+    EXPECT_EQ(6 * kMB, stats.cached_bytes);
+}
+
+TEST(FramePoolTest, CacheLimitReleasesExtraBuffers) {
+    FramePool pool(HugePageMode::Off, 4 * kMB);
+    void* a = pool.allocate(4 * kMB);
+    void* b = pool.allocate(4 * kMB);
+    pool.deallocate(a, 4 * kMB);
+    pool.deallocate(b, 4 * kMB); // Over the limit: unmapped
+    EXPECT_EQ(4 * kMB, pool.stats().cached_bytes);
+
+    pool.setMaxCachedBytes(0);
+    EXPECT_EQ(0u, pool.stats().cached_bytes);
+}
+
+TEST(FramePoolTest, PrefaultedBuffersDoNotFault) {
+    FramePool pool(HugePageMode::Transparent);
+    pool.prefault(8 * kMB, 1);
+
+    PageFaults before = PageFaults::now();
+    void* buffer = pool.allocate(8 * kMB);
+    std::memset(buffer, 1, 8 * kMB);
+    PageFaults faults = PageFaults::now() - before;
+    pool.deallocate(buffer, 8 * kMB);
+
+    // A fresh 8 MB buffer takes 2048 faults with 4 KB pages
+    EXPECT_LT(faults.minor, 64);
+    EXPECT_EQ(1u, pool.stats().reused);
+}
+
+TEST(FramePoolTest, ExplicitModeFallsBackWithoutReservedPages) {
+    FramePool pool(HugePageMode::Explicit);
+    void* buffer = pool.allocate(2 * kMB);
+    ASSERT_NE(nullptr, buffer);
+    std::memset(buffer, 0xAB, 2 * kMB);
+    pool.deallocate(buffer, 2 * kMB);
+    EXPECT_EQ(1u, pool.stats().mapped);
+}
+
+TEST(FramePoolTest, HugePageModeNames) {
+    for (HugePageMode mode : {HugePageMode::Off, HugePageMode::Transparent, HugePageMode::Explicit}) {
+        EXPECT_EQ(mode, parseHugePageMode(hugePageModeName(mode)));
+    }
+    EXPECT_THROW(parseHugePageMode("always"), std::invalid_argument);
+}
+
+TEST(FrameBufferTest, LargeBuffersComeFromSharedPool) {
+    FramePool::Stats before = FramePool::shared().stats();
+    {
+        FrameBuffer small(1000);
+        FramePool::Stats after = FramePool::shared().stats();
+        EXPECT_EQ(before.mapped + before.reused, after.mapped + after.reused);
+    }
+
+    FrameBuffer large(3 * kMB);
+    EXPECT_TRUE(hugePageAligned(large.data()));
+    FramePool::Stats after = FramePool::shared().stats();
+    EXPECT_EQ(before.mapped + before.reused + 1, after.mapped + after.reused);
+
+    // Copies draw from the pool too and compare like any vector
+    large[123] = 7;
+    FrameBuffer copy = large;
+    EXPECT_EQ(large, copy);
+    EXPECT_NE(large.data(), copy.data());
+}
+
+TEST(HeapStatsTest, SeesResidentMemoryAndHeapUse) {
+    HeapStats before = HeapStats::now();
+    EXPECT_GT(before.resident, 0);
+
+    // Large enough to be its own mmapped chunk in glibc
+    std::vector<char> block(16 * kMB, 1);
+    HeapStats after = HeapStats::now();
+    EXPECT_GE(after.resident, before.resident + static_cast<int64_t>(8 * kMB));
+    if (after.heap > 0) {
+        EXPECT_GE(after.heap_in_use, before.heap_in_use + static_cast<int64_t>(16 * kMB));
+        EXPECT_LE(after.heap_free, after.heap);
+        EXPECT_GE(after.fragmentation(), 0.0);
+        EXPECT_LE(after.fragmentation(), 1.0);
+    }
+}
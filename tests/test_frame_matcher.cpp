@@ -0,0 +1,141 @@
+#include "feature_matcher/frame_matcher.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+
+using namespace voyis;
+
+namespace {
+
+/**
+ * @brief Frames showing the same random features, shifted between frames
+ */
+class FrameMatcherTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<float> value(0.0f, 100.0f);
+        std::uniform_real_distribution<float> coord(0.0f, 600.0f);
+
+        base_descriptors_.assign(kFeatures, std::vector<float>(128));
+        base_points_.resize(kFeatures);
+        for (int i = 0; i < kFeatures; ++i) {
+            for (float& v : base_descriptors_[i]) {
+                v = value(rng);
+            }
+            base_points_[i] = Point2f(coord(rng), coord(rng));
+        }
+    }
+
+    // Frame with every feature moved by (dx, dy), in reversed keypoint order
+    ProcessedImageMessage makeFrame(const std::string& id, float dx, float dy,
+                                    const std::string& stream = "cam0") {
+        ProcessedImageMessage msg;
+        msg.image_id = id;
+        msg.stream_id = stream;
+        msg.descriptor_dim = 128;
+        for (int i = kFeatures - 1; i >= 0; --i) {
+            KeyPoint kp;
+            kp.pt = Point2f(base_points_[i].x + dx, base_points_[i].y + dy);
+            msg.keypoints.push_back(kp);
+            msg.descriptors.push_back(base_descriptors_[i]);
+        }
+        return msg;
+    }
+
+    static constexpr int kFeatures = 100;
+    std::vector<std::vector<float>> base_descriptors_;
+    std::vector<Point2f> base_points_;
+};
+
+} // anonymous namespace
+
+TEST_F(FrameMatcherTest, EstimatesTranslationHomography) {
+    for (MatchMethod method : {MatchMethod::BruteForce, MatchMethod::Flann}) {
+        FrameMatcherConfig config;
+        config.method = method;
+        FrameMatcher matcher(config);
+
+        EXPECT_TRUE(matcher.process(makeFrame("a", 0, 0)).frames.empty());
+        MatchSetMessage result = matcher.process(makeFrame("b", 12, -7));
+
+        ASSERT_EQ(1u, result.frames.size()) << matchMethodName(method);
+        const FrameMatch& match = result.frames[0];
+        EXPECT_EQ("a", match.reference_id);
+        ASSERT_TRUE(match.has_homography);
+        EXPECT_NEAR(-12.0, match.homography[2], 0.1);
+        EXPECT_NEAR(7.0, match.homography[5], 0.1);
+        EXPECT_GT(match.num_inliers, 90u);
+        EXPECT_EQ(match.num_inliers, match.matches.size());
+
+        // Both frames list the features in the same order
+        for (const FeatureMatch& m : match.matches) {
+            EXPECT_EQ(m.query_idx, m.train_idx);
+        }
+    }
+}
+
+TEST_F(FrameMatcherTest, RollingWindowPerStream) {
+    FrameMatcherConfig config;
+    config.window = 2;
+    FrameMatcher matcher(config);
+
+    matcher.process(makeFrame("a", 0, 0));
+    matcher.process(makeFrame("b", 1, 0));
+    matcher.process(makeFrame("other", 0, 0, "cam1"));
+    matcher.process(makeFrame("c", 2, 0));
+    MatchSetMessage result = matcher.process(makeFrame("d", 3, 0));
+
+    EXPECT_EQ(2u, matcher.windowSize("cam0"));
+    EXPECT_EQ(1u, matcher.windowSize("cam1"));
+    ASSERT_EQ(2u, result.frames.size());
+    EXPECT_EQ("c", result.frames[0].reference_id);
+    EXPECT_EQ("b", result.frames[1].reference_id);
+}
+
+TEST_F(FrameMatcherTest, SetConfigBetweenFrames) {
+    FrameMatcherConfig config;
+    config.window = 3;
+    FrameMatcher matcher(config);
+    for (int i = 0; i < 3; ++i) {
+        matcher.process(makeFrame(std::to_string(i), static_cast<float>(i), 0));
+    }
+    EXPECT_EQ(3u, matcher.windowSize("cam0"));
+
+    config.window = 1;
+    config.ratio = 0.6f;
+    matcher.setConfig(config);
+    EXPECT_EQ(1u, matcher.windowSize("cam0"));
+    EXPECT_FLOAT_EQ(0.6f, matcher.config().ratio);
+    EXPECT_EQ(1u, matcher.process(makeFrame("3", 3, 0)).frames.size());
+
+    config.method = MatchMethod::Flann;
+    EXPECT_THROW(matcher.setConfig(config), std::invalid_argument);
+    EXPECT_EQ(MatchMethod::BruteForce, matcher.config().method);
+}
+
+TEST_F(FrameMatcherTest, SkipsFramesWithoutCompatibleDescriptors) {
+    FrameMatcher matcher(FrameMatcherConfig{});
+    matcher.process(makeFrame("a", 0, 0));
+
+    // Rejected frames carry no descriptors and do not enter the window
+    ProcessedImageMessage rejected;
+    rejected.image_id = "blurry";
+    rejected.stream_id = "cam0";
+    EXPECT_TRUE(matcher.process(rejected).frames.empty());
+    EXPECT_EQ(1u, matcher.windowSize("cam0"));
+
+    // PCA-reduced descriptors are not compared with full ones
+    ProcessedImageMessage reduced = makeFrame("pca", 0, 0);
+    for (auto& desc : reduced.descriptors) {
+        desc.resize(32);
+    }
+    EXPECT_TRUE(matcher.process(reduced).frames.empty());
+}
+
+TEST(MatchMethodTest, Parse) {
+    EXPECT_EQ(MatchMethod::BruteForce, parseMatchMethod("bf"));
+    EXPECT_EQ(MatchMethod::Flann, parseMatchMethod("flann"));
+    EXPECT_STREQ("flann", matchMethodName(MatchMethod::Flann));
+    EXPECT_THROW(parseMatchMethod("lsh"), std::invalid_argument);
+}
@@ -0,0 +1,94 @@
+#include "data_logger/frame_preparer.h"
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace voyis;
+
+namespace {
+
+FrameBuffer rawFrame(const std::string& image_id, size_t keypoints, size_t descriptors) {
+    ProcessedImageMessage msg;
+    msg.image_id = image_id;
+    msg.format = "jpg";
+    msg.image_data.assign(1000, 3);
+    msg.descriptor_dim = 4;
+    msg.keypoints.resize(keypoints);
+    msg.descriptors.assign(descriptors, std::vector<float>(4, 1.0f));
+    std::vector<uint8_t> bytes = msg.serialize();
+    return FrameBuffer(bytes.begin(), bytes.end());
+}
+
+} // anonymous namespace
+
+TEST(FramePreparerTest, PreparesAndValidatesOneFrame) {
+    PreparedFrame frame = FramePreparer::prepare(rawFrame("frame_1", 5, 5));
+    ASSERT_NE(nullptr, frame.message);
+    EXPECT_TRUE(frame.error.empty());
+    EXPECT_EQ("frame_1", frame.message->image_id);
+    EXPECT_EQ(5u, frame.message->descriptors.size());
+
+    // Keypoints-only frames carry no descriptors
+    EXPECT_NE(nullptr, FramePreparer::prepare(rawFrame("frame_2", 5, 0)).message);
+
+    PreparedFrame mismatched = FramePreparer::prepare(rawFrame("frame_3", 5, 2));
+    EXPECT_EQ(nullptr, mismatched.message);
+    EXPECT_NE(std::string::npos, mismatched.error.find("2 descriptors for 5 keypoints"));
+
+    FrameBuffer truncated = rawFrame("frame_4", 5, 5);
+    truncated.resize(truncated.size() / 2);
+    EXPECT_FALSE(FramePreparer::prepare(truncated).error.empty());
+}
+
+TEST(FramePreparerTest, ReturnsFramesInSubmissionOrder) {
+    FramePreparer preparer(4, 8);
+    EXPECT_EQ(4u, preparer.threads());
+
+    const int kFrames = 200;
+    std::thread producer([&preparer] {
+        for (int i = 0; i < kFrames; ++i) {
+            // Uneven sizes so that later frames often finish first
+            preparer.submit(i == 50 ? FrameBuffer{1, 2, 3}
+                                    : rawFrame("frame_" + std::to_string(i), (i % 7) * 40,
+                                               (i % 7) * 40));
+        }
+    });
+
+    PreparedFrame frame;
+    for (int i = 0; i < kFrames; ++i) {
+        ASSERT_TRUE(preparer.next(frame, std::chrono::milliseconds(5000))) << i;
+        EXPECT_LE(preparer.pending(), 8u);
+        if (i == 50) {
+            EXPECT_EQ(nullptr, frame.message);
+            EXPECT_FALSE(frame.error.empty());
+        } else {
+            ASSERT_NE(nullptr, frame.message) << frame.error;
+            EXPECT_EQ("frame_" + std::to_string(i), frame.message->image_id);
+        }
+    }
+    producer.join();
+    EXPECT_EQ(0u, preparer.pending());
+    EXPECT_FALSE(preparer.next(frame, std::chrono::milliseconds(10)));
+}
+
+TEST(FramePreparerTest, LogsFramesOffTheWriterThread) {
+    std::ostringstream log;
+    {
+        FramePreparer preparer(2, 8, 0, &log);
+        preparer.submit(rawFrame("frame_1", 3, 3));
+        preparer.submit(FrameBuffer{1, 2, 3});
+        PreparedFrame frame;
+        ASSERT_TRUE(preparer.next(frame, std::chrono::milliseconds(5000)));
+        ASSERT_TRUE(preparer.next(frame, std::chrono::milliseconds(5000)));
+    }
+    EXPECT_NE(std::string::npos, log.str().find("Received processed image: frame_1"));
+    EXPECT_NE(std::string::npos, log.str().find("  Keypoints: 3"));
+    EXPECT_NE(std::string::npos, log.str().find("Error processing message"));
+}
+
+TEST(FramePreparerTest, RejectsEmptyPool) {
+    EXPECT_THROW(FramePreparer(0, 8), std::invalid_argument);
+    EXPECT_THROW(FramePreparer(2, 0), std::invalid_argument);
+}
@@ -0,0 +1,231 @@
+#include "feature_extractor/frame_queue.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+
+using namespace voyis;
+
+class FrameQueueTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        now_ = std::make_shared<std::atomic<int64_t>>(10000);
+    }
+
+    FrameQueueConfig makeConfig(SchedulePolicy policy, int64_t slo_ms) {
+        FrameQueueConfig config;
+        config.policy = policy;
+        config.latency_slo_ms = slo_ms;
+        auto now = now_;
+        config.clock = [now]() { return now->load(); };
+        return config;
+    }
+
+    ImageMessage makeFrame(const std::string& id, const std::string& stream, int64_t timestamp) {
+        ImageMessage msg;
+        msg.image_id = id;
+        msg.stream_id = stream;
+        msg.timestamp = timestamp;
+        return msg;
+    }
+
+    ImageMessage makeSizedFrame(const std::string& id, const std::string& stream,
+                                int width, int height) {
+        ImageMessage msg = makeFrame(id, stream, now_->load());
+        msg.width = width;
+        msg.height = height;
+        return msg;
+    }
+
+    std::shared_ptr<std::atomic<int64_t>> now_;
+};
+
+TEST_F(FrameQueueTest, FifoOrder) {
+    FrameQueue queue(makeConfig(SchedulePolicy::Fifo, 0));
+    queue.push(makeFrame("a", "cam0", 1));
+    queue.push(makeFrame("b", "cam0", 2));
+
+    EXPECT_EQ("a", queue.pop(0)->image_id);
+    EXPECT_EQ("b", queue.pop(0)->image_id);
+    EXPECT_FALSE(queue.pop(0).has_value());
+}
+
+TEST_F(FrameQueueTest, LatestFirstOrder) {
+    FrameQueue queue(makeConfig(SchedulePolicy::LatestFirst, 0));
+    queue.push(makeFrame("a", "cam0", 1));
+    queue.push(makeFrame("b", "cam0", 2));
+    queue.push(makeFrame("c", "cam0", 3));
+
+    EXPECT_EQ("c", queue.pop(0)->image_id);
+    EXPECT_EQ("b", queue.pop(0)->image_id);
+}
+
+TEST_F(FrameQueueTest, DropsFramesPastDeadline) {
+    FrameQueue queue(makeConfig(SchedulePolicy::Fifo, 500));
+    queue.push(makeFrame("stale", "cam0", 9000)); // Deadline 9500, already passed
+    queue.push(makeFrame("fresh", "cam0", 9800)); // Deadline 10300
+
+    auto frame = queue.pop(0);
+    ASSERT_TRUE(frame.has_value());
+    EXPECT_EQ("fresh", frame->image_id);
+
+    auto stats = queue.stats();
+    EXPECT_EQ(2u, stats["cam0"].enqueued);
+    EXPECT_EQ(1u, stats["cam0"].expired);
+    EXPECT_EQ(1u, stats["cam0"].dequeued);
+}
+
+TEST_F(FrameQueueTest, FramesExpireWhileQueued) {
+    FrameQueue queue(makeConfig(SchedulePolicy::LatestFirst, 500));
+    queue.push(makeFrame("old", "cam0", 9800));
+    queue.push(makeFrame("new", "cam0", 9900));
+
+    EXPECT_EQ("new", queue.pop(0)->image_id);
+
+    // The older frame misses its deadline while the newer one is processed
+    now_->store(10400);
+    EXPECT_FALSE(queue.pop(0).has_value());
+    EXPECT_EQ(1u, queue.stats()["cam0"].expired);
+}
+
+TEST_F(FrameQueueTest, PerStreamSlo) {
+    FrameQueueConfig config = makeConfig(SchedulePolicy::Fifo, 100);
+    config.stream_slo_ms["survey"] = 5000;
+    FrameQueue queue(config);
+
+    EXPECT_EQ(100, queue.sloFor("cam0"));
+    EXPECT_EQ(5000, queue.sloFor("survey"));
+
+    queue.push(makeFrame("live", "cam0", 9000));
+    queue.push(makeFrame("mosaic", "survey", 9000));
+
+    EXPECT_EQ("mosaic", queue.pop(0)->image_id);
+    EXPECT_EQ(1u, queue.stats()["cam0"].expired);
+}
+
+TEST_F(FrameQueueTest, NoDeadlineWithoutTimestamp) {
+    FrameQueue queue(makeConfig(SchedulePolicy::Fifo, 100));
+    queue.push(makeFrame("untimed", "cam0", 0));
+
+    EXPECT_TRUE(queue.pop(0).has_value());
+}
+
+TEST_F(FrameQueueTest, OverflowDropsOldest) {
+    FrameQueueConfig config = makeConfig(SchedulePolicy::Fifo, 0);
+    config.capacity = 2;
+    FrameQueue queue(config);
+
+    queue.push(makeFrame("a", "cam0", 1));
+    queue.push(makeFrame("b", "cam0", 2));
+    queue.push(makeFrame("c", "cam0", 3));
+
+    EXPECT_EQ(2u, queue.size());
+    EXPECT_EQ("b", queue.pop(0)->image_id);
+    EXPECT_EQ(1u, queue.stats()["cam0"].overflowed);
+}
+
+TEST_F(FrameQueueTest, CloseWakesConsumer) {
+    FrameQueue queue(makeConfig(SchedulePolicy::Fifo, 0));
+
+    std::thread closer([&queue]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        queue.close();
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(queue.pop(5000).has_value());
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    closer.join();
+
+    EXPECT_LT(elapsed, std::chrono::seconds(2));
+    EXPECT_FALSE(queue.push(makeFrame("late", "cam0", 1)));
+}
+
+TEST_F(FrameQueueTest, ShortestJobFirst) {
+    FrameQueue queue(makeConfig(SchedulePolicy::ShortestJobFirst, 0));
+    queue.push(makeSizedFrame("survey", "cam0", 6000, 5000));
+    queue.push(makeSizedFrame("thumb", "cam1", 320, 240));
+    queue.push(makeSizedFrame("medium", "cam1", 2000, 1500));
+
+    EXPECT_EQ("thumb", queue.pop(0)->image_id);
+    EXPECT_EQ("medium", queue.pop(0)->image_id);
+    EXPECT_EQ("survey", queue.pop(0)->image_id);
+}
+
+TEST_F(FrameQueueTest, StarvationProtection) {
+    FrameQueueConfig config = makeConfig(SchedulePolicy::ShortestJobFirst, 0);
+    config.max_wait_ms = 1000;
+    FrameQueue queue(config);
+
+    queue.push(makeSizedFrame("survey", "cam0", 6000, 5000));
+    now_->store(now_->load() + 1500);
+    queue.push(makeSizedFrame("thumb", "cam1", 320, 240));
+
+    // The large frame has waited past max_wait_ms and goes first
+    EXPECT_EQ("survey", queue.pop(0)->image_id);
+
+    auto delays = queue.delayStats();
+    const QueueDelayStats& large = delays[static_cast<size_t>(FrameSizeClass::Large)];
+    EXPECT_EQ(1u, large.count);
+    EXPECT_EQ(1500, large.max_ms);
+    EXPECT_DOUBLE_EQ(1500.0, large.meanMs());
+}
+
+TEST_F(FrameQueueTest, WeightedFairQueuing) {
+    FrameQueueConfig config = makeConfig(SchedulePolicy::WeightedFair, 0);
+    config.stream_weight["cam1"] = 2.0;
+    FrameQueue queue(config);
+
+    // Equal cost frames: cam1 has twice the weight, so it gets two frames
+    // for every frame of cam0
+    for (int i = 0; i < 4; ++i) {
+        queue.push(makeSizedFrame("a" + std::to_string(i), "cam0", 1000, 1000));
+        queue.push(makeSizedFrame("b" + std::to_string(i), "cam1", 1000, 1000));
+    }
+
+    std::string order;
+    for (int i = 0; i < 6; ++i) {
+        order += queue.pop(0)->image_id.substr(0, 1);
+    }
+    EXPECT_EQ("babbab", order);
+}
+
+TEST_F(FrameQueueTest, WeightedFairQueuingKeepsStreamOrder) {
+    FrameQueue queue(makeConfig(SchedulePolicy::WeightedFair, 0));
+    queue.push(makeSizedFrame("large", "cam0", 6000, 5000));
+    queue.push(makeSizedFrame("small", "cam0", 320, 240));
+    queue.push(makeSizedFrame("other", "cam1", 320, 240));
+
+    // Frames of one stream stay in order, other streams may overtake
+    EXPECT_EQ("other", queue.pop(0)->image_id);
+    EXPECT_EQ("large", queue.pop(0)->image_id);
+    EXPECT_EQ("small", queue.pop(0)->image_id);
+}
+
+TEST(FrameCostTest, EstimateAndClassify) {
+    ImageMessage sized;
+    sized.width = 4000;
+    sized.height = 3000;
+    EXPECT_DOUBLE_EQ(12.0, estimateFrameCost(sized));
+    EXPECT_EQ(FrameSizeClass::Medium, classifyFrameCost(estimateFrameCost(sized)));
+
+    ImageMessage thumbnail;
+    thumbnail.format = "jpg";
+    thumbnail.image_data.resize(50 * 1024);
+    EXPECT_EQ(FrameSizeClass::Small, classifyFrameCost(estimateFrameCost(thumbnail)));
+
+    ImageMessage survey;
+    survey.format = "tiff";
+    survey.image_data.resize(60 * 1024 * 1024);
+    EXPECT_EQ(FrameSizeClass::Large, classifyFrameCost(estimateFrameCost(survey)));
+}
+
+TEST(SchedulePolicyTest, Parse) {
+    EXPECT_EQ(SchedulePolicy::Fifo, parseSchedulePolicy("fifo"));
+    EXPECT_EQ(SchedulePolicy::LatestFirst, parseSchedulePolicy("latest"));
+    EXPECT_EQ(SchedulePolicy::ShortestJobFirst, parseSchedulePolicy("sjf"));
+    EXPECT_EQ(SchedulePolicy::WeightedFair, parseSchedulePolicy("wfq"));
+    EXPECT_STREQ("latest", schedulePolicyName(SchedulePolicy::LatestFirst));
+    EXPECT_THROW(parseSchedulePolicy("random"), std::invalid_argument);
+}
@@ -0,0 +1,185 @@
+#include "image_archive.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace voyis;
+
+namespace {
+
+using Bytes = std::vector<uint8_t>;
+
+Bytes bytesOf(const std::string& text) {
+    return Bytes(text.begin(), text.end());
+}
+
+void putOctal(Bytes& header, size_t offset, size_t width, uint64_t value) {
+    std::snprintf(reinterpret_cast<char*>(&header[offset]), width, "%0*llo",
+                  static_cast<int>(width - 1), static_cast<unsigned long long>(value));
+}
+
+// One ustar header plus the contents padded to whole blocks
+void addTarEntry(Bytes& tar, const std::string& name, const Bytes& contents, char type = '0') {
+    Bytes header(512, 0);
+    std::memcpy(&header[0], name.data(), std::min<size_t>(name.size(), 100));
+    putOctal(header, 100, 8, 0644);
+    putOctal(header, 124, 12, contents.size());
+    header[156] = static_cast<uint8_t>(type);
+    std::memcpy(&header[257], "ustar", 6);
+    std::memcpy(&header[263], "00", 2);
+    std::memset(&header[148], ' ', 8);
+    unsigned sum = 0;
+    for (uint8_t byte : header) {
+        sum += byte;
+    }
+    putOctal(header, 148, 7, sum);
+
+    tar.insert(tar.end(), header.begin(), header.end());
+    tar.insert(tar.end(), contents.begin(), contents.end());
+    tar.resize((tar.size() + 511) / 512 * 512, 0);
+}
+
+void putLe(Bytes& out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+struct ZipEntry {
+    std::string name;
+    Bytes contents;
+    uint16_t method = 0;
+};
+
+// Local headers, central directory and end record, as zip -0 writes them
+Bytes makeZip(const std::vector<ZipEntry>& entries) {
+    Bytes zip;
+    std::vector<uint64_t> offsets;
+    for (const ZipEntry& entry : entries) {
+        offsets.push_back(zip.size());
+        putLe(zip, 0x04034b50, 4);
+        putLe(zip, 10, 2);
+        putLe(zip, 0, 2);
+        putLe(zip, entry.method, 2);
+        putLe(zip, 0, 4);                    // Time, date
+        putLe(zip, 0, 4);                    // CRC (not checked)
+        putLe(zip, entry.contents.size(), 4);
+        putLe(zip, entry.contents.size(), 4);
+        putLe(zip, entry.name.size(), 2);
+        putLe(zip, 4, 2);                    // Extra field
+        zip.insert(zip.end(), entry.name.begin(), entry.name.end());
+        putLe(zip, 0xcafe, 2);
+        putLe(zip, 0, 2);
+        zip.insert(zip.end(), entry.contents.begin(), entry.contents.end());
+    }
+
+    uint64_t directory = zip.size();
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const ZipEntry& entry = entries[i];
+        putLe(zip, 0x02014b50, 4);
+        putLe(zip, 20, 2);
+        putLe(zip, 10, 2);
+        putLe(zip, 0, 2);
+        putLe(zip, entry.method, 2);
+        putLe(zip, 0, 4);
+        putLe(zip, 0, 4);
+        putLe(zip, entry.contents.size(), 4);
+        putLe(zip, entry.contents.size(), 4);
+        putLe(zip, entry.name.size(), 2);
+        putLe(zip, 0, 2);
+        putLe(zip, 0, 2);
+        putLe(zip, 0, 8);                    // Disk, attributes
+        putLe(zip, offsets[i], 4);
+        zip.insert(zip.end(), entry.name.begin(), entry.name.end());
+    }
+
+    uint64_t directory_size = zip.size() - directory;
+    putLe(zip, 0x06054b50, 4);
+    putLe(zip, 0, 4);
+    putLe(zip, entries.size(), 2);
+    putLe(zip, entries.size(), 2);
+    putLe(zip, directory_size, 4);
+    putLe(zip, directory, 4);
+    putLe(zip, 0, 2);
+    return zip;
+}
+
+std::string writeTemp(const std::string& name, const Bytes& data) {
+    std::string path = testing::TempDir() + name;
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    return path;
+}
+
+std::string contentsOf(const ImageArchive& archive, const ArchiveMember& member) {
+    return std::string(reinterpret_cast<const char*>(archive.data(member)), member.size);
+}
+
+} // anonymous namespace
+
+TEST(ImageArchiveTest, IndexesTarMembersInOrder) {
+    Bytes tar;
+    addTarEntry(tar, "survey/", {}, '5');
+    addTarEntry(tar, "survey/b.jpg", bytesOf("second image"));
+    addTarEntry(tar, "survey/a.jpg", Bytes(1000, 0x5a));
+    addTarEntry(tar, "././@LongLink", bytesOf(std::string(120, 'd') + "/long.png"), 'L');
+    addTarEntry(tar, "truncated-name", bytesOf("png bytes"));
+    tar.resize(tar.size() + 1024, 0);
+    std::string path = writeTemp("voyis_archive_test.tar", tar);
+
+    ImageArchive archive(path);
+    ASSERT_EQ(3u, archive.members().size());
+    EXPECT_EQ("survey/b.jpg", archive.members()[0].name);
+    EXPECT_EQ("second image", contentsOf(archive, archive.members()[0]));
+    EXPECT_EQ(1000u, archive.members()[1].size);
+    EXPECT_EQ(0, archive.members()[1].offset % 512);
+    EXPECT_EQ(std::string(120, 'd') + "/long.png", archive.members()[2].name);
+    EXPECT_EQ("png bytes", contentsOf(archive, archive.members()[2]));
+    std::remove(path.c_str());
+}
+
+TEST(ImageArchiveTest, IndexesStoredZipMembers) {
+    Bytes zip = makeZip({{"frames/", {}}, {"frames/0001.jpg", bytesOf("jpeg one")},
+                         {"frames/0002.raw", Bytes(4096, 7)}});
+    std::string path = writeTemp("voyis_archive_test.zip", zip);
+
+    ImageArchive archive(path);
+    ASSERT_EQ(2u, archive.members().size());
+    EXPECT_EQ("frames/0001.jpg", archive.members()[0].name);
+    EXPECT_EQ("jpeg one", contentsOf(archive, archive.members()[0]));
+    EXPECT_EQ(4096u, archive.members()[1].size);
+    EXPECT_EQ(7, archive.data(archive.members()[1])[4095]);
+    std::remove(path.c_str());
+}
+
+TEST(ImageArchiveTest, RejectsCompressedAndForeignFiles) {
+    std::string deflated = writeTemp("voyis_archive_deflated.zip",
+                                     makeZip({{"a.jpg", bytesOf("deflated"), 8}}));
+    EXPECT_THROW(ImageArchive archive(deflated), std::runtime_error);
+    std::remove(deflated.c_str());
+
+    std::string text = writeTemp("voyis_archive_text.tar", Bytes(2048, 'x'));
+    EXPECT_THROW(ImageArchive archive(text), std::runtime_error);
+    std::remove(text.c_str());
+
+    Bytes truncated;
+    addTarEntry(truncated, "big.jpg", Bytes(4096, 1));
+    truncated.resize(1024);
+    std::string cut = writeTemp("voyis_archive_truncated.tar", truncated);
+    EXPECT_THROW(ImageArchive archive(cut), std::runtime_error);
+    std::remove(cut.c_str());
+
+    EXPECT_THROW(ImageArchive archive(testing::TempDir() + "voyis_missing.tar"), std::runtime_error);
+}
+
+TEST(ImageArchiveTest, RecognizesArchiveNames) {
+    EXPECT_TRUE(isImageArchive("/data/survey_2025.tar"));
+    EXPECT_TRUE(isImageArchive("dives.ZIP"));
+    EXPECT_FALSE(isImageArchive("/data/images"));
+    EXPECT_FALSE(isImageArchive("frames.tar.gz"));
+}
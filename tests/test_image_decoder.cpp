@@ -0,0 +1,154 @@
+#include "feature_extractor/image_decoder.h"
+#include <gtest/gtest.h>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cstring>
+
+using namespace voyis;
+
+namespace {
+
+ImageMessage makeRawMessage(const std::string& format, int width, int height,
+                            int stride, int bit_depth) {
+    ImageMessage msg;
+    msg.image_id = "raw";
+    msg.format = format;
+    msg.width = width;
+    msg.height = height;
+    msg.stride = stride;
+    msg.bit_depth = bit_depth;
+    msg.image_data.assign(static_cast<size_t>(stride) * height, 0);
+    return msg;
+}
+
+} // anonymous namespace
+
+TEST(DecodedFrameTest, Mono8IsWrappedWithoutCopy) {
+    // 4x2 pixels with 2 bytes of row padding
+    ImageMessage msg = makeRawMessage("mono8", 4, 2, 6, 8);
+    msg.image_data[1 * 6 + 3] = 200;
+
+    DecodedFrame frame(msg);
+    const cv::Mat& image = frame.full();
+
+    EXPECT_EQ(CV_8UC1, image.type());
+    EXPECT_EQ(4, image.cols);
+    EXPECT_EQ(2, image.rows);
+    EXPECT_EQ(msg.image_data.data(), image.data);
+    EXPECT_EQ(200, image.at<uint8_t>(1, 3));
+}
+
+TEST(DecodedFrameTest, Mono16IsScaledByBitDepth) {
+    ImageMessage msg = makeRawMessage("mono16", 2, 1, 4, 12);
+    uint16_t samples[2] = {4095, 1024};
+    std::memcpy(msg.image_data.data(), samples, sizeof(samples));
+
+    DecodedFrame frame(msg);
+    const cv::Mat& image = frame.full();
+
+    EXPECT_EQ(CV_8UC1, image.type());
+    EXPECT_EQ(255, image.at<uint8_t>(0, 0));
+    EXPECT_EQ(64, image.at<uint8_t>(0, 1));
+}
+
+TEST(DecodedFrameTest, BayerIsConvertedToGray) {
+    ImageMessage msg = makeRawMessage("bayer_rggb8", 8, 8, 8, 8);
+    std::fill(msg.image_data.begin(), msg.image_data.end(), 128);
+
+    DecodedFrame frame(msg);
+    const cv::Mat& image = frame.full();
+
+    EXPECT_EQ(CV_8UC1, image.type());
+    EXPECT_EQ(8, image.cols);
+    EXPECT_NEAR(128, image.at<uint8_t>(4, 4), 1);
+}
+
+TEST(DecodedFrameTest, RejectsInvalidRawGeometry) {
+    ImageMessage too_small = makeRawMessage("mono8", 4, 4, 4, 8);
+    too_small.image_data.resize(10);
+    DecodedFrame frame(too_small);
+    EXPECT_THROW(frame.full(), std::runtime_error);
+
+    ImageMessage no_size = makeRawMessage("mono16", 0, 0, 0, 16);
+    DecodedFrame unsized(no_size);
+    EXPECT_THROW(unsized.full(), std::runtime_error);
+}
+
+TEST(DecodeGrayscaleTest, MatchesOpenCV) {
+    cv::Mat scene(240, 320, CV_8UC1);
+    cv::randu(scene, 0, 256);
+
+    for (const char* ext : {".png", ".jpg"}) {
+        std::vector<uint8_t> encoded;
+        ASSERT_TRUE(cv::imencode(ext, scene, encoded));
+
+        DecodeBackend backend = DecodeBackend::OpenCV;
+        cv::Mat decoded = decodeGrayscale(encoded.data(), encoded.size(), 1, &backend);
+        cv::Mat reference = cv::imdecode(encoded, cv::IMREAD_GRAYSCALE);
+        ASSERT_EQ(reference.size(), decoded.size()) << ext << " via " << decodeBackendName(backend);
+        ASSERT_EQ(CV_8UC1, decoded.type());
+
+        // Lossless PNG must match exactly; JPEG decoders may differ by rounding
+        double max_diff = cv::norm(reference, decoded, cv::NORM_INF);
+        EXPECT_LE(max_diff, std::string(ext) == ".png" ? 0.0 : 2.0) << ext;
+    }
+}
+
+TEST(DecodeGrayscaleTest, ReducedDecode) {
+    cv::Mat scene(480, 640, CV_8UC1);
+    cv::randu(scene, 0, 256);
+    std::vector<uint8_t> encoded;
+    ASSERT_TRUE(cv::imencode(".jpg", scene, encoded));
+
+    cv::Mat reduced = decodeGrayscale(encoded.data(), encoded.size(), 4);
+    EXPECT_EQ(160, reduced.cols);
+    EXPECT_EQ(120, reduced.rows);
+}
+
+TEST(DecodeGrayscaleTest, SniffsSignatures) {
+    const uint8_t jpeg[] = {0xFF, 0xD8, 0xFF, 0xE0};
+    const uint8_t png[] = {0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A};
+    EXPECT_TRUE(isJpegData(jpeg, sizeof(jpeg)));
+    EXPECT_FALSE(isPngData(jpeg, sizeof(jpeg)));
+    EXPECT_TRUE(isPngData(png, sizeof(png)));
+    EXPECT_FALSE(isJpegData(png, sizeof(png)));
+
+    const uint8_t garbage[] = {1, 2, 3};
+    EXPECT_TRUE(decodeGrayscale(garbage, sizeof(garbage)).empty());
+}
+
+TEST(DecodeBufferPoolTest, ReusesReleasedBuffers) {
+    DecodeBufferPool pool(1);
+
+    cv::Mat first = pool.acquire(100, 200);
+    ASSERT_TRUE(first.isContinuous());
+    EXPECT_EQ(100, first.rows);
+    EXPECT_EQ(200, first.cols);
+    const uint8_t* first_data = first.data;
+
+    // The only pooled buffer is in use, so this is a plain allocation
+    cv::Mat second = pool.acquire(10, 10);
+    EXPECT_NE(first_data, second.data);
+
+    // Once released, a smaller request reuses the same memory
+    first.release();
+    cv::Mat third = pool.acquire(50, 50);
+    EXPECT_EQ(first_data, third.data);
+    EXPECT_EQ(50, third.rows);
+    EXPECT_EQ(50, third.cols);
+}
+
+TEST(DecodeBufferPoolTest, GrowsToMaxBuffers) {
+    DecodeBufferPool pool(1);
+    cv::Mat held = pool.acquire(10, 10);
+
+    pool.setMaxBuffers(2);
+    EXPECT_EQ(2u, pool.maxBuffers());
+    cv::Mat pooled = pool.acquire(10, 10);
+    const uint8_t* pooled_data = pooled.data;
+
+    // The second buffer is pooled too: released, it serves a smaller request
+    pooled.release();
+    EXPECT_EQ(pooled_data, pool.acquire(5, 5).data);
+}
@@ -1,5 +1,8 @@
 #include "ipc.h"
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
 #include <thread>
 #include <chrono>
 #include <vector>
@@ -128,6 +131,59 @@ TEST_F(IPCTest, LargeMessage) {
     EXPECT_EQ(large_data.back(), received_data.back());
 }
 
+// Pooled frame buffers are sent without copying and received into the pool
+TEST_F(IPCTest, FrameBufferZeroCopy) {
+    Publisher pub("tcp://*:5984");
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    Subscriber sub("tcp://localhost:5984", 2000);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    FrameBuffer frame(4 * 1024 * 1024);
+    for (size_t i = 0; i < frame.size(); ++i) {
+        frame[i] = static_cast<uint8_t>(i % 251);
+    }
+    FrameBuffer expected = frame;
+
+    ASSERT_TRUE(pub.publish(std::move(frame)));
+
+    FrameBuffer received;
+    ASSERT_TRUE(sub.receive(received));
+    EXPECT_EQ(expected, received);
+}
+
+// Parts sent from caller-owned memory arrive as one joined message
+TEST_F(IPCTest, MultipartPublishIsJoined) {
+    Publisher pub("tcp://*:5986");
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    Subscriber sub("tcp://localhost:5986", 2000);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    auto payload = std::make_shared<std::vector<uint8_t>>(1024 * 1024);
+    for (size_t i = 0; i < payload->size(); ++i) {
+        (*payload)[i] = static_cast<uint8_t>(i % 253);
+    }
+    FrameBuffer head = {1, 2, 3};
+    FrameBuffer tail = {9};
+    std::vector<uint8_t> expected(head.begin(), head.end());
+    expected.insert(expected.end(), payload->begin(), payload->end());
+    expected.insert(expected.end(), tail.begin(), tail.end());
+
+    std::weak_ptr<std::vector<uint8_t>> watcher = payload;
+    ASSERT_TRUE(pub.publish(std::move(head), payload->data(), payload->size(), payload,
+                            std::move(tail)));
+    payload.reset(); // ZeroMQ keeps the memory alive until it has been sent
+
+    FrameBuffer received;
+    ASSERT_TRUE(sub.receive(received));
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), received.begin(), received.end()));
+    for (int i = 0; i < 100 && !watcher.expired(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_TRUE(watcher.expired());
+}
+
 // Test subscriber timeout
 TEST_F(IPCTest, SubscriberTimeout) {
     Subscriber sub("tcp://localhost:5995", 100); // 100ms timeout
@@ -223,3 +279,55 @@ TEST_F(IPCTest, LateSubscriber) {
 
     EXPECT_GT(count, 0);
 }
+
+// Test request/reply round trip and recovery from an unanswered request
+TEST_F(IPCTest, RequestReply) {
+    Replier rep("tcp://*:5985", 1000);
+    Requester req("tcp://localhost:5985", 200);
+
+    std::thread server([&rep]() {
+        std::vector<uint8_t> request;
+        ASSERT_TRUE(rep.receive(request));
+        EXPECT_EQ((std::vector<uint8_t>{1, 2}), request);
+        std::this_thread::sleep_for(std::chrono::milliseconds(400)); // Too late
+        rep.reply(request);
+
+        ASSERT_TRUE(rep.receive(request));
+        request.push_back(9);
+        rep.reply(request);
+    });
+
+    std::vector<uint8_t> reply;
+    EXPECT_FALSE(req.request({1, 2}, reply));
+
+    // The late reply to the first request is ignored
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    ASSERT_TRUE(req.request({3}, reply));
+    EXPECT_EQ((std::vector<uint8_t>{3, 9}), reply);
+    server.join();
+}
+
+// Test the threaded reply server answering through its handler
+TEST_F(IPCTest, ReplyServerAnswersWithHandler) {
+    std::atomic<int> handled(0);
+    {
+        ReplyServer server("tcp://*:6010", [&handled](const std::vector<uint8_t>& request) {
+            ++handled;
+            std::vector<uint8_t> reply(request.rbegin(), request.rend());
+            return reply;
+        });
+        EXPECT_EQ("tcp://*:6010", server.endpoint());
+        Requester req("tcp://localhost:6010", 2000);
+
+        std::vector<uint8_t> reply;
+        ASSERT_TRUE(req.request({1, 2, 3}, reply));
+        EXPECT_EQ((std::vector<uint8_t>{3, 2, 1}), reply);
+        ASSERT_TRUE(req.request({}, reply));
+        EXPECT_TRUE(reply.empty());
+    }
+    // The destructor stopped the thread; nothing answers anymore
+    EXPECT_EQ(2, handled.load());
+    Requester late("tcp://localhost:6010", 300);
+    std::vector<uint8_t> reply;
+    EXPECT_FALSE(late.request({1}, reply));
+}
@@ -0,0 +1,134 @@
+#include "lockfree_queue.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace voyis;
+
+TEST(SpscRingTest, RoundsCapacityAndReportsFull) {
+    SpscRing<int> ring(5);
+    EXPECT_EQ(8u, ring.capacity());
+
+    for (int i = 0; i < 8; ++i) {
+        EXPECT_TRUE(ring.tryPush(i));
+    }
+    EXPECT_FALSE(ring.tryPush(8));
+    EXPECT_EQ(8u, ring.sizeApprox());
+
+    int value = -1;
+    for (int i = 0; i < 8; ++i) {
+        ASSERT_TRUE(ring.tryPop(value));
+        EXPECT_EQ(i, value);
+    }
+    EXPECT_FALSE(ring.tryPop(value));
+}
+
+TEST(SpscRingTest, MovesOnlyTypes) {
+    SpscRing<std::unique_ptr<std::string>> ring(2);
+    EXPECT_TRUE(ring.tryPush(std::make_unique<std::string>("frame")));
+
+    std::unique_ptr<std::string> value;
+    ASSERT_TRUE(ring.tryPop(value));
+    EXPECT_EQ("frame", *value);
+}
+
+TEST(SpscRingTest, PreservesOrderAcrossThreads) {
+    constexpr int kItems = 200000;
+    SpscRing<int> ring(64);
+
+    std::thread producer([&]() {
+        for (int i = 0; i < kItems; ++i) {
+            while (!ring.tryPush(i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    int expected = 0;
+    int value = 0;
+    while (expected < kItems) {
+        if (ring.tryPop(value)) {
+            ASSERT_EQ(expected, value);
+            ++expected;
+        }
+    }
+    producer.join();
+    EXPECT_EQ(0u, ring.sizeApprox());
+}
+
+TEST(MpmcQueueTest, RejectsWhenFullAndEmpty) {
+    MpmcQueue<int> queue(4);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(queue.tryPush(i));
+    }
+    EXPECT_FALSE(queue.tryPush(4));
+
+    int value = -1;
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(queue.tryPop(value));
+        EXPECT_EQ(i, value);
+    }
+    EXPECT_FALSE(queue.tryPop(value));
+
+    // Slots are reused on the next lap
+    EXPECT_TRUE(queue.tryPush(42));
+    ASSERT_TRUE(queue.tryPop(value));
+    EXPECT_EQ(42, value);
+}
+
+TEST(MpmcQueueTest, DeliversEveryItemExactlyOnce) {
+    constexpr int kProducers = 4;
+    constexpr int kConsumers = 4;
+    constexpr int kPerProducer = 50000;
+    MpmcQueue<int> queue(128);
+
+    std::vector<std::vector<int>> received(kConsumers);
+    std::atomic<int> remaining(kProducers * kPerProducer);
+    std::vector<std::thread> threads;
+
+    for (int p = 0; p < kProducers; ++p) {
+        threads.emplace_back([&, p]() {
+            for (int i = 0; i < kPerProducer; ++i) {
+                while (!queue.tryPush(p * kPerProducer + i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (int c = 0; c < kConsumers; ++c) {
+        threads.emplace_back([&, c]() {
+            int value = 0;
+            while (remaining.load() > 0) {
+                if (queue.tryPop(value)) {
+                    received[c].push_back(value);
+                    remaining.fetch_sub(1);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::set<int> all;
+    size_t total = 0;
+    for (const auto& values : received) {
+        total += values.size();
+        all.insert(values.begin(), values.end());
+
+        // Each producer's items reach any one consumer in order
+        std::vector<int> last(kProducers, -1);
+        for (int v : values) {
+            EXPECT_GT(v, last[v / kPerProducer]);
+            last[v / kPerProducer] = v;
+        }
+    }
+    EXPECT_EQ(static_cast<size_t>(kProducers * kPerProducer), total);
+    EXPECT_EQ(total, all.size());
+}
@@ -12,7 +12,7 @@ protected:
         sample_image_data_ = {0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A};
     }
 
-    std::vector<uint8_t> sample_image_data_;
+    FrameBuffer sample_image_data_;
 };
 
 // Test ImageMessage serialization and deserialization
@@ -20,6 +20,7 @@ TEST_F(MessageTest, ImageMessageSerializeDeserialize) {
     // Create message
     ImageMessage original;
     original.image_id = "test_image_001";
+    original.stream_id = "cam0";
     original.image_data = sample_image_data_;
     original.format = "png";
     original.width = 640;
@@ -35,6 +36,7 @@ TEST_F(MessageTest, ImageMessageSerializeDeserialize) {
 
     // Verify all fields match
     EXPECT_EQ(original.image_id, deserialized.image_id);
+    EXPECT_EQ(original.stream_id, deserialized.stream_id);
     EXPECT_EQ(original.image_data, deserialized.image_data);
     EXPECT_EQ(original.format, deserialized.format);
     EXPECT_EQ(original.width, deserialized.width);
@@ -42,6 +44,57 @@ TEST_F(MessageTest, ImageMessageSerializeDeserialize) {
     EXPECT_EQ(original.timestamp, deserialized.timestamp);
 }
 
+// Header, separately sent image bytes and trailer join into the usual encoding
+TEST_F(MessageTest, ImageMessagePartsJoinIntoSerialization) {
+    ImageMessage message;
+    message.image_id = "member.jpg_7";
+    message.stream_id = "survey";
+    message.format = "jpg";
+    message.timestamp = 99;
+
+    FrameParts parts = message.serializeParts(sample_image_data_.size());
+    std::vector<uint8_t> joined(parts.head.begin(), parts.head.end());
+    joined.insert(joined.end(), sample_image_data_.begin(), sample_image_data_.end());
+    joined.insert(joined.end(), parts.tail.begin(), parts.tail.end());
+
+    message.image_data = sample_image_data_;
+    EXPECT_EQ(message.serialize(), joined);
+    EXPECT_THROW(message.serializeParts(8), std::logic_error);
+}
+
+TEST_F(MessageTest, ImageMessageRawPixels) {
+    ImageMessage original;
+    original.image_id = "raw_001";
+    original.format = "mono16";
+    original.width = 3;
+    original.height = 2;
+    original.stride = 8; // 6 bytes of pixels plus 2 bytes of padding per row
+    original.bit_depth = 12;
+    original.image_data.assign(16, 0x0F);
+    original.timestamp = 42;
+
+    ImageMessage deserialized = ImageMessage::deserialize(original.serialize());
+
+    EXPECT_EQ(original.format, deserialized.format);
+    EXPECT_EQ(original.width, deserialized.width);
+    EXPECT_EQ(original.height, deserialized.height);
+    EXPECT_EQ(original.stride, deserialized.stride);
+    EXPECT_EQ(original.bit_depth, deserialized.bit_depth);
+    EXPECT_EQ(original.image_data, deserialized.image_data);
+}
+
+TEST(RawPixelFormatTest, BytesPerPixel) {
+    EXPECT_EQ(1, rawBytesPerPixel("mono8"));
+    EXPECT_EQ(2, rawBytesPerPixel("mono16"));
+    EXPECT_EQ(1, rawBytesPerPixel("bayer_rggb8"));
+    EXPECT_EQ(2, rawBytesPerPixel("bayer_gbrg16"));
+    EXPECT_EQ(0, rawBytesPerPixel("png"));
+    EXPECT_EQ(0, rawBytesPerPixel("jpg"));
+
+    EXPECT_TRUE(isRawPixelFormat("bayer_bggr8"));
+    EXPECT_FALSE(isRawPixelFormat("tiff"));
+}
+
 TEST_F(MessageTest, ImageMessageEmptyData) {
     ImageMessage original;
     original.image_id = "empty_image";
@@ -80,12 +133,22 @@ TEST_F(MessageTest, ImageMessageLargeData) {
 TEST_F(MessageTest, ProcessedImageMessageSerializeDeserialize) {
     ProcessedImageMessage original;
     original.image_id = "processed_001";
+    original.stream_id = "cam1";
     original.image_data = sample_image_data_;
     original.format = "png";
     original.width = 800;
     original.height = 600;
+    original.stride = 1600;
+    original.bit_depth = 10;
     original.timestamp = 1111111111;
     original.processed_timestamp = 2222222222;
+    original.quality.sharpness = 153.5f;
+    original.quality.brightness = 97.25f;
+    original.quality.contrast = 41.0f;
+    original.quality.dark_fraction = 0.125f;
+    original.quality.saturated_fraction = 0.01f;
+    original.quality.flags = kQualityBlurry | kQualityLowContrast;
+    original.descriptor_dim = 128;
 
     // Add keypoints
     for (int i = 0; i < 5; ++i) {
@@ -117,13 +180,25 @@ TEST_F(MessageTest, ProcessedImageMessageSerializeDeserialize) {
 
     // Verify basic fields
     EXPECT_EQ(original.image_id, deserialized.image_id);
+    EXPECT_EQ(original.stream_id, deserialized.stream_id);
     EXPECT_EQ(original.image_data, deserialized.image_data);
     EXPECT_EQ(original.format, deserialized.format);
     EXPECT_EQ(original.width, deserialized.width);
     EXPECT_EQ(original.height, deserialized.height);
+    EXPECT_EQ(original.stride, deserialized.stride);
+    EXPECT_EQ(original.bit_depth, deserialized.bit_depth);
     EXPECT_EQ(original.timestamp, deserialized.timestamp);
     EXPECT_EQ(original.processed_timestamp, deserialized.processed_timestamp);
 
+    // Verify quality scores
+    EXPECT_FLOAT_EQ(original.quality.sharpness, deserialized.quality.sharpness);
+    EXPECT_FLOAT_EQ(original.quality.brightness, deserialized.quality.brightness);
+    EXPECT_FLOAT_EQ(original.quality.contrast, deserialized.quality.contrast);
+    EXPECT_FLOAT_EQ(original.quality.dark_fraction, deserialized.quality.dark_fraction);
+    EXPECT_FLOAT_EQ(original.quality.saturated_fraction, deserialized.quality.saturated_fraction);
+    EXPECT_EQ(original.quality.flags, deserialized.quality.flags);
+    EXPECT_EQ(128u, deserialized.descriptor_dim);
+
     // Verify keypoints
     ASSERT_EQ(original.keypoints.size(), deserialized.keypoints.size());
     for (size_t i = 0; i < original.keypoints.size(); ++i) {
@@ -162,6 +237,139 @@ TEST_F(MessageTest, ProcessedImageMessageNoKeypoints) {
     EXPECT_EQ(original.image_id, deserialized.image_id);
     EXPECT_TRUE(deserialized.keypoints.empty());
     EXPECT_TRUE(deserialized.descriptors.empty());
+    EXPECT_EQ(0u, deserialized.descriptor_dim);
+}
+
+TEST_F(MessageTest, ProcessedImageMessageReducedDescriptors) {
+    ProcessedImageMessage original;
+    original.image_id = "pca";
+    original.descriptor_dim = 32;
+    original.keypoints.resize(2);
+    original.descriptors.assign(2, std::vector<float>(32, 0.5f));
+
+    ProcessedImageMessage deserialized = ProcessedImageMessage::deserialize(original.serialize());
+    EXPECT_EQ(32u, deserialized.descriptor_dim);
+    ASSERT_EQ(2u, deserialized.descriptors.size());
+    EXPECT_EQ(32u, deserialized.descriptors[1].size());
+}
+
+TEST(MatchSetMessageTest, SerializeDeserialize) {
+    MatchSetMessage original;
+    original.image_id = "frame_002";
+    original.stream_id = "cam0";
+    original.timestamp = 5555555555;
+    original.matched_timestamp = 6666666666;
+
+    FrameMatch with_homography;
+    with_homography.reference_id = "frame_001";
+    with_homography.has_homography = true;
+    for (int i = 0; i < 9; ++i) {
+        with_homography.homography[i] = i * 0.5;
+    }
+    with_homography.num_inliers = 2;
+    with_homography.matches = {FeatureMatch(0, 3, 12.5f), FeatureMatch(4, 1, 80.0f)};
+    original.frames.push_back(with_homography);
+
+    FrameMatch without;
+    without.reference_id = "frame_000";
+    without.matches = {FeatureMatch(7, 7, 1.0f)};
+    original.frames.push_back(without);
+    original.loop_candidates = {PlaceCandidate("frame_100", "cam1", 0.42f)};
+
+    MatchSetMessage deserialized = MatchSetMessage::deserialize(original.serialize());
+    EXPECT_EQ(original.image_id, deserialized.image_id);
+    EXPECT_EQ(original.stream_id, deserialized.stream_id);
+    EXPECT_EQ(original.timestamp, deserialized.timestamp);
+    EXPECT_EQ(original.matched_timestamp, deserialized.matched_timestamp);
+    ASSERT_EQ(2u, deserialized.frames.size());
+
+    const FrameMatch& first = deserialized.frames[0];
+    EXPECT_EQ("frame_001", first.reference_id);
+    EXPECT_TRUE(first.has_homography);
+    EXPECT_DOUBLE_EQ(4.0, first.homography[8]);
+    EXPECT_EQ(2u, first.num_inliers);
+    ASSERT_EQ(2u, first.matches.size());
+    EXPECT_EQ(4u, first.matches[1].query_idx);
+    EXPECT_EQ(1u, first.matches[1].train_idx);
+    EXPECT_FLOAT_EQ(80.0f, first.matches[1].distance);
+
+    EXPECT_FALSE(deserialized.frames[1].has_homography);
+    EXPECT_EQ(1u, deserialized.frames[1].matches.size());
+
+    ASSERT_EQ(1u, deserialized.loop_candidates.size());
+    EXPECT_EQ("frame_100", deserialized.loop_candidates[0].image_id);
+    EXPECT_EQ("cam1", deserialized.loop_candidates[0].stream_id);
+    EXPECT_FLOAT_EQ(0.42f, deserialized.loop_candidates[0].score);
+}
+
+TEST(MatchSetMessageTest, TruncatedData) {
+    MatchSetMessage original;
+    original.image_id = "frame";
+    FrameMatch frame;
+    frame.matches.resize(10);
+    original.frames.push_back(frame);
+
+    std::vector<uint8_t> data = original.serialize();
+    data.resize(data.size() - 20);
+    EXPECT_THROW(MatchSetMessage::deserialize(data), std::runtime_error);
+}
+
+TEST(DescriptorMessageTest, RequestAndReplyRoundTrip) {
+    DescriptorRequest request;
+    request.image_id = "frame_042";
+    request.keypoint_indices = {3, 0, 17};
+    DescriptorRequest request_copy = DescriptorRequest::deserialize(request.serialize());
+    EXPECT_EQ("frame_042", request_copy.image_id);
+    EXPECT_EQ(request.keypoint_indices, request_copy.keypoint_indices);
+
+    DescriptorReply reply;
+    reply.image_id = "frame_042";
+    reply.found = true;
+    reply.descriptor_dim = 4;
+    reply.keypoint_indices = {3, 0};
+    reply.descriptors = {{1, 2, 3, 4}, {5, 6, 7, 8}};
+    DescriptorReply reply_copy = DescriptorReply::deserialize(reply.serialize());
+    EXPECT_TRUE(reply_copy.found);
+    EXPECT_TRUE(reply_copy.error.empty());
+    EXPECT_EQ(4u, reply_copy.descriptor_dim);
+    EXPECT_EQ(reply.keypoint_indices, reply_copy.keypoint_indices);
+    EXPECT_EQ(reply.descriptors, reply_copy.descriptors);
+
+    DescriptorReply missing;
+    missing.error = "Frame not cached";
+    DescriptorReply missing_copy = DescriptorReply::deserialize(missing.serialize());
+    EXPECT_FALSE(missing_copy.found);
+    EXPECT_EQ("Frame not cached", missing_copy.error);
+}
+
+TEST(FrameQueryMessageTest, QueryAndReplyRoundTrip) {
+    FrameQuery query;
+    query.count = 5;
+    query.include_image = true;
+    FrameQuery query_copy = FrameQuery::deserialize(query.serialize());
+    EXPECT_TRUE(query_copy.image_id.empty());
+    EXPECT_EQ(5u, query_copy.count);
+    EXPECT_TRUE(query_copy.include_image);
+    EXPECT_TRUE(query_copy.include_features);
+
+    FrameQueryReply reply;
+    reply.frames.resize(2);
+    reply.frames[0].image_id = "frame_2";
+    reply.frames[0].image_data.assign(100, 7);
+    reply.frames[0].keypoints.resize(3);
+    reply.frames[1].image_id = "frame_1";
+    reply.frames[1].descriptor_dim = 2;
+    reply.frames[1].descriptors = {{1.0f, 2.0f}};
+    reply.cache_hits = 1;
+    reply.database_reads = 1;
+    FrameQueryReply copy = FrameQueryReply::deserialize(reply.serialize());
+    ASSERT_EQ(2u, copy.frames.size());
+    EXPECT_EQ("frame_2", copy.frames[0].image_id);
+    EXPECT_EQ(100u, copy.frames[0].image_data.size());
+    EXPECT_EQ(3u, copy.frames[0].keypoints.size());
+    EXPECT_EQ(reply.frames[1].descriptors, copy.frames[1].descriptors);
+    EXPECT_EQ(1u, copy.cache_hits);
+    EXPECT_EQ(1u, copy.database_reads);
 }
 
 // Test Point2f
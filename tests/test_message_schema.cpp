@@ -0,0 +1,187 @@
+#include "message.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace voyis;
+
+// Fixed-size POD sections are copied in bulk; anything with strings, vectors or bools is not
+static_assert(schema::isBulk<Point2f>, "Point2f should be bulk");
+static_assert(schema::isBulk<KeyPoint>, "KeyPoint should be bulk");
+static_assert(schema::isBulk<QualityMetrics>, "QualityMetrics should be bulk");
+static_assert(schema::isBulk<FeatureMatch>, "FeatureMatch should be bulk");
+static_assert(!schema::isBulk<FrameMatch>, "FrameMatch has variable-size fields");
+static_assert(!schema::isBulk<bool>, "bool is encoded as a checked byte");
+static_assert(schema::fixedSize<KeyPoint>() == 24, "KeyPoint is 24 bytes on the wire");
+static_assert(schema::fixedSize<ImageMessage>() == 0, "ImageMessage has variable size");
+static_assert(schema::minSize<std::string>() == 4, "Strings carry a length prefix");
+
+namespace {
+
+ProcessedImageMessage makeProcessed() {
+    ProcessedImageMessage msg;
+    msg.image_id = "frame_001";
+    msg.stream_id = "cam0";
+    msg.image_data = {1, 2, 3, 4, 5};
+    msg.format = "jpg";
+    msg.width = 640;
+    msg.height = 480;
+    msg.timestamp = 1000;
+    msg.processed_timestamp = 1050;
+    msg.quality.sharpness = 12.5f;
+    msg.quality.flags = kQualityBlurry;
+    msg.descriptor_dim = 2;
+    for (int i = 0; i < 3; ++i) {
+        KeyPoint kp;
+        kp.pt = Point2f(10.0f * i, 20.0f * i);
+        kp.size = 1.5f;
+        kp.angle = 90.0f;
+        kp.response = 0.25f;
+        kp.octave = i;
+        msg.keypoints.push_back(kp);
+        msg.descriptors.push_back({static_cast<float>(i), 0.5f});
+    }
+    return msg;
+}
+
+} // anonymous namespace
+
+TEST(MessageSchemaTest, BulkTypesMatchTheirMemoryLayout) {
+    EXPECT_TRUE(schema::layoutMatchesSchema<Point2f>());
+    EXPECT_TRUE(schema::layoutMatchesSchema<KeyPoint>());
+    EXPECT_TRUE(schema::layoutMatchesSchema<QualityMetrics>());
+    EXPECT_TRUE(schema::layoutMatchesSchema<FeatureMatch>());
+}
+
+TEST(MessageSchemaTest, EncodedSizeIsExact) {
+    ProcessedImageMessage processed = makeProcessed();
+    EXPECT_EQ(processed.serialize().size(), schema::encodedSize(processed));
+
+    ImageMessage image;
+    image.image_id = "img";
+    image.image_data.resize(1000);
+    EXPECT_EQ(image.serialize().size(), schema::encodedSize(image));
+
+    MatchSetMessage matches;
+    FrameMatch frame;
+    frame.matches.resize(7);
+    matches.frames.push_back(frame);
+    matches.loop_candidates.emplace_back("old", "cam0", 0.5f);
+    EXPECT_EQ(matches.serialize().size(), schema::encodedSize(matches));
+}
+
+TEST(MessageSchemaTest, KeypointsKeepFieldByFieldWireLayout) {
+    ProcessedImageMessage msg = makeProcessed();
+    std::vector<uint8_t> data = msg.serialize();
+
+    // Keypoints follow the fixed header fields, the quality block and descriptor_dim
+    size_t offset = 4 + msg.image_id.size() + 4 + msg.stream_id.size() + 4 + msg.image_data.size() +
+                    4 + msg.format.size() + 4 * 4 + 8 * 2 + 24 + 4;
+    uint32_t count;
+    std::memcpy(&count, &data[offset], 4);
+    ASSERT_EQ(3u, count);
+
+    // Second keypoint: x, y, size, angle, response, octave
+    const uint8_t* kp = &data[offset + 4 + 24];
+    float values[5];
+    int octave;
+    std::memcpy(values, kp, sizeof(values));
+    std::memcpy(&octave, kp + 20, 4);
+    EXPECT_FLOAT_EQ(10.0f, values[0]);
+    EXPECT_FLOAT_EQ(20.0f, values[1]);
+    EXPECT_FLOAT_EQ(1.5f, values[2]);
+    EXPECT_FLOAT_EQ(90.0f, values[3]);
+    EXPECT_FLOAT_EQ(0.25f, values[4]);
+    EXPECT_EQ(1, octave);
+}
+
+TEST(MessageSchemaTest, ValidateRejectsEveryTruncation) {
+    std::vector<uint8_t> data = makeProcessed().serialize();
+    EXPECT_TRUE(schema::validate<ProcessedImageMessage>(data.data(), data.size()));
+    for (size_t size = 0; size < data.size(); ++size) {
+        EXPECT_FALSE(schema::validate<ProcessedImageMessage>(data.data(), size)) << size;
+    }
+}
+
+TEST(MessageSchemaTest, HugeCountsAreRejectedBeforeAllocating) {
+    ImageMessage image;
+    std::vector<uint8_t> data = image.serialize();
+
+    // Claim a 4 GB image_data payload
+    uint32_t huge = 0xFFFFFFFFu;
+    std::memcpy(&data[8], &huge, 4);
+    EXPECT_FALSE(schema::validate<ImageMessage>(data.data(), data.size()));
+    EXPECT_THROW(ImageMessage::deserialize(data), std::runtime_error);
+}
+
+TEST(MessageSchemaTest, ViewsPointIntoTheBuffer) {
+    ProcessedImageMessage msg = makeProcessed();
+    std::vector<uint8_t> data = msg.serialize();
+    const uint8_t* begin = data.data();
+    const uint8_t* end = data.data() + data.size();
+
+    std::string_view stream = schema::view<&ProcessedImageMessage::stream_id>(begin, data.size());
+    EXPECT_EQ("cam0", stream);
+    EXPECT_GE(reinterpret_cast<const uint8_t*>(stream.data()), begin);
+    EXPECT_LT(reinterpret_cast<const uint8_t*>(stream.data()), end);
+
+    auto pixels = schema::view<&ProcessedImageMessage::image_data>(begin, data.size());
+    ASSERT_EQ(5u, pixels.size());
+    EXPECT_EQ(3, pixels[2]);
+    EXPECT_GE(pixels.bytes(), begin);
+
+    auto keypoints = schema::view<&ProcessedImageMessage::keypoints>(begin, data.size());
+    ASSERT_EQ(3u, keypoints.size());
+    EXPECT_FLOAT_EQ(20.0f, keypoints[2].pt.x);
+    EXPECT_EQ(2, keypoints.toVector()[2].octave);
+
+    EXPECT_EQ(1050, schema::view<&ProcessedImageMessage::processed_timestamp>(begin, data.size()));
+    EXPECT_EQ(static_cast<uint32_t>(kQualityBlurry),
+              schema::view<&ProcessedImageMessage::quality>(begin, data.size()).flags);
+}
+
+TEST(MessageSchemaTest, BoolDecodesAnyNonZeroByte) {
+    MatchSetMessage msg;
+    FrameMatch frame;
+    frame.has_homography = true;
+    msg.frames.push_back(frame);
+    std::vector<uint8_t> data = msg.serialize();
+
+    // image_id, stream_id, two timestamps, frame count, reference_id, then has_homography
+    size_t offset = 4 + 4 + 8 + 8 + 4 + 4;
+    ASSERT_EQ(1, data[offset]);
+    data[offset] = 7;
+    EXPECT_TRUE(MatchSetMessage::deserialize(data).frames[0].has_homography);
+}
+
+TEST(MessageSchemaTest, ValidatesAndViewsPastFixedArrays) {
+    MatchSetMessage msg;
+    msg.image_id = "frame_2";
+    msg.stream_id = "cam0";
+    msg.matched_timestamp = 2000;
+    FrameMatch frame;
+    frame.reference_id = "frame_1";
+    frame.has_homography = true;
+    frame.homography[8] = 1.0;
+    frame.matches.resize(3);
+    msg.frames.push_back(frame);
+    msg.loop_candidates.emplace_back("frame_0", "cam0", 0.75f);
+    std::vector<uint8_t> data = msg.serialize();
+
+    // FrameMatch::homography is a double[9], skipped as nine doubles
+    EXPECT_TRUE(schema::validate<MatchSetMessage>(data.data(), data.size()));
+    for (size_t size = 0; size < data.size(); ++size) {
+        EXPECT_FALSE(schema::validate<MatchSetMessage>(data.data(), size)) << size;
+    }
+
+    EXPECT_EQ("cam0", schema::view<&MatchSetMessage::stream_id>(data.data(), data.size()));
+    EXPECT_EQ(2000, schema::view<&MatchSetMessage::matched_timestamp>(data.data(), data.size()));
+
+    // Fields after the array are found by skipping it
+    frame.num_inliers = 42;
+    std::vector<uint8_t> frame_data = schema::serialize(frame);
+    EXPECT_EQ(42u, schema::view<&FrameMatch::num_inliers>(frame_data.data(), frame_data.size()));
+    auto matches = schema::view<&FrameMatch::matches>(frame_data.data(), frame_data.size());
+    EXPECT_EQ(3u, matches.size());
+}
@@ -0,0 +1,86 @@
+#include "options.h"
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace voyis;
+
+namespace {
+
+// Build an Options object from a list of arguments (argv[0] is added)
+Options parse(std::vector<std::string> args) {
+    args.insert(args.begin(), "app");
+    std::vector<char*> argv;
+    for (auto& arg : args) {
+        argv.push_back(arg.data());
+    }
+    return Options(static_cast<int>(argv.size()), argv.data());
+}
+
+} // anonymous namespace
+
+TEST(OptionsTest, PositionalAndNamed) {
+    Options opts = parse({"--rate=5", "/data/images", "--verbose", "extra"});
+
+    ASSERT_EQ(2u, opts.positional().size());
+    EXPECT_EQ("/data/images", opts.positional()[0]);
+    EXPECT_EQ("extra", opts.positional()[1]);
+
+    EXPECT_TRUE(opts.has("rate"));
+    EXPECT_EQ(5, opts.getInt("rate"));
+    EXPECT_TRUE(opts.getBool("verbose"));
+    EXPECT_FALSE(opts.has("missing"));
+}
+
+TEST(OptionsTest, Defaults) {
+    Options opts = parse({});
+
+    EXPECT_EQ("fallback", opts.getString("name", "fallback"));
+    EXPECT_EQ(42, opts.getInt("count", 42));
+    EXPECT_DOUBLE_EQ(1.5, opts.getDouble("scale", 1.5));
+    EXPECT_TRUE(opts.getBool("flag", true));
+    EXPECT_TRUE(opts.getList("list").empty());
+}
+
+TEST(OptionsTest, InvalidNumbers) {
+    Options opts = parse({"--count=12abc", "--scale=fast"});
+
+    EXPECT_THROW(opts.getInt("count"), std::invalid_argument);
+    EXPECT_THROW(opts.getDouble("scale"), std::invalid_argument);
+}
+
+TEST(OptionsTest, ListsAndMaps) {
+    Options opts = parse({"--streams=cam0,,cam1", "--stream-slo=cam0:200,cam1:500", "--bad=cam0"});
+
+    std::vector<std::string> streams = opts.getList("streams");
+    ASSERT_EQ(2u, streams.size());
+    EXPECT_EQ("cam0", streams[0]);
+    EXPECT_EQ("cam1", streams[1]);
+
+    auto slo = opts.getMap("stream-slo");
+    ASSERT_EQ(2u, slo.size());
+    EXPECT_EQ("200", slo["cam0"]);
+    EXPECT_EQ("500", slo["cam1"]);
+
+    EXPECT_THROW(opts.getMap("bad"), std::invalid_argument);
+}
+
+TEST(OptionsTest, TypedMaps) {
+    Options opts = parse({"--stream-slo=cam0:200,cam1:500", "--stream-weight=cam0:0.5",
+                          "--bad-slo=cam0:fast", "--bad-weight=cam0:2x"});
+
+    auto slo = opts.getIntMap("stream-slo");
+    ASSERT_EQ(2u, slo.size());
+    EXPECT_EQ(500, slo["cam1"]);
+    EXPECT_DOUBLE_EQ(0.5, opts.getDoubleMap("stream-weight")["cam0"]);
+    EXPECT_TRUE(opts.getIntMap("absent").empty());
+
+    try {
+        opts.getIntMap("bad-slo");
+        FAIL() << "Expected std::invalid_argument";
+    } catch (const std::invalid_argument& e) {
+        EXPECT_NE(std::string::npos, std::string(e.what()).find("--bad-slo"));
+    }
+    EXPECT_THROW(opts.getDoubleMap("bad-weight"), std::invalid_argument);
+}
@@ -0,0 +1,188 @@
+#include "feature_matcher/place_index.h"
+#include "feature_matcher/place_index_store.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <string>
+
+using namespace voyis;
+
+namespace {
+
+// Four one-hot words in 4 dimensions
+Vocabulary unitVocabulary() {
+    return Vocabulary(cv::Mat::eye(4, 4, CV_32F));
+}
+
+// Frame whose descriptors sit on the given words
+ProcessedImageMessage makeFrame(const std::string& id, const std::vector<int>& words,
+                                const std::string& stream = "cam0") {
+    ProcessedImageMessage msg;
+    msg.image_id = id;
+    msg.stream_id = stream;
+    msg.descriptor_dim = 4;
+    for (int word : words) {
+        std::vector<float> desc(4, 0.0f);
+        desc[word] = 1.0f;
+        msg.descriptors.push_back(desc);
+        msg.keypoints.push_back(KeyPoint());
+    }
+    return msg;
+}
+
+PlaceIndexConfig noExclusion() {
+    PlaceIndexConfig config;
+    config.exclude_recent = 0;
+    config.min_score = 0.0f;
+    return config;
+}
+
+} // anonymous namespace
+
+TEST(VocabularyTest, QuantizesToNearestWord) {
+    Vocabulary vocabulary = unitVocabulary();
+    cv::Mat descriptors = (cv::Mat_<float>(3, 4) << 0.9f, 0.1f, 0, 0,
+                                                    0, 0, 0.2f, 0.8f,
+                                                    1, 0, 0, 0);
+
+    EXPECT_EQ((std::vector<uint32_t>{0, 3, 0}), vocabulary.quantize(descriptors));
+
+    BagOfWords bow = vocabulary.bagOfWords(descriptors);
+    ASSERT_EQ(2u, bow.size());
+    EXPECT_EQ(0u, bow[0].first);
+    EXPECT_FLOAT_EQ(2.0f / 3.0f, bow[0].second);
+    EXPECT_EQ(3u, bow[1].first);
+}
+
+TEST(PlaceIndexTest, RanksByTfIdfSimilarity) {
+    PlaceIndex index(4, noExclusion());
+    index.add("same", "cam0", {{0, 0.5f}, {1, 0.5f}});
+    index.add("half", "cam0", {{0, 0.5f}, {2, 0.5f}});
+    index.add("none", "cam0", {{3, 1.0f}});
+
+    auto candidates = index.query({{0, 0.5f}, {1, 0.5f}}, "cam1");
+    ASSERT_EQ(2u, candidates.size());
+    EXPECT_EQ("same", candidates[0].image_id);
+    EXPECT_EQ("half", candidates[1].image_id);
+    EXPECT_NEAR(1.0f, candidates[0].score, 1e-4f);
+    EXPECT_LT(candidates[1].score, candidates[0].score);
+}
+
+TEST(PlaceIndexTest, ScoresOldAndRecentFramesAlike) {
+    PlaceIndex index(4, noExclusion());
+    index.add("old", "cam0", {{0, 0.5f}, {1, 0.5f}});
+    for (int i = 0; i < 200; ++i) {
+        index.add("other_" + std::to_string(i), "cam0", {{2, 0.5f}, {3, 0.5f}});
+    }
+    index.add("recent", "cam0", {{0, 0.5f}, {1, 0.5f}});
+
+    auto candidates = index.query({{0, 0.5f}, {1, 0.5f}}, "cam1");
+    ASSERT_EQ(2u, candidates.size());
+    EXPECT_NEAR(1.0f, candidates[0].score, 1e-4f);
+    EXPECT_NEAR(1.0f, candidates[1].score, 1e-4f);
+}
+
+TEST(PlaceIndexTest, ExcludesRecentFramesOfOwnStream) {
+    PlaceIndexConfig config = noExclusion();
+    config.exclude_recent = 2;
+    PlaceIndex index(4, config);
+    index.add("old", "cam0", {{0, 1.0f}});
+    index.add("recent1", "cam0", {{0, 1.0f}});
+    index.add("recent2", "cam0", {{0, 1.0f}});
+    index.add("other", "cam1", {{0, 1.0f}});
+
+    auto own = index.query({{0, 1.0f}}, "cam0");
+    ASSERT_EQ(2u, own.size());
+    for (const auto& candidate : own) {
+        EXPECT_TRUE(candidate.image_id == "old" || candidate.image_id == "other");
+    }
+
+    EXPECT_EQ(4u, index.query({{0, 1.0f}}, "cam2").size());
+}
+
+TEST(PlaceIndexTest, KeepsTopKAboveMinScore) {
+    PlaceIndexConfig config = noExclusion();
+    config.top_k = 1;
+    config.min_score = 0.5f;
+    PlaceIndex index(4, config);
+    index.add("a", "cam0", {{0, 1.0f}});
+    index.add("b", "cam0", {{0, 0.5f}, {1, 0.5f}});
+    index.add("c", "cam0", {{0, 0.1f}, {2, 0.9f}});
+
+    auto candidates = index.query({{0, 1.0f}}, "cam1");
+    ASSERT_EQ(1u, candidates.size());
+    EXPECT_EQ("a", candidates[0].image_id);
+}
+
+TEST(PlaceRecognizerTest, LearnsVocabularyFromFirstFrames) {
+    VocabularyConfig vocabulary_config;
+    vocabulary_config.num_words = 4;
+    vocabulary_config.training_samples = 8;
+    PlaceRecognizer recognizer(Vocabulary(), vocabulary_config, noExclusion(), nullptr);
+
+    EXPECT_TRUE(recognizer.process(makeFrame("a", {0, 1, 2, 3})).empty());
+    EXPECT_FALSE(recognizer.hasVocabulary());
+    recognizer.process(makeFrame("b", {0, 1, 2, 3}));
+
+    ASSERT_TRUE(recognizer.hasVocabulary());
+    EXPECT_EQ(4, recognizer.vocabulary().size());
+    EXPECT_EQ(2u, recognizer.indexedFrames());
+
+    auto candidates = recognizer.process(makeFrame("c", {0, 1, 2, 3}));
+    EXPECT_EQ(2u, candidates.size());
+}
+
+TEST(PlaceRecognizerTest, SkipsFramesOfAnotherDescriptorLength) {
+    VocabularyConfig vocabulary_config;
+    vocabulary_config.num_words = 4;
+    vocabulary_config.training_samples = 8;
+    PlaceRecognizer recognizer(Vocabulary(), vocabulary_config, noExclusion(), nullptr);
+
+    ProcessedImageMessage other_length = makeFrame("pca", {0, 1, 2, 3});
+    for (std::vector<float>& desc : other_length.descriptors) {
+        desc.resize(2);
+    }
+    other_length.descriptor_dim = 2;
+
+    // Not buffered while learning, and not counted towards the training samples
+    recognizer.process(makeFrame("a", {0, 1, 2, 3}));
+    recognizer.process(other_length);
+    EXPECT_EQ(1u, recognizer.mismatchedFrames());
+    EXPECT_FALSE(recognizer.hasVocabulary());
+
+    recognizer.process(makeFrame("b", {0, 1, 2, 3}));
+    ASSERT_TRUE(recognizer.hasVocabulary());
+    EXPECT_EQ(2u, recognizer.indexedFrames());
+
+    EXPECT_TRUE(recognizer.process(other_length).empty());
+    EXPECT_EQ(2u, recognizer.mismatchedFrames());
+    EXPECT_EQ(2u, recognizer.indexedFrames());
+}
+
+TEST(PlaceRecognizerTest, ResumesPersistedIndex) {
+    const std::string path = ::testing::TempDir() + "voyis_place_index_test.db";
+    std::remove(path.c_str());
+
+    {
+        PlaceRecognizer recognizer(unitVocabulary(), VocabularyConfig{}, noExclusion(),
+                                   std::make_unique<PlaceIndexStore>(path));
+        recognizer.process(makeFrame("dock", {0, 0, 1}));
+        recognizer.process(makeFrame("reef", {2, 3}));
+    }
+
+    // Restart without a vocabulary: both come back from the store
+    PlaceRecognizer resumed(Vocabulary(), VocabularyConfig{}, noExclusion(),
+                            std::make_unique<PlaceIndexStore>(path));
+    ASSERT_TRUE(resumed.hasVocabulary());
+    EXPECT_EQ(2u, resumed.indexedFrames());
+
+    auto candidates = resumed.process(makeFrame("dock again", {0, 1, 0}));
+    ASSERT_EQ(1u, candidates.size());
+    EXPECT_EQ("dock", candidates[0].image_id);
+
+    // A different vocabulary discards frames indexed with the stored one
+    PlaceRecognizer replaced(Vocabulary(cv::Mat::eye(4, 4, CV_32F) * 2), VocabularyConfig{},
+                             noExclusion(), std::make_unique<PlaceIndexStore>(path));
+    EXPECT_EQ(0u, replaced.indexedFrames());
+
+    std::remove(path.c_str());
+}
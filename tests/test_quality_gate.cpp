@@ -0,0 +1,76 @@
+#include "feature_extractor/quality_gate.h"
+#include <gtest/gtest.h>
+#include <opencv2/imgproc.hpp>
+
+using namespace voyis;
+
+namespace {
+
+// Checkerboard with sharp edges and mid-range exposure
+cv::Mat makeCheckerboard(int size, int square) {
+    cv::Mat image(size, size, CV_8UC1);
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            image.at<uint8_t>(y, x) = ((x / square + y / square) % 2) ? 200 : 60;
+        }
+    }
+    return image;
+}
+
+} // anonymous namespace
+
+TEST(QualityGateTest, SharpImageScoresHigherThanBlurred) {
+    cv::Mat sharp = makeCheckerboard(256, 16);
+    cv::Mat blurred;
+    cv::GaussianBlur(sharp, blurred, cv::Size(0, 0), 6.0);
+
+    QualityMetrics sharp_metrics = measureQuality(sharp);
+    QualityMetrics blurred_metrics = measureQuality(blurred);
+
+    EXPECT_GT(sharp_metrics.sharpness, 10.0f * blurred_metrics.sharpness);
+    EXPECT_NEAR(130.0f, sharp_metrics.brightness, 1.0f);
+    EXPECT_NEAR(70.0f, sharp_metrics.contrast, 1.0f);
+    EXPECT_FLOAT_EQ(0.0f, sharp_metrics.dark_fraction);
+    EXPECT_FLOAT_EQ(0.0f, sharp_metrics.saturated_fraction);
+}
+
+TEST(QualityGateTest, ExposureFractions) {
+    cv::Mat image(100, 100, CV_8UC1, cv::Scalar(5));
+    image(cv::Rect(0, 0, 100, 25)).setTo(250);
+
+    QualityMetrics metrics = measureQuality(image);
+    EXPECT_NEAR(0.75f, metrics.dark_fraction, 1e-6f);
+    EXPECT_NEAR(0.25f, metrics.saturated_fraction, 1e-6f);
+}
+
+TEST(QualityGateTest, DefaultThresholdsAcceptEverything) {
+    cv::Mat black(64, 64, CV_8UC1, cv::Scalar(0));
+    QualityMetrics metrics = measureQuality(black);
+
+    EXPECT_EQ(kQualityOk, applyQualityThresholds(metrics, QualityThresholds()));
+    EXPECT_EQ(kQualityOk, metrics.flags);
+    EXPECT_TRUE(acceptsEveryFrame(QualityThresholds()));
+
+    QualityThresholds dark_limit;
+    dark_limit.max_dark_fraction = 0.5;
+    EXPECT_FALSE(acceptsEveryFrame(dark_limit));
+}
+
+TEST(QualityGateTest, FlagsFailedChecks) {
+    cv::Mat black(64, 64, CV_8UC1, cv::Scalar(2));
+    QualityMetrics metrics = measureQuality(black);
+
+    QualityThresholds thresholds;
+    thresholds.min_sharpness = 10.0;
+    thresholds.min_brightness = 20.0;
+    thresholds.min_contrast = 5.0;
+
+    uint32_t flags = applyQualityThresholds(metrics, thresholds);
+    EXPECT_EQ(kQualityBlurry | kQualityUnderexposed | kQualityLowContrast, flags);
+    EXPECT_EQ(flags, metrics.flags);
+    EXPECT_FALSE(flags & kQualityOverexposed);
+}
+
+TEST(QualityGateTest, RejectsInvalidInput) {
+    EXPECT_THROW(measureQuality(cv::Mat()), std::invalid_argument);
+}
@@ -0,0 +1,252 @@
+#include "data_logger/database.h"
+#include "data_logger/query_service.h"
+#include "ipc.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace voyis;
+
+namespace {
+
+ProcessedImageMessage makeFrame(const std::string& image_id, size_t image_bytes,
+                                size_t keypoints = 0) {
+    ProcessedImageMessage frame;
+    frame.image_id = image_id;
+    frame.stream_id = "cam0";
+    frame.format = "jpg";
+    frame.width = 64;
+    frame.height = 48;
+    frame.timestamp = 1000;
+    frame.processed_timestamp = 1010;
+    frame.quality.sharpness = 12.5f;
+    frame.image_data.assign(image_bytes, 7);
+    frame.descriptor_dim = keypoints > 0 ? 4 : 0;
+    for (size_t i = 0; i < keypoints; ++i) {
+        KeyPoint kp;
+        kp.pt.x = static_cast<float>(i);
+        kp.pt.y = 2.0f * static_cast<float>(i);
+        kp.octave = static_cast<int>(i);
+        frame.keypoints.push_back(kp);
+        frame.descriptors.push_back({1.0f, 2.0f, 3.0f, static_cast<float>(i)});
+    }
+    return frame;
+}
+
+std::shared_ptr<const ProcessedImageMessage> share(ProcessedImageMessage frame) {
+    return std::make_shared<const ProcessedImageMessage>(std::move(frame));
+}
+
+/**
+ * @brief Fresh database file, removed again after the test
+ */
+class TempDatabase {
+public:
+    explicit TempDatabase(const std::string& name) : path_(testing::TempDir() + name) {
+        std::remove(path_.c_str());
+        database_ = std::make_unique<Database>(path_);
+    }
+    ~TempDatabase() {
+        database_.reset();
+        std::remove(path_.c_str());
+        std::remove((path_ + "-wal").c_str());
+        std::remove((path_ + "-shm").c_str());
+    }
+
+    Database& database() { return *database_; }
+    const std::string& path() const { return path_; }
+
+private:
+    std::string path_;
+    std::unique_ptr<Database> database_;
+};
+
+} // anonymous namespace
+
+TEST(RecentFrameCacheTest, KeepsOversizedFramesAsMetadata) {
+    RecentFrameCache cache(8, 1000);
+    cache.insert(1, share(makeFrame("small_1", 100, 2)));
+    cache.insert(2, share(makeFrame("huge", 5000, 2)));
+    cache.insert(3, share(makeFrame("small_2", 100, 2)));
+
+    // The oversized row stays in the run, without image or features
+    std::vector<RecentFrame> newest = cache.newest(3);
+    ASSERT_EQ(3u, newest.size());
+    EXPECT_EQ(2, newest[1].row_id);
+    EXPECT_FALSE(newest[1].complete);
+    EXPECT_EQ("huge", newest[1].frame->image_id);
+    EXPECT_EQ(64, newest[1].frame->width);
+    EXPECT_TRUE(newest[1].frame->image_data.empty());
+    EXPECT_TRUE(newest[1].frame->keypoints.empty());
+    EXPECT_TRUE(newest[0].complete);
+    EXPECT_EQ(2 * RecentFrameCache::frameBytes(makeFrame("small", 100, 2)), cache.bytes());
+}
+
+TEST(RecentFrameCacheTest, KeepsEveryRowOfARepeatedImageId) {
+    RecentFrameCache cache(4, 1 << 20);
+    cache.insert(1, share(makeFrame("same", 10)));
+    cache.insert(2, share(makeFrame("same", 20)));
+    EXPECT_EQ(2u, cache.newest(4).size());
+
+    RecentFrame found = cache.find("same");
+    EXPECT_EQ(2, found.row_id);
+    EXPECT_EQ(20u, found.frame->image_data.size());
+    EXPECT_EQ(nullptr, cache.find("other").frame);
+}
+
+TEST(QueryServiceTest, ServesRecentFramesFromMemory) {
+    TempDatabase db("voyis_query_memory.db");
+    RecentFrameCache cache(4, 1 << 20);
+    QueryService service("tcp://127.0.0.1:6001", cache, db.path(), nullptr);
+    cache.insert(1, share(makeFrame("frame_1", 100, 3)));
+    cache.insert(2, share(makeFrame("frame_2", 100, 5)));
+
+    FrameQuery query;
+    query.image_id = "frame_1";
+    FrameQueryReply reply = service.handle(query);
+    EXPECT_TRUE(reply.error.empty()) << reply.error;
+    EXPECT_EQ(1u, reply.cache_hits);
+    EXPECT_EQ(0u, reply.database_reads);
+    ASSERT_EQ(1u, reply.frames.size());
+    EXPECT_EQ(3u, reply.frames[0].keypoints.size());
+    EXPECT_EQ(3u, reply.frames[0].descriptors.size());
+    EXPECT_TRUE(reply.frames[0].image_data.empty());
+
+    query.image_id.clear();
+    query.count = 5;
+    query.include_image = true;
+    query.include_features = false;
+    reply = service.handle(query);
+    ASSERT_EQ(2u, reply.frames.size());
+    EXPECT_EQ("frame_2", reply.frames[0].image_id);
+    EXPECT_EQ(100u, reply.frames[0].image_data.size());
+    EXPECT_TRUE(reply.frames[0].keypoints.empty());
+    EXPECT_EQ(2u, reply.cache_hits);
+}
+
+TEST(QueryServiceTest, NewestQueriesIncludeFramesTooLargeToCache) {
+    TempDatabase db("voyis_query_oversized.db");
+    db.database().enableWriteAheadLog();
+    RecentFrameCache cache(8, 1000);
+    QueryService service("tcp://127.0.0.1:6006", cache, db.path(), nullptr);
+
+    const size_t sizes[] = {100, 100, 5000, 100};
+    for (size_t i = 0; i < 4; ++i) {
+        ProcessedImageMessage frame = makeFrame("frame_" + std::to_string(i + 1), sizes[i], 3);
+        int64_t row_id = 0;
+        ASSERT_TRUE(db.database().storeProcessedImage(frame, &row_id));
+        cache.insert(row_id, share(std::move(frame)));
+    }
+    db.database().flush();
+
+    // Metadata alone is answered from memory
+    FrameQuery query;
+    query.count = 4;
+    query.include_features = false;
+    FrameQueryReply reply = service.handle(query);
+    ASSERT_EQ(4u, reply.frames.size());
+    EXPECT_EQ(4u, reply.cache_hits);
+    EXPECT_EQ("frame_3", reply.frames[1].image_id);
+
+    // The oversized frame's image and features come from disk, in place
+    query.include_image = true;
+    query.include_features = true;
+    reply = service.handle(query);
+    EXPECT_TRUE(reply.error.empty()) << reply.error;
+    ASSERT_EQ(4u, reply.frames.size());
+    EXPECT_EQ(3u, reply.cache_hits);
+    EXPECT_EQ(1u, reply.database_reads);
+    for (size_t i = 0; i < 4; ++i) {
+        EXPECT_EQ("frame_" + std::to_string(4 - i), reply.frames[i].image_id);
+        EXPECT_EQ(sizes[3 - i], reply.frames[i].image_data.size());
+        EXPECT_EQ(3u, reply.frames[i].keypoints.size());
+    }
+
+    query.count = 1;
+    query.image_id = "frame_3";
+    reply = service.handle(query);
+    EXPECT_EQ(1u, reply.database_reads);
+    ASSERT_EQ(1u, reply.frames.size());
+    EXPECT_EQ(5000u, reply.frames[0].image_data.size());
+}
+
+TEST(QueryServiceTest, FallsBackToDatabaseForOlderFrames) {
+    TempDatabase db("voyis_query_fallback.db");
+    db.database().enableWriteAheadLog();
+    RecentFrameCache cache(1, 1 << 20);
+    QueryService service("tcp://127.0.0.1:6002", cache, db.path(), nullptr);
+
+    for (int i = 1; i <= 3; ++i) {
+        ProcessedImageMessage frame = makeFrame("frame_" + std::to_string(i), 50, 4);
+        int64_t row_id = 0;
+        ASSERT_TRUE(db.database().storeProcessedImage(frame, &row_id));
+        cache.insert(row_id, share(std::move(frame)));
+    }
+
+    FrameQuery query;
+    query.count = 3;
+    FrameQueryReply reply = service.handle(query);
+    EXPECT_TRUE(reply.error.empty()) << reply.error;
+    EXPECT_EQ(1u, reply.cache_hits);
+    EXPECT_EQ(2u, reply.database_reads);
+    ASSERT_EQ(3u, reply.frames.size());
+    EXPECT_EQ("frame_3", reply.frames[0].image_id);
+    EXPECT_EQ("frame_2", reply.frames[1].image_id);
+    EXPECT_EQ("frame_1", reply.frames[2].image_id);
+
+    const ProcessedImageMessage& stored = reply.frames[1];
+    EXPECT_EQ("cam0", stored.stream_id);
+    EXPECT_EQ(64, stored.width);
+    EXPECT_FLOAT_EQ(12.5f, stored.quality.sharpness);
+    EXPECT_EQ(4u, stored.descriptor_dim);
+    EXPECT_TRUE(stored.image_data.empty());
+    ASSERT_EQ(4u, stored.keypoints.size());
+    EXPECT_FLOAT_EQ(6.0f, stored.keypoints[3].pt.y);
+    ASSERT_EQ(4u, stored.descriptors.size());
+    EXPECT_FLOAT_EQ(3.0f, stored.descriptors[3][3]);
+
+    query.count = 1;
+    query.image_id = "frame_1";
+    query.include_image = true;
+    reply = service.handle(query);
+    EXPECT_EQ(1u, reply.database_reads);
+    ASSERT_EQ(1u, reply.frames.size());
+    EXPECT_EQ(50u, reply.frames[0].image_data.size());
+}
+
+TEST(QueryServiceTest, ReportsMissingFrames) {
+    TempDatabase db("voyis_query_missing.db");
+    RecentFrameCache cache(4, 1 << 20);
+    QueryService service("tcp://127.0.0.1:6003", cache, db.path(), nullptr);
+
+    FrameQuery query;
+    query.image_id = "never_logged";
+    FrameQueryReply reply = service.handle(query);
+    EXPECT_NE(std::string::npos, reply.error.find("not found"));
+    EXPECT_TRUE(reply.frames.empty());
+
+    EXPECT_THROW(QueryService("tcp://127.0.0.1:6004", cache,
+                              testing::TempDir() + "voyis_query_absent.db", nullptr),
+                 std::runtime_error);
+}
+
+TEST(QueryServiceTest, AnswersOverRequestReply) {
+    TempDatabase db("voyis_query_reqrep.db");
+    RecentFrameCache cache(4, 1 << 20);
+    cache.insert(1, share(makeFrame("frame_1", 10, 2)));
+    QueryService service("tcp://127.0.0.1:6005", cache, db.path(), nullptr);
+    Requester requester("tcp://127.0.0.1:6005", 5000);
+
+    FrameQuery query;
+    query.image_id = "frame_1";
+    std::vector<uint8_t> reply_data;
+    ASSERT_TRUE(requester.request(query.serialize(), reply_data));
+    FrameQueryReply reply = FrameQueryReply::deserialize(reply_data);
+    ASSERT_EQ(1u, reply.frames.size());
+    EXPECT_EQ(2u, reply.frames[0].keypoints.size());
+
+    ASSERT_TRUE(requester.request({1, 2, 3}, reply_data));
+    EXPECT_NE(std::string::npos, FrameQueryReply::deserialize(reply_data).error.find("Malformed"));
+}
@@ -0,0 +1,249 @@
+#include "feature_extractor/tiled_extractor.h"
+#include "feature_extractor/image_decoder.h"
+#include <gtest/gtest.h>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#ifdef VOYIS_HAVE_TIFF
+#include "feature_extractor/tiff_region_reader.h"
+#include <tiffio.h>
+#endif
+
+using namespace voyis;
+
+namespace {
+
+/**
+ * @brief Detector reporting every pixel of value 255, with its column as descriptor
+ */
+class BrightPixelDetector : public cv::Feature2D {
+public:
+    void detectAndCompute(cv::InputArray image, cv::InputArray, std::vector<cv::KeyPoint>& keypoints,
+                          cv::OutputArray descriptors, bool) override {
+        cv::Mat pixels = image.getMat();
+        cv::Mat rows;
+        for (int y = 0; y < pixels.rows; ++y) {
+            for (int x = 0; x < pixels.cols; ++x) {
+                if (pixels.at<uint8_t>(y, x) == 255) {
+                    keypoints.emplace_back(static_cast<float>(x), static_cast<float>(y), 1.0f);
+                    rows.push_back(cv::Mat(1, 1, CV_32F, cv::Scalar(x)));
+                }
+            }
+        }
+        rows.copyTo(descriptors);
+    }
+};
+
+RegionReader cropReader(const cv::Mat& image, std::atomic<int>* reads = nullptr) {
+    return [image, reads](const cv::Rect& rect) {
+        if (reads) {
+            ++*reads;
+        }
+        return image(rect).clone();
+    };
+}
+
+} // anonymous namespace
+
+TEST(TiledExtractorTest, PlanRegionsCoversImage) {
+    std::vector<cv::Rect> regions = planRegions(cv::Size(1000, 500), cv::Size(400, 400));
+    ASSERT_EQ(6u, regions.size());
+    EXPECT_EQ(cv::Rect(0, 0, 400, 400), regions[0]);
+    EXPECT_EQ(cv::Rect(800, 0, 200, 400), regions[2]);
+    EXPECT_EQ(cv::Rect(800, 400, 200, 100), regions[5]);
+
+    int area = 0;
+    for (const cv::Rect& region : regions) {
+        area += region.area();
+    }
+    EXPECT_EQ(1000 * 500, area);
+    EXPECT_THROW(planRegions(cv::Size(10, 10), cv::Size(0, 10)), std::invalid_argument);
+}
+
+TEST(TiledExtractorTest, FeaturesAreReportedOnceInImageCoordinates) {
+    cv::Mat image = cv::Mat::zeros(300, 500, CV_8UC1);
+    // Inside a region, in the overlap margin near a border, and on a corner
+    std::vector<cv::Point> points = {{10, 10}, {199, 50}, {201, 50}, {200, 200}, {499, 299}};
+    for (const cv::Point& p : points) {
+        image.at<uint8_t>(p) = 255;
+    }
+
+    std::atomic<int> reads(0);
+    TiledExtractionConfig config;
+    config.region_size = cv::Size(200, 200);
+    config.overlap = 16;
+    BrightPixelDetector detector;
+    TiledFeatures features = extractTiled(image.size(), cropReader(image, &reads), detector, config);
+
+    EXPECT_EQ(6u, features.regions);
+    EXPECT_EQ(6, reads.load());
+    ASSERT_EQ(points.size(), features.keypoints.size());
+    ASSERT_EQ(static_cast<int>(points.size()), features.descriptors.rows);
+
+    for (const cv::Point& p : points) {
+        int found = 0;
+        for (size_t i = 0; i < features.keypoints.size(); ++i) {
+            if (cv::Point(features.keypoints[i].pt) == p) {
+                ++found;
+                // Descriptors stay aligned with their keypoints
+                EXPECT_FLOAT_EQ(static_cast<float>(p.x - std::max(0, (p.x / 200) * 200 - 16)),
+                                features.descriptors.at<float>(static_cast<int>(i), 0));
+            }
+        }
+        EXPECT_EQ(1, found) << p;
+    }
+}
+
+TEST(TiledExtractorTest, PreviewMatchesWholeImageResize) {
+    cv::Mat image(900, 1200, CV_8UC1);
+    cv::randu(image, 0, 256);
+
+    cv::Mat preview = buildPreview(image.size(), cropReader(image), cv::Size(1200, 300), 400);
+    EXPECT_EQ(400, preview.cols);
+    EXPECT_EQ(300, preview.rows);
+
+    // Bands line up with a one-shot resize up to rounding at band edges
+    cv::Mat reference;
+    cv::resize(image, reference, preview.size(), 0, 0, cv::INTER_AREA);
+    EXPECT_LT(cv::norm(reference, preview, cv::NORM_L1) / preview.total(), 2.0);
+}
+
+TEST(TiledExtractorTest, DetectsTiffSignature) {
+    const uint8_t little[] = {'I', 'I', 42, 0};
+    const uint8_t big[] = {'M', 'M', 0, 42};
+    const uint8_t bigtiff[] = {'I', 'I', 43, 0};
+    const uint8_t other[] = {'I', 'I', 41, 0};
+    EXPECT_TRUE(isTiffData(little, sizeof(little)));
+    EXPECT_TRUE(isTiffData(big, sizeof(big)));
+    EXPECT_TRUE(isTiffData(bigtiff, sizeof(bigtiff)));
+    EXPECT_FALSE(isTiffData(other, sizeof(other)));
+}
+
+#ifdef VOYIS_HAVE_TIFF
+
+namespace {
+
+// Write a tiled 16-bit grayscale TIFF and return its bytes
+std::vector<uint8_t> encodeTiledTiff(const cv::Mat& image16, int tile) {
+    std::string path = testing::TempDir() + "voyis_tiled_test.tif";
+    TIFF* tiff = TIFFOpen(path.c_str(), "w");
+    TIFFSetField(tiff, TIFFTAG_IMAGEWIDTH, image16.cols);
+    TIFFSetField(tiff, TIFFTAG_IMAGELENGTH, image16.rows);
+    TIFFSetField(tiff, TIFFTAG_BITSPERSAMPLE, 16);
+    TIFFSetField(tiff, TIFFTAG_SAMPLESPERPIXEL, 1);
+    TIFFSetField(tiff, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_MINISBLACK);
+    TIFFSetField(tiff, TIFFTAG_COMPRESSION, COMPRESSION_DEFLATE);
+    TIFFSetField(tiff, TIFFTAG_TILEWIDTH, tile);
+    TIFFSetField(tiff, TIFFTAG_TILELENGTH, tile);
+
+    cv::Mat padded;
+    cv::copyMakeBorder(image16, padded, 0, tile, 0, tile, cv::BORDER_CONSTANT, 0);
+    for (int y = 0; y < image16.rows; y += tile) {
+        for (int x = 0; x < image16.cols; x += tile) {
+            cv::Mat block = padded(cv::Rect(x, y, tile, tile)).clone();
+            TIFFWriteTile(tiff, block.data, x, y, 0, 0);
+        }
+    }
+    TIFFClose(tiff);
+
+    std::ifstream file(path, std::ios::binary);
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::remove(path.c_str());
+    return bytes;
+}
+
+// Write an 8-bit grayscale TIFF in strips and return its bytes
+std::vector<uint8_t> encodeStripedTiff(const cv::Mat& image, int rows_per_strip, int compression) {
+    std::string path = testing::TempDir() + "voyis_striped_test.tif";
+    TIFF* tiff = TIFFOpen(path.c_str(), "w");
+    TIFFSetField(tiff, TIFFTAG_IMAGEWIDTH, image.cols);
+    TIFFSetField(tiff, TIFFTAG_IMAGELENGTH, image.rows);
+    TIFFSetField(tiff, TIFFTAG_BITSPERSAMPLE, 8);
+    TIFFSetField(tiff, TIFFTAG_SAMPLESPERPIXEL, 1);
+    TIFFSetField(tiff, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_MINISBLACK);
+    TIFFSetField(tiff, TIFFTAG_COMPRESSION, compression);
+    TIFFSetField(tiff, TIFFTAG_ROWSPERSTRIP, rows_per_strip);
+    for (int y = 0; y < image.rows; ++y) {
+        TIFFWriteScanline(tiff, const_cast<uint8_t*>(image.ptr<uint8_t>(y)), y, 0);
+    }
+    TIFFClose(tiff);
+
+    std::ifstream file(path, std::ios::binary);
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::remove(path.c_str());
+    return bytes;
+}
+
+} // anonymous namespace
+
+TEST(TiffRegionReaderTest, ReadsRegionsOfTiledTiff) {
+    cv::Mat image16(300, 500, CV_16UC1);
+    cv::randu(image16, 0, 65536);
+    std::vector<uint8_t> bytes = encodeTiledTiff(image16, 64);
+
+    TiffRegionReader reader(bytes.data(), bytes.size());
+    EXPECT_TRUE(reader.isTiled());
+    EXPECT_EQ(cv::Size(500, 300), reader.size());
+    EXPECT_EQ(cv::Size(64, 64), reader.chunkSize());
+    EXPECT_EQ(cv::Size(128, 128), reader.regionSize(100));
+
+    cv::Mat expected;
+    image16.convertTo(expected, CV_8U, 1.0 / 256.0);
+    cv::Rect roi(50, 70, 300, 200); // Crosses tile boundaries
+    cv::Mat region = reader.readRegion(roi);
+    EXPECT_EQ(0.0, cv::norm(expected(roi), region, cv::NORM_INF));
+
+    EXPECT_THROW(reader.readRegion(cv::Rect(400, 0, 200, 10)), std::runtime_error);
+}
+
+TEST(TiffRegionReaderTest, ReadsBandsOfStripedTiff) {
+    cv::Mat image(240, 320, CV_8UC1);
+    cv::randu(image, 0, 256);
+    std::vector<uint8_t> bytes;
+    ASSERT_TRUE(cv::imencode(".tif", image, bytes));
+
+    TiffRegionReader reader(bytes.data(), bytes.size());
+    EXPECT_FALSE(reader.isTiled());
+    EXPECT_EQ(320, reader.regionSize(64).width); // Strips span the full width
+
+    cv::Rect roi(10, 100, 200, 50);
+    EXPECT_EQ(0.0, cv::norm(image(roi), reader.readRegion(roi), cv::NORM_INF));
+}
+
+TEST(TiffRegionReaderTest, ReadsRowsOfUncompressedSingleStrip) {
+    cv::Mat image(240, 320, CV_8UC1);
+    cv::randu(image, 0, 256);
+    std::vector<uint8_t> bytes = encodeStripedTiff(image, image.rows, COMPRESSION_NONE);
+
+    // The whole image is one strip, but regions only touch their own rows
+    TiffRegionReader reader(bytes.data(), bytes.size());
+    EXPECT_EQ(cv::Size(320, 1), reader.chunkSize());
+    EXPECT_EQ(cv::Size(320, 64), reader.regionSize(64));
+
+    cv::Rect roi(10, 100, 200, 50);
+    EXPECT_EQ(0.0, cv::norm(image(roi), reader.readRegion(roi), cv::NORM_INF));
+}
+
+TEST(TiffRegionReaderTest, RejectsHugeCompressedStrips) {
+    // One deflated strip larger than the chunk limit
+    cv::Mat image(8200, 8200, CV_8UC1, cv::Scalar(0));
+    ASSERT_GT(image.total(), TiffRegionReader::kMaxChunkBytes);
+    std::vector<uint8_t> bytes = encodeStripedTiff(image, image.rows, COMPRESSION_DEFLATE);
+    EXPECT_THROW(TiffRegionReader(bytes.data(), bytes.size()), std::runtime_error);
+}
+
+TEST(TiffRegionReaderTest, RejectsOtherFormats) {
+    cv::Mat image(16, 16, CV_8UC1, cv::Scalar(0));
+    std::vector<uint8_t> png;
+    ASSERT_TRUE(cv::imencode(".png", image, png));
+    EXPECT_THROW(TiffRegionReader(png.data(), png.size()), std::runtime_error);
+}
+
+#endif // VOYIS_HAVE_TIFF
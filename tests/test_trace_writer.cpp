@@ -0,0 +1,147 @@
+#include "trace_writer.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+using namespace voyis;
+
+namespace {
+
+std::string readFile(const std::string& path) {
+    std::ifstream file(path);
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+size_t countOf(const std::string& text, const std::string& needle) {
+    size_t count = 0;
+    for (size_t pos = text.find(needle); pos != std::string::npos;
+         pos = text.find(needle, pos + 1)) {
+        ++count;
+    }
+    return count;
+}
+
+constexpr std::chrono::hours kNoPeriodicFlush(1);
+
+} // anonymous namespace
+
+TEST(TraceWriterTest, WritesCompleteEventsAsJsonArray) {
+    std::string path = testing::TempDir() + "voyis_trace_test.json";
+    {
+        TraceWriter writer(path, "test_process", kNoPeriodicFlush);
+        writer.record("decode", 1000000, 1250500, "img_1.jpg_0");
+        writer.record("publish", 2000000, 2000100, "img_1.jpg_0", 5556);
+        EXPECT_EQ(0u, writer.written());
+    }
+    std::string trace = readFile(path);
+    std::remove(path.c_str());
+
+    EXPECT_EQ(0u, trace.find("[\n"));
+    EXPECT_EQ(trace.size() - 3, trace.rfind("\n]\n"));
+    EXPECT_NE(std::string::npos, trace.find("\"name\":\"process_name\""));
+    EXPECT_NE(std::string::npos, trace.find("\"name\":\"test_process\""));
+    EXPECT_NE(std::string::npos, trace.find("\"name\":\"clock_sync\""));
+    EXPECT_NE(std::string::npos, trace.find("\"boot_id\":"));
+
+    // Microsecond timestamps with nanosecond precision
+    EXPECT_NE(std::string::npos, trace.find("\"name\":\"decode\",\"cat\":\"frame\",\"ph\":\"X\","
+                                            "\"ts\":1000.000,\"dur\":250.500"));
+    EXPECT_NE(std::string::npos, trace.find("\"args\":{\"frame\":\"img_1.jpg_0\",\"port\":5556}"));
+    EXPECT_NE(std::string::npos, trace.find("\"spans\":2,\"dropped\":0"));
+    EXPECT_EQ(std::string::npos, trace.find(",\n]"));
+}
+
+TEST(TraceWriterTest, FlusherWritesWhileRunning) {
+    std::string path = testing::TempDir() + "voyis_trace_periodic.json";
+    TraceWriter writer(path, "test_process", std::chrono::milliseconds(10));
+    writer.record("read", 1000, 2000, "frame_0");
+
+    for (int i = 0; i < 200 && writer.written() == 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_EQ(1u, writer.written());
+    EXPECT_NE(std::string::npos, readFile(path).find("\"frame\":\"frame_0\""));
+    std::remove(path.c_str());
+}
+
+TEST(TraceWriterTest, FullRingDropsSpans) {
+    std::string path = testing::TempDir() + "voyis_trace_dropped.json";
+    {
+        TraceWriter writer(path, "test_process", kNoPeriodicFlush, 4);
+        for (int i = 0; i < 10; ++i) {
+            writer.record("detect", 0, 1, "frame");
+        }
+        EXPECT_EQ(6u, writer.dropped());
+
+        writer.flush();
+        EXPECT_EQ(4u, writer.written());
+        writer.record("detect", 0, 1, "frame");
+        EXPECT_EQ(6u, writer.dropped());
+    }
+    std::string trace = readFile(path);
+    std::remove(path.c_str());
+    EXPECT_EQ(5u, countOf(trace, "\"name\":\"detect\""));
+}
+
+TEST(TraceWriterTest, ThreadsGetNamedTracks) {
+    std::string path = testing::TempDir() + "voyis_trace_threads.json";
+    {
+        TraceWriter writer(path, "test_process", kNoPeriodicFlush);
+        writer.nameThread("main");
+        writer.record("commit", 0, 1, "a");
+        std::thread worker([&writer]() {
+            writer.nameThread("receiver");
+            for (int i = 0; i < 100; ++i) {
+                writer.record("receive", 0, 1, "b");
+            }
+        });
+        worker.join();
+    }
+    std::string trace = readFile(path);
+    std::remove(path.c_str());
+
+    EXPECT_EQ(2u, countOf(trace, "\"name\":\"thread_name\""));
+    EXPECT_NE(std::string::npos, trace.find("\"args\":{\"name\":\"receiver\"}"));
+    EXPECT_EQ(100u, countOf(trace, "\"name\":\"receive\""));
+}
+
+TEST(TraceWriterTest, SpansRecordOnlyIntoActiveWriter) {
+    std::string path = testing::TempDir() + "voyis_trace_span.json";
+    {
+        TraceWriter writer(path, "test_process", kNoPeriodicFlush);
+        { TraceSpan ignored("serialize", "not_traced"); }
+
+        TraceWriter::setActive(&writer);
+        std::string frame_id = "frame_\"7\"";
+        {
+            TraceSpan span("serialize", frame_id, 5555);
+            std::string moved = std::move(frame_id); // Span keeps its own copy
+        }
+        TraceSpan early("publish", "frame_8");
+        early.end();
+        early.end();
+        writer.flush();
+        EXPECT_EQ(2u, writer.written());
+    }
+    EXPECT_EQ(nullptr, TraceWriter::active()); // Cleared by the destructor
+
+    std::string trace = readFile(path);
+    std::remove(path.c_str());
+    EXPECT_EQ(std::string::npos, trace.find("not_traced"));
+    EXPECT_NE(std::string::npos, trace.find("\"frame\":\"frame_\\\"7\\\"\",\"port\":5555"));
+}
+
+TEST(TraceWriterTest, EndpointPort) {
+    EXPECT_EQ(5555, endpointPort("tcp://*:5555"));
+    EXPECT_EQ(5556, endpointPort("tcp://localhost:5556"));
+    EXPECT_EQ(0, endpointPort("inproc://frames"));
+    EXPECT_EQ(0, endpointPort("tcp://localhost:"));
+}
+
+TEST(TraceWriterTest, UnwritablePathThrows) {
+    EXPECT_THROW(TraceWriter("/nonexistent/dir/trace.json", "test_process"), std::runtime_error);
+}
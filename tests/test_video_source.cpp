@@ -0,0 +1,134 @@
+#include "video_source.h"
+#include <gtest/gtest.h>
+#include <opencv2/videoio.hpp>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace voyis;
+
+namespace {
+
+constexpr int kFrames = 10;
+constexpr double kFps = 10.0;
+
+/**
+ * @brief Motion JPEG AVI whose frames get brighter, 100 ms apart
+ */
+std::string writeTestVideo(const std::string& name) {
+    std::string path = testing::TempDir() + name;
+    cv::VideoWriter writer(path, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), kFps,
+                           cv::Size(64, 48), true);
+    if (!writer.isOpened()) {
+        return "";
+    }
+    for (int i = 0; i < kFrames; ++i) {
+        cv::Mat frame(48, 64, CV_8UC3, cv::Scalar::all(20 + 20 * i));
+        writer.write(frame);
+    }
+    writer.release();
+    return path;
+}
+
+std::vector<VideoFrame> readFrames(VideoSource& source, size_t limit) {
+    std::vector<VideoFrame> frames;
+    while (frames.size() < limit && !source.finished()) {
+        VideoFrame frame;
+        if (source.next(frame, 1000)) {
+            frames.push_back(std::move(frame));
+        }
+    }
+    return frames;
+}
+
+VideoSourceConfig onePass() {
+    VideoSourceConfig config;
+    config.loop = false;
+    config.queue_frames = 2; // Decoder has to wait for the reader
+    return config;
+}
+
+} // anonymous namespace
+
+TEST(VideoSourceTest, DecodesRawFramesWithTimestamps) {
+    std::string path = writeTestVideo("voyis_video_raw.avi");
+    if (path.empty()) {
+        GTEST_SKIP() << "No Motion JPEG writer in this OpenCV build";
+    }
+
+    VideoSource source(path, onePass());
+    EXPECT_NEAR(kFps, source.nativeFps(), 0.01);
+    std::vector<VideoFrame> frames = readFrames(source, 100);
+    ASSERT_EQ(static_cast<size_t>(kFrames), frames.size());
+    EXPECT_TRUE(source.finished());
+    EXPECT_TRUE(source.error().empty());
+
+    for (int i = 0; i < kFrames; ++i) {
+        const VideoFrame& frame = frames[i];
+        EXPECT_EQ(i, frame.index);
+        EXPECT_NEAR(i * 100.0, frame.pts_ms, 1.0);
+        EXPECT_EQ("mono8", frame.format);
+        EXPECT_EQ(64, frame.width);
+        EXPECT_EQ(48, frame.height);
+        EXPECT_EQ(64, frame.stride);
+        EXPECT_EQ(64u * 48u, frame.data.size());
+    }
+    EXPECT_GT(frames.back().data[0], frames.front().data[0]); // Brighter over time
+    std::remove(path.c_str());
+}
+
+TEST(VideoSourceTest, DecimatesToTargetRateAndLoops) {
+    std::string path = writeTestVideo("voyis_video_loop.avi");
+    if (path.empty()) {
+        GTEST_SKIP() << "No Motion JPEG writer in this OpenCV build";
+    }
+
+    VideoSourceConfig config;
+    config.fps = 5.0;
+    VideoSource source(path, config);
+    std::vector<VideoFrame> frames = readFrames(source, 8);
+    ASSERT_EQ(8u, frames.size());
+    for (size_t i = 0; i < frames.size(); ++i) {
+        // Every other frame, with the timeline carrying on into the second pass
+        EXPECT_EQ(static_cast<int64_t>(2 * i), frames[i].index);
+        EXPECT_NEAR(200.0 * i, frames[i].pts_ms, 1.0);
+    }
+    EXPECT_FALSE(source.finished());
+    std::remove(path.c_str());
+}
+
+TEST(VideoSourceTest, EncodesFramesAsJpeg) {
+    std::string path = writeTestVideo("voyis_video_jpeg.avi");
+    if (path.empty()) {
+        GTEST_SKIP() << "No Motion JPEG writer in this OpenCV build";
+    }
+
+    VideoSourceConfig config = onePass();
+    config.encoding = "jpg";
+    VideoSource source(path, config);
+    std::vector<VideoFrame> frames = readFrames(source, 1);
+    ASSERT_EQ(1u, frames.size());
+    EXPECT_EQ("jpg", frames[0].format);
+    EXPECT_EQ(0, frames[0].stride);
+    ASSERT_GT(frames[0].data.size(), 2u);
+    EXPECT_EQ(0xff, frames[0].data[0]);
+    EXPECT_EQ(0xd8, frames[0].data[1]);
+    std::remove(path.c_str());
+}
+
+TEST(VideoSourceTest, RejectsBadConfiguration) {
+    VideoSourceConfig config;
+    config.encoding = "bmp";
+    EXPECT_THROW(VideoSource("clip.avi", config), std::invalid_argument);
+    EXPECT_THROW(VideoSource(testing::TempDir() + "voyis_missing.avi", onePass()),
+                 std::runtime_error);
+}
+
+TEST(VideoSourceTest, RecognizesVideoNames) {
+    EXPECT_TRUE(isVideoFile("/data/dive_042.mp4"));
+    EXPECT_TRUE(isVideoFile("camera.MJPEG"));
+    EXPECT_TRUE(isVideoFile("stream.h264"));
+    EXPECT_FALSE(isVideoFile("/data/video.d/frames"));
+    EXPECT_FALSE(isVideoFile("image.jpg"));
+}
@@ -0,0 +1,94 @@
+#include "work_stealing_pool.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace voyis;
+
+namespace {
+
+// Recursively split a range sum into pool tasks
+void parallelSum(WorkStealingPool& pool, const std::vector<int>& values, size_t begin, size_t end,
+                 std::atomic<long long>& total) {
+    if (end - begin <= 64) {
+        long long sum = 0;
+        for (size_t i = begin; i < end; ++i) {
+            sum += values[i];
+        }
+        total += sum;
+        return;
+    }
+    size_t mid = begin + (end - begin) / 2;
+    pool.submit([&pool, &values, mid, end, &total]() { parallelSum(pool, values, mid, end, total); });
+    parallelSum(pool, values, begin, mid, total);
+}
+
+} // anonymous namespace
+
+TEST(WorkStealingPoolTest, RunsEverySubmittedTask) {
+    WorkStealingPool pool(4);
+    EXPECT_EQ(4u, pool.size());
+
+    std::atomic<int> count(0);
+    for (int i = 0; i < 10000; ++i) {
+        pool.submit([&count]() { count.fetch_add(1); });
+    }
+    pool.waitIdle();
+    EXPECT_EQ(10000, count.load());
+}
+
+TEST(WorkStealingPoolTest, AsyncReturnsResultsAndExceptions) {
+    WorkStealingPool pool(2);
+    std::future<int> answer = pool.async([]() { return 6 * 7; });
+    std::future<void> failure = pool.async([]() { throw std::runtime_error("bad frame"); });
+
+    EXPECT_EQ(42, answer.get());
+    EXPECT_THROW(failure.get(), std::runtime_error);
+}
+
+TEST(WorkStealingPoolTest, NestedTasksComplete) {
+    std::vector<int> values(100000);
+    long long expected = 0;
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = static_cast<int>(i % 1000);
+        expected += values[i];
+    }
+
+    WorkStealingPool pool(4);
+    std::atomic<long long> total(0);
+    pool.submit([&]() { parallelSum(pool, values, 0, values.size(), total); });
+    pool.waitIdle();
+
+    EXPECT_EQ(expected, total.load());
+}
+
+TEST(WorkStealingPoolTest, IdleWorkerStealsFromBusyOne) {
+    WorkStealingPool pool(2);
+    std::atomic<bool> inner_ran(false);
+
+    // The inner task lands on the outer task's own deque while that worker is
+    // blocked, so only the other worker can run it
+    pool.submit([&]() {
+        pool.submit([&]() { inner_ran = true; });
+        while (!inner_ran) {
+            std::this_thread::yield();
+        }
+    });
+    pool.waitIdle();
+
+    EXPECT_TRUE(inner_ran);
+    EXPECT_GE(pool.steals(), 1u);
+}
+
+TEST(WorkStealingPoolTest, DestructorDrainsQueuedTasks) {
+    std::atomic<int> count(0);
+    {
+        WorkStealingPool pool(1);
+        for (int i = 0; i < 100; ++i) {
+            pool.submit([&count]() { count.fetch_add(1); });
+        }
+    }
+    EXPECT_EQ(100, count.load());
+}